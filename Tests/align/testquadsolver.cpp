@@ -0,0 +1,236 @@
+/*  Quad Solver Tests
+    Copyright (C) 2020 KStars Developers
+
+    This application is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public
+    License as published by the Free Software Foundation; either
+    version 2 of the License, or (at your option) any later version.
+ */
+
+#include "testquadsolver.h"
+
+#include "ekos/align/quadsolver.h"
+
+#include <QtTest>
+
+#include <cmath>
+
+using namespace Ekos;
+
+namespace
+{
+const double catalogRA  = 83;
+const double catalogDEC = -5;
+const int width         = 1200;
+const int height        = 800;
+const double pixscale   = 4.5;
+
+// Simple LCG so the tests are repeatable
+class Random
+{
+  public:
+    explicit Random(uint32_t seed) : m_Seed(seed) {}
+    double uniform()
+    {
+        m_Seed = m_Seed * 1103515245 + 12345;
+        return ((m_Seed >> 8) & 0xFFFFFF) / 16777216.0;
+    }
+
+  private:
+    uint32_t m_Seed;
+};
+
+void basis(double ra, double dec, double *east, double *north, double *center)
+{
+    const double a = ra * M_PI / 180, d = dec * M_PI / 180;
+    east[0]   = -sin(a);
+    east[1]   = cos(a);
+    east[2]   = 0;
+    north[0]  = -sin(d) * cos(a);
+    north[1]  = -sin(d) * sin(a);
+    north[2]  = cos(d);
+    center[0] = cos(d) * cos(a);
+    center[1] = cos(d) * sin(a);
+    center[2] = sin(d);
+}
+
+// Uniform star field in a 5 degrees cap, brighter stars are rarer
+QVector<quad_catalog_star_t> catalog()
+{
+    Random random(7);
+    double east[3], north[3], center[3];
+    basis(catalogRA, catalogDEC, east, north, center);
+
+    QVector<quad_catalog_star_t> stars;
+    const double capCos = cos(5 * M_PI / 180);
+    for (int i = 0; i < 1500; i++)
+    {
+        const double z   = capCos + (1 - capCos) * random.uniform();
+        const double phi = 2 * M_PI * random.uniform();
+        const double r   = sqrt(1 - z * z);
+
+        double v[3];
+        for (int k = 0; k < 3; k++)
+            v[k] = r * cos(phi) * east[k] + r * sin(phi) * north[k] + z * center[k];
+
+        quad_catalog_star_t star;
+        star.ra = atan2(v[1], v[0]) * 180 / M_PI;
+        if (star.ra < 0)
+            star.ra += 360;
+        star.dec = asin(v[2]) * 180 / M_PI;
+        star.mag = 12 + 2 * log10(random.uniform() + 1e-6);
+        stars.append(star);
+    }
+
+    return stars;
+}
+
+// Projects the catalog on an image centered on (ra, dec), with North rotated by orientation degrees East of up
+QVector<quad_image_star_t> image(const QVector<quad_catalog_star_t> &stars, double ra, double dec, double orientation,
+                                 bool mirrored)
+{
+    Random random(11);
+    double east[3], north[3], center[3];
+    basis(ra, dec, east, north, center);
+
+    const double scale = pixscale / 206264.8062470963552;
+    const double rot   = orientation * M_PI / 180;
+
+    QVector<quad_image_star_t> result;
+    for (const auto &star : stars)
+    {
+        const double a = star.ra * M_PI / 180, d = star.dec * M_PI / 180;
+        const double v[3] = { cos(d) * cos(a), cos(d) * sin(a), sin(d) };
+        const double dot  = v[0] * center[0] + v[1] * center[1] + v[2] * center[2];
+        if (dot <= 0)
+            continue;
+
+        const double xi  = (v[0] * east[0] + v[1] * east[1] + v[2] * east[2]) / dot;
+        const double eta = (v[0] * north[0] + v[1] * north[1] + v[2] * north[2]) / dot;
+
+        // East is on the left of an image that is not mirrored
+        double u       = (-xi * cos(rot) + eta * sin(rot)) / scale;
+        const double w = (xi * sin(rot) + eta * cos(rot)) / scale;
+        if (mirrored)
+            u = -u;
+
+        quad_image_star_t pixel;
+        pixel.x    = width / 2.0 + u + random.uniform() - 0.5;
+        pixel.y    = height / 2.0 + w + random.uniform() - 0.5;
+        pixel.flux = pow(10, -0.4 * star.mag);
+        if (pixel.x >= 0 && pixel.y >= 0 && pixel.x < width && pixel.y < height)
+            result.append(pixel);
+    }
+
+    return result;
+}
+}
+
+void TestQuadSolver::emptyIndex()
+{
+    QuadSolver solver;
+    quad_solution_t solution;
+
+    QVERIFY(solver.buildIndex(0.1, 0.6) == false);
+    QCOMPARE(solver.indexSize(), 0);
+    QVERIFY(solver.solve(QVector<quad_image_star_t>(), width, height, 0, 0, solution) == false);
+}
+
+void TestQuadSolver::solveField_data()
+{
+    QTest::addColumn<double>("orientation");
+    QTest::addColumn<bool>("mirrored");
+
+    QTest::newRow("north up") << 0.0 << false;
+    QTest::newRow("rotated") << 30.0 << false;
+    QTest::newRow("rotated mirrored") << 120.0 << true;
+    QTest::newRow("rotated negative") << -150.0 << false;
+}
+
+void TestQuadSolver::solveField()
+{
+    QFETCH(double, orientation);
+    QFETCH(bool, mirrored);
+
+    const QVector<quad_catalog_star_t> stars = catalog();
+    const double ra = catalogRA + 0.3, dec = catalogDEC - 0.2;
+
+    QuadSolver solver;
+    solver.setCatalog(stars);
+    QVERIFY(solver.buildIndex(0.1, 0.6));
+    QVERIFY(solver.indexSize() > 0);
+
+    quad_solution_t solution;
+    QVERIFY(solver.solve(image(stars, ra, dec, orientation, mirrored), width, height, pixscale * 0.8, pixscale * 1.2,
+                         solution));
+
+    QVERIFY(fabs(solution.ra - ra) < 0.001);
+    QVERIFY(fabs(solution.dec - dec) < 0.001);
+    QVERIFY(fabs(solution.pixscale - pixscale) < 0.05);
+    QVERIFY(fabs(remainder(solution.orientation - orientation, 360)) < 0.1);
+    QCOMPARE(solution.mirrored, mirrored);
+    QVERIFY(solution.matches >= 6);
+}
+
+void TestQuadSolver::unknownScale()
+{
+    const QVector<quad_catalog_star_t> stars = catalog();
+
+    QuadSolver solver;
+    solver.setCatalog(stars);
+    QVERIFY(solver.buildIndex(0.1, 0.6));
+
+    quad_solution_t solution;
+    QVERIFY(solver.solve(image(stars, catalogRA, catalogDEC, 45, false), width, height, 0, 0, solution));
+    QVERIFY(fabs(solution.ra - catalogRA) < 0.001);
+    QVERIFY(fabs(solution.dec - catalogDEC) < 0.001);
+    QVERIFY(fabs(solution.pixscale - pixscale) < 0.05);
+}
+
+void TestQuadSolver::unrelatedStars()
+{
+    QuadSolver solver;
+    solver.setCatalog(catalog());
+    QVERIFY(solver.buildIndex(0.1, 0.6));
+
+    Random random(3);
+    QVector<quad_image_star_t> stars;
+    for (int i = 0; i < 60; i++)
+    {
+        quad_image_star_t star;
+        star.x    = random.uniform() * width;
+        star.y    = random.uniform() * height;
+        star.flux = random.uniform();
+        stars.append(star);
+    }
+
+    quad_solution_t solution;
+    QVERIFY(solver.solve(stars, width, height, pixscale * 0.8, pixscale * 1.2, solution) == false);
+}
+
+void TestQuadSolver::abortBeforeStart()
+{
+    const QVector<quad_catalog_star_t> stars = catalog();
+
+    QuadSolver solver;
+    solver.setCatalog(stars);
+
+    // An abort that lands before the solve starts is kept until the next reset
+    solver.abort();
+    QVERIFY(solver.buildIndex(0.1, 0.6) == false);
+    QCOMPARE(solver.indexSize(), 0);
+
+    solver.reset();
+    QVERIFY(solver.buildIndex(0.1, 0.6));
+
+    quad_solution_t solution;
+    solver.abort();
+    QVERIFY(solver.solve(image(stars, catalogRA, catalogDEC, 0, false), width, height, pixscale * 0.8,
+                         pixscale * 1.2, solution) == false);
+
+    solver.reset();
+    QVERIFY(solver.solve(image(stars, catalogRA, catalogDEC, 0, false), width, height, pixscale * 0.8,
+                         pixscale * 1.2, solution));
+}
+
+QTEST_GUILESS_MAIN(TestQuadSolver)
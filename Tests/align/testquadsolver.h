@@ -0,0 +1,33 @@
+/*  Quad Solver Tests
+    Copyright (C) 2020 KStars Developers
+
+    This application is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public
+    License as published by the Free Software Foundation; either
+    version 2 of the License, or (at your option) any later version.
+ */
+
+#pragma once
+
+#include <QObject>
+
+/**
+ * @class TestQuadSolver
+ * @short Tests for the local quad hash plate solver
+ */
+class TestQuadSolver : public QObject
+{
+    Q_OBJECT
+
+  public:
+    TestQuadSolver() : QObject() {}
+    ~TestQuadSolver() override = default;
+
+  private slots:
+    void emptyIndex();
+    void solveField_data();
+    void solveField();
+    void unknownScale();
+    void unrelatedStars();
+    void abortBeforeStart();
+};
@@ -0,0 +1,571 @@
+/*  Capture Sequence Replay
+    Copyright (C) 2020 KStars Developers
+
+    This application is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public
+    License as published by the Free Software Foundation; either
+    version 2 of the License, or (at your option) any later version.
+ */
+
+#include "testcapturereplay.h"
+
+#include "Options.h"
+#include "ekos/capture/sequencejob.h"
+#include "fitsviewer/fitsdata.h"
+#include "indi/clientmanager.h"
+#include "indi/deviceinfo.h"
+#include "indi/driverinfo.h"
+#include "indi/indiccd.h"
+
+#include <basedevice.h>
+#include <indiapi.h>
+#include <lilxml.h>
+
+#include <QElapsedTimer>
+#include <QEventLoop>
+#include <QFile>
+#include <QFileInfo>
+#include <QLocale>
+#include <QStandardPaths>
+#include <QTemporaryDir>
+#include <QTimer>
+#include <QtTest>
+
+#include <cmath>
+#include <cstring>
+#include <memory>
+#include <vector>
+
+namespace
+{
+// Simple LCG so the frames are repeatable
+class Random
+{
+  public:
+    explicit Random(uint32_t seed) : m_Seed(seed) {}
+    double uniform()
+    {
+        m_Seed = m_Seed * 1103515245 + 12345;
+        return ((m_Seed >> 8) & 0xFFFFFF) / 16777216.0;
+    }
+
+  private:
+    uint32_t m_Seed;
+};
+
+double environment(const char *name, double defaultValue)
+{
+    bool ok = false;
+    const double value = QString::fromLocal8Bit(qgetenv(name)).toDouble(&ok);
+    return (ok && value > 0) ? value : defaultValue;
+}
+
+QString sequenceFile()
+{
+    const QString file = QString::fromLocal8Bit(qgetenv("KSTARS_REPLAY_SEQUENCE"));
+    return file.isEmpty() ? QFINDTESTDATA("2x10x20s_refocus1min.esq") : file;
+}
+
+int childValue(XMLEle *ep, const char *name, int defaultValue)
+{
+    XMLEle *subEP = findXMLEle(ep, name);
+    return subEP ? QLocale::c().toInt(pcdataXMLEle(subEP)) : defaultValue;
+}
+
+CCDFrameType frameType(const QString &name)
+{
+    if (name == "Bias")
+        return FRAME_BIAS;
+    if (name == "Dark")
+        return FRAME_DARK;
+    if (name == "Flat")
+        return FRAME_FLAT;
+    return FRAME_LIGHT;
+}
+
+// Reads the jobs of a sequence file, as far as the camera is concerned, and sets them up the way
+// Capture::addJob does from the fields Capture::processJobInfo fills. The caller owns the jobs.
+QList<Ekos::SequenceJob *> readSequence(const QString &filename)
+{
+    QList<Ekos::SequenceJob *> jobs;
+
+    QFile sFile(filename);
+    if (!sFile.open(QIODevice::ReadOnly))
+        return jobs;
+
+    LilXML *xmlParser = newLilXML();
+    char errmsg[MAXRBUF];
+    QLocale cLocale = QLocale::c();
+    char c;
+
+    while (sFile.getChar(&c))
+    {
+        XMLEle *root = readXMLEle(xmlParser, c, errmsg);
+        if (root == nullptr)
+        {
+            if (errmsg[0])
+                break;
+            continue;
+        }
+
+        for (XMLEle *ep = nextXMLEle(root, 1); ep != nullptr; ep = nextXMLEle(root, 0))
+        {
+            if (strcmp(tagXMLEle(ep), "Job"))
+                continue;
+
+            double exposure = 1;
+            int count = 1, delay = 0, binX = 1, binY = 1;
+            int x = 0, y = 0, w = 1280, h = 1024;
+            QString filter, type = "Light", rawPrefix, directory;
+            bool filterEnabled = false, expEnabled = false, tsEnabled = false;
+
+            for (XMLEle *jobEP = nextXMLEle(ep, 1); jobEP != nullptr; jobEP = nextXMLEle(ep, 0))
+            {
+                if (!strcmp(tagXMLEle(jobEP), "Exposure"))
+                    exposure = cLocale.toDouble(pcdataXMLEle(jobEP));
+                else if (!strcmp(tagXMLEle(jobEP), "Count"))
+                    count = cLocale.toInt(pcdataXMLEle(jobEP));
+                else if (!strcmp(tagXMLEle(jobEP), "Delay"))
+                    delay = cLocale.toInt(pcdataXMLEle(jobEP));
+                else if (!strcmp(tagXMLEle(jobEP), "Filter"))
+                    filter = pcdataXMLEle(jobEP);
+                else if (!strcmp(tagXMLEle(jobEP), "Type"))
+                    type = pcdataXMLEle(jobEP);
+                else if (!strcmp(tagXMLEle(jobEP), "FITSDirectory"))
+                    directory = pcdataXMLEle(jobEP);
+                else if (!strcmp(tagXMLEle(jobEP), "Binning"))
+                {
+                    binX = qMax(1, childValue(jobEP, "X", 1));
+                    binY = qMax(1, childValue(jobEP, "Y", 1));
+                }
+                else if (!strcmp(tagXMLEle(jobEP), "Frame"))
+                {
+                    x = childValue(jobEP, "X", x);
+                    y = childValue(jobEP, "Y", y);
+                    w = childValue(jobEP, "W", w);
+                    h = childValue(jobEP, "H", h);
+                }
+                else if (!strcmp(tagXMLEle(jobEP), "Prefix"))
+                {
+                    XMLEle *subEP = findXMLEle(jobEP, "RawPrefix");
+                    if (subEP)
+                        rawPrefix = pcdataXMLEle(subEP);
+                    filterEnabled = childValue(jobEP, "FilterEnabled", 0) == 1;
+                    expEnabled    = childValue(jobEP, "ExpEnabled", 0) == 1;
+                    tsEnabled     = childValue(jobEP, "TimeStampEnabled", 0) == 1;
+                }
+            }
+
+            // Same as Capture::constructPrefix
+            QString prefix = rawPrefix;
+            if (prefix.isEmpty() == false)
+                prefix += '_';
+            prefix += type;
+            if (filterEnabled && filter.isEmpty() == false &&
+                    (frameType(type) == FRAME_LIGHT || frameType(type) == FRAME_FLAT))
+                prefix += '_' + filter;
+            if (expEnabled)
+                prefix += '_' + QString::number(exposure, 'f', exposure == static_cast<int>(exposure) ? 0 : 3) +
+                          QString("_secs");
+            if (tsEnabled)
+                prefix += Ekos::SequenceJob::ISOMarker;
+
+            Ekos::SequenceJob *job = new Ekos::SequenceJob();
+            job->setPrefixSettings(rawPrefix, filterEnabled, expEnabled, tsEnabled);
+            job->setFrameType(frameType(type));
+            job->setFullPrefix(prefix);
+            // No filter wheel, the name only goes into the prefix and the FITS header
+            job->setTargetFilter(-1, filter);
+            job->setExposure(exposure);
+            job->setCount(count);
+            job->setBin(binX, binY);
+            job->setDelay(delay * 1000); /* in ms */
+            job->setFrame(x, y, w, h);
+            job->setLocalDir(directory);
+            jobs.append(job);
+        }
+
+        delXMLEle(root);
+    }
+
+    delLilXML(xmlParser);
+    return jobs;
+}
+
+// 16 bit FITS image of a noisy star field, as a camera driver sends it
+QByteArray syntheticFITS(int width, int height, double exposure, const QString &filter, uint32_t seed)
+{
+    QByteArray fits;
+    auto card = [&fits](const QString &text)
+    {
+        fits.append(text.leftJustified(80, ' ', true).toLatin1());
+    };
+
+    card(QString("SIMPLE  = %1").arg("T", 20));
+    card(QString("BITPIX  = %1").arg(16, 20));
+    card(QString("NAXIS   = %1").arg(2, 20));
+    card(QString("NAXIS1  = %1").arg(width, 20));
+    card(QString("NAXIS2  = %1").arg(height, 20));
+    card(QString("BZERO   = %1").arg(32768, 20));
+    card(QString("BSCALE  = %1").arg(1, 20));
+    card(QString("EXPTIME = %1").arg(exposure, 20, 'f', 3));
+    card(QString("FILTER  = '%1'").arg(filter.leftJustified(8)));
+    card("END");
+    fits.append(QByteArray((2880 - fits.size() % 2880) % 2880, ' '));
+
+    Random random(seed);
+    std::vector<double> pixels(static_cast<size_t>(width) * height);
+    for (double &pixel : pixels)
+        pixel = 1000 + 60 * random.uniform();
+
+    for (int i = 0; i < 80; i++)
+    {
+        const double x = 8 + random.uniform() * (width - 16);
+        const double y = 8 + random.uniform() * (height - 16);
+        const double amplitude = 2000 + random.uniform() * 20000;
+        for (int dy = -5; dy <= 5; dy++)
+        {
+            for (int dx = -5; dx <= 5; dx++)
+            {
+                const int px = static_cast<int>(x) + dx, py = static_cast<int>(y) + dy;
+                const double r2 = (px - x) * (px - x) + (py - y) * (py - y);
+                pixels[static_cast<size_t>(py) * width + px] += amplitude * exp(-r2 / (2 * 1.5 * 1.5));
+            }
+        }
+    }
+
+    // Big endian, signed with BZERO
+    const int dataStart = fits.size();
+    fits.resize(dataStart + static_cast<int>(pixels.size()) * 2);
+    char *data = fits.data() + dataStart;
+    for (const double pixel : pixels)
+    {
+        const uint16_t value = static_cast<uint16_t>(qBound(0.0, pixel, 65535.0)) ^ 0x8000;
+        *data++ = static_cast<char>(value >> 8);
+        *data++ = static_cast<char>(value & 0xFF);
+    }
+    fits.append(QByteArray((2880 - fits.size() % 2880) % 2880, '\0'));
+
+    return fits;
+}
+
+/**
+ * Plays the part of the camera driver and of Capture around a real ISD::CCD. The sequence jobs set the camera
+ * up for each exposure, the camera driver hands a synthetic FITS BLOB to CCD::processBLOB once the exposure is
+ * over, and the next exposure starts when the camera emits BLOBUpdated for the frame, as it does for Capture.
+ */
+class CameraReplay
+{
+  public:
+    CameraReplay(const QList<Ekos::SequenceJob *> &jobs, int depth, double timeScale, double sizeScale)
+        : m_Jobs(jobs), m_Depth(depth), m_TimeScale(timeScale), m_Driver("CCD Simulator")
+    {
+        m_Device.setDeviceName("CCD Simulator");
+        m_Driver.setClientManager(&m_ClientManager);
+        m_DeviceInfo.reset(new DeviceInfo(&m_Driver, &m_Device));
+        m_CCD.reset(new ISD::CCD(new ISD::GenericDevice(*m_DeviceInfo)));
+
+        // The camera property of the primary chip, as the client library fills it for each frame
+        memset(&m_BLOBProperty, 0, sizeof(m_BLOBProperty));
+        memset(&m_BLOB, 0, sizeof(m_BLOB));
+        strncpy(m_BLOBProperty.device, "CCD Simulator", MAXINDIDEVICE - 1);
+        strncpy(m_BLOBProperty.name, "CCD1", MAXINDINAME - 1);
+        m_BLOBProperty.p   = IP_RO;
+        m_BLOBProperty.s   = IPS_OK;
+        m_BLOBProperty.bp  = &m_BLOB;
+        m_BLOBProperty.nbp = 1;
+        strncpy(m_BLOB.name, "CCD1", MAXINDINAME - 1);
+        strncpy(m_BLOB.format, ".fits", MAXINDIBLOBFMT - 1);
+        m_BLOB.bvp = &m_BLOBProperty;
+
+        // Generated up front so it does not count as overhead
+        for (int i = 0; i < m_Jobs.count(); i++)
+        {
+            Ekos::SequenceJob *job = m_Jobs[i];
+            const int width  = qMax(16, static_cast<int>(job->getSubW() / qMax(1, job->getXBin()) * sizeScale));
+            const int height = qMax(16, static_cast<int>(job->getSubH() / qMax(1, job->getYBin()) * sizeScale));
+            m_Images.append(syntheticFITS(width, height, job->getExposure(), job->getFilterName(),
+                                          static_cast<uint32_t>(i + 1)));
+
+            job->setActiveCCD(m_CCD.get());
+            job->setActiveChip(m_CCD->getChip(ISD::CCDChip::PRIMARY_CCD));
+            QObject::connect(job, &Ekos::SequenceJob::prepareComplete, &m_Loop, [this]()
+            {
+                startExposure();
+            });
+        }
+
+        QObject::connect(m_CCD.get(), &ISD::CCD::BLOBUpdated, &m_Loop, [this](IBLOB *bp)
+        {
+            frameReleased(bp);
+        });
+        QObject::connect(m_CCD.get(), &ISD::CCD::frameProcessed, &m_Loop,
+                         [this](ISD::CCDChip *, const QString &filename, bool success)
+        {
+            processed.append(filename);
+            if (success)
+                written++;
+            finish();
+        });
+    }
+
+    // False if the sequence failed or did not complete within the timeout
+    bool run(int timeout)
+    {
+        m_Clock.start();
+        QTimer::singleShot(0, &m_Loop, [this]()
+        {
+            startJob();
+        });
+        QTimer::singleShot(timeout, &m_Loop, &QEventLoop::quit);
+        m_Loop.exec();
+
+        m_Duration = m_Clock.elapsed();
+        return m_Failed == false && m_Done && processed.count() == submitted.count();
+    }
+
+    QStringList submitted, processed;
+    QList<qint64> overheads;
+    int written { 0 };
+    qint64 exposed { 0 };
+
+    qint64 duration() const
+    {
+        return m_Duration;
+    }
+    ISD::CCD *ccd() const
+    {
+        return m_CCD.get();
+    }
+
+  private:
+    int scaled(double milliseconds) const
+    {
+        return static_cast<int>(milliseconds * m_TimeScale);
+    }
+
+    void startJob()
+    {
+        if (m_Job >= m_Jobs.count())
+        {
+            m_Done = true;
+            finish();
+            return;
+        }
+
+        // Nothing to change on the simulated camera, so the job is prepared at once
+        m_Jobs[m_Job]->resetStatus();
+        m_Jobs[m_Job]->prepareCapture();
+    }
+
+    void startExposure()
+    {
+        Ekos::SequenceJob *job = m_Jobs[m_Job];
+
+        if (m_ExposureEnd >= 0)
+            overheads.append(m_Clock.elapsed() - m_ExposureEnd - m_Delay);
+
+        m_CCD->setNextSequenceID(job->getCompleted() + 1);
+        m_CCD->setFramePipelineDepth(m_Depth);
+        if (job->capture(false) != Ekos::SequenceJob::CAPTURE_OK)
+        {
+            m_Failed = true;
+            m_Loop.quit();
+            return;
+        }
+
+        const int duration = scaled(job->getExposure() * 1000);
+        exposed += duration;
+        QTimer::singleShot(duration, &m_Loop, [this]()
+        {
+            exposureDone();
+        });
+    }
+
+    void exposureDone()
+    {
+        m_ExposureEnd = m_Clock.elapsed();
+
+        const QByteArray &image = m_Images[m_Job];
+        m_BLOB.blob    = const_cast<char *>(image.constData());
+        m_BLOB.bloblen = image.size();
+        m_BLOB.size    = image.size();
+        m_CCD->processBLOB(&m_BLOB);
+    }
+
+    // Same as Capture once the camera is done with the frame
+    void frameReleased(IBLOB *bp)
+    {
+        if (bp == nullptr)
+        {
+            m_Failed = true;
+            m_Loop.quit();
+            return;
+        }
+
+        submitted.append(QString(static_cast<const char *>(bp->aux2)));
+
+        Ekos::SequenceJob *job = m_Jobs[m_Job];
+        job->setCompleted(job->getCompleted() + 1);
+        if (job->getCompleted() >= job->getCount())
+        {
+            job->done();
+            m_Job++;
+            m_Delay = 0;
+            startJob();
+            return;
+        }
+
+        m_Delay = scaled(job->getDelay());
+        QTimer::singleShot(m_Delay, &m_Loop, [this]()
+        {
+            startExposure();
+        });
+    }
+
+    void finish()
+    {
+        if (m_Done && processed.count() == submitted.count())
+            m_Loop.quit();
+    }
+
+    QList<Ekos::SequenceJob *> m_Jobs;
+    QList<QByteArray> m_Images;
+    int m_Depth { 0 };
+    double m_TimeScale { 1 };
+
+    // Destroyed in reverse order, the camera first
+    INDI::BaseDevice m_Device;
+    ClientManager m_ClientManager;
+    DriverInfo m_Driver;
+    std::unique_ptr<DeviceInfo> m_DeviceInfo;
+    std::unique_ptr<ISD::CCD> m_CCD;
+    IBLOBVectorProperty m_BLOBProperty;
+    IBLOB m_BLOB;
+
+    QEventLoop m_Loop;
+    QElapsedTimer m_Clock;
+
+    int m_Job { 0 };
+    qint64 m_ExposureEnd { -1 };
+    int m_Delay { 0 };
+    qint64 m_Duration { 0 };
+    bool m_Failed { false };
+    bool m_Done { false };
+};
+}
+
+void TestCaptureReplay::initTestCase()
+{
+    // Keep the options of the user out of the test, frames are not shown without the main window
+    QStandardPaths::setTestModeEnabled(true);
+    Options::setUseFITSViewer(false);
+}
+
+void TestCaptureReplay::loadSequence()
+{
+    const QList<Ekos::SequenceJob *> jobs = readSequence(QFINDTESTDATA("2x10x20s_refocus1min.esq"));
+
+    QCOMPARE(jobs.count(), 2);
+    QCOMPARE(jobs[0]->getFilterName(), QString("Red"));
+    QCOMPARE(jobs[1]->getFilterName(), QString("Blue"));
+    QCOMPARE(jobs[0]->getFullPrefix(), QString("Light_Red_20_secs") + Ekos::SequenceJob::ISOMarker);
+    for (Ekos::SequenceJob *job : jobs)
+    {
+        QCOMPARE(job->getExposure(), 20.0);
+        QCOMPARE(job->getCount(), 5);
+        QCOMPARE(job->getSubW(), 1280);
+        QCOMPARE(job->getSubH(), 1024);
+        QCOMPARE(job->getDelay(), 0);
+        QCOMPARE(job->getFrameType(), FRAME_LIGHT);
+    }
+
+    qDeleteAll(jobs);
+}
+
+void TestCaptureReplay::replaySequence_data()
+{
+    QTest::addColumn<int>("depth");
+
+    QTest::newRow("single") << 1;
+    QTest::newRow("double") << 2;
+}
+
+void TestCaptureReplay::replaySequence()
+{
+    QFETCH(int, depth);
+
+    const double timeScale = environment("KSTARS_REPLAY_TIME_SCALE", 0.005);
+    const double sizeScale = environment("KSTARS_REPLAY_SIZE_SCALE", 1);
+    const bool verbose     = qEnvironmentVariableIsSet("KSTARS_REPLAY_VERBOSE");
+
+    QTemporaryDir directory;
+    QVERIFY(directory.isValid());
+
+    QList<Ekos::SequenceJob *> jobs = readSequence(sequenceFile());
+    QVERIFY(jobs.isEmpty() == false);
+
+    int total = 0;
+    double exposure = 0;
+    for (Ekos::SequenceJob *job : jobs)
+    {
+        job->setLocalDir(directory.path());
+        total    += job->getCount();
+        exposure += job->getExposure() * job->getCount() * timeScale;
+    }
+
+    CameraReplay replay(jobs, depth, timeScale, sizeScale);
+    const bool replayed = replay.run(static_cast<int>(exposure * 1000) + total * 10000);
+    const QString last = replay.submitted.isEmpty() ? QString() : replay.submitted.last();
+    const FramePipeline::Statistics statistics = replay.ccd()->getFramePipelineStatistics();
+    const bool pending = replay.ccd()->isFramePending(last);
+    int completed = 0;
+    for (Ekos::SequenceJob *job : jobs)
+        completed += job->getStatus() == Ekos::SequenceJob::JOB_DONE ? job->getCompleted() : 0;
+    qDeleteAll(jobs);
+    QVERIFY(replayed);
+
+    // Every frame is written by the camera and reported in the order it was captured
+    QCOMPARE(completed, total);
+    QCOMPARE(replay.submitted.count(), total);
+    QCOMPARE(replay.processed, replay.submitted);
+    QCOMPARE(replay.written, total);
+    QVERIFY(pending == false);
+    QCOMPARE(QFileInfo(last).absolutePath(), QFileInfo(directory.path()).absoluteFilePath());
+
+    QCOMPARE(statistics.frames, static_cast<quint64>(total));
+    QCOMPARE(statistics.failed, static_cast<quint64>(0));
+    QVERIFY(statistics.deepest <= depth + 1);
+
+    FITSData data;
+    QFuture<bool> loader = data.loadFITS(last, true);
+    loader.waitForFinished();
+    QVERIFY(loader.result());
+    QVERIFY(data.width() > 0 && data.height() > 0);
+
+    qint64 overhead = 0, longest = 0;
+    for (qint64 frameOverhead : replay.overheads)
+    {
+        overhead += frameOverhead;
+        longest = qMax(longest, frameOverhead);
+    }
+
+    QStringList stages;
+    for (int i = 0; i < FramePipeline::STAGE_COUNT; i++)
+        stages << QString("%1 %2 ms").arg(FramePipeline::stageName(static_cast<FramePipeline::Stage>(i)))
+               .arg(statistics.total[i] / static_cast<double>(statistics.frames), 0, 'f', 1);
+
+    qInfo() << "Replayed" << total << "frames with pipeline depth" << depth << "in" << replay.duration() << "ms.";
+    qInfo() << "Overhead from exposure end to next exposure start: average"
+            << QString::number(replay.overheads.isEmpty() ? 0 : overhead / static_cast<double>(replay.overheads.count()), 'f', 1)
+            << "ms, max" << longest << "ms, duty cycle"
+            << QString::number(100.0 * replay.exposed / qMax<qint64>(1, replay.duration()), 'f', 1) << "%.";
+    qInfo() << "Average per frame:" << stages.join(", ");
+    if (verbose)
+    {
+        for (int i = 0; i < replay.overheads.count(); i++)
+            qInfo() << "Frame" << i + 1 << "overhead" << replay.overheads[i] << "ms";
+    }
+}
+
+QTEST_GUILESS_MAIN(TestCaptureReplay)
@@ -0,0 +1,42 @@
+/*  Capture Sequence Replay
+    Copyright (C) 2020 KStars Developers
+
+    This application is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public
+    License as published by the Free Software Foundation; either
+    version 2 of the License, or (at your option) any later version.
+ */
+
+#pragma once
+
+#include <QObject>
+
+/**
+ * @class TestCaptureReplay
+ * @short Replays capture sequence files through ISD::CCD with a simulated camera driver
+ *
+ * The jobs of the sequence file are set up as SequenceJob objects and drive a real ISD::CCD over a device that
+ * has no driver behind it. Each exposure lasts the scaled duration of the job and ends with a synthetic FITS BLOB
+ * of the job frame size handed to CCD::processBLOB, which writes it through the frame pipeline. The next exposure
+ * starts once the camera releases the frame with BLOBUpdated, and the time from the end of an exposure to the
+ * start of the next one is reported. The pipeline is replayed at depths 1 and 2, without it the camera needs the
+ * main window.
+ *
+ * KSTARS_REPLAY_SEQUENCE replays another sequence file, KSTARS_REPLAY_TIME_SCALE scales exposure durations
+ * (default 0.005), KSTARS_REPLAY_SIZE_SCALE scales frame sizes (default 1) and KSTARS_REPLAY_VERBOSE also reports
+ * the overhead of each frame.
+ */
+class TestCaptureReplay : public QObject
+{
+    Q_OBJECT
+
+  public:
+    TestCaptureReplay() : QObject() {}
+    ~TestCaptureReplay() override = default;
+
+  private slots:
+    void initTestCase();
+    void loadSequence();
+    void replaySequence_data();
+    void replaySequence();
+};
@@ -0,0 +1,249 @@
+/*  Message Publisher Tests
+    Copyright (C) 2020 KStars Developers
+
+    This application is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public
+    License as published by the Free Software Foundation; either
+    version 2 of the License, or (at your option) any later version.
+ */
+
+#include "testmessagepublisher.h"
+
+#include "ekos/ekoslive/messagepublisher.h"
+
+#include <QElapsedTimer>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QtTest>
+
+#if QT_VERSION >= QT_VERSION_CHECK(5, 12, 0)
+#include <QCborValue>
+#endif
+
+using EkosLive::MessagePublisher;
+
+namespace
+{
+// Frames received as text, in the order they were sent
+QList<QJsonObject> frames(const QSignalSpy &spy)
+{
+    QList<QJsonObject> result;
+    for (const QList<QVariant> &arguments : spy)
+        result.append(QJsonDocument::fromJson(arguments.first().toString().toUtf8()).object());
+    return result;
+}
+
+QJsonObject frame(const QString &type, const QJsonValue &payload)
+{
+    return {{"type", type}, {"payload", payload}};
+}
+}
+
+void TestMessagePublisher::mergeState()
+{
+    MessagePublisher publisher;
+    QSignalSpy text(&publisher, &MessagePublisher::textMessage);
+
+    publisher.publishState("new_mount_state", {{"ra", 1}});
+    publisher.publishState("new_mount_state", {{"de", 2}});
+    publisher.publishState("new_mount_state", {{"ra", 3}});
+    QCOMPARE(text.count(), 0);
+
+    publisher.flush();
+
+    // Later fields override earlier ones within the window
+    QCOMPARE(frames(text), QList<QJsonObject>() << frame("new_mount_state", QJsonObject({{"ra", 3}, {"de", 2}})));
+    QCOMPARE(publisher.statistics().published, static_cast<quint64>(3));
+    QCOMPARE(publisher.statistics().merged, static_cast<quint64>(2));
+    QCOMPARE(publisher.statistics().frames, static_cast<quint64>(1));
+}
+
+void TestMessagePublisher::skipUnchanged()
+{
+    MessagePublisher publisher;
+    QSignalSpy text(&publisher, &MessagePublisher::textMessage);
+
+    publisher.publishState("new_focus_state", {{"status", "Idle"}, {"hfr", 2.5}});
+    publisher.flush();
+
+    // Only the fields that changed since the client last received the state are sent
+    publisher.publishState("new_focus_state", {{"status", "Idle"}, {"hfr", 2.1}});
+    publisher.flush();
+
+    // Nothing changed, nothing is sent
+    publisher.publishState("new_focus_state", {{"status", "Idle"}, {"hfr", 2.1}});
+    publisher.flush();
+
+    QCOMPARE(frames(text), QList<QJsonObject>()
+             << frame("new_focus_state", QJsonObject({{"status", "Idle"}, {"hfr", 2.5}}))
+             << frame("new_focus_state", QJsonObject({{"hfr", 2.1}})));
+    QCOMPARE(publisher.statistics().skipped, static_cast<quint64>(1));
+}
+
+void TestMessagePublisher::batchWindow()
+{
+    MessagePublisher publisher;
+    QSignalSpy text(&publisher, &MessagePublisher::textMessage);
+
+    QElapsedTimer timer;
+    timer.start();
+
+    publisher.publishState("new_capture_state", {{"status", "Capturing"}});
+    publisher.publishState("new_capture_state", {{"seqv", 1}});
+    QCOMPARE(text.count(), 0);
+
+    // The window closes on its own, with one frame for both updates
+    QVERIFY(text.wait(2000));
+    QVERIFY(timer.elapsed() >= 150);
+    QCOMPARE(frames(text), QList<QJsonObject>()
+             << frame("new_capture_state", QJsonObject({{"status", "Capturing"}, {"seqv", 1}})));
+}
+
+void TestMessagePublisher::publishLatest()
+{
+    MessagePublisher publisher;
+    QSignalSpy text(&publisher, &MessagePublisher::textMessage);
+
+    // Messages of the same key replace each other as a whole, other keys keep their own place
+    publisher.publishLatest("new_device_property", "CCD\nTEMP", QJsonObject({{"value", -5}, {"state", "Busy"}}));
+    publisher.publishLatest("new_device_property", "CCD\nBIN", QJsonObject({{"value", 2}}));
+    publisher.publishLatest("new_device_property", "CCD\nTEMP", QJsonObject({{"value", -6}}));
+    publisher.flush();
+
+    QCOMPARE(frames(text), QList<QJsonObject>()
+             << frame("new_device_property", QJsonObject({{"value", -6}}))
+             << frame("new_device_property", QJsonObject({{"value", 2}})));
+
+    // Unlike states, the same message is sent again in the next window
+    publisher.publishLatest("new_device_property", "CCD\nBIN", QJsonObject({{"value", 2}}));
+    publisher.flush();
+
+    QCOMPARE(text.count(), 3);
+    QCOMPARE(publisher.statistics().skipped, static_cast<quint64>(0));
+}
+
+void TestMessagePublisher::publishEvents()
+{
+    MessagePublisher publisher;
+    QSignalSpy text(&publisher, &MessagePublisher::textMessage);
+
+    // Samples of a plot are never merged or dropped, even if they repeat
+    publisher.publish("new_guide_state", QJsonObject({{"drift_ra", 0.5}}));
+    publisher.publish("new_guide_state", QJsonObject({{"drift_ra", 0.5}}));
+    publisher.publish("new_guide_state", QJsonObject({{"drift_ra", 0.7}}));
+    publisher.flush();
+
+    QCOMPARE(frames(text), QList<QJsonObject>()
+             << frame("new_guide_state", QJsonObject({{"drift_ra", 0.5}}))
+             << frame("new_guide_state", QJsonObject({{"drift_ra", 0.5}}))
+             << frame("new_guide_state", QJsonObject({{"drift_ra", 0.7}})));
+    QCOMPARE(publisher.statistics().merged, static_cast<quint64>(0));
+}
+
+void TestMessagePublisher::sendAfterPending()
+{
+    MessagePublisher publisher;
+    QSignalSpy text(&publisher, &MessagePublisher::textMessage);
+
+    publisher.publishState("new_mount_state", {{"status", "Slewing"}});
+    publisher.publish("new_notification", QJsonObject({{"message", "Slew started"}}));
+    publisher.send("get_profiles", QJsonArray({"Simulators"}));
+
+    // The message sent right away goes out after the ones published before it, without waiting for the window
+    QCOMPARE(frames(text), QList<QJsonObject>()
+             << frame("new_mount_state", QJsonObject({{"status", "Slewing"}}))
+             << frame("new_notification", QJsonObject({{"message", "Slew started"}}))
+             << frame("get_profiles", QJsonArray({"Simulators"})));
+
+    // A full state sent directly is what the client has now
+    publisher.send("new_mount_state", QJsonObject({{"status", "Tracking"}}));
+    publisher.publishState("new_mount_state", {{"status", "Tracking"}});
+    publisher.flush();
+    QCOMPARE(text.count(), 4);
+}
+
+void TestMessagePublisher::batchFrame()
+{
+    MessagePublisher publisher;
+    QSignalSpy text(&publisher, &MessagePublisher::textMessage);
+    publisher.setBatchingEnabled(true);
+
+    publisher.publishState("new_mount_state", {{"status", "Slewing"}});
+    publisher.publish("new_notification", QJsonObject({{"message", "Slew started"}}));
+    publisher.flush();
+
+    // A single message is not wrapped
+    publisher.publishState("new_mount_state", {{"status", "Tracking"}});
+    publisher.flush();
+
+    QCOMPARE(frames(text), QList<QJsonObject>()
+             << frame("new_batch", QJsonArray(
+                          {
+                              frame("new_mount_state", QJsonObject({{"status", "Slewing"}})),
+                              frame("new_notification", QJsonObject({{"message", "Slew started"}}))
+                          }))
+             << frame("new_mount_state", QJsonObject({{"status", "Tracking"}})));
+}
+
+void TestMessagePublisher::binaryFrame()
+{
+#if QT_VERSION >= QT_VERSION_CHECK(5, 12, 0)
+    MessagePublisher publisher;
+    QSignalSpy text(&publisher, &MessagePublisher::textMessage);
+    QSignalSpy binary(&publisher, &MessagePublisher::binaryMessage);
+    publisher.setBinaryEnabled(true);
+    QVERIFY(publisher.isBinaryEnabled());
+
+    publisher.send("new_temperature", QJsonObject({{"temperature", -10.5}}));
+
+    QCOMPARE(text.count(), 0);
+    QCOMPARE(binary.count(), 1);
+
+    // Each frame is a single CBOR item holding the same {type, payload} map as the JSON frame
+    const QByteArray data = binary.first().first().toByteArray();
+    QCborParserError error;
+    const QCborValue value = QCborValue::fromCbor(data, &error);
+    QVERIFY(error.error == QCborError::NoError);
+    QCOMPARE(static_cast<int>(error.offset), data.size());
+    QVERIFY(value.isMap());
+    QCOMPARE(value.toJsonValue().toObject(), frame("new_temperature", QJsonObject({{"temperature", -10.5}})));
+    QCOMPARE(publisher.statistics().bytes, static_cast<quint64>(data.size()));
+#else
+    QSKIP("Binary frames need Qt 5.12");
+#endif
+}
+
+void TestMessagePublisher::countBytes()
+{
+    MessagePublisher publisher;
+    QSignalSpy text(&publisher, &MessagePublisher::textMessage);
+
+    publisher.send("new_notification", QJsonObject({{"message", QString::fromUtf8("Température −10 °C")}}));
+
+    // Bytes on the socket are UTF-8, not characters
+    QCOMPARE(text.count(), 1);
+    const QString message = text.first().first().toString();
+    QVERIFY(message.toUtf8().size() > message.size());
+    QCOMPARE(publisher.statistics().bytes, static_cast<quint64>(message.toUtf8().size()));
+}
+
+void TestMessagePublisher::resetClient()
+{
+    MessagePublisher publisher;
+    QSignalSpy text(&publisher, &MessagePublisher::textMessage);
+
+    publisher.publishState("new_focus_state", {{"status", "Idle"}});
+    publisher.flush();
+
+    // A new client has not received anything yet, and pending messages were meant for the old one
+    publisher.publishState("new_capture_state", {{"status", "Idle"}});
+    publisher.reset();
+    publisher.publishState("new_focus_state", {{"status", "Idle"}});
+    publisher.flush();
+
+    QCOMPARE(frames(text), QList<QJsonObject>()
+             << frame("new_focus_state", QJsonObject({{"status", "Idle"}}))
+             << frame("new_focus_state", QJsonObject({{"status", "Idle"}})));
+}
+
+QTEST_GUILESS_MAIN(TestMessagePublisher)
@@ -0,0 +1,40 @@
+/*  Message Publisher Tests
+    Copyright (C) 2020 KStars Developers
+
+    This application is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public
+    License as published by the Free Software Foundation; either
+    version 2 of the License, or (at your option) any later version.
+ */
+
+#pragma once
+
+#include <QObject>
+
+/**
+ * @class TestMessagePublisher
+ * @short Tests for the coalescing of the EkosLive Message Channel
+ *
+ * Clients that did not opt in must keep receiving one {type, payload} text frame per message, in the order the
+ * messages were published.
+ */
+class TestMessagePublisher : public QObject
+{
+    Q_OBJECT
+
+  public:
+    TestMessagePublisher() : QObject() {}
+    ~TestMessagePublisher() override = default;
+
+  private slots:
+    void mergeState();
+    void skipUnchanged();
+    void batchWindow();
+    void publishLatest();
+    void publishEvents();
+    void sendAfterPending();
+    void batchFrame();
+    void binaryFrame();
+    void countBytes();
+    void resetClient();
+};
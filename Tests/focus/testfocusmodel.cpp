@@ -0,0 +1,140 @@
+/*  Focus Model Tests
+    Copyright (C) 2020 KStars Developers
+
+    This application is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public
+    License as published by the Free Software Foundation; either
+    version 2 of the License, or (at your option) any later version.
+ */
+
+#include "testfocusmodel.h"
+
+#include "ekos/focus/focusmodel.h"
+
+#include <QtTest>
+
+using Ekos::FocusModel;
+
+namespace
+{
+FocusModel::sample_t sample(double temperature, int position, double hfr = 2, double curvature = 0)
+{
+    FocusModel::sample_t result;
+    result.temperature = temperature;
+    result.position    = position;
+    result.hfr         = hfr;
+    result.curvature   = curvature;
+    return result;
+}
+
+// Focus moving in by 20 steps per degree, from 0C to 5C
+QList<FocusModel::sample_t> drift()
+{
+    QList<FocusModel::sample_t> samples;
+    for (int i = 0; i <= 5; i++)
+        samples.append(sample(i, 10000 - 20 * i));
+    return samples;
+}
+}
+
+void TestFocusModel::noSamples()
+{
+    FocusModel model("Focuser Simulator", QString());
+    FocusModel::prediction_t prediction;
+
+    QVERIFY(model.predict(10, &prediction) == false);
+}
+
+void TestFocusModel::latestPosition()
+{
+    FocusModel model("Focuser Simulator", "Red");
+    model.setSamples({ sample(FOCUS_MODEL_NO_TEMPERATURE, 1000), sample(FOCUS_MODEL_NO_TEMPERATURE, 1010),
+                       sample(FOCUS_MODEL_NO_TEMPERATURE, 990), sample(FOCUS_MODEL_NO_TEMPERATURE, 1000),
+                       sample(FOCUS_MODEL_NO_TEMPERATURE, 1020)
+                     });
+    FocusModel::prediction_t prediction;
+
+    QVERIFY(model.predict(10, &prediction));
+    QCOMPARE(prediction.position, 1020);
+    // Scatter of the samples around the latest one, sqrt((400 + 100 + 900 + 400) / 4)
+    QCOMPARE(prediction.uncertainty, 21);
+    QCOMPARE(prediction.halfWidth, 0);
+}
+
+void TestFocusModel::temperatureFit_data()
+{
+    QTest::addColumn<double>("temperature");
+    QTest::addColumn<int>("position");
+    QTest::addColumn<int>("uncertainty");
+
+    QTest::newRow("inside") << 2.5 << 9950 << 0;
+    QTest::newRow("warmer") << 10.0 << 9800 << 100;
+    QTest::newRow("colder") << -2.0 << 10040 << 40;
+}
+
+void TestFocusModel::temperatureFit()
+{
+    QFETCH(double, temperature);
+    QFETCH(int, position);
+    QFETCH(int, uncertainty);
+
+    FocusModel model("Focuser Simulator", "Red");
+    model.setSamples(drift());
+    FocusModel::prediction_t prediction;
+
+    QVERIFY(model.predict(temperature, &prediction));
+    QCOMPARE(prediction.position, position);
+    // Outside the samples the slope adds to the error
+    QCOMPARE(prediction.uncertainty, uncertainty);
+
+    // Without a temperature to predict at, the latest position is used
+    QVERIFY(model.predict(FOCUS_MODEL_NO_TEMPERATURE, &prediction));
+    QCOMPARE(prediction.position, 9900);
+}
+
+void TestFocusModel::narrowSpan()
+{
+    FocusModel model("Focuser Simulator", "Red");
+    model.setSamples({ sample(10, 5000), sample(10.5, 5100), sample(11, 5200) });
+    FocusModel::prediction_t prediction;
+
+    // One degree is too little to fit a drift from
+    QVERIFY(model.predict(20, &prediction));
+    QCOMPARE(prediction.position, 5200);
+}
+
+void TestFocusModel::recentSamples()
+{
+    QList<FocusModel::sample_t> samples;
+    for (int i = 0; i < 5; i++)
+        samples.append(sample(i, 50000));
+    for (int i = 0; i < 20; i++)
+        samples.append(sample(i / 4.0, 10000 - 20 * i / 4));
+
+    FocusModel model("Focuser Simulator", "Red");
+    model.setSamples(samples);
+    FocusModel::prediction_t prediction;
+
+    // Only the 20 most recent samples are fitted
+    QVERIFY(model.predict(2.5, &prediction));
+    QCOMPARE(prediction.position, 9950);
+}
+
+void TestFocusModel::halfWidth()
+{
+    FocusModel model("Focuser Simulator", "Red");
+    // Curves reach 1.5 times their best HFR at sqrt(0.5 * hfr / curvature) steps: 100, 50 and 200
+    model.setSamples({ sample(FOCUS_MODEL_NO_TEMPERATURE, 1000, 2, 0.0001),
+                       sample(FOCUS_MODEL_NO_TEMPERATURE, 1000, 2, 0.0004),
+                       sample(FOCUS_MODEL_NO_TEMPERATURE, 1000, 2, 0.000025),
+                       sample(FOCUS_MODEL_NO_TEMPERATURE, 1000, 2, 0)
+                     });
+    FocusModel::prediction_t prediction;
+
+    QVERIFY(model.predict(FOCUS_MODEL_NO_TEMPERATURE, &prediction));
+    // Median of the known curves
+    QCOMPARE(prediction.halfWidth, 100);
+    QCOMPARE(prediction.uncertainty, 0);
+}
+
+QTEST_GUILESS_MAIN(TestFocusModel)
@@ -0,0 +1,34 @@
+/*  Focus Model Tests
+    Copyright (C) 2020 KStars Developers
+
+    This application is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public
+    License as published by the Free Software Foundation; either
+    version 2 of the License, or (at your option) any later version.
+ */
+
+#pragma once
+
+#include <QObject>
+
+/**
+ * @class TestFocusModel
+ * @short Tests for the prediction of the autofocus position from past results
+ */
+class TestFocusModel : public QObject
+{
+    Q_OBJECT
+
+  public:
+    TestFocusModel() : QObject() {}
+    ~TestFocusModel() override = default;
+
+  private slots:
+    void noSamples();
+    void latestPosition();
+    void temperatureFit_data();
+    void temperatureFit();
+    void narrowSpan();
+    void recentSamples();
+    void halfWidth();
+};
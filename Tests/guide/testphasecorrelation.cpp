@@ -0,0 +1,121 @@
+/*  Phase Correlation Tests
+    Copyright (C) 2020 KStars Developers
+
+    This application is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public
+    License as published by the Free Software Foundation; either
+    version 2 of the License, or (at your option) any later version.
+ */
+
+#include "testphasecorrelation.h"
+
+#include "ekos/guide/internalguide/phasecorrelation.h"
+
+#include <QtTest>
+
+#include <cmath>
+
+namespace
+{
+const int axis = 128;
+
+// Synthetic star field with a few gaussian stars shifted by (dx, dy) over a noisy background
+QVector<float> starField(double dx, double dy, uint32_t seed)
+{
+    const double stars[][3] = { { 30, 35, 1000 }, { 70, 50, 600 }, { 95, 100, 1500 }, { 40, 90, 400 } };
+    const double sigma      = 1.8;
+
+    QVector<float> image(axis * axis);
+    for (int y = 0; y < axis; y++)
+    {
+        for (int x = 0; x < axis; x++)
+        {
+            double value = 100;
+            for (const auto &star : stars)
+            {
+                const double rx = x - star[0] - dx;
+                const double ry = y - star[1] - dy;
+                value += star[2] * exp(-(rx * rx + ry * ry) / (2 * sigma * sigma));
+            }
+
+            // Simple LCG noise so the test is repeatable
+            seed  = seed * 1103515245 + 12345;
+            value += (seed >> 16) % 10;
+
+            image[y * axis + x] = value;
+        }
+    }
+
+    return image;
+}
+}
+
+void TestPhaseCorrelation::invalidSize()
+{
+    PhaseCorrelation correlation;
+
+    QVERIFY(correlation.setSize(100) == false);
+    QCOMPARE(correlation.size(), 0u);
+    QVERIFY(correlation.setSize(axis));
+    QCOMPARE(correlation.size(), static_cast<uint32_t>(axis));
+}
+
+void TestPhaseCorrelation::noReference()
+{
+    PhaseCorrelation correlation(axis);
+    QVector<float> image = starField(0, 0, 1);
+    phase_shift_t shift;
+
+    QVERIFY(correlation.hasReference() == false);
+    QVERIFY(correlation.registerImage(image.constData(), shift) == false);
+    QCOMPARE(shift.confidence, 0.0);
+}
+
+void TestPhaseCorrelation::subPixelShift_data()
+{
+    QTest::addColumn<double>("dx");
+    QTest::addColumn<double>("dy");
+
+    QTest::newRow("none") << 0.0 << 0.0;
+    QTest::newRow("integer") << 3.0 << -2.0;
+    QTest::newRow("sub-pixel") << 0.4 << 0.7;
+    QTest::newRow("large") << -9.3 << 6.6;
+}
+
+void TestPhaseCorrelation::subPixelShift()
+{
+    QFETCH(double, dx);
+    QFETCH(double, dy);
+
+    PhaseCorrelation correlation(axis);
+    QVector<float> reference = starField(0, 0, 1);
+    QVector<float> image     = starField(dx, dy, 2);
+    phase_shift_t shift;
+
+    correlation.setReference(reference.constData());
+    QVERIFY(correlation.registerImage(image.constData(), shift));
+
+    QVERIFY2(fabs(shift.dx - dx) < 0.1, qPrintable(QString("dx %1 expected %2").arg(shift.dx).arg(dx)));
+    QVERIFY2(fabs(shift.dy - dy) < 0.1, qPrintable(QString("dy %1 expected %2").arg(shift.dy).arg(dy)));
+    QVERIFY(shift.confidence > 0.3);
+}
+
+void TestPhaseCorrelation::unrelatedImage()
+{
+    PhaseCorrelation correlation(axis);
+    QVector<float> reference = starField(0, 0, 1);
+    QVector<float> noise(axis * axis);
+    uint32_t seed = 7;
+    for (float &value : noise)
+    {
+        seed  = seed * 1103515245 + 12345;
+        value = (seed >> 16) % 100;
+    }
+    phase_shift_t shift;
+
+    correlation.setReference(reference.constData());
+    QVERIFY(correlation.registerImage(noise.constData(), shift));
+    QVERIFY(shift.confidence < 0.1);
+}
+
+QTEST_GUILESS_MAIN(TestPhaseCorrelation)
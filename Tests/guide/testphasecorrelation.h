@@ -0,0 +1,32 @@
+/*  Phase Correlation Tests
+    Copyright (C) 2020 KStars Developers
+
+    This application is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public
+    License as published by the Free Software Foundation; either
+    version 2 of the License, or (at your option) any later version.
+ */
+
+#pragma once
+
+#include <QObject>
+
+/**
+ * @class TestPhaseCorrelation
+ * @short Tests for the image guiding phase correlation registration
+ */
+class TestPhaseCorrelation : public QObject
+{
+    Q_OBJECT
+
+  public:
+    TestPhaseCorrelation() : QObject() {}
+    ~TestPhaseCorrelation() override = default;
+
+  private slots:
+    void invalidSize();
+    void noReference();
+    void subPixelShift_data();
+    void subPixelShift();
+    void unrelatedImage();
+};
@@ -0,0 +1,130 @@
+/*  HiPS Manager Tests
+    Copyright (C) 2020 KStars Developers
+
+    This application is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public
+    License as published by the Free Software Foundation; either
+    version 2 of the License, or (at your option) any later version.
+ */
+
+#include "testhipsmanager.h"
+
+#include "hips/hipsmanager.h"
+
+#include <QFile>
+#include <QFileInfo>
+#include <QSignalSpy>
+#include <QStandardPaths>
+#include <QTextStream>
+#include <QtTest>
+
+namespace
+{
+// Keys and values of a survey properties file, as the survey list of OpsHIPS reads them
+QMap<QString, QString> readProperties(const QString &filename)
+{
+    QMap<QString, QString> properties;
+
+    QFile file(filename);
+    if (!file.open(QIODevice::ReadOnly | QIODevice::Text))
+        return properties;
+
+    QTextStream stream(&file);
+    while (stream.atEnd() == false)
+    {
+        const QString line = stream.readLine();
+        const int index    = line.indexOf('=');
+        if (index > 0 && line.startsWith('#') == false)
+            properties[line.left(index).simplified()] = line.mid(index + 1).simplified();
+    }
+
+    return properties;
+}
+
+QMap<QString, QString> survey()
+{
+    const QString properties = QFINDTESTDATA("survey/properties");
+    QMap<QString, QString> source = readProperties(properties);
+    // A plain directory, as a user would type it
+    source["hips_service_url"] = QFileInfo(properties).absolutePath();
+    return source;
+}
+}
+
+void TestHIPSManager::initTestCase()
+{
+    // The tile store and the options go to test locations
+    QStandardPaths::setTestModeEnabled(true);
+    HIPSManager::Instance()->clearDiscCache();
+}
+
+void TestHIPSManager::localSource()
+{
+    HIPSManager *manager = HIPSManager::Instance();
+
+    QMap<QString, QString> fits = survey();
+    fits["hips_tile_format"] = "fits";
+    QVERIFY(manager->setSource(fits) == false);
+
+    QVERIFY(manager->setSource(survey()));
+    QCOMPARE(manager->getCurrentFormat(), QString("png"));
+    QCOMPARE(static_cast<int>(manager->getCurrentOrder()), 3);
+    QCOMPARE(static_cast<int>(manager->getCurrentTileWidth()), 64);
+    QCOMPARE(manager->getCurrentFrame(), HIPSManager::HIPS_EQUATORIAL_FRAME);
+    QVERIFY(manager->getCurrentURL().isLocalFile());
+}
+
+void TestHIPSManager::loadTile()
+{
+    HIPSManager *manager = HIPSManager::Instance();
+    QVERIFY(manager->setSource(survey()));
+    QSignalSpy repaint(manager, &HIPSManager::sigRepaint);
+    bool freeImage = false;
+
+    // Read and decoded in the background, there is no lower order to draw meanwhile
+    QVERIFY(manager->getPix(false, 3, 0, freeImage) == nullptr);
+    QVERIFY(repaint.wait(5000));
+
+    QImage *image = manager->getPix(false, 3, 0, freeImage);
+    QVERIFY(image != nullptr);
+    QVERIFY(freeImage == false);
+    QCOMPARE(image->width(), 64);
+    QCOMPARE(image->height(), 64);
+    QCOMPARE(image->pixel(0, 0), qRgb(255, 0, 0));
+    QCOMPARE(image->pixel(63, 63), qRgb(255, 255, 255));
+
+    // Local surveys are already on disk, they are not cached again
+    QCOMPARE(manager->getDiscCacheSize(), static_cast<qint64>(0));
+}
+
+void TestHIPSManager::placeholder_data()
+{
+    QTest::addColumn<int>("pix");
+    QTest::addColumn<uint>("color");
+
+    QTest::newRow("first") << 0 << qRgb(255, 0, 0);
+    QTest::newRow("second") << 1 << qRgb(0, 0, 255);
+    QTest::newRow("third") << 2 << qRgb(0, 255, 0);
+    QTest::newRow("fourth") << 3 << qRgb(255, 255, 255);
+}
+
+void TestHIPSManager::placeholder()
+{
+    QFETCH(int, pix);
+    QFETCH(uint, color);
+
+    HIPSManager *manager = HIPSManager::Instance();
+    QVERIFY(manager->setSource(survey()));
+    bool freeImage = false;
+
+    // Order 4 is not in the survey, its tiles are drawn from their quarter of the tile of order 3
+    QImage *image = manager->getPix(false, 4, pix, freeImage);
+    QVERIFY(image != nullptr);
+    QVERIFY(freeImage);
+    QCOMPARE(image->width(), 32);
+    QCOMPARE(image->pixel(0, 0), color);
+    QCOMPARE(image->pixel(31, 31), color);
+    delete image;
+}
+
+QTEST_GUILESS_MAIN(TestHIPSManager)
@@ -0,0 +1,35 @@
+/*  HiPS Manager Tests
+    Copyright (C) 2020 KStars Developers
+
+    This application is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public
+    License as published by the Free Software Foundation; either
+    version 2 of the License, or (at your option) any later version.
+ */
+
+#pragma once
+
+#include <QObject>
+
+/**
+ * @class TestHIPSManager
+ * @short Tests for reading a HiPS survey from a local directory
+ *
+ * The survey in the survey directory has the properties file of a survey and a single tile of order 3, whose
+ * quarters are red, green, blue and white.
+ */
+class TestHIPSManager : public QObject
+{
+    Q_OBJECT
+
+  public:
+    TestHIPSManager() : QObject() {}
+    ~TestHIPSManager() override = default;
+
+  private slots:
+    void initTestCase();
+    void localSource();
+    void loadTile();
+    void placeholder_data();
+    void placeholder();
+};
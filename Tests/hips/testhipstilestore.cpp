@@ -0,0 +1,247 @@
+/*  HiPS Tile Store Tests
+    Copyright (C) 2020 KStars Developers
+
+    This application is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public
+    License as published by the Free Software Foundation; either
+    version 2 of the License, or (at your option) any later version.
+ */
+
+#include "testhipstilestore.h"
+
+#include "hips/hipstilestore.h"
+
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QTemporaryDir>
+#include <QtTest>
+
+namespace
+{
+// Magic, size, uid, level and pix in front of every tile of the data file
+const int header = 24;
+const int tileSize = 1000;
+const int record = header + tileSize;
+
+pixCacheKey_t key(int pix)
+{
+    pixCacheKey_t key;
+    key.uid = 42;
+    key.level = 3;
+    key.pix = pix;
+    return key;
+}
+
+QByteArray tile(int pix)
+{
+    return QByteArray(tileSize, static_cast<char>('a' + pix % 26));
+}
+
+void insertTiles(HIPSTileStore &store, int first, int last)
+{
+    for (int pix = first; pix <= last; pix++)
+        store.insert(key(pix), tile(pix));
+}
+
+// True if the tile is in the store with its data
+bool hasTile(HIPSTileStore &store, int pix)
+{
+    QByteArray data;
+    return store.find(key(pix), data) && data == tile(pix);
+}
+}
+
+void TestHIPSTileStore::insertFind()
+{
+    QTemporaryDir directory;
+    HIPSTileStore store;
+    QVERIFY(store.open(directory.path()));
+    QCOMPARE(store.count(), 0);
+
+    insertTiles(store, 0, 2);
+
+    QCOMPARE(store.count(), 3);
+    QCOMPARE(store.size(), static_cast<qint64>(3 * record));
+    QVERIFY(store.contains(key(1)));
+    QVERIFY(hasTile(store, 0));
+    QVERIFY(hasTile(store, 1));
+    QVERIFY(hasTile(store, 2));
+
+    QByteArray data;
+    QVERIFY(store.find(key(3), data) == false);
+
+    // Another survey or order is another tile
+    pixCacheKey_t other = key(1);
+    other.uid = 7;
+    QVERIFY(store.contains(other) == false);
+    other = key(1);
+    other.level = 4;
+    QVERIFY(store.contains(other) == false);
+
+    // Storing a tile again replaces it, the old record only counts once the file is compacted
+    store.insert(key(1), QByteArray(tileSize, 'z'));
+    QCOMPARE(store.count(), 3);
+    QCOMPARE(store.size(), static_cast<qint64>(3 * record));
+    QVERIFY(store.find(key(1), data));
+    QCOMPARE(data, QByteArray(tileSize, 'z'));
+
+    // Empty tiles are not stored
+    store.insert(key(5), QByteArray());
+    QVERIFY(store.contains(key(5)) == false);
+
+    store.clear();
+    QCOMPARE(store.count(), 0);
+    QCOMPARE(QFileInfo(QDir(directory.path()).filePath("tiles.dat")).size(), static_cast<qint64>(0));
+}
+
+void TestHIPSTileStore::reopen()
+{
+    QTemporaryDir directory;
+
+    {
+        HIPSTileStore store;
+        QVERIFY(store.open(directory.path()));
+        insertTiles(store, 0, 4);
+    }
+
+    QVERIFY(QFile::exists(QDir(directory.path()).filePath("tiles.idx")));
+
+    HIPSTileStore store;
+    QVERIFY(store.open(directory.path()));
+    QCOMPARE(store.count(), 5);
+    QCOMPARE(store.size(), static_cast<qint64>(5 * record));
+    for (int pix = 0; pix <= 4; pix++)
+        QVERIFY(hasTile(store, pix));
+}
+
+void TestHIPSTileStore::rebuildIndex()
+{
+    QTemporaryDir directory;
+
+    {
+        HIPSTileStore store;
+        QVERIFY(store.open(directory.path()));
+        insertTiles(store, 0, 4);
+        store.insert(key(2), QByteArray(tileSize, 'z'));
+    }
+
+    QVERIFY(QFile::remove(QDir(directory.path()).filePath("tiles.idx")));
+
+    // The record headers are enough to find every tile again, the last record of a tile wins
+    HIPSTileStore store;
+    QVERIFY(store.open(directory.path()));
+    QCOMPARE(store.count(), 5);
+    QCOMPARE(store.size(), static_cast<qint64>(5 * record));
+    QVERIFY(hasTile(store, 0));
+    QVERIFY(hasTile(store, 4));
+
+    QByteArray data;
+    QVERIFY(store.find(key(2), data));
+    QCOMPARE(data, QByteArray(tileSize, 'z'));
+
+    // The rebuilt index is saved
+    QVERIFY(QFile::exists(QDir(directory.path()).filePath("tiles.idx")));
+}
+
+void TestHIPSTileStore::truncateTornRecord()
+{
+    QTemporaryDir directory;
+    const QString dataFile = QDir(directory.path()).filePath("tiles.dat");
+
+    {
+        HIPSTileStore store;
+        QVERIFY(store.open(directory.path()));
+        insertTiles(store, 0, 2);
+    }
+
+    // A crash while the fourth tile was written leaves its header and part of its data
+    QFile data(dataFile);
+    QVERIFY(data.open(QIODevice::ReadOnly));
+    QByteArray torn = data.read(header + tileSize / 2);
+    data.close();
+    QVERIFY(data.open(QIODevice::Append));
+    QCOMPARE(data.write(torn), static_cast<qint64>(torn.size()));
+    data.close();
+
+    // The index no longer matches the data file, so it is rebuilt and the torn record dropped
+    HIPSTileStore store;
+    QVERIFY(store.open(directory.path()));
+    QCOMPARE(store.count(), 3);
+    QCOMPARE(QFileInfo(dataFile).size(), static_cast<qint64>(3 * record));
+    for (int pix = 0; pix <= 2; pix++)
+        QVERIFY(hasTile(store, pix));
+
+    // New tiles go after the last whole record
+    store.insert(key(3), tile(3));
+    QVERIFY(hasTile(store, 3));
+    QCOMPARE(QFileInfo(dataFile).size(), static_cast<qint64>(4 * record));
+}
+
+void TestHIPSTileStore::evict()
+{
+    QTemporaryDir directory;
+    HIPSTileStore store;
+    QVERIFY(store.open(directory.path()));
+    store.setMaximumSize(10 * record);
+
+    insertTiles(store, 0, 9);
+    QCOMPARE(store.count(), 10);
+
+    // Reading a tile makes it the most recent
+    QVERIFY(hasTile(store, 0));
+
+    // One tile over the maximum drops the least recently used ones down to 90% of it
+    store.insert(key(10), tile(10));
+    QCOMPARE(store.count(), 9);
+    QCOMPARE(store.size(), static_cast<qint64>(9 * record));
+    QVERIFY(store.size() <= 10 * record / 10 * 9);
+
+    QVERIFY(hasTile(store, 0));
+    QVERIFY(store.contains(key(1)) == false);
+    QVERIFY(store.contains(key(2)) == false);
+    for (int pix = 3; pix <= 10; pix++)
+        QVERIFY(hasTile(store, pix));
+
+    // Lowering the maximum evicts right away
+    store.setMaximumSize(5 * record);
+    QVERIFY(store.size() <= 5 * record / 10 * 9);
+    QVERIFY(hasTile(store, 10));
+}
+
+void TestHIPSTileStore::compactWhileInserting()
+{
+    QTemporaryDir directory;
+    const QString dataFile = QDir(directory.path()).filePath("tiles.dat");
+    HIPSTileStore store;
+    QVERIFY(store.open(directory.path()));
+    store.setMaximumSize(10 * record);
+
+    // Every second insert past the maximum drops two tiles. After the fifteenth, the six dropped tiles
+    // leave more than half the live size behind and the compaction starts.
+    insertTiles(store, 0, 14);
+    QCOMPARE(store.count(), 9);
+
+    // The copy finishes in the event loop at the earliest, so this tile is appended while it runs
+    store.insert(key(15), tile(15));
+    QCOMPARE(store.count(), 10);
+    QCOMPARE(QFileInfo(dataFile).size(), static_cast<qint64>(16 * record));
+
+    QTRY_COMPARE(QFileInfo(dataFile).size(), static_cast<qint64>(10 * record));
+    QVERIFY(QFile::exists(QDir(directory.path()).filePath("tiles.dat.new")) == false);
+
+    QCOMPARE(store.count(), 10);
+    for (int pix = 0; pix <= 5; pix++)
+        QVERIFY(store.contains(key(pix)) == false);
+    for (int pix = 6; pix <= 15; pix++)
+        QVERIFY(hasTile(store, pix));
+
+    // The index saved after the compaction points into the new file
+    store.close();
+    QVERIFY(store.open(directory.path()));
+    QCOMPARE(store.count(), 10);
+    for (int pix = 6; pix <= 15; pix++)
+        QVERIFY(hasTile(store, pix));
+}
+
+QTEST_GUILESS_MAIN(TestHIPSTileStore)
@@ -0,0 +1,36 @@
+/*  HiPS Tile Store Tests
+    Copyright (C) 2020 KStars Developers
+
+    This application is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public
+    License as published by the Free Software Foundation; either
+    version 2 of the License, or (at your option) any later version.
+ */
+
+#pragma once
+
+#include <QObject>
+
+/**
+ * @class TestHIPSTileStore
+ * @short Tests for the packed on-disk store of HiPS tiles
+ *
+ * Every test works on a store in its own temporary directory. Tiles are 1000 bytes, so each record takes 1024
+ * bytes of the data file with its header.
+ */
+class TestHIPSTileStore : public QObject
+{
+    Q_OBJECT
+
+  public:
+    TestHIPSTileStore() : QObject() {}
+    ~TestHIPSTileStore() override = default;
+
+  private slots:
+    void insertFind();
+    void reopen();
+    void rebuildIndex();
+    void truncateTornRecord();
+    void evict();
+    void compactWhileInserting();
+};
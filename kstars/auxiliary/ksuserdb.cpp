@@ -159,6 +159,16 @@ bool KSUserDB::Initialize()
                 if (!query.exec(columnQuery))
                     qCWarning(KSTARS) << query.lastError();
             }
+
+            // Add focus models
+            if (currentDBVersion < 306)
+            {
+                QSqlQuery query(userdb_);
+                if (!query.exec("CREATE TABLE IF NOT EXISTS focusmodel (id INTEGER DEFAULT NULL PRIMARY KEY AUTOINCREMENT, focuser TEXT "
+                                "NOT NULL, filter TEXT DEFAULT NULL, temperature REAL, position INTEGER, hfr REAL, curvature REAL, "
+                                "timestamp DATETIME DEFAULT CURRENT_TIMESTAMP)"))
+                    qCWarning(KSTARS) << query.lastError();
+            }
         }
     }
     userdb_.close();
@@ -296,6 +306,10 @@ bool KSUserDB::RebuildDB()
                   "NOT NULL, chip INTEGER DEFAULT 0, binX INTEGER, binY INTEGER, temperature REAL, duration REAL, "
                   "filename TEXT NOT NULL, timestamp DATETIME DEFAULT CURRENT_TIMESTAMP)");
 
+    tables.append("CREATE TABLE IF NOT EXISTS focusmodel (id INTEGER DEFAULT NULL PRIMARY KEY AUTOINCREMENT, focuser TEXT "
+                  "NOT NULL, filter TEXT DEFAULT NULL, temperature REAL, position INTEGER, hfr REAL, curvature REAL, "
+                  "timestamp DATETIME DEFAULT CURRENT_TIMESTAMP)");
+
     tables.append("CREATE TABLE IF NOT EXISTS hips (ID TEXT NOT NULL UNIQUE,"
                   "obs_title TEXT NOT NULL, obs_description TEXT NOT NULL, hips_order TEXT NOT NULL,"
                   "hips_frame TEXT NOT NULL, hips_tile_width TEXT NOT NULL, hips_tile_format TEXT NOT NULL,"
@@ -540,6 +554,80 @@ void KSUserDB::GetAllDarkFrames(QList<QVariantMap> &darkFrames)
 }
 
 
+/* Focus Model Section */
+
+// autofocus results kept per focuser and filter
+#define FOCUS_MODEL_HISTORY 100
+
+void KSUserDB::AddFocusModel(const QVariantMap &oneModel)
+{
+    userdb_.open();
+    QSqlTableModel focusmodel(nullptr, userdb_);
+    focusmodel.setTable("focusmodel");
+    focusmodel.select();
+
+    QSqlRecord record = focusmodel.record();
+
+    // Remove PK so that it gets auto-incremented later
+    record.remove(0);
+    // Remove timestamp so that it gets auto-generated
+    record.remove(6);
+
+    for (QVariantMap::const_iterator iter = oneModel.begin(); iter != oneModel.end(); ++iter)
+        record.setValue(iter.key(), iter.value());
+
+    // A null QString is stored and bound as NULL, which "= ?" never matches, so focusers without a filter
+    // are stored with an empty filter name
+    const QString focuser = oneModel["focuser"].toString().isNull() ? QString("") : oneModel["focuser"].toString();
+    const QString filter  = oneModel["filter"].toString().isNull() ? QString("") : oneModel["filter"].toString();
+    record.setValue("focuser", focuser);
+    record.setValue("filter", filter);
+
+    focusmodel.insertRecord(-1, record);
+
+    focusmodel.submitAll();
+
+    // Older results no longer describe the optical train
+    QSqlQuery query(userdb_);
+    query.prepare("DELETE FROM focusmodel WHERE focuser = ? AND filter = ? AND id NOT IN "
+                  "(SELECT id FROM focusmodel WHERE focuser = ? AND filter = ? ORDER BY id DESC LIMIT ?)");
+    query.addBindValue(focuser);
+    query.addBindValue(filter);
+    query.addBindValue(focuser);
+    query.addBindValue(filter);
+    query.addBindValue(FOCUS_MODEL_HISTORY);
+    if (!query.exec())
+        qCWarning(KSTARS) << query.lastError();
+
+    userdb_.close();
+}
+
+void KSUserDB::GetFocusModels(const QString &focuser, const QString &filter, QList<QVariantMap> &focusModels)
+{
+    focusModels.clear();
+
+    userdb_.open();
+
+    QSqlQuery query(userdb_);
+    query.prepare("SELECT * FROM focusmodel WHERE focuser = :focuser AND filter = :filter ORDER BY id");
+    query.bindValue(":focuser", focuser.isNull() ? QString("") : focuser);
+    query.bindValue(":filter", filter.isNull() ? QString("") : filter);
+    if (!query.exec())
+        qCWarning(KSTARS) << query.lastError();
+
+    while (query.next())
+    {
+        QVariantMap recordMap;
+        QSqlRecord record = query.record();
+        for (int j = 1; j < record.count(); j++)
+            recordMap[record.fieldName(j)] = record.value(j);
+
+        focusModels.append(recordMap);
+    }
+
+    userdb_.close();
+}
+
 /* Effective FOV Section */
 
 void KSUserDB::AddEffectiveFOV(const QVariantMap &oneFOV)
@@ -83,6 +83,22 @@ class KSUserDB
     void GetAllDarkFrames(QList<QVariantMap> &darkFrames);
 
 
+    /************************************************************************
+     ******************************* Focus Models ***************************
+     ************************************************************************/
+
+    /**
+     * @brief AddFocusModel Record the result of a successful autofocus run. Only the most recent
+     * runs of each focuser and filter are kept.
+     * @param oneModel focuser, filter, temperature, position, hfr and curvature values.
+     */
+    void AddFocusModel(const QVariantMap &oneModel);
+    /**
+     * @brief GetFocusModels Get the autofocus results of a focuser and filter, oldest first.
+     */
+    void GetFocusModels(const QString &focuser, const QString &filter, QList<QVariantMap> &focusModels);
+
+
     /************************************************************************
      ******************************* Effective FOVs *************************
      ************************************************************************/
@@ -379,5 +395,5 @@ class KSUserDB
     /** XML reader for importing old formats **/
     QXmlStreamReader *reader_ { nullptr };
 
-    static const uint16_t SCHEMA_VERSION = 305;
+    static const uint16_t SCHEMA_VERSION = 306;
 };
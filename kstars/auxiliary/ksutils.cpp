@@ -1081,6 +1081,10 @@ QString getDefaultPath(QString option)
     {
         return QDir::homePath();
     }
+    else if (option == "clientRecordDirectory")
+    {
+        return QStandardPaths::writableLocation(QStandardPaths::MoviesLocation);
+    }
     else if (option == "indiServer")
     {
 #if defined(Q_OS_OSX)
@@ -0,0 +1,189 @@
+/*  Startup Loader
+    Copyright (C) 2020 KStars Developers
+
+    This application is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public
+    License as published by the Free Software Foundation; either
+    version 2 of the License, or (at your option) any later version.
+ */
+
+#include "startuploader.h"
+
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QThread>
+#include <QtConcurrent>
+
+#include <kstars_debug.h>
+
+// milliseconds between two checks of the events while threaded steps run
+#define STARTUP_EVENT_INTERVAL 50
+
+typedef struct
+{
+    QString name;
+    qint64 elapsed;
+    bool threaded;
+} timing_t;
+
+static QMutex timingMutex;
+static QList<timing_t> timings;
+
+void StartupLoader::add(const QString &name, const std::function<bool()> &load, const QStringList &dependencies,
+                        bool threaded)
+{
+    step_t step;
+    step.name         = name;
+    step.load         = load;
+    step.dependencies = dependencies;
+    step.threaded     = threaded;
+    step.state        = STEP_PENDING;
+    m_Steps.append(step);
+}
+
+bool StartupLoader::run()
+{
+    QMutexLocker locker(&m_Mutex);
+
+    forever
+    {
+        // Threaded steps are started first so that they overlap the steps of this thread
+        startThreadedSteps();
+
+        int next = -1;
+        for (int i = 0; m_FailedStep.isEmpty() && next < 0 && i < m_Steps.count(); i++)
+        {
+            if (m_Steps[i].threaded == false && m_Steps[i].state == STEP_PENDING && isReady(m_Steps[i]))
+                next = i;
+        }
+
+        if (next >= 0)
+        {
+            m_Steps[next].state = STEP_RUNNING;
+
+            locker.unlock();
+            const bool loaded = runStep(next);
+            locker.relock();
+
+            m_Steps[next].state = STEP_DONE;
+            if (loaded == false && m_FailedStep.isEmpty())
+                m_FailedStep = m_Steps[next].name;
+            continue;
+        }
+
+        if (m_Running == 0)
+            break;
+
+        // Let the progress messages reach the splash screen while waiting
+        m_StepDone.wait(&m_Mutex, STARTUP_EVENT_INTERVAL);
+        locker.unlock();
+        QCoreApplication::processEvents();
+        locker.relock();
+    }
+
+    if (m_FailedStep.isEmpty())
+    {
+        for (const step_t &step : m_Steps)
+        {
+            if (step.state != STEP_DONE)
+            {
+                qCCritical(KSTARS) << "Startup step" << step.name << "depends on missing steps" << step.dependencies;
+                m_FailedStep = step.name;
+                break;
+            }
+        }
+    }
+
+    return m_FailedStep.isEmpty();
+}
+
+void StartupLoader::startThreadedSteps()
+{
+    for (int i = 0; m_FailedStep.isEmpty() && i < m_Steps.count(); i++)
+    {
+        if (m_Steps[i].threaded && m_Steps[i].state == STEP_PENDING && isReady(m_Steps[i]))
+        {
+            m_Steps[i].state = STEP_RUNNING;
+            m_Running++;
+            QtConcurrent::run(this, &StartupLoader::runThreadedStep, i);
+        }
+    }
+}
+
+bool StartupLoader::isReady(const step_t &step) const
+{
+    for (const QString &dependency : step.dependencies)
+    {
+        bool done = false;
+        for (const step_t &other : m_Steps)
+        {
+            if (other.name == dependency)
+            {
+                done = other.state == STEP_DONE;
+                break;
+            }
+        }
+        if (done == false)
+            return false;
+    }
+
+    return true;
+}
+
+bool StartupLoader::runStep(int index)
+{
+    m_Mutex.lock();
+    const QString name               = m_Steps[index].name;
+    const std::function<bool()> load = m_Steps[index].load;
+    m_Mutex.unlock();
+
+    QElapsedTimer timer;
+    timer.start();
+
+    const bool loaded = load();
+
+    record(name, timer.elapsed());
+    if (loaded == false)
+        qCWarning(KSTARS) << "Startup step" << name << "failed";
+
+    return loaded;
+}
+
+void StartupLoader::runThreadedStep(int index)
+{
+    const bool loaded = runStep(index);
+
+    QMutexLocker locker(&m_Mutex);
+    m_Steps[index].state = STEP_DONE;
+    if (loaded == false && m_FailedStep.isEmpty())
+        m_FailedStep = m_Steps[index].name;
+    m_Running--;
+    // Steps waiting for this one do not wait for the calling thread to be free
+    startThreadedSteps();
+    m_StepDone.wakeAll();
+}
+
+void StartupLoader::record(const QString &name, qint64 elapsed)
+{
+    timing_t timing;
+    timing.name     = name;
+    timing.elapsed  = elapsed;
+    timing.threaded = QThread::currentThread() != QCoreApplication::instance()->thread();
+
+    QMutexLocker locker(&timingMutex);
+    timings.append(timing);
+}
+
+QString StartupLoader::report()
+{
+    QMutexLocker locker(&timingMutex);
+
+    QString report;
+    for (const timing_t &timing : timings)
+        report += QString("%1 %2 ms%3\n")
+                  .arg(timing.name, -32)
+                  .arg(timing.elapsed, 6)
+                  .arg(timing.threaded ? " (thread pool)" : "");
+
+    return report;
+}
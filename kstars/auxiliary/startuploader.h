@@ -0,0 +1,86 @@
+/*  Startup Loader
+    Copyright (C) 2020 KStars Developers
+
+    This application is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public
+    License as published by the Free Software Foundation; either
+    version 2 of the License, or (at your option) any later version.
+ */
+
+#pragma once
+
+#include <QList>
+#include <QMutex>
+#include <QString>
+#include <QStringList>
+#include <QWaitCondition>
+
+#include <functional>
+
+/**
+ * @class StartupLoader
+ * @short Runs the loading steps of the KStars startup in dependency order and times them.
+ *
+ * Each step names the steps it needs. Threaded steps only read files into data that nothing else uses until they
+ * are done, so they run on the global thread pool as soon as their dependencies are done. The other steps run on
+ * the calling thread in the order they were added, while the threaded ones go on. A step returns false on a fatal
+ * error, run() then waits for the threaded steps already started and stops.
+ *
+ * The time of each step goes into a report, together with the times added with record() by the steps themselves,
+ * such as the loading of each sky component. "kstars --startup-report" prints it once the main window is up.
+ */
+class StartupLoader
+{
+    public:
+        /**
+         * @brief add Add a step.
+         * @param name Name of the step in the report and in the dependencies of other steps.
+         * @param load Loads the data, returns false on a fatal error.
+         * @param dependencies Steps that must be done before this one starts.
+         * @param threaded Run the step on the thread pool.
+         */
+        void add(const QString &name, const std::function<bool()> &load,
+                 const QStringList &dependencies = QStringList(), bool threaded = false);
+
+        /**
+         * @brief run Run all the steps.
+         * @return False if a step failed, see failedStep().
+         */
+        bool run();
+
+        const QString &failedStep() const
+        {
+            return m_FailedStep;
+        }
+
+        // Add the time a part of the startup took to the report, from any thread
+        static void record(const QString &name, qint64 elapsed);
+        // One line per recorded time, in the order they were recorded
+        static QString report();
+
+    private:
+        enum { STEP_PENDING, STEP_RUNNING, STEP_DONE };
+
+        typedef struct
+        {
+            QString name;
+            std::function<bool()> load;
+            QStringList dependencies;
+            bool threaded;
+            int state;
+        } step_t;
+
+        // Start the threaded steps whose dependencies are done, with the mutex held
+        void startThreadedSteps();
+        bool isReady(const step_t &step) const;
+        bool runStep(int index);
+        void runThreadedStep(int index);
+
+        QList<step_t> m_Steps;
+        QString m_FailedStep;
+
+        // Guards the states of the steps, the failure and the count of threaded steps running
+        QMutex m_Mutex;
+        QWaitCondition m_StepDone;
+        int m_Running { 0 };
+};
@@ -19,6 +19,7 @@
 #include "offlineastrometryparser.h"
 #include "onlineastrometryparser.h"
 #include "astapastrometryparser.h"
+#include "localastrometryparser.h"
 #include "opsalign.h"
 #include "opsastap.h"
 #include "opsastrometry.h"
@@ -267,10 +268,11 @@ Align::Align(ProfileInfo *activeProfile) : m_ActiveProfile(activeProfile)
 
     solverBackendGroup->setId(astapSolverR, SOLVER_ASTAP);
     solverBackendGroup->setId(astrometrySolverR, SOLVER_ASTROMETRYNET);
+    solverBackendGroup->setId(localSolverR, SOLVER_LOCAL);
 
     // JM 2019-11-10: solver type was 3 in previous version (online, offline, remote)
     // But they are now two choices (ASTAP and ASTROMETERY.NET) so we need to accommodate that.
-    if (Options::solverBackend() > SOLVER_ASTROMETRYNET)
+    if (Options::solverBackend() > SOLVER_LOCAL)
     {
         Options::setSolverBackend(SOLVER_ASTROMETRYNET);
     }
@@ -1837,7 +1839,7 @@ void Align::checkAlignmentTimeout()
 
 void Align::setSolverBackend(int type)
 {
-    if (sender() == nullptr && type >= 0 && type <= 1)
+    if (sender() == nullptr && type >= 0 && type <= 2)
     {
         solverBackendGroup->button(type)->setChecked(true);
     }
@@ -1848,6 +1850,28 @@ void Align::setSolverBackend(int type)
         astrometryTypeCombo->setEnabled(true);
         setAstrometrySolverType(Options::astrometrySolverType());
     }
+    // Local solver
+    else if (type == SOLVER_LOCAL)
+    {
+        if (localParser.get() != nullptr)
+            parser = localParser.get();
+        else
+        {
+            localParser.reset(new Ekos::LocalAstrometryParser());
+            parser = localParser.get();
+        }
+
+        parser->setAlign(this);
+        if (parser->init())
+        {
+            connect(parser, &AstrometryParser::solverFinished, this, &Ekos::Align::solverFinished, Qt::UniqueConnection);
+            connect(parser, &AstrometryParser::solverFailed, this, &Ekos::Align::solverFailed, Qt::UniqueConnection);
+        }
+        else
+            parser->disconnect();
+
+        astrometryTypeCombo->setEnabled(false);
+    }
     // ASTAP solver
     else
     {
@@ -2496,6 +2520,27 @@ QStringList Align::generateOptions(const QVariantMap &optionsMap, uint8_t solver
         if (optionsMap.contains("custom"))
             solver_args << optionsMap.value("custom").toString();
     }
+    // The local solver accepts the astrometry.net scale and position arguments
+    else if (solverType == SOLVER_LOCAL)
+    {
+        if (optionsMap.contains("scaleL"))
+            solver_args << "-L" << QString::number(optionsMap.value("scaleL").toDouble());
+
+        if (optionsMap.contains("scaleH"))
+            solver_args << "-H" << QString::number(optionsMap.value("scaleH").toDouble());
+
+        if (optionsMap.contains("scaleUnits"))
+            solver_args << "-u" << optionsMap.value("scaleUnits").toString();
+
+        if (optionsMap.contains("ra"))
+            solver_args << "-3" << QString::number(optionsMap.value("ra").toDouble());
+
+        if (optionsMap.contains("de"))
+            solver_args << "-4" << QString::number(optionsMap.value("de").toDouble());
+
+        if (optionsMap.contains("radius"))
+            solver_args << "-5" << QString::number(optionsMap.value("radius").toDouble());
+    }
     else
     {
         // Radius
@@ -2625,6 +2670,29 @@ void Align::generateArgs()
         if (Options::astrometryCustomOptions().isEmpty() == false)
             optionsMap["custom"] = Options::astrometryCustomOptions();
     }
+    // Local solver
+    else if (solverBackendGroup->checkedId() == SOLVER_LOCAL)
+    {
+        if (fov_pixscale > 0)
+        {
+            // If effective FOV is pending, let's set a wider tolerance range
+            double tolerance = m_EffectiveFOVPending ? 0.3 : 0.05;
+
+            optionsMap["scaleL"]     = fov_pixscale * (1 - tolerance);
+            optionsMap["scaleH"]     = fov_pixscale * (1 + tolerance);
+            optionsMap["scaleUnits"] = "app";
+        }
+
+        if (Options::astrometryUsePosition() && currentTelescope != nullptr)
+        {
+            double ra = 0, dec = 0;
+            currentTelescope->getEqCoords(&ra, &dec);
+
+            optionsMap["ra"]     = ra * 15.0;
+            optionsMap["de"]     = dec;
+            optionsMap["radius"] = Options::astrometryRadius();
+        }
+    }
     // ASTAP
     else
     {
@@ -4909,7 +4977,7 @@ QStringList Align::getSolverOptionsFromFITS(const QString &filename)
     if (Options::astrometryAutoDownsample())
     {
         optionsMap["downsample"] = getSolverDownsample(fits_ccd_width);
-        solver_args = generateOptions(optionsMap, SOLVER_ASTROMETRYNET);
+        solver_args = generateOptions(optionsMap, solverBackendGroup->checkedId());
     }
 
     bool coord_ok = true;
@@ -6092,6 +6160,10 @@ void Align::setSettings(const QJsonObject &settings)
         astrometryTypeCombo->setCurrentIndex(solverType);
         solverBackendGroup->button(SOLVER_ASTROMETRYNET)->animateClick();
     }
+    else if (solverBackend == SOLVER_LOCAL)
+    {
+        solverBackendGroup->button(SOLVER_LOCAL)->animateClick();
+    }
     else
     {
         solverBackendGroup->button(SOLVER_ASTAP)->animateClick();
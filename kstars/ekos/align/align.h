@@ -43,6 +43,7 @@ class OnlineAstrometryParser;
 class OfflineAstrometryParser;
 class RemoteAstrometryParser;
 class ASTAPAstrometryParser;
+class LocalAstrometryParser;
 class OpsAstrometry;
 class OpsAlign;
 class OpsASTAP;
@@ -102,7 +103,7 @@ class Align : public QWidget, public Ui::Align
         } ALTStage;
         typedef enum { GOTO_SYNC, GOTO_SLEW, GOTO_NOTHING } GotoMode;
         typedef enum { SOLVER_ONLINE, SOLVER_OFFLINE, SOLVER_REMOTE } AstrometrySolverType;
-        typedef enum { SOLVER_ASTAP, SOLVER_ASTROMETRYNET } SolverBackend;
+        typedef enum { SOLVER_ASTAP, SOLVER_ASTROMETRYNET, SOLVER_LOCAL } SolverBackend;
         typedef enum
         {
             PAH_IDLE,
@@ -405,7 +406,7 @@ class Align : public QWidget, public Ui::Align
 
         /** DBUS interface function.
              * Select the solver type
-             * @param type Set solver type. 0 ASTAP, 1 astrometry.net
+             * @param type Set solver type. 0 ASTAP, 1 astrometry.net, 2 local
              */
         Q_SCRIPTABLE Q_NOREPLY void setSolverBackend(int type);
 
@@ -793,6 +794,7 @@ class Align : public QWidget, public Ui::Align
         ISD::GDInterface *remoteParserDevice { nullptr };
 
         std::unique_ptr<ASTAPAstrometryParser> astapParser;
+        std::unique_ptr<LocalAstrometryParser> localParser;
 
         // Pointers to our devices
         ISD::Telescope *currentTelescope { nullptr };
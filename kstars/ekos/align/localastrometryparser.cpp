@@ -0,0 +1,322 @@
+/*  Local Quad Hash Parser
+    Copyright (C) 2020 KStars Developers
+
+    This application is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public
+    License as published by the Free Software Foundation; either
+    version 2 of the License, or (at your option) any later version.
+ */
+
+#include "localastrometryparser.h"
+
+#include "align.h"
+#include "ekos_align_debug.h"
+#include "Options.h"
+#include "starcomponent.h"
+#include "starobject.h"
+#include "fitsviewer/fitsdata.h"
+
+#include <KLocalizedString>
+
+#include <QtConcurrent>
+
+#include <algorithm>
+#include <cmath>
+
+// catalog stars kept for each field of view of the search area, and bounds of the catalog size
+#define LOCAL_STARS_PER_FIELD 60
+#define LOCAL_MIN_CATALOG     500
+#define LOCAL_MAX_CATALOG     20000
+#define LOCAL_MAX_BLIND       30000
+// square degrees of the whole sky
+#define LOCAL_SKY_AREA        41253.0
+// stars of the whole sky brighter than a magnitude m are about 10^(LOCAL_COUNT_ZERO + LOCAL_COUNT_SLOPE * m)
+#define LOCAL_COUNT_ZERO      1.15
+#define LOCAL_COUNT_SLOPE     0.43
+// magnitudes added to the estimated limit for the star density changing across the sky
+#define LOCAL_MAG_MARGIN      1.0
+// brightest magnitude limit of a catalog query
+#define LOCAL_MIN_MAGNITUDE   6.0
+// quad diameters indexed, as a fraction of the shortest side of the field of view
+#define LOCAL_MIN_QUAD        0.1
+#define LOCAL_MAX_QUAD        0.6
+// blind indexes are reused while the requested diameters are within this ratio
+#define LOCAL_INDEX_TOLERANCE 0.1
+
+namespace Ekos
+{
+LocalAstrometryParser::LocalAstrometryParser() : AstrometryParser()
+{
+    connect(&m_StarsWatcher, &QFutureWatcher<bool>::finished, this, &LocalAstrometryParser::starsExtracted);
+    connect(&m_SolveWatcher, &QFutureWatcher<bool>::finished, this, &LocalAstrometryParser::solverComplete);
+}
+
+LocalAstrometryParser::~LocalAstrometryParser()
+{
+    stopSolver();
+    m_StarsWatcher.waitForFinished();
+    m_SolveWatcher.waitForFinished();
+}
+
+bool LocalAstrometryParser::init()
+{
+    return StarComponent::Instance() != nullptr;
+}
+
+void LocalAstrometryParser::verifyIndexFiles(double, double)
+{
+}
+
+bool LocalAstrometryParser::startSovler(const QString &filename, const QStringList &args, bool generated)
+{
+    Q_UNUSED(generated)
+
+    // A previous solve that was stopped may still be running, abort flags make it return quickly
+    if (m_StarsWatcher.isRunning() || m_SolveWatcher.isRunning())
+    {
+        stopSolver();
+        m_StarsWatcher.waitForFinished();
+        m_SolveWatcher.waitForFinished();
+    }
+
+    m_RA = m_DEC = m_Radius = 0;
+    m_ScaleLow = m_ScaleHigh = 0;
+    m_ScaleUnits = "app";
+
+    bool hasPosition[2] = { false, false };
+    for (int i = 0; i + 1 < args.count(); i++)
+    {
+        const QString &option = args[i];
+        bool ok               = false;
+
+        if (option == "-3")
+            m_RA = args[++i].toDouble(&hasPosition[0]);
+        else if (option == "-4")
+            m_DEC = args[++i].toDouble(&hasPosition[1]);
+        else if (option == "-5")
+            m_Radius = args[++i].toDouble(&ok);
+        else if (option == "-L")
+            m_ScaleLow = args[++i].toDouble(&ok);
+        else if (option == "-H")
+            m_ScaleHigh = args[++i].toDouble(&ok);
+        else if (option == "-u")
+            m_ScaleUnits = args[++i];
+    }
+
+    // Solve blind without a complete search position
+    if (hasPosition[0] == false || hasPosition[1] == false || m_Radius <= 0)
+        m_Radius = 0;
+
+    m_Aborted = false;
+    m_Solver.reset();
+    solverTimer.start();
+
+    align->appendLogText(i18n("Starting solver..."));
+
+    if (Options::alignmentLogging())
+        align->appendLogText(i18n("Local solver: %1 %2", filename, args.join(' ')));
+
+    m_StarsWatcher.setFuture(QtConcurrent::run(this, &LocalAstrometryParser::extractStars, filename));
+
+    return true;
+}
+
+bool LocalAstrometryParser::extractStars(const QString &filename)
+{
+    m_Stars.clear();
+    m_Width = m_Height = 0;
+
+    FITSData imageData(FITS_ALIGN);
+    if (imageData.loadFITS(filename).result() == false)
+        return false;
+
+    if (m_Aborted)
+        return false;
+
+    imageData.findStars(ALGORITHM_SEP);
+
+    m_Width  = imageData.width();
+    m_Height = imageData.height();
+
+    // The edges are owned by the image data
+    for (const Edge *edge : imageData.getStarCenters())
+    {
+        quad_image_star_t star;
+        star.x    = edge->x;
+        star.y    = edge->y;
+        star.flux = edge->sum;
+        m_Stars.append(star);
+    }
+
+    return m_Stars.count() >= 4;
+}
+
+void LocalAstrometryParser::starsExtracted()
+{
+    if (m_Aborted)
+        return;
+
+    m_DetectionTime = solverTimer.elapsed();
+
+    if (m_StarsWatcher.result() == false)
+    {
+        align->appendLogText(i18n("Local solver failed to detect enough stars in the image."));
+        emit solverFailed();
+        return;
+    }
+
+    // Convert the pixel scale to arcsec per pixel
+    double scaleFactor = 1;
+    if (m_ScaleUnits == "aw" || m_ScaleUnits == "arcminwidth")
+        scaleFactor = 60.0 / m_Width;
+    else if (m_ScaleUnits == "dw" || m_ScaleUnits == "degwidth")
+        scaleFactor = 3600.0 / m_Width;
+    m_ScaleLow *= scaleFactor;
+    m_ScaleHigh *= scaleFactor;
+
+    const double shortSide = std::min(m_Width, m_Height);
+    double fovArea         = 0;
+    if (m_ScaleLow > 0 && m_ScaleHigh >= m_ScaleLow)
+    {
+        m_MinDiameter = LOCAL_MIN_QUAD * m_ScaleLow * shortSide / 3600.0;
+        m_MaxDiameter = LOCAL_MAX_QUAD * m_ScaleHigh * shortSide / 3600.0;
+        fovArea       = (m_ScaleHigh * m_Width / 3600.0) * (m_ScaleHigh * m_Height / 3600.0);
+    }
+    else
+    {
+        // Without a scale, index the quads of common fields of view
+        m_ScaleLow = m_ScaleHigh = 0;
+        m_MinDiameter            = 0.05;
+        m_MaxDiameter            = 10;
+    }
+
+    // Blind indexes are expensive to build, keep them while the field of view does not change much
+    m_RebuildIndex = true;
+    if (m_Radius == 0 && m_BlindIndex && m_Solver.indexSize() > 0 &&
+            fabs(m_Solver.minDiameter() - m_MinDiameter) <= LOCAL_INDEX_TOLERANCE * m_MinDiameter &&
+            fabs(m_Solver.maxDiameter() - m_MaxDiameter) <= LOCAL_INDEX_TOLERANCE * m_MaxDiameter)
+        m_RebuildIndex = false;
+
+    QElapsedTimer catalogTimer;
+    catalogTimer.start();
+
+    if (m_RebuildIndex)
+    {
+        // The solution may be anywhere the image overlaps the search area
+        double radius = 180;
+        if (m_Radius > 0)
+            radius = m_Radius + (m_ScaleHigh > 0 ? m_ScaleHigh * std::hypot(m_Width, m_Height) / 7200.0 : m_MaxDiameter);
+
+        queryCatalog(std::min(radius, 180.0), fovArea);
+        m_BlindIndex = radius >= 180;
+
+        if (m_Catalog.count() < 4)
+        {
+            align->appendLogText(i18n("Local solver failed: not enough catalog stars in the search area."));
+            emit solverFailed();
+            return;
+        }
+    }
+
+    m_CatalogTime = catalogTimer.elapsed();
+
+    m_SolveWatcher.setFuture(QtConcurrent::run(this, &LocalAstrometryParser::solveStars));
+}
+
+void LocalAstrometryParser::queryCatalog(double radius, double fovArea)
+{
+    m_Catalog.clear();
+
+    // Keep enough of the brightest stars to have a few dozens in each field of view
+    const double searchArea = 2 * M_PI * (1 - cos(radius * dms::DegToRad)) * (180 / M_PI) * (180 / M_PI);
+    m_CatalogLimit = LOCAL_MAX_BLIND;
+    if (radius < 180)
+    {
+        m_CatalogLimit = LOCAL_MAX_CATALOG;
+        if (fovArea > 0)
+            m_CatalogLimit = qBound(LOCAL_MIN_CATALOG, static_cast<int>(LOCAL_STARS_PER_FIELD * searchArea / fovArea),
+                                    LOCAL_MAX_CATALOG);
+    }
+
+    // Only page in the deep stars down to the magnitude where the search area holds about that many stars
+    const double skyCount  = m_CatalogLimit * LOCAL_SKY_AREA / searchArea;
+    const double magnitude = (log10(skyCount) - LOCAL_COUNT_ZERO) / LOCAL_COUNT_SLOPE + LOCAL_MAG_MARGIN;
+    const float maglim     = static_cast<float>(std::max(LOCAL_MIN_MAGNITUDE, magnitude));
+
+    QList<StarObject *> stars;
+    SkyPoint center(dms(m_RA), dms(m_DEC));
+    StarComponent::Instance()->starsInAperture(stars, center, radius, maglim);
+
+    // The brightest stars are picked by solveStars() on the worker thread
+    m_Catalog.reserve(stars.count());
+    for (const StarObject *object : stars)
+    {
+        if (object->mag() > maglim)
+            continue;
+
+        quad_catalog_star_t star;
+        star.ra  = object->ra0().Degrees();
+        star.dec = object->dec0().Degrees();
+        star.mag = object->mag();
+        m_Catalog.append(star);
+    }
+}
+
+bool LocalAstrometryParser::solveStars()
+{
+    if (m_RebuildIndex)
+    {
+        if (m_Catalog.count() > m_CatalogLimit)
+        {
+            std::partial_sort(m_Catalog.begin(), m_Catalog.begin() + m_CatalogLimit, m_Catalog.end(),
+                              [](const quad_catalog_star_t &a, const quad_catalog_star_t &b)
+            {
+                return a.mag < b.mag;
+            });
+            m_Catalog.resize(m_CatalogLimit);
+        }
+
+        m_Solver.setCatalog(m_Catalog);
+        if (m_Solver.buildIndex(m_MinDiameter, m_MaxDiameter) == false)
+            return false;
+    }
+
+    if (m_Aborted)
+        return false;
+
+    return m_Solver.solve(m_Stars, m_Width, m_Height, m_ScaleLow, m_ScaleHigh, m_Solution);
+}
+
+void LocalAstrometryParser::solverComplete()
+{
+    if (m_Aborted)
+        return;
+
+    qCInfo(KSTARS_EKOS_ALIGN) << "Local solver: detection" << m_DetectionTime << "ms," << m_Stars.count() << "stars;"
+                              << "catalog" << m_CatalogTime << "ms," << m_Catalog.count() << "stars;"
+                              << "index" << m_Solver.indexSize() << "quads" << (m_RebuildIndex ? "built" : "reused") << ";"
+                              << "total" << solverTimer.elapsed() << "ms";
+
+    if (m_SolveWatcher.result() == false)
+    {
+        align->appendLogText(i18n("Solver failed. Try again."));
+        emit solverFailed();
+        return;
+    }
+
+    if (Options::alignmentLogging())
+        align->appendLogText(i18n("Local solver matched %1 of %2 stars.", m_Solution.matches, m_Stars.count()));
+
+    int elapsed = static_cast<int>(round(solverTimer.elapsed() / 1000.0));
+    align->appendLogText(i18np("Solver completed in %1 second.", "Solver completed in %1 seconds.", elapsed));
+    emit solverFinished(m_Solution.orientation, m_Solution.ra, m_Solution.dec, m_Solution.pixscale);
+}
+
+bool LocalAstrometryParser::stopSolver()
+{
+    m_Aborted = true;
+    m_Solver.abort();
+
+    return true;
+}
+}
@@ -0,0 +1,98 @@
+/*  Local Quad Hash Parser
+    Copyright (C) 2020 KStars Developers
+
+    This application is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public
+    License as published by the Free Software Foundation; either
+    version 2 of the License, or (at your option) any later version.
+ */
+
+#pragma once
+
+#include "astrometryparser.h"
+#include "quadsolver.h"
+
+#include <QElapsedTimer>
+#include <QFutureWatcher>
+
+#include <atomic>
+
+namespace Ekos
+{
+class Align;
+
+/**
+ * @class LocalAstrometryParser
+ * LocalAstrometryParser solves images in process with QuadSolver, using the stars of the loaded KStars catalogs.
+ *
+ * It accepts the same arguments as the astrometry.net solver for the search position (-3, -4, -5) and the
+ * pixel scale (-L, -H, -u). Stars are detected with SEP and the image is solved on worker threads. The catalog
+ * is queried on the main thread as the star components are not thread safe. When blind solving, the all-sky
+ * index is kept until the field of view changes.
+ */
+class LocalAstrometryParser : public AstrometryParser
+{
+        Q_OBJECT
+
+    public:
+        LocalAstrometryParser();
+        virtual ~LocalAstrometryParser() override;
+
+        virtual void setAlign(Align *_align) override
+        {
+            align = _align;
+        }
+        virtual bool init() override;
+        virtual void verifyIndexFiles(double fov_x, double fov_y) override;
+        virtual bool startSovler(const QString &filename, const QStringList &args, bool generated = true) override;
+        virtual bool stopSolver() override;
+
+    private slots:
+        void starsExtracted();
+        void solverComplete();
+
+    private:
+        // Worker thread: load the image and detect its stars
+        bool extractStars(const QString &filename);
+        // Worker thread: build the index if required, then solve
+        bool solveStars();
+        // Main thread: fill m_Catalog with the stars around the search position, or all the sky if blind, down to the
+        // magnitude that gives about m_CatalogLimit stars
+        void queryCatalog(double radius, double fovArea);
+
+        Align *align { nullptr };
+
+        // Search position and radius in degrees, radius is 0 when blind solving
+        double m_RA { 0 };
+        double m_DEC { 0 };
+        double m_Radius { 0 };
+        // Pixel scale as passed by Align, and its units
+        double m_ScaleLow { 0 };
+        double m_ScaleHigh { 0 };
+        QString m_ScaleUnits;
+
+        QVector<quad_image_star_t> m_Stars;
+        int m_Width { 0 };
+        int m_Height { 0 };
+
+        QVector<quad_catalog_star_t> m_Catalog;
+        // Brightest catalog stars kept by solveStars()
+        int m_CatalogLimit { 0 };
+        double m_MinDiameter { 0 };
+        double m_MaxDiameter { 0 };
+        bool m_RebuildIndex { true };
+        // True if the index of the solver covers the whole sky
+        bool m_BlindIndex { false };
+
+        QuadSolver m_Solver;
+        quad_solution_t m_Solution;
+
+        QFutureWatcher<bool> m_StarsWatcher;
+        QFutureWatcher<bool> m_SolveWatcher;
+        std::atomic<bool> m_Aborted { false };
+
+        QElapsedTimer solverTimer;
+        qint64 m_DetectionTime { 0 };
+        qint64 m_CatalogTime { 0 };
+};
+}
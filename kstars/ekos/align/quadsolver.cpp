@@ -0,0 +1,620 @@
+/*  Quad Hash Plate Solver
+    Copyright (C) 2020 KStars Developers
+
+    This application is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public
+    License as published by the Free Software Foundation; either
+    version 2 of the License, or (at your option) any later version.
+ */
+
+#include "quadsolver.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+// brightest fainter neighbours of each catalog star used to form quads
+#define QUAD_NEIGHBORS      8
+// size of the hash bins in code space, must be at least twice the tolerance
+#define QUAD_CODE_BIN       0.02
+// largest distance between the codes of matching quads
+#define QUAD_CODE_TOLERANCE 0.01
+// brightest image stars used to form quads
+#define QUAD_IMAGE_STARS    25
+// brightest image stars used to verify a candidate solution
+#define QUAD_VERIFY_STARS   150
+// pixels between matching image and catalog stars
+#define QUAD_MATCH_RADIUS   3.0
+// matches required to accept a solution, in stars and as a fraction of the stars that could match
+#define QUAD_MIN_MATCHES    6
+#define QUAD_MATCH_RATIO    0.2
+
+namespace
+{
+const double ARCSEC_PER_RADIAN = 206264.8062470963552;
+}
+
+namespace Ekos
+{
+QuadSolver::QuadSolver()
+{
+}
+
+void QuadSolver::setCatalog(const QVector<quad_catalog_star_t> &stars)
+{
+    m_Catalog = stars;
+    std::sort(m_Catalog.begin(), m_Catalog.end(), [](const quad_catalog_star_t & a, const quad_catalog_star_t & b)
+    {
+        return a.mag < b.mag;
+    });
+
+    m_Vectors.resize(m_Catalog.count());
+    for (int i = 0; i < m_Catalog.count(); i++)
+        m_Vectors[i] = toVector(m_Catalog[i].ra, m_Catalog[i].dec);
+
+    m_Grid.clear();
+    m_CellSize = 0;
+    m_Quads.clear();
+    m_Index.clear();
+    m_MinDiameter = m_MaxDiameter = 0;
+}
+
+double QuadSolver::minDiameter() const
+{
+    return m_MinDiameter * 180 / M_PI;
+}
+
+double QuadSolver::maxDiameter() const
+{
+    return m_MaxDiameter * 180 / M_PI;
+}
+
+QuadSolver::vector_t QuadSolver::toVector(double ra, double dec)
+{
+    const double r = ra * M_PI / 180, d = dec * M_PI / 180;
+    vector_t v = { cos(d) * cos(r), cos(d) * sin(r), sin(d) };
+    return v;
+}
+
+QuadSolver::plane_t QuadSolver::tangentPlane(const vector_t &center)
+{
+    const double ra  = atan2(center.y, center.x);
+    const double dec = asin(std::max(-1.0, std::min(1.0, center.z)));
+
+    plane_t plane;
+    plane.center = center;
+    plane.east   = { -sin(ra), cos(ra), 0 };
+    plane.north  = { -sin(dec) * cos(ra), -sin(dec) * sin(ra), cos(dec) };
+    return plane;
+}
+
+bool QuadSolver::project(const plane_t &plane, const vector_t &point, double &xi, double &eta)
+{
+    const double d = point.x * plane.center.x + point.y * plane.center.y + point.z * plane.center.z;
+    if (d <= 0)
+        return false;
+
+    xi  = (point.x * plane.east.x + point.y * plane.east.y + point.z * plane.east.z) / d;
+    eta = (point.x * plane.north.x + point.y * plane.north.y + point.z * plane.north.z) / d;
+    return true;
+}
+
+QuadSolver::vector_t QuadSolver::deproject(const plane_t &plane, double xi, double eta)
+{
+    vector_t v = { plane.center.x + xi * plane.east.x + eta * plane.north.x,
+                   plane.center.y + xi * plane.east.y + eta * plane.north.y,
+                   plane.center.z + xi * plane.east.z + eta * plane.north.z
+                 };
+    const double norm = sqrt(v.x * v.x + v.y * v.y + v.z * v.z);
+    v.x /= norm;
+    v.y /= norm;
+    v.z /= norm;
+    return v;
+}
+
+bool QuadSolver::quadCode(const double *x, const double *y, int *order, float *code, double &diameter)
+{
+    // A and B are the most distant pair
+    int a = 0, b = 1;
+    double longest = -1;
+    for (int i = 0; i < 3; i++)
+    {
+        for (int j = i + 1; j < 4; j++)
+        {
+            const double d = (x[i] - x[j]) * (x[i] - x[j]) + (y[i] - y[j]) * (y[i] - y[j]);
+            if (d > longest)
+            {
+                longest = d;
+                a       = i;
+                b       = j;
+            }
+        }
+    }
+
+    if (longest <= 0)
+        return false;
+
+    diameter = sqrt(longest);
+
+    int c = -1, d = -1;
+    for (int i = 0; i < 4; i++)
+    {
+        if (i == a || i == b)
+            continue;
+        if (c < 0)
+            c = i;
+        else
+            d = i;
+    }
+
+    // Similarity mapping A to (0,0) and B to (1,1): w = (z - zA) * (1 + i) / (zB - zA)
+    const double dx = x[b] - x[a], dy = y[b] - y[a];
+    const double ur = (dx + dy) / longest, ui = (dx - dy) / longest;
+
+    double cx = (x[c] - x[a]) * ur - (y[c] - y[a]) * ui;
+    double cy = (x[c] - x[a]) * ui + (y[c] - y[a]) * ur;
+    double dx2 = (x[d] - x[a]) * ur - (y[d] - y[a]) * ui;
+    double dy2 = (x[d] - x[a]) * ui + (y[d] - y[a]) * ur;
+
+    // C and D must be inside the circle with AB as diameter
+    if ((cx - 0.5) * (cx - 0.5) + (cy - 0.5) * (cy - 0.5) > 0.5 ||
+            (dx2 - 0.5) * (dx2 - 0.5) + (dy2 - 0.5) * (dy2 - 0.5) > 0.5)
+        return false;
+
+    // Break the symmetries: swapping A and B maps w to (1 + i) - w, swapping C and D reorders the code
+    if (cx + dx2 > 1)
+    {
+        std::swap(a, b);
+        cx  = 1 - cx;
+        cy  = 1 - cy;
+        dx2 = 1 - dx2;
+        dy2 = 1 - dy2;
+    }
+    if (cx > dx2)
+    {
+        std::swap(c, d);
+        std::swap(cx, dx2);
+        std::swap(cy, dy2);
+    }
+
+    order[0] = a;
+    order[1] = b;
+    order[2] = c;
+    order[3] = d;
+    code[0]  = cx;
+    code[1]  = cy;
+    code[2]  = dx2;
+    code[3]  = dy2;
+    return true;
+}
+
+uint32_t QuadSolver::codeKey(const int *bins)
+{
+    return (bins[0] & 0x7F) | (bins[1] & 0x7F) << 7 | (bins[2] & 0x7F) << 14 | (bins[3] & 0x7F) << 21;
+}
+
+quint64 QuadSolver::cellKey(const vector_t &v) const
+{
+    const quint64 x = static_cast<quint64>((v.x + 1) / m_CellSize);
+    const quint64 y = static_cast<quint64>((v.y + 1) / m_CellSize);
+    const quint64 z = static_cast<quint64>((v.z + 1) / m_CellSize);
+    return x | y << 21 | z << 42;
+}
+
+void QuadSolver::buildGrid(double cellSize)
+{
+    m_Grid.clear();
+    m_CellSize = cellSize;
+
+    for (int i = 0; i < m_Vectors.count(); i++)
+        m_Grid[cellKey(m_Vectors[i])].append(i);
+}
+
+void QuadSolver::starsWithin(const vector_t &center, double radius, QVector<int> &result) const
+{
+    result.clear();
+
+    const double cosRadius = cos(radius);
+    const double chord     = 2 * sin(std::min(radius, M_PI) / 2);
+    const int reach        = static_cast<int>(ceil(chord / m_CellSize));
+
+    const int cx = static_cast<int>((center.x + 1) / m_CellSize);
+    const int cy = static_cast<int>((center.y + 1) / m_CellSize);
+    const int cz = static_cast<int>((center.z + 1) / m_CellSize);
+    const int maxCell = static_cast<int>(2 / m_CellSize);
+
+    for (int x = std::max(0, cx - reach); x <= std::min(maxCell, cx + reach); x++)
+    {
+        for (int y = std::max(0, cy - reach); y <= std::min(maxCell, cy + reach); y++)
+        {
+            for (int z = std::max(0, cz - reach); z <= std::min(maxCell, cz + reach); z++)
+            {
+                auto cell = m_Grid.constFind(static_cast<quint64>(x) | static_cast<quint64>(y) << 21 |
+                                             static_cast<quint64>(z) << 42);
+                if (cell == m_Grid.constEnd())
+                    continue;
+
+                for (int index : cell.value())
+                {
+                    const vector_t &v = m_Vectors[index];
+                    if (v.x * center.x + v.y * center.y + v.z * center.z >= cosRadius)
+                        result.append(index);
+                }
+            }
+        }
+    }
+}
+
+bool QuadSolver::buildIndex(double minDiameter, double maxDiameter)
+{
+    m_Quads.clear();
+    m_Index.clear();
+    m_MinDiameter = minDiameter * M_PI / 180;
+    m_MaxDiameter = maxDiameter * M_PI / 180;
+
+    if (m_Catalog.count() < 4 || m_MaxDiameter <= m_MinDiameter)
+        return false;
+
+    buildGrid(2 * sin(m_MaxDiameter / 2));
+
+    QVector<int> neighbors;
+    double x[QUAD_NEIGHBORS + 1], y[QUAD_NEIGHBORS + 1];
+
+    for (int anchor = 0; anchor < m_Catalog.count(); anchor++)
+    {
+        if ((anchor & 0xFF) == 0 && m_Abort)
+        {
+            m_Quads.clear();
+            m_Index.clear();
+            return false;
+        }
+
+        // Each quad is only formed around its brightest star, catalog stars are sorted by magnitude
+        starsWithin(m_Vectors[anchor], m_MaxDiameter, neighbors);
+        neighbors.erase(std::remove_if(neighbors.begin(), neighbors.end(), [anchor](int index)
+        {
+            return index <= anchor;
+        }), neighbors.end());
+
+        if (neighbors.count() < 3)
+            continue;
+
+        std::sort(neighbors.begin(), neighbors.end());
+        if (neighbors.count() > QUAD_NEIGHBORS)
+            neighbors.resize(QUAD_NEIGHBORS);
+
+        const plane_t plane = tangentPlane(m_Vectors[anchor]);
+        x[0] = y[0] = 0;
+        for (int i = 0; i < neighbors.count(); i++)
+            project(plane, m_Vectors[neighbors[i]], x[i + 1], y[i + 1]);
+
+        for (int b = 1; b <= neighbors.count(); b++)
+        {
+            for (int c = b + 1; c <= neighbors.count(); c++)
+            {
+                for (int d = c + 1; d <= neighbors.count(); d++)
+                {
+                    const int members[4] = { 0, b, c, d };
+                    double qx[4], qy[4];
+                    for (int i = 0; i < 4; i++)
+                    {
+                        qx[i] = x[members[i]];
+                        qy[i] = y[members[i]];
+                    }
+
+                    quad_t quad;
+                    int order[4];
+                    double diameter = 0;
+                    if (quadCode(qx, qy, order, quad.code, diameter) == false)
+                        continue;
+
+                    // Angular diameter, tangent plane distances are slightly stretched away from the anchor
+                    if (diameter < m_MinDiameter || diameter > m_MaxDiameter)
+                        continue;
+
+                    for (int i = 0; i < 4; i++)
+                        quad.stars[i] = members[order[i]] == 0 ? anchor : neighbors[members[order[i]] - 1];
+
+                    int bins[4];
+                    for (int i = 0; i < 4; i++)
+                        bins[i] = static_cast<int>(floor((quad.code[i] + 0.25) / QUAD_CODE_BIN));
+
+                    m_Index[codeKey(bins)].append(m_Quads.count());
+                    m_Quads.append(quad);
+                }
+            }
+        }
+    }
+
+    return m_Quads.isEmpty() == false;
+}
+
+bool QuadSolver::fitTransform(const QVector<double> &x, const QVector<double> &y, const QVector<double> &xi,
+                              const QVector<double> &eta, transform_t &transform)
+{
+    const int count = x.count();
+    if (count < 2)
+        return false;
+
+    const double sign = transform.mirrored ? -1 : 1;
+
+    double zx = 0, zy = 0, wx = 0, wy = 0;
+    for (int i = 0; i < count; i++)
+    {
+        zx += x[i];
+        zy += sign * y[i];
+        wx += xi[i];
+        wy += eta[i];
+    }
+    zx /= count;
+    zy /= count;
+    wx /= count;
+    wy /= count;
+
+    // Complex least squares: a = sum((w - mean w) * conj(z - mean z)) / sum(|z - mean z|^2)
+    double norm = 0, re = 0, im = 0;
+    for (int i = 0; i < count; i++)
+    {
+        const double dzx = x[i] - zx, dzy = sign * y[i] - zy;
+        const double dwx = xi[i] - wx, dwy = eta[i] - wy;
+        norm += dzx * dzx + dzy * dzy;
+        re += dwx * dzx + dwy * dzy;
+        im += dwy * dzx - dwx * dzy;
+    }
+
+    if (norm <= 0)
+        return false;
+
+    transform.ar = re / norm;
+    transform.ai = im / norm;
+    transform.br = wx - (transform.ar * zx - transform.ai * zy);
+    transform.bi = wy - (transform.ai * zx + transform.ar * zy);
+
+    return true;
+}
+
+bool QuadSolver::verify(transform_t &transform, const QVector<quad_image_star_t> &stars, int width, int height,
+                        double matchRadius, int &matches) const
+{
+    matches = 0;
+
+    const double sign  = transform.mirrored ? -1 : 1;
+    const double scale = sqrt(transform.ar * transform.ar + transform.ai * transform.ai);
+    if (scale <= 0)
+        return false;
+
+    // Image center on the sky
+    const double zx = width / 2.0, zy = sign * height / 2.0;
+    const vector_t center = deproject(transform.plane, transform.ar * zx - transform.ai * zy + transform.br,
+                                      transform.ai * zx + transform.ar * zy + transform.bi);
+
+    QVector<int> field;
+    starsWithin(center, atan(scale * sqrt(width * width + height * height) / 2) * 1.05, field);
+    std::sort(field.begin(), field.end());
+
+    const double norm = scale * scale;
+    QVector<double> x, y;
+    QVector<int> matched;
+    QVector<bool> used(stars.count(), false);
+
+    // Catalog stars are matched in order of brightness, no more than there are image stars
+    int candidates = 0;
+    for (int index : field)
+    {
+        double w1 = 0, w2 = 0;
+        if (project(transform.plane, m_Vectors[index], w1, w2) == false)
+            continue;
+
+        const double dr = w1 - transform.br, di = w2 - transform.bi;
+        const double px = (dr * transform.ar + di * transform.ai) / norm;
+        const double py = sign * (di * transform.ar - dr * transform.ai) / norm;
+        if (px < 0 || py < 0 || px > width || py > height)
+            continue;
+
+        if (++candidates > stars.count())
+            break;
+
+        int best = -1;
+        double bestDistance = matchRadius * matchRadius;
+        for (int i = 0; i < stars.count(); i++)
+        {
+            if (used[i])
+                continue;
+            const double d = (stars[i].x - px) * (stars[i].x - px) + (stars[i].y - py) * (stars[i].y - py);
+            if (d < bestDistance)
+            {
+                bestDistance = d;
+                best         = i;
+            }
+        }
+
+        if (best < 0)
+            continue;
+
+        used[best] = true;
+        x.append(stars[best].x);
+        y.append(stars[best].y);
+        matched.append(index);
+    }
+
+    matches = x.count();
+    const int required = std::max(QUAD_MIN_MATCHES,
+                                  static_cast<int>(ceil(QUAD_MATCH_RATIO * std::min(candidates, stars.count()))));
+    if (matches < required)
+        return false;
+
+    // Refit in the tangent plane at the image center
+    transform.plane = tangentPlane(center);
+    QVector<double> xi(matches), eta(matches);
+    for (int i = 0; i < matches; i++)
+        project(transform.plane, m_Vectors[matched[i]], xi[i], eta[i]);
+
+    return fitTransform(x, y, xi, eta, transform);
+}
+
+bool QuadSolver::solve(const QVector<quad_image_star_t> &stars, int width, int height, double scaleLow,
+                       double scaleHigh, quad_solution_t &solution)
+{
+    if (m_Quads.isEmpty() || stars.count() < 4 || width <= 0 || height <= 0)
+        return false;
+
+    QVector<quad_image_star_t> sorted = stars;
+    std::sort(sorted.begin(), sorted.end(), [](const quad_image_star_t & a, const quad_image_star_t & b)
+    {
+        return a.flux > b.flux;
+    });
+    if (sorted.count() > QUAD_VERIFY_STARS)
+        sorted.resize(QUAD_VERIFY_STARS);
+
+    // Radians per pixel with a margin, the solution is checked against the range
+    const double lowScale  = scaleLow > 0 ? 0.9 * scaleLow / ARCSEC_PER_RADIAN : 0;
+    const double highScale = scaleHigh > 0 ? 1.1 * scaleHigh / ARCSEC_PER_RADIAN : std::numeric_limits<double>::max();
+
+    // The first match is only a four star fit, so allow more error away from the quad
+    const double firstRadius = std::max(QUAD_MATCH_RADIUS * 1.5, 0.005 * sqrt(width * width + height * height));
+
+    const int count = std::min(QUAD_IMAGE_STARS, sorted.count());
+
+    // Quads of the brightest stars are tried first
+    for (int d = 3; d < count; d++)
+    {
+        for (int c = 2; c < d; c++)
+        {
+            for (int b = 1; b < c; b++)
+            {
+                if (m_Abort)
+                    return false;
+
+                for (int a = 0; a < b; a++)
+                {
+                    const int members[4] = { a, b, c, d };
+
+                    for (int parity = 0; parity < 2; parity++)
+                    {
+                        const double sign = parity ? -1 : 1;
+                        double qx[4], qy[4];
+                        for (int i = 0; i < 4; i++)
+                        {
+                            qx[i] = sorted[members[i]].x;
+                            qy[i] = sign * sorted[members[i]].y;
+                        }
+
+                        int order[4];
+                        float code[4];
+                        double diameter = 0;
+                        if (quadCode(qx, qy, order, code, diameter) == false)
+                            continue;
+
+                        if (diameter * highScale < m_MinDiameter || diameter * lowScale > m_MaxDiameter)
+                            continue;
+
+                        if (matchQuad(sorted, members, order, code, parity, width, height, lowScale, highScale,
+                                      firstRadius, solution))
+                            return true;
+                    }
+                }
+            }
+        }
+    }
+
+    return false;
+}
+
+bool QuadSolver::matchQuad(const QVector<quad_image_star_t> &stars, const int *members, const int *order,
+                           const float *code, bool mirrored, int width, int height, double lowScale, double highScale,
+                           double firstRadius, quad_solution_t &solution) const
+{
+    int low[4], high[4];
+    for (int i = 0; i < 4; i++)
+    {
+        low[i]  = static_cast<int>(floor((code[i] - QUAD_CODE_TOLERANCE + 0.25) / QUAD_CODE_BIN));
+        high[i] = static_cast<int>(floor((code[i] + QUAD_CODE_TOLERANCE + 0.25) / QUAD_CODE_BIN));
+    }
+
+    // The tolerance spans at most two bins on each axis
+    for (int combination = 0; combination < 16; combination++)
+    {
+        int bins[4];
+        bool valid = true;
+        for (int i = 0; i < 4; i++)
+        {
+            bins[i] = low[i] + ((combination >> i) & 1);
+            valid &= bins[i] <= high[i];
+        }
+        if (valid == false)
+            continue;
+
+        auto candidates = m_Index.constFind(codeKey(bins));
+        if (candidates == m_Index.constEnd())
+            continue;
+
+        for (int q : candidates.value())
+        {
+            const quad_t &quad = m_Quads[q];
+
+            double distance = 0;
+            for (int i = 0; i < 4; i++)
+                distance += (quad.code[i] - code[i]) * (quad.code[i] - code[i]);
+            if (distance > QUAD_CODE_TOLERANCE * QUAD_CODE_TOLERANCE)
+                continue;
+
+            transform_t transform;
+            transform.mirrored = mirrored;
+            transform.plane    = tangentPlane(m_Vectors[quad.stars[0]]);
+
+            QVector<double> x(4), y(4), xi(4), eta(4);
+            for (int i = 0; i < 4; i++)
+            {
+                x[i] = stars[members[order[i]]].x;
+                y[i] = stars[members[order[i]]].y;
+                project(transform.plane, m_Vectors[quad.stars[i]], xi[i], eta[i]);
+            }
+
+            if (fitTransform(x, y, xi, eta, transform) == false)
+                continue;
+
+            const double scale = sqrt(transform.ar * transform.ar + transform.ai * transform.ai);
+            if (scale < lowScale || scale > highScale)
+                continue;
+
+            // A first pass with the four star fit, then two passes with the refined transform
+            int matches = 0;
+            if (verify(transform, stars, width, height, firstRadius, matches) == false ||
+                    verify(transform, stars, width, height, QUAD_MATCH_RADIUS, matches) == false ||
+                    verify(transform, stars, width, height, QUAD_MATCH_RADIUS, matches) == false)
+                continue;
+
+            const double sign = mirrored ? -1 : 1;
+            const double zx = width / 2.0, zy = sign * height / 2.0;
+            const vector_t center = deproject(transform.plane, transform.ar * zx - transform.ai * zy + transform.br,
+                                              transform.ai * zx + transform.ar * zy + transform.bi);
+
+            solution.ra = atan2(center.y, center.x) * 180 / M_PI;
+            if (solution.ra < 0)
+                solution.ra += 360;
+            solution.dec      = asin(center.z) * 180 / M_PI;
+            solution.pixscale = scale * ARCSEC_PER_RADIAN;
+            solution.matches  = matches;
+
+            // CD matrix of the solution, then the orientation as computed by astrometry.net
+            double cd[2][2];
+            cd[0][0] = transform.ar;
+            cd[1][0] = transform.ai;
+            cd[0][1] = -sign * transform.ai;
+            cd[1][1] = sign * transform.ar;
+
+            // A sky image seen without mirrors has East to the left of North, which is a negative determinant
+            const double determinant = cd[0][0] * cd[1][1] - cd[0][1] * cd[1][0];
+            solution.mirrored        = determinant > 0;
+            const double cdParity    = determinant >= 0 ? 1 : -1;
+            const double T           = cdParity * cd[0][0] + cd[1][1];
+            const double A           = cdParity * cd[1][0] - cd[0][1];
+            solution.orientation     = -atan2(A, T) * 180 / M_PI;
+
+            return true;
+        }
+    }
+
+    return false;
+}
+}
@@ -0,0 +1,172 @@
+/*  Quad Hash Plate Solver
+    Copyright (C) 2020 KStars Developers
+
+    This application is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public
+    License as published by the Free Software Foundation; either
+    version 2 of the License, or (at your option) any later version.
+ */
+
+#pragma once
+
+#include <QHash>
+#include <QVector>
+
+#include <atomic>
+#include <cstdint>
+
+namespace Ekos
+{
+// Catalog star, J2000 coordinates in degrees
+typedef struct
+{
+    double ra;
+    double dec;
+    float mag;
+} quad_catalog_star_t;
+
+// Star detected in the image, in pixels
+typedef struct
+{
+    double x;
+    double y;
+    double flux;
+} quad_image_star_t;
+
+// Solution for the center of the image
+typedef struct
+{
+    /// J2000 RA of the image center in degrees
+    double ra;
+    /// J2000 DEC of the image center in degrees
+    double dec;
+    /// Degrees East of North, same convention as astrometry.net
+    double orientation;
+    /// Arcseconds per pixel
+    double pixscale;
+    /// True if the image is mirrored relative to the sky as seen without mirrors
+    bool mirrored;
+    /// Number of image stars matched to catalog stars
+    int matches;
+} quad_solution_t;
+
+/**
+ * @class QuadSolver
+ * In-process plate solver matching geometric hashes of star quads, after the astrometry.net approach.
+ *
+ * Each quad of four nearby catalog stars is described by the position of its two inner stars in the frame
+ * where its two most distant stars are at (0,0) and (1,1). That code does not change with translation,
+ * rotation and scale, so quads of image stars are looked up in a hash of catalog quad codes. Every match
+ * gives a candidate transform which is verified by projecting the catalog stars in the field onto the image.
+ *
+ * The catalog and index are kept between solves, so near solves reuse the index as long as the diameter range
+ * does not change. All functions run on the calling thread, only abort() may be called from another thread.
+ * Once aborted, building the index and solving return early until reset() is called before the next solve.
+ */
+class QuadSolver
+{
+  public:
+    QuadSolver();
+
+    /**
+     * @brief setCatalog Replace the catalog stars. The index must be built again afterwards.
+     * @param stars Catalog stars, in any order.
+     */
+    void setCatalog(const QVector<quad_catalog_star_t> &stars);
+    int catalogSize() const { return m_Catalog.count(); }
+
+    /**
+     * @brief buildIndex Hash all quads of catalog stars whose diameter is within the range.
+     * @param minDiameter Smallest quad diameter in degrees.
+     * @param maxDiameter Largest quad diameter in degrees.
+     * @return True if at least one quad was indexed, false if the catalog is too sparse or the build was aborted.
+     */
+    bool buildIndex(double minDiameter, double maxDiameter);
+    int indexSize() const { return m_Quads.count(); }
+    double minDiameter() const;
+    double maxDiameter() const;
+
+    /**
+     * @brief solve Find where the image is on the sky.
+     * @param stars Stars detected in the image, in any order.
+     * @param width Image width in pixels.
+     * @param height Image height in pixels.
+     * @param scaleLow Lowest expected pixel scale in arcsec per pixel, 0 if unknown.
+     * @param scaleHigh Highest expected pixel scale in arcsec per pixel, 0 if unknown.
+     * @param solution Solution for the center of the image.
+     * @return True if solved, false otherwise.
+     */
+    bool solve(const QVector<quad_image_star_t> &stars, int width, int height, double scaleLow, double scaleHigh,
+               quad_solution_t &solution);
+
+    // Stop building the index or solving as soon as possible
+    void abort() { m_Abort = true; }
+    // Clear an abort, called before the worker starts so that an abort landing meanwhile is not lost
+    void reset() { m_Abort = false; }
+
+  private:
+    typedef struct
+    {
+        double x, y, z;
+    } vector_t;
+
+    typedef struct
+    {
+        // Catalog indexes of stars A, B, C and D of the code
+        int stars[4];
+        float code[4];
+    } quad_t;
+
+    // Tangent plane around a point of the sphere
+    typedef struct
+    {
+        vector_t center, east, north;
+    } plane_t;
+
+    // Candidate transform from image pixels to the tangent plane, w = a * z + b with z = x + iy, or x - iy if mirrored
+    typedef struct
+    {
+        plane_t plane;
+        double ar, ai, br, bi;
+        bool mirrored;
+    } transform_t;
+
+    static vector_t toVector(double ra, double dec);
+    static plane_t tangentPlane(const vector_t &center);
+    static bool project(const plane_t &plane, const vector_t &point, double &xi, double &eta);
+    static vector_t deproject(const plane_t &plane, double xi, double eta);
+
+    // Computes the code of four points and orders them as A, B, C and D. Returns false if C or D is outside the AB circle.
+    static bool quadCode(const double *x, const double *y, int *order, float *code, double &diameter);
+    static uint32_t codeKey(const int *bins);
+
+    quint64 cellKey(const vector_t &v) const;
+    void buildGrid(double cellSize);
+    void starsWithin(const vector_t &center, double radius, QVector<int> &result) const;
+
+    // Least squares fit of the transform from image points to catalog stars in the plane of the transform
+    static bool fitTransform(const QVector<double> &x, const QVector<double> &y, const QVector<double> &xi,
+                             const QVector<double> &eta, transform_t &transform);
+    // Look up the catalog quads matching the code of an image quad, and verify each candidate transform
+    bool matchQuad(const QVector<quad_image_star_t> &stars, const int *members, const int *order, const float *code,
+                   bool mirrored, int width, int height, double lowScale, double highScale, double firstRadius,
+                   quad_solution_t &solution) const;
+    // Move the tangent point of the transform to the center of the image and refit it with the matched stars
+    bool verify(transform_t &transform, const QVector<quad_image_star_t> &stars, int width, int height,
+                double matchRadius, int &matches) const;
+
+    QVector<quad_catalog_star_t> m_Catalog;
+    QVector<vector_t> m_Vectors;
+
+    // Catalog stars binned by their unit vector
+    QHash<quint64, QVector<int>> m_Grid;
+    double m_CellSize { 0 };
+
+    QVector<quad_t> m_Quads;
+    QHash<uint32_t, QVector<int>> m_Index;
+    double m_MinDiameter { 0 };
+    double m_MaxDiameter { 0 };
+
+    std::atomic<bool> m_Abort { false };
+};
+}
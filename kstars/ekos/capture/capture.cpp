@@ -743,15 +743,50 @@ void Capture::sendNewImage(const QString &filename, ISD::CCDChip * myChip)
 {
     if (activeJob && (myChip == nullptr || myChip == targetChip))
     {
-        activeJob->setProperty("filename", filename);
-        emit newImage(activeJob);
-        // We only emit this for client/both images since remote images already send this automatically
-        if (currentCCD->getUploadMode() != ISD::CCD::UPLOAD_LOCAL && activeJob->isPreview() == false)
+        // The file may not be on disk yet while the next exposure runs
+        if (filename.isEmpty() == false && currentCCD->isFramePending(filename))
         {
-            emit newSequenceImage(filename, m_GeneratedPreviewFITS);
-            m_GeneratedPreviewFITS.clear();
+            m_PendingImages.insert(filename, activeJob);
+            return;
         }
+
+        announceImage(filename, activeJob);
+    }
+}
+
+void Capture::announceImage(const QString &filename, SequenceJob *job)
+{
+    job->setProperty("filename", filename);
+    emit newImage(job);
+    // We only emit this for client/both images since remote images already send this automatically
+    if (currentCCD->getUploadMode() != ISD::CCD::UPLOAD_LOCAL && job->isPreview() == false)
+    {
+        emit newSequenceImage(filename, m_GeneratedPreviewFITS);
+        m_GeneratedPreviewFITS.clear();
+    }
+}
+
+void Capture::setFrameProcessed(ISD::CCDChip *chip, const QString &filename, bool success)
+{
+    Q_UNUSED(chip)
+
+    // Frames not announced yet are handled by setCaptureComplete
+    if (m_PendingImages.contains(filename) == false)
+        return;
+
+    QPointer<SequenceJob> job = m_PendingImages.take(filename);
+
+    if (success == false)
+    {
+        appendLogText(i18n("Failed to save file to %1", filename));
+        if (m_State != CAPTURE_IDLE && m_State != CAPTURE_ABORTED)
+            abort();
+        return;
     }
+
+    // The job may have been removed from the queue in the meantime
+    if (job)
+        announceImage(filename, job);
 }
 
 bool Capture::setCamera(const QString &device)
@@ -2096,6 +2131,14 @@ void Capture::captureImage()
 
     connect(currentCCD, &ISD::CCD::newExposureValue, this, &Ekos::Capture::setExposureProgress, Qt::UniqueConnection);
 
+    // Light frames are saved and displayed while the next one is exposed. The last frame of a job waits for
+    // all of them, so the job is complete on disk when it is done, and so does a frame a post capture script reads.
+    const bool pipelined = activeJob->isPreview() == false && activeJob->getFrameType() == FRAME_LIGHT &&
+                           activeJob->getPostCaptureScript().isEmpty() &&
+                           activeJob->getCompleted() + 1 < activeJob->getCount();
+    currentCCD->setFramePipelineDepth(pipelined ? static_cast<int>(Options::capturePipelineDepth()) : 0);
+    connect(currentCCD, &ISD::CCD::frameProcessed, this, &Ekos::Capture::setFrameProcessed, Qt::UniqueConnection);
+
     rc = activeJob->capture(darkSubCheck->isChecked() ? true : false);
 
     if (rc != SequenceJob::CAPTURE_OK)
@@ -612,6 +612,8 @@ class Capture : public QWidget, public Ui::Capture
 
         void setGuideChip(ISD::CCDChip *chip);
         void setGeneratedPreviewFITS(const QString &previewFITS);
+        // Frames saved and displayed while the next exposure ran
+        void setFrameProcessed(ISD::CCDChip *chip, const QString &filename, bool success);
 
         // Clear Camera Configuration
         void clearCameraConfiguration();
@@ -679,6 +681,7 @@ class Capture : public QWidget, public Ui::Capture
 
         // Send image info
         void sendNewImage(const QString &filename, ISD::CCDChip *myChip);
+        void announceImage(const QString &filename, SequenceJob *job);
 
         // Capture
         bool setCaptureComplete();
@@ -822,6 +825,8 @@ class Capture : public QWidget, public Ui::Capture
         ISD::CCDChip *blobChip { nullptr };
         QString blobFilename;
         QString m_GeneratedPreviewFITS;
+        // Images announced once the camera is done saving them, with the job that captured them
+        QMap<QString, QPointer<SequenceJob>> m_PendingImages;
 
         // They're generic GDInterface because they could be either ISD::CCD or ISD::Filter
         QList<ISD::GDInterface *> Filters;
@@ -42,6 +42,7 @@ enum COMMANDS
     NEW_ALIGN_FRAME,
     NEW_NOTIFICATION,
     NEW_TEMPERATURE,
+    NEW_BATCH,
 
     SET_CLIENT_STATE,
     LOGOUT,
@@ -133,6 +134,8 @@ enum COMMANDS
     OPTION_SET_IMAGE_TRANSFER,
     OPTION_SET_NOTIFICATIONS,
     OPTION_SET_CLOUD_STORAGE,
+    OPTION_SET_BATCH_UPDATES,
+    OPTION_SET_BINARY_UPDATES,
 
     // Storage Options
     SET_BLOBS,
@@ -184,6 +187,7 @@ static QMap<COMMANDS, QString> const commands =
     {NEW_ALIGN_FRAME, "new_align_frame"},
     {NEW_NOTIFICATION, "new_notification"},
     {NEW_TEMPERATURE, "new_temperature"},
+    {NEW_BATCH, "new_batch"},
 
     {SET_CLIENT_STATE, "set_client_state"},
     {LOGOUT, "logout"},
@@ -264,6 +268,8 @@ static QMap<COMMANDS, QString> const commands =
     {OPTION_SET_IMAGE_TRANSFER, "option_set_image_transfer"},
     {OPTION_SET_NOTIFICATIONS, "option_set_notifications"},
     {OPTION_SET_CLOUD_STORAGE, "option_set_cloud_storage"},
+    {OPTION_SET_BATCH_UPDATES, "option_set_batch_updates"},
+    {OPTION_SET_BINARY_UPDATES, "option_set_binary_updates"},
 
     {SET_BLOBS, "set_blobs"},
 
@@ -33,6 +33,16 @@ Media::Media(Ekos::Manager * manager): m_Manager(manager)
 
     connect(this, &Media::newMetadata, this, &Media::uploadMetadata);
     connect(this, &Media::newImage, this, &Media::uploadImage);
+
+    // Encoded on the worker, sent from here
+    m_Encoder.reset(new PreviewEncoder(HB_WIDTH, HB_WIDTH / 4));
+    connect(m_Encoder.get(), &PreviewEncoder::previewEncoded, this, [this](const QByteArray & metadata,
+            const QByteArray & jpeg)
+    {
+        emit newMetadata(metadata);
+        emit newImage(jpeg);
+    });
+    connect(m_Encoder.get(), &PreviewEncoder::frameEncoded, this, &Media::uploadImage);
 }
 
 void Media::connectServer()
@@ -93,6 +103,9 @@ void Media::onDisconnected()
         QFile::remove(oneFile);
     temporaryFiles.clear();
 
+    m_Encoder->clear();
+    m_LastPreviewKey.clear();
+
     emit disconnected();
 }
 
@@ -185,20 +198,30 @@ void Media::sendPreviewImage(FITSView * view, const QString &uuid)
     upload(view);
 }
 
+void Media::setOptions(QMap<int, bool> options)
+{
+    const bool highBandwidth = m_Options[OPTION_SET_HIGH_BANDWIDTH];
+    m_Options = options;
+
+    // Clients see the last image at the new quality right away, encoded from the cache
+    if (m_isConnected && m_LastPreviewKey.isEmpty() == false && m_Options[OPTION_SET_HIGH_BANDWIDTH] != highBandwidth)
+        m_Encoder->resendPreview(m_LastPreviewKey, m_Options[OPTION_SET_HIGH_BANDWIDTH] ? HB_WIDTH : HB_WIDTH / 2,
+                                 m_Options[OPTION_SET_HIGH_BANDWIDTH] ? HB_IMAGE_QUALITY : HB_IMAGE_QUALITY / 2);
+}
+
 void Media::sendImage()
 {
-    QtConcurrent::run(this, &Media::upload, previewImage.get());
+    if (!previewImage)
+        return;
+
+    upload(previewImage.get());
+
+    // The view is emitting the signal that got us here
+    previewImage.release()->deleteLater();
 }
 
 void Media::upload(FITSView * view)
 {
-    QByteArray jpegData;
-    QBuffer buffer(&jpegData);
-    buffer.open(QIODevice::WriteOnly);
-    QImage scaledImage = view->getDisplayImage().scaledToWidth(m_Options[OPTION_SET_HIGH_BANDWIDTH] ? HB_WIDTH : HB_WIDTH / 2);
-    scaledImage.save(&buffer, "jpg", m_Options[OPTION_SET_HIGH_BANDWIDTH] ? HB_IMAGE_QUALITY : HB_IMAGE_QUALITY / 2);
-    buffer.close();
-
     const FITSData * imageData = view->getImageData();
     QString resolution = QString("%1x%2").arg(imageData->width()).arg(imageData->height());
     QString sizeBytes = KFormat().formatByteSize(imageData->size());
@@ -223,14 +246,11 @@ void Media::upload(FITSView * view)
         {"uuid", uuid},
     };
 
-    emit newMetadata(QJsonDocument(metadata).toJson(QJsonDocument::Compact));
-    emit newImage(jpegData);
-
-    //m_WebSocket.sendTextMessage(QJsonDocument(metadata).toJson(QJsonDocument::Compact));
-    //m_WebSocket.sendBinaryMessage(jpegData);
-
-    if (view == previewImage.get())
-        previewImage.reset();
+    // The display image is shared with the encoder, not copied
+    m_LastPreviewKey = m_UUID.isEmpty() ? QUuid::createUuid().toString() : m_UUID;
+    m_Encoder->encodePreview(m_LastPreviewKey, view->getDisplayImage(), metadata,
+                             m_Options[OPTION_SET_HIGH_BANDWIDTH] ? HB_WIDTH : HB_WIDTH / 2,
+                             m_Options[OPTION_SET_HIGH_BANDWIDTH] ? HB_IMAGE_QUALITY : HB_IMAGE_QUALITY / 2);
 }
 
 void Media::sendUpdatedFrame(FITSView * view)
@@ -238,9 +258,6 @@ void Media::sendUpdatedFrame(FITSView * view)
     if (m_isConnected == false || m_Options[OPTION_SET_HIGH_BANDWIDTH] == false || m_sendBlobs == false)
         return;
 
-    QByteArray jpegData;
-    QBuffer buffer(&jpegData);
-    buffer.open(QIODevice::WriteOnly);
     QPixmap displayPixmap = view->getDisplayPixmap();
     if (correctionVector.isNull() == false)
     {
@@ -262,10 +279,10 @@ void Media::sendUpdatedFrame(FITSView * view)
     }
     else
         emit newBoundingRect(QRect(), QSize());
-    displayPixmap.save(&buffer, "jpg", m_Options[OPTION_SET_HIGH_BANDWIDTH] ? HB_PAH_IMAGE_QUALITY : HB_PAH_IMAGE_QUALITY / 2);
-    buffer.close();
 
-    m_WebSocket.sendBinaryMessage(jpegData);
+    // Pixmaps can only be used on the GUI thread, the encoder gets an image
+    m_Encoder->encodeFrame(displayPixmap.toImage(), 0,
+                           m_Options[OPTION_SET_HIGH_BANDWIDTH] ? HB_PAH_IMAGE_QUALITY : HB_PAH_IMAGE_QUALITY / 2);
 }
 
 void Media::sendVideoFrame(std::shared_ptr<QImage> frame)
@@ -276,28 +293,8 @@ void Media::sendVideoFrame(std::shared_ptr<QImage> frame)
     int32_t width = m_Options[OPTION_SET_HIGH_BANDWIDTH] ? HB_WIDTH : HB_WIDTH / 2;
 
     // TODO Scale should be configurable
-    QImage oneFrame;
-    if (frame.get()->width() > width)
-        oneFrame = frame.get()->scaledToWidth(width);
-
-    QByteArray array;
-    QBuffer buffer(&array);
-    QImageWriter writer;
-    writer.setDevice(&buffer);
-    writer.setFormat("JPEG");
-    writer.setCompression(7);
-    writer.write(oneFrame);
-    m_WebSocket.sendBinaryMessage(array);
-    //    QTemporaryFile jpegFile;
-    //    jpegFile.open();
-    //    jpegFile.close();
-
-    //    // TODO Quality should be configurable
-    //    scaledImage.save(jpegFile.fileName(), "jpg", m_Options[OPTION_SET_HIGH_BANDWIDTH] ? HB_VIDEO_QUALITY : HB_VIDEO_QUALITY / 2);
-
-    //    jpegFile.open();
-
-    //m_WebSocket.sendBinaryMessage(jpegFile.readAll());
+    // Frames arriving while one is being encoded replace each other, only the latest is sent
+    m_Encoder->encodeFrame(*frame, width, m_Options[OPTION_SET_HIGH_BANDWIDTH] ? HB_VIDEO_QUALITY : HB_VIDEO_QUALITY / 2);
 }
 
 void Media::registerCameras()
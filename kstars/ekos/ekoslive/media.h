@@ -17,6 +17,7 @@
 
 #include "ekos/ekos.h"
 #include "ekos/manager.h"
+#include "previewencoder.h"
 
 class FITSView;
 
@@ -66,10 +67,7 @@ class Media : public QObject
         void sendVideoFrame(std::shared_ptr<QImage> frame);
 
         // Options
-        void setOptions(QMap<int, bool> options)
-        {
-            m_Options = options;
-        }
+        void setOptions(QMap<int, bool> options);
 
         // Correction Vector
         void setCorrectionVector(QLineF correctionVector)
@@ -112,6 +110,11 @@ class Media : public QObject
         QMap<int, bool> m_Options;
         std::unique_ptr<FITSView> previewImage;
 
+        // Encodes previews and frames off the GUI thread
+        std::unique_ptr<PreviewEncoder> m_Encoder;
+        // Cache key of the last preview, sent again when the bandwidth setting changes
+        QString m_LastPreviewKey;
+
         QString extension;
         QStringList temporaryFiles;
         QLineF correctionVector;
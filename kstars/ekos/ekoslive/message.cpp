@@ -32,6 +32,8 @@ Message::Message(Ekos::Manager *manager): m_Manager(manager)
     connect(&m_WebSocket, &QWebSocket::disconnected, this, &Message::onDisconnected);
     connect(&m_WebSocket, static_cast<void(QWebSocket::*)(QAbstractSocket::SocketError)>(&QWebSocket::error), this, &Message::onError);
 
+    connect(&m_Publisher, &MessagePublisher::textMessage, &m_WebSocket, &QWebSocket::sendTextMessage);
+    connect(&m_Publisher, &MessagePublisher::binaryMessage, &m_WebSocket, &QWebSocket::sendBinaryMessage);
 }
 
 void Message::connectServer()
@@ -70,6 +72,11 @@ void Message::onConnected()
     m_isConnected = true;
     m_ReconnectTries = 0;
 
+    // New clients start from scratch and with the default protocol
+    m_Publisher.reset();
+    m_Publisher.setBatchingEnabled(false);
+    m_Publisher.setBinaryEnabled(false);
+
     connect(&m_WebSocket, &QWebSocket::textMessageReceived,  this, &Message::onTextReceived);
 
     sendConnection();
@@ -82,6 +89,11 @@ void Message::onDisconnected()
 {
     qCInfo(KSTARS_EKOS) << "Disconnected from Message Websocket server.";
     m_isConnected = false;
+
+    MessagePublisher::Statistics stats = m_Publisher.statistics();
+    qCInfo(KSTARS_EKOS) << "Messages published:" << stats.published << "merged:" << stats.merged << "unchanged:"
+                        << stats.skipped << "frames sent:" << stats.frames << "bytes:" << stats.bytes;
+    m_Publisher.reset();
     disconnect(&m_WebSocket, &QWebSocket::textMessageReceived,  this, &Message::onTextReceived);
 
     emit disconnected();
@@ -941,6 +953,16 @@ void Message::processOptionsCommands(const QString &command, const QJsonObject &
         m_Options[OPTION_SET_NOTIFICATIONS] = payload["value"].toBool(true);
     else if (command == commands[OPTION_SET_CLOUD_STORAGE])
         m_Options[OPTION_SET_CLOUD_STORAGE] = payload["value"].toBool(false);
+    else if (command == commands[OPTION_SET_BATCH_UPDATES])
+    {
+        m_Options[OPTION_SET_BATCH_UPDATES] = payload["value"].toBool(false);
+        m_Publisher.setBatchingEnabled(m_Options[OPTION_SET_BATCH_UPDATES]);
+    }
+    else if (command == commands[OPTION_SET_BINARY_UPDATES])
+    {
+        m_Publisher.setBinaryEnabled(payload["value"].toBool(false));
+        m_Options[OPTION_SET_BINARY_UPDATES] = m_Publisher.isBinaryEnabled();
+    }
 
     emit optionsChanged(m_Options);
 }
@@ -998,7 +1020,7 @@ void Message::processDeviceCommands(const QString &command, const QJsonObject &p
     {
         QJsonObject propObject;
         if (oneDevice->getJSONProperty(payload["property"].toString(), propObject, payload["compact"].toBool(true)))
-            m_WebSocket.sendTextMessage(QJsonDocument({{"type", commands[DEVICE_PROPERTY_GET]}, {"payload", propObject}}).toJson(QJsonDocument::Compact));
+            m_Publisher.send(commands[DEVICE_PROPERTY_GET], propObject);
     }
     // Set specific property
     else if (command == commands[DEVICE_PROPERTY_SET])
@@ -1016,7 +1038,7 @@ void Message::processDeviceCommands(const QString &command, const QJsonObject &p
                 properties.append(singleProp);
         }
 
-        m_WebSocket.sendTextMessage(QJsonDocument({{"type", commands[DEVICE_GET]}, {"payload", properties}}).toJson(QJsonDocument::Compact));
+        m_Publisher.send(commands[DEVICE_GET], properties);
     }
     // Subscribe to one or more properties
     // When subscribed, the updates are immediately pushed as soon as they are recieved.
@@ -1032,22 +1054,22 @@ void Message::processDeviceCommands(const QString &command, const QJsonObject &p
 
 void Message::requestDSLRInfo(const QString &cameraName)
 {
-    m_WebSocket.sendTextMessage(QJsonDocument({{"type", commands[DSLR_GET_INFO]}, {"payload", cameraName}}).toJson(QJsonDocument::Compact));
+    m_Publisher.send(commands[DSLR_GET_INFO], cameraName);
 }
 
 void Message::sendDialog(const QJsonObject &message)
 {
-    m_WebSocket.sendTextMessage(QJsonDocument({{"type", commands[DIALOG_GET_INFO]}, {"payload", message}}).toJson(QJsonDocument::Compact));
+    m_Publisher.send(commands[DIALOG_GET_INFO], message);
 }
 
 void Message::sendResponse(const QString &command, const QJsonObject &payload)
 {
-    m_WebSocket.sendTextMessage(QJsonDocument({{"type", command}, {"payload", payload}}).toJson(QJsonDocument::Compact));
+    m_Publisher.send(command, payload);
 }
 
 void Message::sendResponse(const QString &command, const QJsonArray &payload)
 {
-    m_WebSocket.sendTextMessage(QJsonDocument({{"type", command}, {"payload", payload}}).toJson(QJsonDocument::Compact));
+    m_Publisher.send(command, payload);
 }
 
 void Message::updateMountStatus(const QJsonObject &status)
@@ -1055,7 +1077,7 @@ void Message::updateMountStatus(const QJsonObject &status)
     if (m_isConnected == false)
         return;
 
-    sendResponse(commands[NEW_MOUNT_STATE], status);
+    m_Publisher.publishState(commands[NEW_MOUNT_STATE], status);
 }
 
 void Message::updateCaptureStatus(const QJsonObject &status)
@@ -1063,7 +1085,7 @@ void Message::updateCaptureStatus(const QJsonObject &status)
     if (m_isConnected == false)
         return;
 
-    sendResponse(commands[NEW_CAPTURE_STATE], status);
+    m_Publisher.publishState(commands[NEW_CAPTURE_STATE], status);
 }
 
 void Message::updateFocusStatus(const QJsonObject &status)
@@ -1071,7 +1093,8 @@ void Message::updateFocusStatus(const QJsonObject &status)
     if (m_isConnected == false)
         return;
 
-    sendResponse(commands[NEW_FOCUS_STATE], status);
+    // HFR updates are points of the focus curve, none may be merged away
+    m_Publisher.publish(commands[NEW_FOCUS_STATE], status);
 }
 
 void Message::updateGuideStatus(const QJsonObject &status)
@@ -1079,7 +1102,11 @@ void Message::updateGuideStatus(const QJsonObject &status)
     if (m_isConnected == false)
         return;
 
-    sendResponse(commands[NEW_GUIDE_STATE], status);
+    // RMS updates are samples of the guide chart, none may be merged away or dropped as repeated
+    if (status.contains("rarms") || status.contains("derms"))
+        m_Publisher.publish(commands[NEW_GUIDE_STATE], status);
+    else
+        m_Publisher.publishState(commands[NEW_GUIDE_STATE], status);
 }
 
 void Message::updateDomeStatus(const QJsonObject &status)
@@ -1087,7 +1114,7 @@ void Message::updateDomeStatus(const QJsonObject &status)
     if (m_isConnected == false)
         return;
 
-    sendResponse(commands[NEW_DOME_STATE], status);
+    m_Publisher.publishState(commands[NEW_DOME_STATE], status);
 }
 
 void Message::updateCapStatus(const QJsonObject &status)
@@ -1095,7 +1122,7 @@ void Message::updateCapStatus(const QJsonObject &status)
     if (m_isConnected == false)
         return;
 
-    sendResponse(commands[NEW_CAP_STATE], status);
+    m_Publisher.publishState(commands[NEW_CAP_STATE], status);
 }
 
 void Message::sendConnection()
@@ -1196,7 +1223,8 @@ void Message::processNewNumber(INumberVectorProperty *nvp)
     {
         QJsonObject propObject;
         ISD::propertyToJson(nvp, propObject);
-        m_WebSocket.sendTextMessage(QJsonDocument({{"type", commands[DEVICE_PROPERTY_GET]}, {"payload", propObject}}).toJson(QJsonDocument::Compact));
+        // Only the latest value of a busy property is sent in each window
+        m_Publisher.publishLatest(commands[DEVICE_PROPERTY_GET], QString("%1.%2").arg(nvp->device, nvp->name), propObject);
     }
 }
 
@@ -1206,7 +1234,8 @@ void Message::processNewText(ITextVectorProperty *tvp)
     {
         QJsonObject propObject;
         ISD::propertyToJson(tvp, propObject);
-        m_WebSocket.sendTextMessage(QJsonDocument({{"type", commands[DEVICE_PROPERTY_GET]}, {"payload", propObject}}).toJson(QJsonDocument::Compact));
+        // Only the latest value of a busy property is sent in each window
+        m_Publisher.publishLatest(commands[DEVICE_PROPERTY_GET], QString("%1.%2").arg(tvp->device, tvp->name), propObject);
     }
 }
 
@@ -1216,7 +1245,8 @@ void Message::processNewSwitch(ISwitchVectorProperty *svp)
     {
         QJsonObject propObject;
         ISD::propertyToJson(svp, propObject);
-        m_WebSocket.sendTextMessage(QJsonDocument({{"type", commands[DEVICE_PROPERTY_GET]}, {"payload", propObject}}).toJson(QJsonDocument::Compact));
+        // Only the latest value of a busy property is sent in each window
+        m_Publisher.publishLatest(commands[DEVICE_PROPERTY_GET], QString("%1.%2").arg(svp->device, svp->name), propObject);
     }
 }
 
@@ -1226,7 +1256,8 @@ void Message::processNewLight(ILightVectorProperty *lvp)
     {
         QJsonObject propObject;
         ISD::propertyToJson(lvp, propObject);
-        m_WebSocket.sendTextMessage(QJsonDocument({{"type", commands[DEVICE_PROPERTY_GET]}, {"payload", propObject}}).toJson(QJsonDocument::Compact));
+        // Only the latest value of a busy property is sent in each window
+        m_Publisher.publishLatest(commands[DEVICE_PROPERTY_GET], QString("%1.%2").arg(lvp->device, lvp->name), propObject);
     }
 }
 
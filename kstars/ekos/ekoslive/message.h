@@ -17,6 +17,7 @@
 
 #include "ekos/ekos.h"
 #include "ekos/manager.h"
+#include "messagepublisher.h"
 
 namespace EkosLive
 {
@@ -166,6 +167,8 @@ class Message : public QObject
         void processDeviceCommands(const QString &command, const QJsonObject &payload);
 
         QWebSocket m_WebSocket;
+        // Every outgoing message goes through the publisher so state updates can be coalesced
+        MessagePublisher m_Publisher;
         QJsonObject m_AuthResponse;
         uint16_t m_ReconnectTries {0};
         Ekos::Manager *m_Manager { nullptr };
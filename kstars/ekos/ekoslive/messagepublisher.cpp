@@ -0,0 +1,211 @@
+/*  Ekos Live Message Publisher
+
+    Copyright (C) 2020 KStars Developers
+
+    Batching for the Message Channel
+
+    This application is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public
+    License as published by the Free Software Foundation; either
+    version 2 of the License, or (at your option) any later version.
+*/
+
+#include "messagepublisher.h"
+#include "commands.h"
+
+#include "ekos_debug.h"
+
+#include <QJsonArray>
+#include <QJsonDocument>
+
+#include <cstring>
+
+#if QT_VERSION >= QT_VERSION_CHECK(5, 12, 0)
+#include <QCborValue>
+#endif
+
+// time state updates are held to be merged, in milliseconds
+#define MESSAGE_BATCH_INTERVAL 200
+
+namespace EkosLive
+{
+
+MessagePublisher::MessagePublisher(QObject *parent) : QObject(parent)
+{
+    memset(&m_Statistics, 0, sizeof(m_Statistics));
+
+    m_Timer.setSingleShot(true);
+    m_Timer.setInterval(MESSAGE_BATCH_INTERVAL);
+    connect(&m_Timer, &QTimer::timeout, this, &MessagePublisher::flush);
+}
+
+void MessagePublisher::setBinaryEnabled(bool enabled)
+{
+#if QT_VERSION >= QT_VERSION_CHECK(5, 12, 0)
+    m_Binary = enabled;
+#else
+    if (enabled)
+        qCWarning(KSTARS_EKOS) << "Binary messages need Qt 5.12, sending JSON.";
+    m_Binary = false;
+#endif
+}
+
+void MessagePublisher::publishState(const QString &command, const QJsonObject &payload)
+{
+    enqueue(MESSAGE_STATE, command, QString(), payload);
+}
+
+void MessagePublisher::publishLatest(const QString &command, const QString &key, const QJsonValue &payload)
+{
+    enqueue(MESSAGE_LATEST, command, key, payload);
+}
+
+void MessagePublisher::publish(const QString &command, const QJsonValue &payload)
+{
+    enqueue(MESSAGE_EVENT, command, QString(), payload);
+}
+
+void MessagePublisher::enqueue(MessageType type, const QString &command, const QString &key,
+                               const QJsonValue &payload)
+{
+    m_Statistics.published++;
+
+    if (type != MESSAGE_EVENT)
+    {
+        const QString index = command + '\n' + key;
+        auto pending = m_PendingIndex.constFind(index);
+        if (pending != m_PendingIndex.constEnd())
+        {
+            message_t &message = m_Pending[pending.value()];
+
+            // Later fields override earlier ones, the message keeps its place in the queue
+            if (type == MESSAGE_STATE)
+            {
+                QJsonObject merged = message.payload.toObject();
+                const QJsonObject update = payload.toObject();
+                for (auto field = update.constBegin(); field != update.constEnd(); ++field)
+                    merged.insert(field.key(), field.value());
+                message.payload = merged;
+            }
+            else
+                message.payload = payload;
+
+            m_Statistics.merged++;
+            return;
+        }
+
+        m_PendingIndex.insert(index, m_Pending.count());
+    }
+
+    m_Pending.append({ type, command, payload });
+
+    if (m_Timer.isActive() == false)
+        m_Timer.start();
+}
+
+bool MessagePublisher::prepareState(const QString &command, QJsonObject &payload)
+{
+    QJsonObject &sent = m_Sent[command];
+
+    for (auto field = payload.begin(); field != payload.end();)
+    {
+        auto previous = sent.constFind(field.key());
+        if (previous != sent.constEnd() && previous.value() == field.value())
+            field = payload.erase(field);
+        else
+        {
+            sent.insert(field.key(), field.value());
+            ++field;
+        }
+    }
+
+    return payload.isEmpty() == false;
+}
+
+void MessagePublisher::flush()
+{
+    m_Timer.stop();
+
+    if (m_Pending.isEmpty())
+        return;
+
+    // Taken first so a slot connected to the socket cannot publish into the list being sent
+    const QList<message_t> pending = m_Pending;
+    m_Pending.clear();
+    m_PendingIndex.clear();
+
+    QJsonArray batch;
+    for (const message_t &message : pending)
+    {
+        QJsonValue payload = message.payload;
+        if (message.type == MESSAGE_STATE)
+        {
+            QJsonObject state = payload.toObject();
+            if (prepareState(message.command, state) == false)
+            {
+                m_Statistics.skipped++;
+                continue;
+            }
+            payload = state;
+        }
+
+        const QJsonObject frame = {{"type", message.command}, {"payload", payload}};
+        if (m_Batching)
+            batch.append(frame);
+        else
+            sendFrame(frame);
+    }
+
+    if (batch.count() == 1)
+        sendFrame(batch.first().toObject());
+    else if (batch.isEmpty() == false)
+        sendFrame({{"type", commands[NEW_BATCH]}, {"payload", batch}});
+}
+
+void MessagePublisher::send(const QString &command, const QJsonValue &payload)
+{
+    // Whatever was published before goes first
+    flush();
+
+    m_Statistics.published++;
+
+    // Full states sent directly, e.g. on request, are what the client has now
+    if (payload.isObject() && m_Sent.contains(command))
+    {
+        QJsonObject &sent = m_Sent[command];
+        const QJsonObject update = payload.toObject();
+        for (auto field = update.constBegin(); field != update.constEnd(); ++field)
+            sent.insert(field.key(), field.value());
+    }
+
+    sendFrame({{"type", command}, {"payload", payload}});
+}
+
+void MessagePublisher::sendFrame(const QJsonObject &frame)
+{
+    m_Statistics.frames++;
+
+#if QT_VERSION >= QT_VERSION_CHECK(5, 12, 0)
+    if (m_Binary)
+    {
+        const QByteArray data = QCborValue::fromJsonValue(frame).toCbor();
+        m_Statistics.bytes += data.size();
+        emit binaryMessage(data);
+        return;
+    }
+#endif
+
+    const QByteArray json = QJsonDocument(frame).toJson(QJsonDocument::Compact);
+    m_Statistics.bytes += json.size();
+    emit textMessage(QString::fromUtf8(json));
+}
+
+void MessagePublisher::reset()
+{
+    m_Timer.stop();
+    m_Pending.clear();
+    m_PendingIndex.clear();
+    m_Sent.clear();
+}
+
+}
@@ -0,0 +1,137 @@
+/*  Ekos Live Message Publisher
+
+    Copyright (C) 2020 KStars Developers
+
+    Batching for the Message Channel
+
+    This application is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public
+    License as published by the Free Software Foundation; either
+    version 2 of the License, or (at your option) any later version.
+*/
+
+#pragma once
+
+#include <QByteArray>
+#include <QHash>
+#include <QJsonObject>
+#include <QJsonValue>
+#include <QList>
+#include <QObject>
+#include <QString>
+#include <QTimer>
+
+namespace EkosLive
+{
+/**
+ * @class MessagePublisher
+ * Coalesces the state updates of the Message Channel.
+ *
+ * State updates are held for a short window. Updates of the same command within the window are merged, and
+ * fields that have the same value the client last received are left out. Every other message is sent right
+ * away, after whatever is pending, so the order the client sees does not change.
+ *
+ * By default each message still goes out as its own text frame in the usual {type, payload} format. Clients that
+ * opt in get all messages of a window in a single new_batch frame, and can ask for CBOR binary frames instead of JSON.
+ */
+class MessagePublisher : public QObject
+{
+        Q_OBJECT
+
+    public:
+        typedef struct
+        {
+            // Messages passed to the publisher
+            quint64 published;
+            // Messages merged into a pending one of the same command
+            quint64 merged;
+            // Messages not sent because nothing changed
+            quint64 skipped;
+            // Frames sent to the socket
+            quint64 frames;
+            // Bytes sent to the socket
+            quint64 bytes;
+        } Statistics;
+
+        explicit MessagePublisher(QObject *parent = nullptr);
+
+        /**
+         * @brief publishState Queue a partial state update, merged with pending updates of the same command.
+         */
+        void publishState(const QString &command, const QJsonObject &payload);
+
+        /**
+         * @brief publishLatest Queue a message replacing any pending message with the same command and key.
+         * @param key Identifies the object within the command, e.g. the device and property name.
+         */
+        void publishLatest(const QString &command, const QString &key, const QJsonValue &payload);
+
+        /**
+         * @brief publish Queue a message that is never merged or skipped, e.g. a sample of a plot.
+         */
+        void publish(const QString &command, const QJsonValue &payload);
+
+        /**
+         * @brief send Send a message right away, after the pending ones.
+         */
+        void send(const QString &command, const QJsonValue &payload);
+
+        // Send everything pending now
+        void flush();
+
+        // Drop pending messages and forget what the client received, for a new connection
+        void reset();
+
+        void setBatchingEnabled(bool enabled)
+        {
+            m_Batching = enabled;
+        }
+        // Ignored when Qt has no CBOR support
+        void setBinaryEnabled(bool enabled);
+        bool isBinaryEnabled() const
+        {
+            return m_Binary;
+        }
+
+        Statistics statistics() const
+        {
+            return m_Statistics;
+        }
+
+    signals:
+        void textMessage(const QString &message);
+        void binaryMessage(const QByteArray &message);
+
+    private:
+        typedef enum
+        {
+            MESSAGE_STATE,
+            MESSAGE_LATEST,
+            MESSAGE_EVENT
+        } MessageType;
+
+        typedef struct
+        {
+            MessageType type;
+            QString command;
+            QJsonValue payload;
+        } message_t;
+
+        void enqueue(MessageType type, const QString &command, const QString &key, const QJsonValue &payload);
+        // Leaves out the fields the client already has, returns false if nothing is left
+        bool prepareState(const QString &command, QJsonObject &payload);
+        void sendFrame(const QJsonObject &frame);
+
+        QTimer m_Timer;
+        QList<message_t> m_Pending;
+        // Index of the pending state or latest message by command and key
+        QHash<QString, int> m_PendingIndex;
+        // State of each command as last sent to the client
+        QHash<QString, QJsonObject> m_Sent;
+
+        bool m_Batching { false };
+        bool m_Binary { false };
+
+        Statistics m_Statistics;
+};
+}
@@ -0,0 +1,298 @@
+/*  Ekos Live Preview Encoder
+
+    Copyright (C) 2020 KStars Developers
+
+    JPEG encoding for the Media Channel
+
+    This application is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public
+    License as published by the Free Software Foundation; either
+    version 2 of the License, or (at your option) any later version.
+*/
+
+#include "previewencoder.h"
+
+#include "ekos_debug.h"
+
+#include <QBuffer>
+#include <QElapsedTimer>
+#include <QImageWriter>
+#include <QJsonDocument>
+#include <QMutexLocker>
+#include <QtConcurrent>
+
+// number of captured images kept encoded
+#define PREVIEW_CACHE_SIZE   4
+// captured images waiting to be encoded, older ones are dropped
+#define PREVIEW_MAX_PENDING  4
+// jpeg quality of the thumbnails
+#define THUMBNAIL_QUALITY    50
+
+namespace EkosLive
+{
+
+PreviewEncoder::PreviewEncoder(int maxWidth, int thumbnailWidth, QObject *parent) : QObject(parent),
+    m_MaxWidth(maxWidth), m_ThumbnailWidth(thumbnailWidth)
+{
+    m_Worker.setMaxThreadCount(1);
+}
+
+PreviewEncoder::~PreviewEncoder()
+{
+    {
+        QMutexLocker locker(&m_Mutex);
+        m_Previews.clear();
+        m_HasFrame = false;
+    }
+
+    m_Worker.waitForDone();
+}
+
+void PreviewEncoder::encodePreview(const QString &uuid, const QImage &image, const QJsonObject &metadata, int width,
+                                   int quality)
+{
+    if (image.isNull())
+        return;
+
+    QMutexLocker locker(&m_Mutex);
+
+    while (m_Previews.count() >= PREVIEW_MAX_PENDING)
+    {
+        qCDebug(KSTARS_EKOS) << "Preview encoder is busy, dropping image" << m_Previews.first().uuid;
+        m_Previews.removeFirst();
+    }
+
+    m_Previews.append({ uuid, image, metadata, width, quality, true });
+    start();
+}
+
+bool PreviewEncoder::resendPreview(const QString &uuid, int width, int quality)
+{
+    QMutexLocker locker(&m_Mutex);
+
+    if (findEntry(uuid) == nullptr)
+    {
+        // It may still be waiting to be encoded
+        for (preview_job_t &job : m_Previews)
+        {
+            if (job.uuid == uuid)
+            {
+                job.width   = width;
+                job.quality = quality;
+                return true;
+            }
+        }
+
+        return false;
+    }
+
+    m_Previews.append({ uuid, QImage(), QJsonObject(), width, quality, false });
+    start();
+    return true;
+}
+
+void PreviewEncoder::encodeFrame(const QImage &image, int width, int quality)
+{
+    if (image.isNull())
+        return;
+
+    QMutexLocker locker(&m_Mutex);
+
+    // Latest frame wins
+    m_Frame.image   = image;
+    m_Frame.width   = width;
+    m_Frame.quality = quality;
+    m_HasFrame      = true;
+    start();
+}
+
+void PreviewEncoder::clear()
+{
+    QMutexLocker locker(&m_Mutex);
+    m_Previews.clear();
+    m_HasFrame = false;
+    m_Frame.image = QImage();
+    m_Cache.clear();
+}
+
+void PreviewEncoder::start()
+{
+    if (m_Running)
+        return;
+
+    m_Running = true;
+    QtConcurrent::run(&m_Worker, this, &PreviewEncoder::encodeLoop);
+}
+
+void PreviewEncoder::encodeLoop()
+{
+    while (true)
+    {
+        preview_job_t preview;
+        frame_job_t frame;
+        bool hasPreview = false, hasFrame = false;
+
+        {
+            QMutexLocker locker(&m_Mutex);
+
+            // Captured images go first, a stream only needs its latest frame
+            if (m_Previews.isEmpty() == false)
+            {
+                preview    = m_Previews.takeFirst();
+                hasPreview = true;
+            }
+            else if (m_HasFrame)
+            {
+                frame      = m_Frame;
+                hasFrame   = true;
+                m_HasFrame = false;
+                m_Frame.image = QImage();
+            }
+            else
+            {
+                m_Running = false;
+                return;
+            }
+        }
+
+        if (hasPreview)
+            processPreview(preview);
+        else if (hasFrame)
+        {
+            QElapsedTimer timer;
+            timer.start();
+
+            QByteArray jpeg = encode(scaled(frame.image, frame.width), frame.quality, false);
+            qCDebug(KSTARS_EKOS) << "Encoded frame of" << jpeg.size() << "bytes in" << timer.elapsed() << "ms";
+
+            if (jpeg.isEmpty() == false)
+                emit frameEncoded(jpeg);
+        }
+    }
+}
+
+void PreviewEncoder::processPreview(const preview_job_t &job)
+{
+    QImage source;
+    QJsonObject metadata = job.metadata;
+    QByteArray thumbnail, preview;
+
+    const quint32 thumbnailKey = variantKey(m_ThumbnailWidth, THUMBNAIL_QUALITY);
+    const quint32 previewKey   = variantKey(job.width, job.quality);
+
+    {
+        QMutexLocker locker(&m_Mutex);
+        cache_entry_t *entry = findEntry(job.uuid);
+        if (entry)
+        {
+            source    = entry->image;
+            metadata  = entry->metadata;
+            thumbnail = entry->variants.value(thumbnailKey);
+            preview   = entry->variants.value(previewKey);
+        }
+    }
+
+    // A resend of an image that fell out of the cache in the meantime
+    if (source.isNull() && job.image.isNull())
+        return;
+
+    QElapsedTimer timer;
+    timer.start();
+
+    // The full frame is scaled down once, every variant starts from that
+    if (source.isNull())
+        source = scaled(job.image, m_MaxWidth);
+
+    if (job.thumbnail)
+    {
+        if (thumbnail.isEmpty())
+        {
+            thumbnail = encode(scaled(source, m_ThumbnailWidth), THUMBNAIL_QUALITY, false);
+            qCDebug(KSTARS_EKOS) << "Encoded thumbnail of" << thumbnail.size() << "bytes in" << timer.elapsed() << "ms";
+        }
+
+        if (thumbnail.isEmpty() == false)
+            emitPreview(metadata, true, thumbnail);
+    }
+
+    if (preview.isEmpty())
+    {
+        timer.restart();
+        preview = encode(scaled(source, job.width), job.quality, true);
+        qCDebug(KSTARS_EKOS) << "Encoded preview of" << preview.size() << "bytes in" << timer.elapsed() << "ms";
+    }
+
+    if (preview.isEmpty())
+    {
+        qCWarning(KSTARS_EKOS) << "Failed to encode preview image.";
+        return;
+    }
+
+    emitPreview(metadata, false, preview);
+
+    QMutexLocker locker(&m_Mutex);
+
+    cache_entry_t *entry = findEntry(job.uuid);
+    if (entry == nullptr)
+    {
+        m_Cache.append({ job.uuid, source, metadata, QMap<quint32, QByteArray>() });
+        while (m_Cache.count() > PREVIEW_CACHE_SIZE)
+            m_Cache.removeFirst();
+        entry = &m_Cache.last();
+    }
+
+    if (thumbnail.isEmpty() == false)
+        entry->variants.insert(thumbnailKey, thumbnail);
+    entry->variants.insert(previewKey, preview);
+}
+
+void PreviewEncoder::emitPreview(QJsonObject metadata, bool thumbnail, const QByteArray &jpeg)
+{
+    metadata.insert("thumbnail", thumbnail);
+    emit previewEncoded(QJsonDocument(metadata).toJson(QJsonDocument::Compact), jpeg);
+}
+
+PreviewEncoder::cache_entry_t *PreviewEncoder::findEntry(const QString &uuid)
+{
+    for (int i = 0; i < m_Cache.count(); i++)
+    {
+        if (m_Cache[i].uuid == uuid)
+        {
+            // Most recently used goes last
+            m_Cache.move(i, m_Cache.count() - 1);
+            return &m_Cache.last();
+        }
+    }
+
+    return nullptr;
+}
+
+QImage PreviewEncoder::scaled(const QImage &image, int width)
+{
+    // Never scaled up, and shared as is when it already fits
+    if (width <= 0 || image.width() <= width)
+        return image;
+
+    return image.scaledToWidth(width);
+}
+
+QByteArray PreviewEncoder::encode(const QImage &image, int quality, bool progressive)
+{
+    QByteArray jpeg;
+    QBuffer buffer(&jpeg);
+    buffer.open(QIODevice::WriteOnly);
+
+    QImageWriter writer(&buffer, "jpg");
+    writer.setQuality(quality);
+    writer.setOptimizedWrite(true);
+    writer.setProgressiveScanWrite(progressive);
+    if (writer.write(image) == false)
+    {
+        qCWarning(KSTARS_EKOS) << "JPEG encoding failed:" << writer.errorString();
+        return QByteArray();
+    }
+
+    return jpeg;
+}
+
+}
@@ -0,0 +1,137 @@
+/*  Ekos Live Preview Encoder
+
+    Copyright (C) 2020 KStars Developers
+
+    JPEG encoding for the Media Channel
+
+    This application is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public
+    License as published by the Free Software Foundation; either
+    version 2 of the License, or (at your option) any later version.
+*/
+
+#pragma once
+
+#include <QByteArray>
+#include <QImage>
+#include <QJsonObject>
+#include <QList>
+#include <QMap>
+#include <QMutex>
+#include <QObject>
+#include <QString>
+#include <QThreadPool>
+
+namespace EkosLive
+{
+/**
+ * @class PreviewEncoder
+ * Encodes Media Channel images to JPEG on a worker thread.
+ *
+ * A captured image is encoded twice: a small thumbnail is sent first so the client shows something right away,
+ * then the progressive preview follows. Encoded previews are cached by UUID together with a copy of the image
+ * scaled to the largest preview width, so requesting the same image again, even at another bandwidth setting,
+ * never scales the full frame again. Stream frames (video and polar alignment) are not cached and only the
+ * latest waiting frame is encoded.
+ */
+class PreviewEncoder : public QObject
+{
+        Q_OBJECT
+
+    public:
+        /**
+         * @param maxWidth Largest preview width ever requested, images are scaled down to it once.
+         * @param thumbnailWidth Width of the thumbnail sent before each preview.
+         */
+        PreviewEncoder(int maxWidth, int thumbnailWidth, QObject *parent = nullptr);
+        virtual ~PreviewEncoder() override;
+
+        /**
+         * @brief encodePreview Queue a captured image. previewEncoded is emitted for the thumbnail and the preview.
+         * @param uuid Key of the image in the cache.
+         * @param image Image to encode, shared and never modified.
+         * @param metadata Sent along with each variant, "thumbnail" is added to tell them apart.
+         * @param width Width of the preview in pixels.
+         * @param quality JPEG quality of the preview.
+         */
+        void encodePreview(const QString &uuid, const QImage &image, const QJsonObject &metadata, int width,
+                           int quality);
+
+        /**
+         * @brief resendPreview Queue a cached image again at another width and quality, without a thumbnail.
+         * @return False if the image is no longer in the cache.
+         */
+        bool resendPreview(const QString &uuid, int width, int quality);
+
+        /**
+         * @brief encodeFrame Queue a stream frame, replacing the frame still waiting if any. frameEncoded is emitted.
+         */
+        void encodeFrame(const QImage &image, int width, int quality);
+
+        // Drop waiting work and cached previews
+        void clear();
+
+    signals:
+        // Emitted from the worker thread
+        void previewEncoded(const QByteArray &metadata, const QByteArray &jpeg);
+        void frameEncoded(const QByteArray &jpeg);
+
+    private:
+        typedef struct
+        {
+            QString uuid;
+            // Scaled to at most the maximum width
+            QImage image;
+            QJsonObject metadata;
+            // Encoded previews keyed by width and quality
+            QMap<quint32, QByteArray> variants;
+        } cache_entry_t;
+
+        typedef struct
+        {
+            QString uuid;
+            QImage image;
+            QJsonObject metadata;
+            int width;
+            int quality;
+            bool thumbnail;
+        } preview_job_t;
+
+        typedef struct
+        {
+            QImage image;
+            int width;
+            int quality;
+        } frame_job_t;
+
+        void start();
+        void encodeLoop();
+        void processPreview(const preview_job_t &job);
+        void emitPreview(QJsonObject metadata, bool thumbnail, const QByteArray &jpeg);
+
+        static QImage scaled(const QImage &image, int width);
+        static QByteArray encode(const QImage &image, int quality, bool progressive);
+        static quint32 variantKey(int width, int quality)
+        {
+            return (static_cast<quint32>(width) << 8) | static_cast<quint32>(quality & 0xFF);
+        }
+
+        // Must be called with the mutex locked
+        cache_entry_t *findEntry(const QString &uuid);
+
+        int m_MaxWidth { 0 };
+        int m_ThumbnailWidth { 0 };
+
+        // Single worker so images are sent in the order they were captured
+        QThreadPool m_Worker;
+        QMutex m_Mutex;
+        bool m_Running { false };
+
+        QList<preview_job_t> m_Previews;
+        frame_job_t m_Frame;
+        bool m_HasFrame { false };
+
+        // Most recently used last
+        QList<cache_entry_t> m_Cache;
+};
+}
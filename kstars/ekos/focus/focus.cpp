@@ -11,6 +11,7 @@
 
 #include "focusadaptor.h"
 #include "focusalgorithms.h"
+#include "focusmodel.h"
 #include "polynomialfit.h"
 #include "kstars.h"
 #include "kstarsdata.h"
@@ -690,6 +691,17 @@ void Focus::start()
         FocusAlgorithmInterface::FocusParams params(
             maxTravelIN->value(), stepIN->value(), position, absMotionMin, absMotionMax,
             MAXIMUM_ABS_ITERATIONS, toleranceIN->value() / 100.0, filter());
+
+        // Start near where previous runs with this filter and temperature ended
+        FocusModel model(currentFocuser->getDeviceName(), filter());
+        model.load();
+        FocusModel::prediction_t prediction;
+        if (model.predict(focuserTemperature(), &prediction))
+        {
+            params.predictedPosition    = prediction.position;
+            params.predictedUncertainty = prediction.uncertainty;
+            params.predictedHalfWidth   = prediction.halfWidth;
+        }
         linearFocuser.reset(MakeLinearFocuser(params));
         linearRequestedPosition = linearFocuser->initialPosition();
         const int newPosition = adjustLinearPosition(position, linearRequestedPosition);
@@ -2764,6 +2776,15 @@ void Focus::setAutoFocusParameters(int boxSize, int stepSize, int maxTravel, dou
     toleranceIN->setValue(tolerance);
 }
 
+double Focus::focuserTemperature()
+{
+    INDI::Property * np = currentFocuser->getProperty("TemperatureNP");
+    if (np == nullptr || np->getNumber() == nullptr)
+        return FOCUS_MODEL_NO_TEMPERATURE;
+
+    return np->getNumber()->np[0].value;
+}
+
 void Focus::setAutoFocusResult(bool status)
 {
     qCDebug(KSTARS_EKOS_FOCUS) << "AutoFocus result:" << status;
@@ -2772,14 +2793,19 @@ void Focus::setAutoFocusResult(bool status)
     {
         // CR add auto focus position, temperature and filter to log in CSV format
         // this will help with setting up focus offsets and temperature compensation
-        INDI::Property * np = currentFocuser->getProperty("TemperatureNP");
-        double temperature = -274;      // impossible temperature as a signal that it isn't available
-        if (np != nullptr)
+        const double temperature = focuserTemperature();
+        qCInfo(KSTARS_EKOS_FOCUS) << "Autofocus values: position, " << currentPosition << ", temperature, " << temperature << ", filter, " << filter();
+
+        // Positions of relative focusers are not repeatable
+        if (canAbsMove)
         {
-            INumberVectorProperty * tnp = np->getNumber();
-            temperature = tnp->np[0].value;
+            FocusModel::sample_t sample;
+            sample.temperature = temperature;
+            sample.position    = static_cast<int>(currentPosition);
+            sample.hfr         = currentHFR;
+            sample.curvature   = (focusAlgorithm == FOCUS_LINEAR && polynomialFit) ? polynomialFit->coefficient(2) : 0;
+            FocusModel(currentFocuser->getDeviceName(), filter()).addSample(sample);
         }
-        qCInfo(KSTARS_EKOS_FOCUS) << "Autofocus values: position, " << currentPosition << ", temperature, " << temperature << ", filter, " << filter();
     }
 
     // In case of failure, go back to last position if the focuser is absolute
@@ -431,6 +431,9 @@ class Focus : public QWidget, public Ui::Focus
         // to reduce backlash on such movement changes and so that we've always focused in before capture.
         int adjustLinearPosition(int position, int newPosition);
 
+        // Temperature reported by the focuser, FOCUS_MODEL_NO_TEMPERATURE if it has no sensor.
+        double focuserTemperature();
+
         /**
          * @brief syncTrackingBoxPosition Sync the tracking box to the current selected star center
          */
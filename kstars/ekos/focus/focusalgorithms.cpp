@@ -11,6 +11,7 @@
 
 #include "polynomialfit.h"
 #include <QVector>
+#include <algorithm>
 #include "kstars.h"
 
 #include <ekos_focus_debug.h>
@@ -129,6 +130,23 @@ void LinearFocusAlgorithm::computeInitialPosition()
                .arg(params.maxTravel).arg(params.initialStepSize).arg(params.startPosition).arg(params.minPositionAllowed)
                .arg(params.maxPositionAllowed).arg(params.maxIterations).arg(params.focusTolerance).arg(minPositionLimit).arg(maxPositionLimit);
 
+    // Only the first sweep starts from the prediction, a restart has found the curve elsewhere.
+    if (numSteps == 0 && params.predictedPosition >= minPositionLimit && params.predictedPosition <= maxPositionLimit)
+    {
+        // Start far enough above the predicted minimum to cover its error, the bottom of the previous curves,
+        // and the samples the polynomial fit needs before it.
+        constexpr int kMinStepsAboveMinimum = 4;
+        const int margin = std::min(params.maxTravel,
+                                    std::max({kMinStepsAboveMinimum * params.initialStepSize,
+                                              2 * params.predictedUncertainty, params.predictedHalfWidth}));
+        requestedPosition = std::min(params.predictedPosition + margin, maxPositionLimit);
+        passStartPosition = requestedPosition;
+        qCDebug(KSTARS_EKOS_FOCUS) << QString("Linear: predicted %1 +/- %2 width %3, initialPosition %4 sized %5")
+                                      .arg(params.predictedPosition).arg(params.predictedUncertainty)
+                                      .arg(params.predictedHalfWidth).arg(requestedPosition).arg(params.initialStepSize);
+        return;
+    }
+
     const int position = params.startPosition;
     int start, end;
 
@@ -41,14 +41,23 @@ public:
         double focusTolerance;
         // The name of the filter used, if any.
         QString filterName;
+        // Best position predicted from previous runs, or -1 if there is no prediction.
+        int predictedPosition;
+        // Expected error of the predicted position, in steps.
+        int predictedUncertainty;
+        // Distance from the best position at which previous curves rose by half, or 0 if unknown.
+        int predictedHalfWidth;
 
         FocusParams(int _maxTravel, int _initialStepSize, int _startPosition,
                     int _minPositionAllowed, int _maxPositionAllowed,
-                    int _maxIterations, double _focusTolerance, const QString &filterName_) :
+                    int _maxIterations, double _focusTolerance, const QString &filterName_,
+                    int _predictedPosition = -1, int _predictedUncertainty = 0, int _predictedHalfWidth = 0) :
             maxTravel(_maxTravel), initialStepSize(_initialStepSize),
             startPosition(_startPosition), minPositionAllowed(_minPositionAllowed),
             maxPositionAllowed(_maxPositionAllowed), maxIterations(_maxIterations),
-            focusTolerance(_focusTolerance), filterName(filterName_) {}
+            focusTolerance(_focusTolerance), filterName(filterName_),
+            predictedPosition(_predictedPosition), predictedUncertainty(_predictedUncertainty),
+            predictedHalfWidth(_predictedHalfWidth) {}
     };
 
     // Constructor initializes an autofocus algorithm from the input params.
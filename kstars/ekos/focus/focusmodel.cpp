@@ -0,0 +1,146 @@
+/*  Ekos Focus Model
+    Copyright (C) 2020 KStars Developers
+
+    This application is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public
+    License as published by the Free Software Foundation; either
+    version 2 of the License, or (at your option) any later version.
+ */
+
+#include "focusmodel.h"
+
+#include "kstarsdata.h"
+#include "auxiliary/ksuserdb.h"
+
+#include <QVariantMap>
+#include <QVector>
+
+#include <gsl/gsl_errno.h>
+#include <gsl/gsl_fit.h>
+
+#include <algorithm>
+#include <cmath>
+
+#include <ekos_focus_debug.h>
+
+// most recent samples a prediction is made from
+#define FOCUS_MODEL_RECENT 20
+// samples scattered around the latest position when there is no temperature fit
+#define FOCUS_MODEL_SCATTER 5
+// degrees the samples must span to fit the temperature drift
+#define FOCUS_MODEL_MIN_SPAN 2.0
+
+namespace Ekos
+{
+
+FocusModel::FocusModel(const QString &focuser, const QString &filter) : m_Focuser(focuser), m_Filter(filter)
+{
+}
+
+void FocusModel::load()
+{
+    QList<QVariantMap> records;
+    KStarsData::Instance()->userdb()->GetFocusModels(m_Focuser, m_Filter, records);
+
+    m_Samples.clear();
+    for (const QVariantMap &record : records)
+    {
+        sample_t sample;
+        sample.temperature = record["temperature"].toDouble();
+        sample.position    = record["position"].toInt();
+        sample.hfr         = record["hfr"].toDouble();
+        sample.curvature   = record["curvature"].toDouble();
+        m_Samples.append(sample);
+    }
+}
+
+void FocusModel::addSample(const sample_t &sample)
+{
+    m_Samples.append(sample);
+
+    QVariantMap record;
+    record["focuser"]     = m_Focuser;
+    record["filter"]      = m_Filter;
+    record["temperature"] = sample.temperature;
+    record["position"]    = sample.position;
+    record["hfr"]         = sample.hfr;
+    record["curvature"]   = sample.curvature;
+    KStarsData::Instance()->userdb()->AddFocusModel(record);
+}
+
+bool FocusModel::predict(double temperature, prediction_t *prediction) const
+{
+    if (m_Samples.isEmpty())
+        return false;
+
+    const QList<sample_t> recent = m_Samples.mid(std::max(0, m_Samples.count() - FOCUS_MODEL_RECENT));
+    const sample_t &latest = recent.last();
+
+    prediction->position    = latest.position;
+    prediction->uncertainty = 0;
+    prediction->halfWidth   = 0;
+
+    QVector<double> temperatures, positions;
+    for (const sample_t &sample : recent)
+    {
+        if (sample.temperature > FOCUS_MODEL_NO_TEMPERATURE)
+        {
+            temperatures.append(sample.temperature);
+            positions.append(sample.position);
+        }
+    }
+
+    bool fitted = false;
+    if (temperature > FOCUS_MODEL_NO_TEMPERATURE && temperatures.count() >= 3)
+    {
+        const auto range = std::minmax_element(temperatures.constBegin(), temperatures.constEnd());
+        const double coldest = *range.first, warmest = *range.second;
+
+        double c0 = 0, c1 = 0, cov00 = 0, cov01 = 0, cov11 = 0, sumsq = 0;
+        if (warmest - coldest >= FOCUS_MODEL_MIN_SPAN &&
+                gsl_fit_linear(temperatures.constData(), 1, positions.constData(), 1, temperatures.count(),
+                               &c0, &c1, &cov00, &cov01, &cov11, &sumsq) == GSL_SUCCESS)
+        {
+            prediction->position = static_cast<int>(std::lround(c0 + c1 * temperature));
+
+            double error = std::sqrt(sumsq / (temperatures.count() - 2));
+            // The slope is trusted less the further the temperature is outside the samples
+            if (temperature < coldest)
+                error += std::fabs(c1) * (coldest - temperature);
+            else if (temperature > warmest)
+                error += std::fabs(c1) * (temperature - warmest);
+            prediction->uncertainty = static_cast<int>(std::lround(error));
+
+            fitted = true;
+            qCDebug(KSTARS_EKOS_FOCUS) << QString("Focus model: %1 steps/C over %2 samples, %3 at %4C +/- %5")
+                                       .arg(c1).arg(temperatures.count()).arg(prediction->position)
+                                       .arg(temperature).arg(prediction->uncertainty);
+        }
+    }
+
+    if (fitted == false && recent.count() > 1)
+    {
+        const int count = std::min(recent.count(), FOCUS_MODEL_SCATTER);
+        double sum = 0;
+        for (int i = recent.count() - count; i < recent.count(); i++)
+            sum += std::pow(recent[i].position - latest.position, 2);
+        prediction->uncertainty = static_cast<int>(std::lround(std::sqrt(sum / (count - 1))));
+    }
+
+    // Curves are hfr + curvature * offset^2 around their minimum
+    QVector<double> widths;
+    for (const sample_t &sample : recent)
+    {
+        if (sample.curvature > 0 && sample.hfr > 0)
+            widths.append(std::sqrt(0.5 * sample.hfr / sample.curvature));
+    }
+    if (widths.isEmpty() == false)
+    {
+        std::nth_element(widths.begin(), widths.begin() + widths.count() / 2, widths.end());
+        prediction->halfWidth = static_cast<int>(std::lround(widths[widths.count() / 2]));
+    }
+
+    return true;
+}
+
+}
@@ -0,0 +1,83 @@
+/*  Ekos Focus Model
+    Copyright (C) 2020 KStars Developers
+
+    This application is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public
+    License as published by the Free Software Foundation; either
+    version 2 of the License, or (at your option) any later version.
+*/
+
+#pragma once
+
+#include <QList>
+#include <QString>
+
+// temperature of focusers without a sensor
+#define FOCUS_MODEL_NO_TEMPERATURE -274
+
+namespace Ekos
+{
+
+/**
+ * @class FocusModel
+ * @short Past autofocus results of one focuser and filter, used to predict where the next run will end.
+ *
+ * Each successful run adds a sample with the focuser temperature, the best position, its HFR and the curvature
+ * of the V-curve fitted around it. Samples are stored in the user database. Focus drifts with temperature as the
+ * optical train contracts, so when recent samples span a range of temperatures the position is predicted from a
+ * linear fit against temperature. Otherwise the latest position is used. The scatter of the samples and the shape
+ * of the previous curves tell the linear algorithm how wide its first sweep needs to be.
+ */
+class FocusModel
+{
+    public:
+        typedef struct
+        {
+            double temperature;
+            int position;
+            double hfr;
+            // Coefficient of the square term of the V-curve polynomial, 0 if unknown
+            double curvature;
+        } sample_t;
+
+        typedef struct
+        {
+            int position;
+            // Expected error of the position in steps
+            int uncertainty;
+            // Steps around the position where previous curves were within half again of their best HFR, 0 if unknown
+            int halfWidth;
+        } prediction_t;
+
+        FocusModel(const QString &focuser, const QString &filter);
+
+        // Read the samples from the user database
+        void load();
+        // Add a sample and store it in the user database
+        void addSample(const sample_t &sample);
+
+        const QList<sample_t> &samples() const
+        {
+            return m_Samples;
+        }
+        // Replace the samples without storing them, oldest first
+        void setSamples(const QList<sample_t> &samples)
+        {
+            m_Samples = samples;
+        }
+
+        /**
+         * @brief predict Predict the best focus position at a temperature.
+         * @param temperature Focuser temperature, or FOCUS_MODEL_NO_TEMPERATURE.
+         * @return False if there are no samples to predict from.
+         */
+        bool predict(double temperature, prediction_t *prediction) const;
+
+    private:
+        QString m_Focuser;
+        QString m_Filter;
+        // Oldest first
+        QList<sample_t> m_Samples;
+};
+
+}
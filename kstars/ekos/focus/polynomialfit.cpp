@@ -33,6 +33,13 @@ void PolynomialFit::solve(const QVector<double>& x, const QVector<double>& y)
     coefficients = gsl_polynomial_fit(x.data(), y.data(), x.count(), degree, chisq);
 }
 
+double PolynomialFit::coefficient(int power) const
+{
+    if (power < 0 || power >= static_cast<int>(coefficients.size()))
+        return 0;
+    return coefficients[power];
+}
+
 double PolynomialFit::polynomialFunction(double x, void *params)
 {
     PolynomialFit *instance = static_cast<PolynomialFit *>(params);
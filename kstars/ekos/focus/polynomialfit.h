@@ -27,6 +27,9 @@ public:
     // Returns false if the polynomial couldn't be solved.
     bool findMinimum(double expected, double minPosition, double maxPosition, double *position, double *value);
 
+    // Returns the coefficient of x^power in the solved polynomial, 0 if there is none.
+    double coefficient(int power) const;
+
     // Draws the polynomial on the plot's graph.
     void drawPolynomial(QCustomPlot *plot, QCPGraph *graph);
     // Annotate's the plot's solution graph with the solution position.
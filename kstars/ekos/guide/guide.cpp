@@ -122,6 +122,7 @@ Guide::Guide() : QWidget()
     page->setIcon(QIcon::fromTheme("kstars_guides"));
 
     internalGuider->setGuideView(guideView);
+    internalGuider->setLatencyRecorder(&m_Latency);
 
     // Set current guide type
     setGuiderType(-1);
@@ -752,6 +753,7 @@ void Guide::checkCCD(int ccdNum)
         //connect(currentCCD, SIGNAL(FITSViewerClosed()), this, &Ekos::Guide::viewerClosed()), Qt::UniqueConnection);
         connect(currentCCD, &ISD::CCD::numberUpdated, this, &Ekos::Guide::processCCDNumber, Qt::UniqueConnection);
         connect(currentCCD, &ISD::CCD::newExposureValue, this, &Ekos::Guide::checkExposureValue, Qt::UniqueConnection);
+        connect(currentCCD, &ISD::CCD::BLOBReceived, this, &Ekos::Guide::processBLOBReceived, Qt::UniqueConnection);
 
         targetChip->setImageView(guideView, FITS_GUIDE);
 
@@ -1081,6 +1083,8 @@ bool Guide::captureOneFrame()
     // Timeout is exposure duration + timeout threshold in seconds
     captureTimeout.start(finalExposure * 1000 + CAPTURE_TIMEOUT_THRESHOLD);
 
+    m_Latency.startFrame(finalExposure);
+
     targetChip->capture(finalExposure);
 
     return true;
@@ -1194,6 +1198,7 @@ void Guide::processCaptureTimeout()
     currentCCD->setTransformFormat(ISD::CCD::FORMAT_FITS);
     ISD::CCDChip *targetChip = currentCCD->getChip(useGuideHead ? ISD::CCDChip::GUIDE_CCD : ISD::CCDChip::PRIMARY_CCD);
     targetChip->abortExposure();
+    m_Latency.startFrame(exposureIN->value());
     targetChip->capture(exposureIN->value());
     captureTimeout.start(exposureIN->value() * 1000 + CAPTURE_TIMEOUT_THRESHOLD);
 }
@@ -1207,6 +1212,8 @@ void Guide::newFITS(IBLOB *bp)
 
     disconnect(currentCCD, &ISD::CCD::BLOBUpdated, this, &Ekos::Guide::newFITS);
 
+    m_Latency.mark(GuideLatency::FITS_LOADED);
+
     qCDebug(KSTARS_EKOS_GUIDE) << "Received guide frame.";
 
     ISD::CCDChip *targetChip = currentCCD->getChip(useGuideHead ? ISD::CCDChip::GUIDE_CCD : ISD::CCDChip::PRIMARY_CCD);
@@ -1249,6 +1256,9 @@ void Guide::setCaptureComplete()
         return;
     }
 
+    // Either the dark frame was subtracted or no dark frame is used
+    m_Latency.mark(GuideLatency::DARK_SUBTRACTED);
+
     switch (state)
     {
         case GUIDE_IDLE:
@@ -1341,7 +1351,9 @@ bool Guide::sendPulse(GuideDirection ra_dir, int ra_msecs, GuideDirection dec_di
     if (state == GUIDE_CALIBRATING)
         pulseTimer.start((ra_msecs > dec_msecs ? ra_msecs : dec_msecs) + 100);
 
-    return GuideDriver->doPulse(ra_dir, ra_msecs, dec_dir, dec_msecs);
+    bool rc = GuideDriver->doPulse(ra_dir, ra_msecs, dec_dir, dec_msecs);
+    m_Latency.mark(GuideLatency::PULSE_SENT);
+    return rc;
 }
 
 bool Guide::sendPulse(GuideDirection dir, int msecs)
@@ -1861,15 +1873,26 @@ void Guide::checkExposureValue(ISD::CCDChip *targetChip, double exposure, IPStat
     if (guiderType != GUIDE_INTERNAL)
         return;
 
-    INDI_UNUSED(exposure);
-
     if (expState == IPS_ALERT &&
             ((state == GUIDE_GUIDING) || (state == GUIDE_DITHERING) || (state == GUIDE_CALIBRATING)))
     {
         appendLogText(i18n("Exposure failed. Restarting exposure..."));
         currentCCD->setTransformFormat(ISD::CCD::FORMAT_FITS);
+        m_Latency.startFrame(exposureIN->value());
         targetChip->capture(exposureIN->value());
     }
+    // Replace the estimated exposure end once the driver counts down to zero, unless the BLOB beat it
+    else if (exposure == 0 && expState != IPS_ALERT && m_Latency.isMarked(GuideLatency::BLOB_RECEIVED) == false)
+        m_Latency.mark(GuideLatency::EXPOSURE_END);
+}
+
+void Guide::processBLOBReceived(ISD::CCDChip *targetChip)
+{
+    if (currentCCD == nullptr ||
+            targetChip != currentCCD->getChip(useGuideHead ? ISD::CCDChip::GUIDE_CCD : ISD::CCDChip::PRIMARY_CCD))
+        return;
+
+    m_Latency.mark(GuideLatency::BLOB_RECEIVED);
 }
 
 void Guide::setDarkFrameEnabled(bool enable)
@@ -2527,6 +2550,21 @@ QList<double> Guide::axisSigma()
     return sigma;
 }
 
+QList<double> Guide::latency()
+{
+    return m_Latency.last();
+}
+
+QList<double> Guide::averageLatency(int frames)
+{
+    return m_Latency.average(frames > 0 ? frames : 1);
+}
+
+QStringList Guide::latencyStages()
+{
+    return GuideLatency::stageNames();
+}
+
 void Guide::setAxisPulse(double ra, double de)
 {
     l_PulseRA->setText(QString::number(static_cast<int>(ra)));
@@ -10,6 +10,7 @@
 #pragma once
 
 #include "ui_guide.h"
+#include "guidelatency.h"
 #include "ekos/ekos.h"
 #include "indi/indiccd.h"
 #include "indi/inditelescope.h"
@@ -54,6 +55,7 @@ class Guide : public QWidget, public Ui::Guide
         Q_PROPERTY(double exposure READ exposure WRITE setExposure)
         Q_PROPERTY(QList<double> axisDelta READ axisDelta NOTIFY newAxisDelta)
         Q_PROPERTY(QList<double> axisSigma READ axisSigma NOTIFY newAxisSigma)
+        Q_PROPERTY(QList<double> latency READ latency)
 
     public:
         Guide();
@@ -319,6 +321,27 @@ class Guide : public QWidget, public Ui::Guide
          */
         Q_SCRIPTABLE QList<double> axisSigma();
 
+        /** DBUS interface function.
+         * @brief latency returns the guide loop latencies of the last guide frame in milliseconds.
+         * @return List of doubles. Time spent receiving the BLOB after the exposure ended, loading the FITS, subtracting the dark,
+         * detecting the star, processing the axes and dispatching the pulse. The last member is the total latency from the end
+         * of the exposure until the pulse was issued. Empty if no frame was guided yet.
+         */
+        Q_SCRIPTABLE QList<double> latency();
+
+        /** DBUS interface function.
+         * @brief averageLatency returns the guide loop latencies averaged over the last guide frames.
+         * @param frames Number of frames to average, up to 64.
+         * @return List of doubles with the same members as latency().
+         */
+        Q_SCRIPTABLE QList<double> averageLatency(int frames);
+
+        /** DBUS interface function.
+         * @brief latencyStages returns the names of the members of latency() and averageLatency().
+         * The names are fixed English keys, whatever the language of the user interface.
+         */
+        Q_SCRIPTABLE QStringList latencyStages();
+
         /**
               * @brief checkCCD Check all CCD parameters and ensure all variables are updated to reflect the selected CCD
               * @param ccdNum CCD index number in the CCD selection combo box
@@ -333,6 +356,12 @@ class Guide : public QWidget, public Ui::Guide
              */
         void checkExposureValue(ISD::CCDChip *targetChip, double exposure, IPState expState);
 
+        /**
+             * @brief processBLOBReceived is called by the INDI framework as soon as a BLOB arrives, before the image is loaded
+             * @param targetChip Chip the BLOB was captured with
+             */
+        void processBLOBReceived(ISD::CCDChip *targetChip);
+
         /**
              * @brief newFITS is called by the INDI framework whenever there is a new BLOB arriving
              */
@@ -587,6 +616,9 @@ class Guide : public QWidget, public Ui::Guide
         // Pulse Timer
         QTimer pulseTimer;
 
+        // Guide loop latency of each frame, from exposure end to pulse dispatch
+        GuideLatency m_Latency;
+
         // Log
         QStringList m_LogText;
 
@@ -0,0 +1,190 @@
+/*  Ekos Guide Latency
+    Copyright (C) 2020 KStars Developers
+
+    This application is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public
+    License as published by the Free Software Foundation; either
+    version 2 of the License, or (at your option) any later version.
+ */
+
+#include "guidelatency.h"
+
+#include <chrono>
+
+namespace Ekos
+{
+const uint32_t GuideLatency::RING_SIZE;
+
+GuideLatency::GuideLatency()
+{
+    for (int i = 0; i < STAGE_COUNT; i++)
+        m_Current[i] = 0;
+
+    for (uint32_t i = 0; i < RING_SIZE; i++)
+    {
+        m_Ring[i].sequence.store(0, std::memory_order_relaxed);
+        for (int j = 0; j < STAGE_COUNT; j++)
+            m_Ring[i].stamps[j].store(0, std::memory_order_relaxed);
+    }
+}
+
+int64_t GuideLatency::now()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+void GuideLatency::startFrame(double exposure)
+{
+    for (int i = 0; i < STAGE_COUNT; i++)
+        m_Current[i] = 0;
+
+    // Estimated until the driver reports the exposure is over
+    m_Current[EXPOSURE_END] = now() + static_cast<int64_t>(exposure * 1e9);
+    m_Pending               = true;
+}
+
+void GuideLatency::mark(Stage stage)
+{
+    if (m_Pending)
+        m_Current[stage] = now();
+}
+
+bool GuideLatency::isMarked(Stage stage) const
+{
+    return m_Pending && m_Current[stage] != 0;
+}
+
+bool GuideLatency::commit()
+{
+    if (m_Pending == false)
+        return false;
+
+    m_Pending = false;
+
+    const uint32_t index = m_Committed.load(std::memory_order_relaxed);
+    slot_t &slot         = m_Ring[index % RING_SIZE];
+
+    // An odd sequence tells readers the slot is being written
+    const uint32_t sequence = slot.sequence.load(std::memory_order_relaxed);
+    slot.sequence.store(sequence + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    for (int i = 0; i < STAGE_COUNT; i++)
+        slot.stamps[i].store(m_Current[i], std::memory_order_relaxed);
+
+    slot.sequence.store(sequence + 2, std::memory_order_release);
+    m_Committed.store(index + 1, std::memory_order_release);
+
+    return true;
+}
+
+uint32_t GuideLatency::frames() const
+{
+    return m_Committed.load(std::memory_order_acquire);
+}
+
+bool GuideLatency::read(uint32_t index, int64_t *stamps) const
+{
+    const slot_t &slot = m_Ring[index % RING_SIZE];
+
+    // The writer only laps a slot after RING_SIZE frames, so a few retries are plenty
+    for (int attempt = 0; attempt < 4; attempt++)
+    {
+        const uint32_t before = slot.sequence.load(std::memory_order_acquire);
+        if (before & 1)
+            continue;
+
+        for (int i = 0; i < STAGE_COUNT; i++)
+            stamps[i] = slot.stamps[i].load(std::memory_order_relaxed);
+
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (slot.sequence.load(std::memory_order_relaxed) == before)
+            return true;
+    }
+
+    return false;
+}
+
+void GuideLatency::latencies(const int64_t *stamps, double *values)
+{
+    int64_t previous = stamps[EXPOSURE_END];
+    int64_t last     = previous;
+
+    for (int i = BLOB_RECEIVED; i < STAGE_COUNT; i++)
+    {
+        if (stamps[i] == 0)
+        {
+            values[i - 1] = 0;
+            continue;
+        }
+
+        // The estimated exposure end may be later than the BLOB if the driver downloads early
+        values[i - 1] = stamps[i] > previous ? (stamps[i] - previous) / 1e6 : 0;
+        previous      = stamps[i];
+        last          = stamps[i];
+    }
+
+    values[STAGE_COUNT - 1] = last > stamps[EXPOSURE_END] ? (last - stamps[EXPOSURE_END]) / 1e6 : 0;
+}
+
+QList<double> GuideLatency::last() const
+{
+    QList<double> result;
+
+    const uint32_t committed = frames();
+    if (committed == 0)
+        return result;
+
+    int64_t stamps[STAGE_COUNT];
+    if (read(committed - 1, stamps) == false)
+        return result;
+
+    double values[STAGE_COUNT];
+    latencies(stamps, values);
+
+    for (int i = 0; i < STAGE_COUNT; i++)
+        result << values[i];
+
+    return result;
+}
+
+QList<double> GuideLatency::average(uint32_t count) const
+{
+    QList<double> result;
+
+    const uint32_t committed = frames();
+    count = qMin(qMin(count, committed), RING_SIZE);
+    if (count == 0)
+        return result;
+
+    double sum[STAGE_COUNT] = { 0 };
+    uint32_t used = 0;
+
+    for (uint32_t index = committed - count; index < committed; index++)
+    {
+        int64_t stamps[STAGE_COUNT];
+        if (read(index, stamps) == false)
+            continue;
+
+        double values[STAGE_COUNT];
+        latencies(stamps, values);
+        for (int i = 0; i < STAGE_COUNT; i++)
+            sum[i] += values[i];
+        used++;
+    }
+
+    if (used == 0)
+        return result;
+
+    for (int i = 0; i < STAGE_COUNT; i++)
+        result << sum[i] / used;
+
+    return result;
+}
+
+QStringList GuideLatency::stageNames()
+{
+    return QStringList() << "BLOB Receipt" << "FITS Load" << "Dark Subtraction" << "Star Detection"
+           << "Axes Processing" << "Pulse Dispatch" << "Total";
+}
+}
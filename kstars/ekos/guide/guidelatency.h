@@ -0,0 +1,109 @@
+/*  Ekos Guide Latency
+    Copyright (C) 2020 KStars Developers
+
+    This application is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public
+    License as published by the Free Software Foundation; either
+    version 2 of the License, or (at your option) any later version.
+ */
+
+#pragma once
+
+#include <QList>
+#include <QStringList>
+
+#include <atomic>
+#include <cstdint>
+
+namespace Ekos
+{
+/**
+ * @class GuideLatency
+ * Records when each guide frame passes through the stages of the guide loop, from the end of the exposure
+ * until the guide pulse is issued.
+ *
+ * The stages of the frame being processed are marked by the guide loop. Once the pulse is dispatched, the frame
+ * is committed to a fixed size ring buffer. Committing and reading do not lock or allocate, so the statistics can
+ * be queried from any thread while guiding. Readers retry if the frame they read is overwritten meanwhile.
+ */
+class GuideLatency
+{
+  public:
+    typedef enum
+    {
+        EXPOSURE_END,
+        BLOB_RECEIVED,
+        FITS_LOADED,
+        DARK_SUBTRACTED,
+        STAR_DETECTED,
+        AXES_PROCESSED,
+        PULSE_SENT,
+        STAGE_COUNT
+    } Stage;
+
+    // Number of guide frames kept in the ring buffer
+    static const uint32_t RING_SIZE = 64;
+
+    GuideLatency();
+
+    /**
+     * @brief startFrame Start recording a new guide frame. Any frame that was not committed is discarded.
+     * @param exposure Exposure duration in seconds, used to estimate the end of the exposure until the driver reports it.
+     */
+    void startFrame(double exposure);
+
+    /**
+     * @brief mark Record that the current frame has just completed stage.
+     */
+    void mark(Stage stage);
+    bool isMarked(Stage stage) const;
+
+    /**
+     * @brief commit Publish the current frame to the ring buffer.
+     * @return True if a frame was started and not committed yet, false otherwise.
+     */
+    bool commit();
+
+    // Number of frames committed since the recorder was created
+    uint32_t frames() const;
+
+    /**
+     * @brief last Latencies of the last committed frame.
+     * @return Milliseconds spent in each stage from BLOB_RECEIVED to PULSE_SENT, followed by the total latency
+     * from the end of the exposure. Empty if no frame was committed yet.
+     */
+    QList<double> last() const;
+
+    /**
+     * @brief average Average latencies over the last committed frames.
+     * @param count Number of frames to average, capped to RING_SIZE.
+     * @return Same layout as last().
+     */
+    QList<double> average(uint32_t count) const;
+
+    // Names of the members returned by last() and average(). They are not translated, scripts read them over
+    // D-Bus and from the header of the latency log.
+    static QStringList stageNames();
+
+  private:
+    typedef struct
+    {
+        std::atomic<uint32_t> sequence;
+        std::atomic<int64_t> stamps[STAGE_COUNT];
+    } slot_t;
+
+    // Monotonic timestamp in nanoseconds
+    static int64_t now();
+    // Copy the stamps of the frame committed as index, false if it was overwritten while reading
+    bool read(uint32_t index, int64_t *stamps) const;
+    // Stage and total latencies in milliseconds, stages that were not marked count as 0
+    static void latencies(const int64_t *stamps, double *values);
+
+    // Frame being processed, only touched by the guide loop
+    int64_t m_Current[STAGE_COUNT];
+    bool m_Pending { false };
+
+    slot_t m_Ring[RING_SIZE];
+    std::atomic<uint32_t> m_Committed { 0 };
+};
+}
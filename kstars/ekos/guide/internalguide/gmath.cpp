@@ -11,15 +11,16 @@
 
 #include "gmath.h"
 
-#include "imageautoguiding.h"
 #include "Options.h"
 #include "fitsviewer/fitsdata.h"
 #include "fitsviewer/fitsview.h"
 #include "auxiliary/kspaths.h"
+#include "../guidelatency.h"
 
 #include "ekos_guide_debug.h"
 
 #include <QVector3D>
+#include <algorithm>
 #include <cmath>
 #include <set>
 
@@ -58,6 +59,9 @@ struct Peak
     }
 };
 
+// Upper limits of the processing latency histogram bins in milliseconds
+static const double latency_bins[LATENCY_BIN_CNT - 1] = { 1, 2, 5, 10, 20, 50, 100 };
+
 // JM: Why not use QPoint?
 typedef struct
 {
@@ -89,20 +93,18 @@ cgmath::cgmath() : QObject()
     memset(drift[GUIDE_RA], 0, sizeof(double) * MAX_ACCUM_CNT);
     memset(drift[GUIDE_DEC], 0, sizeof(double) * MAX_ACCUM_CNT);
     drift_integral[GUIDE_RA] = drift_integral[GUIDE_DEC] = 0;
+    memset(latencyHistogram, 0, sizeof(latencyHistogram));
 
     QString logFileName = KSPaths::writableLocation(QStandardPaths::GenericDataLocation) + "guide_log.txt";
     logFile.setFileName(logFileName);
+    latencyLogFile.setFileName(KSPaths::writableLocation(QStandardPaths::GenericDataLocation) +
+                               "guide_latency_log.txt");
 }
 
 cgmath::~cgmath()
 {
     delete[] drift[GUIDE_RA];
     delete[] drift[GUIDE_DEC];
-
-    foreach (float *region, referenceRegions)
-        delete[] region;
-
-    referenceRegions.clear();
 }
 
 bool cgmath::setVideoParameters(int vid_wd, int vid_ht, int binX, int binY)
@@ -168,13 +170,57 @@ void cgmath::createGuideLog()
     out << "Focal,mm: " << focal << endl;
     out << "Aperture,mm: " << aperture << endl;
     out << "F/D: " << focal / aperture << endl;
+    out << "Multi-star guiding: " << (multiStarEnabled ? "On" : "Off") << endl;
     out << "Frame #, Time Elapsed (ms), RA Error (arcsec), RA Correction (ms), RA Correction Direction, DEC Error "
-        "(arcsec), DEC Correction (ms), DEC Correction Direction"
+        "(arcsec), DEC Correction (ms), DEC Correction Direction, Processing Latency (ms)"
         << endl;
 
+    latencyLogFile.close();
+    latencyLogFile.open(QIODevice::WriteOnly | QIODevice::Text);
+    QTextStream latencyOut(&latencyLogFile);
+
+    latencyOut << "Frame #, " << Ekos::GuideLatency::stageNames().join(" (ms), ") << " (ms)" << endl;
+
     logTime.restart();
 }
 
+void cgmath::logLatencyHistogram()
+{
+    uint32_t total = 0;
+    for (int i = 0; i < LATENCY_BIN_CNT; i++)
+        total += latencyHistogram[i];
+
+    if (total == 0)
+        return;
+
+    if (logFile.isOpen() && Options::guideLogging())
+    {
+        QTextStream out(&logFile);
+        out << "Processing latency histogram (ms), Frames, Percent" << endl;
+        for (int i = 0; i < LATENCY_BIN_CNT; i++)
+        {
+            QString bin = (i < LATENCY_BIN_CNT - 1) ? QString("< %1").arg(latency_bins[i]) :
+                          QString(">= %1").arg(latency_bins[LATENCY_BIN_CNT - 2]);
+            out << bin << "," << latencyHistogram[i] << "," << QString::number(latencyHistogram[i] * 100.0 / total, 'f', 1)
+                << endl;
+        }
+    }
+
+    qCDebug(KSTARS_EKOS_GUIDE) << "Processed" << total << "guide frames. Last processing latency" << lastLatency << "ms";
+}
+
+void cgmath::logLatency(const QList<double> &stages)
+{
+    if (stages.isEmpty() || latencyLogFile.isOpen() == false || Options::guideLogging() == false)
+        return;
+
+    QTextStream out(&latencyLogFile);
+    out << ticks;
+    for (double stage : stages)
+        out << "," << QString::number(stage, 'f', 3);
+    out << endl;
+}
+
 bool cgmath::setReticleParameters(double x, double y, double ang)
 {
     // check frame ranges
@@ -275,6 +321,9 @@ bool cgmath::reset(void)
     // cleanup stat vars.
     sum = 0;
 
+    // Secondary stars must be referenced again against the new lock position
+    multiStarNeedsReference = true;
+
     return true;
 }
 
@@ -522,18 +571,33 @@ void cgmath::start(void)
 
     preview_mode = false;
 
+    multiStars.clear();
+    multiStarNeedsReference = true;
+    memset(latencyHistogram, 0, sizeof(latencyHistogram));
+
     if (focal > 0 && aperture > 0)
         createGuideLog();
 
     // Create reference Image
     if (imageGuideEnabled)
     {
-        foreach (float *region, referenceRegions)
-            delete[] region;
+        imageShift.dx = imageShift.dy = imageShift.confidence = 0;
 
-        referenceRegions.clear();
+        if (prepareImageRegions())
+        {
+            const int regionSize  = regionAxis * regionAxis;
+            const int regionCount = imageRegions.count() / regionSize;
 
-        referenceRegions = partitionImage();
+            // FFT plans are only rebuilt if the region axis changed
+            regionCorrelators.resize(regionCount);
+            for (int i = 0; i < regionCount; i++)
+            {
+                regionCorrelators[i].setSize(regionAxis);
+                regionCorrelators[i].setReference(imageRegions.constData() + i * regionSize);
+            }
+        }
+        else
+            regionCorrelators.clear();
 
         reticle_pos = Vector(0, 0, 0);
     }
@@ -541,6 +605,9 @@ void cgmath::start(void)
 
 void cgmath::stop(void)
 {
+    if (preview_mode == false)
+        logLatencyHistogram();
+
     preview_mode = true;
 }
 
@@ -564,146 +631,112 @@ void cgmath::setLostStar(bool is_lost)
     lost_star = is_lost;
 }
 
-float *cgmath::createFloatImage(FITSData *target) const
+bool cgmath::createFloatImage(QVector<float> &buffer, FITSData *target) const
 {
     FITSData *imageData = target;
     if (imageData == nullptr)
         imageData = guideView->getImageData();
 
-    // #1 Convert to float array
-    // We only process 1st plane if it is a color image
-    uint32_t imgSize = imageData->width() * imageData->height();
-    float *imgFloat  = new float[imgSize];
+    // We only process 1st plane if it is a color image. Resizing to the same frame size does not reallocate.
+    buffer.resize(imageData->width() * imageData->height());
 
-    if (imgFloat == nullptr)
+    if (imageData->getFloatRegion(buffer.data()) == false)
     {
-        qCritical() << "Not enough memory for float image array!";
-        return nullptr;
+        buffer.clear();
+        return false;
     }
 
-    switch (imageData->property("dataType").toInt())
-    {
-        case TBYTE:
-        {
-            uint8_t *buffer = imageData->getImageBuffer();
-            for (uint32_t i = 0; i < imgSize; i++)
-                imgFloat[i] = buffer[i];
-        }
-        break;
+    return true;
+}
 
-        case TSHORT:
-        {
-            int16_t *buffer = reinterpret_cast<int16_t *>(imageData->getImageBuffer());
-            for (uint32_t i = 0; i < imgSize; i++)
-                imgFloat[i] = buffer[i];
-        }
-        break;
+bool cgmath::partitionImage(QVector<float> &regions) const
+{
+    FITSData *imageData = guideView->getImageData();
 
-        case TUSHORT:
-        {
-            uint16_t *buffer = reinterpret_cast<uint16_t *>(imageData->getImageBuffer());
-            for (uint32_t i = 0; i < imgSize; i++)
-                imgFloat[i] = buffer[i];
-        }
-        break;
+    const uint32_t xRegions   = imageData->width() / regionAxis;
+    const uint32_t yRegions   = imageData->height() / regionAxis;
+    const uint32_t regionSize = regionAxis * regionAxis;
 
-        case TLONG:
-        {
-            int32_t *buffer = reinterpret_cast<int32_t *>(imageData->getImageBuffer());
-            for (uint32_t i = 0; i < imgSize; i++)
-                imgFloat[i] = buffer[i];
-        }
-        break;
+    // All regions are stored back to back in one buffer that is reused from frame to frame
+    regions.resize(xRegions * yRegions * regionSize);
 
-        case TULONG:
-        {
-            uint32_t *buffer = reinterpret_cast<uint32_t *>(imageData->getImageBuffer());
-            for (uint32_t i = 0; i < imgSize; i++)
-                imgFloat[i] = buffer[i];
-        }
-        break;
+    if (regions.isEmpty())
+        return false;
 
-        case TFLOAT:
-        {
-            float *buffer = reinterpret_cast<float *>(imageData->getImageBuffer());
-            for (uint32_t i = 0; i < imgSize; i++)
-                imgFloat[i] = buffer[i];
-        }
-        break;
+    float *regionPtr = regions.data();
 
-        case TLONGLONG:
+    for (uint32_t i = 0; i < yRegions; i++)
+    {
+        for (uint32_t j = 0; j < xRegions; j++)
         {
-            int64_t *buffer = reinterpret_cast<int64_t *>(imageData->getImageBuffer());
-            for (uint32_t i = 0; i < imgSize; i++)
-                imgFloat[i] = buffer[i];
-        }
-        break;
+            // Convert the region straight from the native image buffer
+            if (imageData->getFloatRegion(regionPtr, QRect(j * regionAxis, i * regionAxis, regionAxis, regionAxis)) == false)
+            {
+                regions.clear();
+                return false;
+            }
 
-        case TDOUBLE:
-        {
-            double *buffer = reinterpret_cast<double *>(imageData->getImageBuffer());
-            for (uint32_t i = 0; i < imgSize; i++)
-                imgFloat[i] = buffer[i];
+            regionPtr += regionSize;
         }
-        break;
-
-        default:
-            delete[] imgFloat;
-            return nullptr;
     }
 
-    return imgFloat;
+    return true;
 }
 
-QVector<float *> cgmath::partitionImage() const
+bool cgmath::prepareImageRegions()
 {
-    QVector<float *> regions;
-
-    FITSData *imageData = guideView->getImageData();
-
-    float *imgFloat = createFloatImage();
+    return partitionImage(imageRegions);
+}
 
-    if (imgFloat == nullptr)
-        return regions;
+phase_shift_t cgmath::registerImageRegions()
+{
+    phase_shift_t result = { 0, 0, 0 };
 
-    const uint16_t width  = imageData->width();
-    const uint16_t height = imageData->height();
+    const int regionSize  = regionAxis * regionAxis;
+    const int regionCount = imageRegions.count() / regionSize;
 
-    uint8_t xRegions = floor(width / regionAxis);
-    uint8_t yRegions = floor(height / regionAxis);
-    // Find number of regions to divide the image
-    //uint8_t regions =  xRegions * yRegions;
+    if (regionCount == 0 || regionCount != regionCorrelators.count())
+    {
+        qCWarning(KSTARS_EKOS_GUIDE) << "Mismatch between reference regions #" << regionCorrelators.count()
+                                     << "and image partition regions #" << regionCount;
+        return result;
+    }
 
-    float *regionPtr = imgFloat;
+    QVector<double> xshifts, yshifts;
+    double confidence = 0;
 
-    for (uint8_t i = 0; i < yRegions; i++)
+    for (int i = 0; i < regionCount; i++)
     {
-        for (uint8_t j = 0; j < xRegions; j++)
-        {
-            // Allocate space for one region
-            float *oneRegion = new float[regionAxis * regionAxis];
-            // Create points to region and current location of the source image in the desired region
-            float *oneRegionPtr = oneRegion, *imgFloatPtr = regionPtr + j * regionAxis;
+        phase_shift_t shift;
+        if (regionCorrelators[i].registerImage(imageRegions.constData() + i * regionSize, shift) == false)
+            continue;
 
-            // copy from image to region line by line
-            for (uint32_t line = 0; line < regionAxis; line++)
-            {
-                memcpy(oneRegionPtr, imgFloatPtr, regionAxis);
-                oneRegionPtr += regionAxis;
-                imgFloatPtr += width;
-            }
+        qCDebug(KSTARS_EKOS_GUIDE) << "Region #" << i << ": X-Shift=" << shift.dx << "Y-Shift=" << shift.dy
+                                   << "Confidence=" << shift.confidence;
 
-            regions.append(oneRegion);
-        }
+        // Regions without stars or with a poor match do not vote
+        if (shift.confidence < IMAGE_GUIDE_MIN_CONFIDENCE)
+            continue;
 
-        // Move regionPtr block by (width * regionAxis) elements
-        regionPtr += width * regionAxis;
+        xshifts.append(shift.dx);
+        yshifts.append(shift.dy);
+        confidence += shift.confidence;
     }
 
-    // We're done with imgFloat
-    delete[] imgFloat;
+    if (xshifts.isEmpty())
+        return result;
+
+    std::nth_element(xshifts.begin(), xshifts.begin() + xshifts.count() / 2, xshifts.end());
+    std::nth_element(yshifts.begin(), yshifts.begin() + yshifts.count() / 2, yshifts.end());
 
-    return regions;
+    result.dx         = xshifts[xshifts.count() / 2];
+    result.dy         = yshifts[yshifts.count() / 2];
+    result.confidence = confidence / xshifts.count();
+
+    qCDebug(KSTARS_EKOS_GUIDE) << "Median  : X-Shift=" << result.dx << "Y-Shift=" << result.dy
+                               << "Confidence=" << result.confidence;
+
+    return result;
 }
 
 void cgmath::setRegionAxis(const uint32_t &value)
@@ -720,62 +753,13 @@ Vector cgmath::findLocalStarPosition(void) const
 
     FITSData *imageData = guideView->getImageData();
 
+    // The phase shift is measured on the guide worker thread and handed over by setImageShift()
     if (imageGuideEnabled)
     {
-        float xshift = 0, yshift = 0;
-
-        QVector<Vector> shifts;
-        float xsum = 0, ysum = 0;
-
-        QVector<float *> imagePartition = partitionImage();
-
-        if (imagePartition.isEmpty())
-        {
-            qWarning() << "Failed to partition regions in image!";
+        if (imageShift.confidence < IMAGE_GUIDE_MIN_CONFIDENCE)
             return Vector(-1, -1, -1);
-        }
 
-        if (imagePartition.count() != referenceRegions.count())
-        {
-            qWarning() << "Mismatch between reference regions #" << referenceRegions.count()
-                       << "and image partition regions #" << imagePartition.count();
-            // Clear memory in case of mis-match
-            foreach (float *region, imagePartition)
-            {
-                delete[] region;
-            }
-
-            return Vector(-1, -1, -1);
-        }
-
-        for (uint8_t i = 0; i < imagePartition.count(); i++)
-        {
-            ImageAutoGuiding::ImageAutoGuiding1(referenceRegions[i], imagePartition[i], regionAxis, &xshift, &yshift);
-            Vector shift(xshift, yshift, -1);
-            qCDebug(KSTARS_EKOS_GUIDE) << "Region #" << i << ": X-Shift=" << xshift << "Y-Shift=" << yshift;
-
-            xsum += xshift;
-            ysum += yshift;
-            shifts.append(shift);
-        }
-
-        // Delete partitions
-        foreach (float *region, imagePartition)
-        {
-            delete[] region;
-        }
-        imagePartition.clear();
-
-        float average_x = xsum / referenceRegions.count();
-        float average_y = ysum / referenceRegions.count();
-
-        float median_x = shifts[referenceRegions.count() / 2 - 1].x;
-        float median_y = shifts[referenceRegions.count() / 2 - 1].y;
-
-        qCDebug(KSTARS_EKOS_GUIDE) << "Average : X-Shift=" << average_x << "Y-Shift=" << average_y;
-        qCDebug(KSTARS_EKOS_GUIDE) << "Median  : X-Shift=" << median_x << "Y-Shift=" << median_y;
-
-        return Vector(median_x, median_y, -1);
+        return Vector(imageShift.dx, imageShift.dy, -1);
     }
 
     switch (imageData->property("dataType").toInt())
@@ -820,9 +804,9 @@ Vector cgmath::findLocalStarPosition(void) const
     Vector ret;
     int i, j;
     double resx, resy, mass, threshold, pval;
-    T *psrc    = nullptr;
-    T *porigin = nullptr;
-    T *pptr;
+    const T *psrc    = nullptr;
+    const T *porigin = nullptr;
+    const T *pptr;
 
     QRect trackingBox = guideView->getTrackingBox();
 
@@ -856,7 +840,11 @@ Vector cgmath::findLocalStarPosition(void) const
         return ret;
     }
 
-    T *pdata = reinterpret_cast<T *>(imageData->getImageBuffer());
+    // Process the tracking box in place in its native pixel type
+    const T *pdata = imageData->getImageView<T>();
+
+    if (pdata == nullptr)
+        return Vector(-1, -1, -1);
 
     qCDebug(KSTARS_EKOS_GUIDE) << "Tracking Square " << trackingBox;
 
@@ -877,7 +865,7 @@ Vector cgmath::findLocalStarPosition(void) const
             float i0, i1, i2, i3, i4, i5, i6, i7, i8;
             int ix = 0, iy = 0;
             int xM4;
-            T *p;
+            const T *p;
             double average, fit, bestFit = 0;
             int minx = 0;
             int maxx = width;
@@ -1171,6 +1159,230 @@ Vector cgmath::findLocalStarPosition(void) const
     return ret;
 }
 
+void cgmath::findMultiStarCentroids(QVector<guide_star_t> &stars, int boxSize) const
+{
+    switch (guideView->getImageData()->property("dataType").toInt())
+    {
+        case TBYTE:
+            findMultiStarCentroids<uint8_t>(stars, boxSize);
+            break;
+
+        case TSHORT:
+            findMultiStarCentroids<int16_t>(stars, boxSize);
+            break;
+
+        case TUSHORT:
+            findMultiStarCentroids<uint16_t>(stars, boxSize);
+            break;
+
+        case TLONG:
+            findMultiStarCentroids<int32_t>(stars, boxSize);
+            break;
+
+        case TULONG:
+            findMultiStarCentroids<uint32_t>(stars, boxSize);
+            break;
+
+        case TFLOAT:
+            findMultiStarCentroids<float>(stars, boxSize);
+            break;
+
+        case TLONGLONG:
+            findMultiStarCentroids<int64_t>(stars, boxSize);
+            break;
+
+        case TDOUBLE:
+            findMultiStarCentroids<double>(stars, boxSize);
+            break;
+
+        default:
+            for (guide_star_t &star : stars)
+                star.found = false;
+            break;
+    }
+}
+
+template <typename T>
+void cgmath::findMultiStarCentroids(QVector<guide_star_t> &stars, int boxSize) const
+{
+    FITSData *imageData = guideView->getImageData();
+
+    const T *pdata    = imageData->getImageView<T>();
+    const int width   = imageData->width();
+    const int height  = imageData->height();
+    const int halfBox = boxSize / 2;
+
+    // All stars are measured in place on the native image buffer, so no float copy of the frame is needed.
+    // Each box is read twice, once for its statistics and once for the moments above the threshold.
+    for (guide_star_t &star : stars)
+    {
+        star.found = false;
+
+        if (pdata == nullptr)
+            continue;
+
+        const int x0 = std::max(0, static_cast<int>(std::lround(star.position.x)) - halfBox);
+        const int y0 = std::max(0, static_cast<int>(std::lround(star.position.y)) - halfBox);
+        const int x1 = std::min(width, x0 + boxSize);
+        const int y1 = std::min(height, y0 + boxSize);
+        const int w  = x1 - x0;
+        const int h  = y1 - y0;
+
+        if (w <= 0 || h <= 0)
+            continue;
+
+        // Pass 1: box mean, standard deviation and peak
+        double total = 0, totalSq = 0, peak = pdata[y0 * width + x0];
+        for (int y = y0; y < y1; y++)
+        {
+            const T *row = pdata + y * width + x0;
+            for (int x = 0; x < w; x++)
+            {
+                const double val = row[x];
+                total += val;
+                totalSq += val * val;
+                peak = std::max(peak, val);
+            }
+        }
+
+        const double count = w * h;
+        const double mean  = total / count;
+        const double stdev = sqrt(std::max(totalSq / count - mean * mean, 0.0));
+
+        if (stdev <= 0 || (peak - mean) < MULTISTAR_MIN_SNR * stdev)
+            continue;
+
+        // Pass 2: threshold subtracted first moments
+        const double threshold = mean + (peak - mean) * SMART_CUT_FACTOR;
+        double mass = 0, momentX = 0, momentY = 0;
+        for (int y = y0; y < y1; y++)
+        {
+            const T *row = pdata + y * width + x0;
+            double rowMass = 0, rowMoment = 0;
+            for (int x = 0; x < w; x++)
+            {
+                const double val = std::max(row[x] - threshold, 0.0);
+                rowMass += val;
+                rowMoment += x * val;
+            }
+            mass += rowMass;
+            momentX += rowMoment;
+            momentY += (y - y0) * rowMass;
+        }
+
+        if (mass <= 0)
+            continue;
+
+        star.position = Vector(x0 + momentX / mass, y0 + momentY / mass, 0);
+        star.flux     = mass;
+        star.found    = true;
+    }
+}
+
+void cgmath::selectMultiStars(const Vector &guideStarPosition)
+{
+    multiStars.clear();
+
+    const int boxSize  = guideView->getTrackingBox().width();
+    const int maxStars = static_cast<int>(Options::guideMultiStarCount()) - 1;
+
+    if (boxSize <= 0 || maxStars <= 0)
+        return;
+
+    // Stars are returned sorted by brightness
+    QList<Edge *> centers = PSFAutoFind();
+
+    for (Edge *center : centers)
+    {
+        if (multiStars.count() >= maxStars)
+            break;
+
+        // Skip the guide star itself
+        if (fabs(center->x - guideStarPosition.x) < boxSize && fabs(center->y - guideStarPosition.y) < boxSize)
+            continue;
+
+        guide_star_t star;
+        star.position = Vector(center->x, center->y, 0);
+        star.flux     = 0;
+        star.found    = false;
+        multiStars.append(star);
+    }
+
+    qDeleteAll(centers);
+
+    // Measure the references with the same kernel used while guiding
+    findMultiStarCentroids(multiStars, boxSize);
+
+    for (int i = multiStars.count() - 1; i >= 0; i--)
+    {
+        if (multiStars[i].found == false)
+            multiStars.remove(i);
+        else
+            multiStars[i].offset = multiStars[i].position - guideStarPosition;
+    }
+
+    qCDebug(KSTARS_EKOS_GUIDE) << "Multi-star guiding selected" << multiStars.count() << "secondary reference stars.";
+}
+
+Vector cgmath::combineMultiStarDrift(const Vector &guideStarPosition)
+{
+    if (multiStarNeedsReference)
+    {
+        selectMultiStars(guideStarPosition);
+        multiStarNeedsReference = false;
+        return guideStarPosition;
+    }
+
+    if (multiStars.isEmpty())
+        return guideStarPosition;
+
+    findMultiStarCentroids(multiStars, guideView->getTrackingBox().width());
+
+    // Drift of each star relative to where it should be given the current reticle (lock) position.
+    // Secondary stars are referenced to the lock position too, so dithering moves all references together.
+    QVector<double> dx, dy;
+    dx.append(guideStarPosition.x - reticle_pos.x);
+    dy.append(guideStarPosition.y - reticle_pos.y);
+    for (const guide_star_t &star : multiStars)
+    {
+        if (star.found == false)
+            continue;
+
+        dx.append(star.position.x - (reticle_pos.x + star.offset.x));
+        dy.append(star.position.y - (reticle_pos.y + star.offset.y));
+    }
+
+    if (dx.count() == 1)
+        return guideStarPosition;
+
+    QVector<double> sortedX = dx, sortedY = dy;
+    std::nth_element(sortedX.begin(), sortedX.begin() + sortedX.count() / 2, sortedX.end());
+    std::nth_element(sortedY.begin(), sortedY.begin() + sortedY.count() / 2, sortedY.end());
+    const double medianX = sortedX[sortedX.count() / 2];
+    const double medianY = sortedY[sortedY.count() / 2];
+
+    // Average the drifts that agree with the median to reject stars disturbed by hot pixels or neighbours
+    double sumX = 0, sumY = 0;
+    int used = 0;
+    for (int i = 0; i < dx.count(); i++)
+    {
+        if (fabs(dx[i] - medianX) > MULTISTAR_MAX_DEVIATION || fabs(dy[i] - medianY) > MULTISTAR_MAX_DEVIATION)
+            continue;
+
+        sumX += dx[i];
+        sumY += dy[i];
+        used++;
+    }
+
+    if (used == 0)
+        return guideStarPosition;
+
+    qCDebug(KSTARS_EKOS_GUIDE) << "Multi-star drift X:" << sumX / used << "Y:" << sumY / used << "using" << used << "of"
+                               << dx.count() << "stars";
+
+    return reticle_pos + Vector(sumX / used, sumY / used, 0);
+}
+
 void cgmath::process_axes(void)
 {
     int cnt        = 0;
@@ -1283,12 +1495,23 @@ void cgmath::process_axes(void)
 
     //emit newAxisDelta(out_params.delta[0], out_params.delta[1]);
 
+    // Latency from the start of frame processing until the pulses are decided
+    lastLatency = latencyTimer.nsecsElapsed() / 1e6;
+    int bin = 0;
+    while (bin < LATENCY_BIN_CNT - 1 && lastLatency >= latency_bins[bin])
+        bin++;
+    latencyHistogram[bin]++;
+
+    if (latencyRecorder)
+        latencyRecorder->mark(Ekos::GuideLatency::AXES_PROCESSED);
+
     if (Options::guideLogging())
     {
         QTextStream out(&logFile);
         out << ticks << "," << logTime.elapsed() << "," << out_params.delta[0] << "," << out_params.pulse_length[0] << ","
             << get_direction_string(out_params.pulse_dir[0]) << "," << out_params.delta[1] << ","
-            << out_params.pulse_length[1] << "," << get_direction_string(out_params.pulse_dir[1]) << endl;
+            << out_params.pulse_length[1] << "," << get_direction_string(out_params.pulse_dir[1]) << ","
+            << QString::number(lastLatency, 'f', 3) << endl;
     }
 }
 
@@ -1300,9 +1523,14 @@ void cgmath::performProcessing(void)
     if (suspended)
         return;
 
+    latencyTimer.start();
+
     // find guiding star location in
     scr_star_pos = star_pos = findLocalStarPosition();
 
+    if (latencyRecorder)
+        latencyRecorder->mark(Ekos::GuideLatency::STAR_DETECTED);
+
     if (star_pos.x == -1 || std::isnan(star_pos.x))
     {
         lost_star = true;
@@ -1324,6 +1552,10 @@ void cgmath::performProcessing(void)
 
     qCDebug(KSTARS_EKOS_GUIDE) << "################## BEGIN PROCESSING ##################";
 
+    // combine drift of secondary reference stars, the screen position remains that of the guide star
+    if (multiStarEnabled && imageGuideEnabled == false && useRapidGuide == false)
+        star_pos = combineMultiStarDrift(star_pos);
+
     // translate star coords into sky coord. system
 
     // convert from pixels into arcsecs
@@ -1437,6 +1669,17 @@ void cgmath::setImageGuideEnabled(bool value)
     imageGuideEnabled = value;
 }
 
+bool cgmath::isMultiStarEnabled() const
+{
+    return multiStarEnabled;
+}
+
+void cgmath::setMultiStarEnabled(bool value)
+{
+    multiStarEnabled = value;
+    multiStarNeedsReference = true;
+}
+
 static void psf_conv(float *dst, const float *src, int width, int height)
 {
     //dst.Init(src.Size);
@@ -1583,18 +1826,17 @@ QList<Edge*> cgmath::PSFAutoFind(int extraEdgeAllowance)
     int size = subW * subH;
 
     // convert to floating point
-    float *conv = createFloatImage(smoothed);
-
-    // run the PSF convolution
+    if (createFloatImage(psfImage, smoothed) == false)
     {
-        float *tmp = new float[size];
-        memset(tmp, 0, size * sizeof(float));
-        psf_conv(tmp, conv, subW, subH);
-        delete [] conv;
-        // Swap
-        conv = tmp;
+        delete (smoothed);
+        return QList<Edge*>();
     }
 
+    // run the PSF convolution
+    psfConvolution.fill(0, size);
+    psf_conv(psfConvolution.data(), psfImage.constData(), subW, subH);
+    const float *conv = psfConvolution.constData();
+
     enum { CONV_RADIUS = 4 };
     int dw = subW;      // width of the downsampled image
     int dh = subH;     // height of the downsampled image
@@ -1761,7 +2003,6 @@ repeat:
         centers.append(center);
     }
 
-    delete [] conv;
     delete (smoothed);
 
     return centers;
@@ -12,9 +12,11 @@
 #pragma once
 
 #include "matr.h"
+#include "phasecorrelation.h"
 #include "vect.h"
 #include "indi/indicommon.h"
 
+#include <QElapsedTimer>
 #include <QObject>
 #include <QPointer>
 #include <QTime>
@@ -28,6 +30,11 @@ class FITSView;
 class FITSData;
 class Edge;
 
+namespace Ekos
+{
+class GuideLatency;
+}
+
 typedef struct
 {
     int size;
@@ -57,6 +64,19 @@ typedef struct
 #define CHANNEL_CNT 2
 
 #define MAX_ACCUM_CNT 50
+
+// multi-star guiding params
+// maximum deviation in pixels of a star drift from the median drift before it is rejected
+#define MULTISTAR_MAX_DEVIATION 1.5
+// minimum peak height above the box mean, in standard deviations, for a star to be considered found
+#define MULTISTAR_MIN_SNR 5.0
+
+// minimum mean phase correlation confidence for an image guiding shift to be trusted
+#define IMAGE_GUIDE_MIN_CONFIDENCE 0.1
+
+// processing latency histogram bins upper limits in milliseconds, the last bin collects everything above
+#define LATENCY_BIN_CNT 8
+
 extern const guide_square_t guide_squares[];
 extern const square_alg_t guide_square_alg[];
 
@@ -93,6 +113,19 @@ class cproc_out_params
     double sigma[2];
 };
 
+// reference star tracked in multi-star guiding
+typedef struct
+{
+    /// Offset of the star from the guide star when the references were taken
+    Vector offset;
+    /// Last measured star position
+    Vector position;
+    /// Background-subtracted flux of the last measurement
+    double flux;
+    /// Whether the star was found in the last frame
+    bool found;
+} guide_star_t;
+
 typedef struct
 {
     double focal_ratio;
@@ -169,6 +202,27 @@ class cgmath : public QObject
     bool isImageGuideEnabled() const;
     void setImageGuideEnabled(bool value);
 
+    // Image Guiding
+    // Converts the guide frame into registration regions. Must be called from the thread owning the guide view.
+    bool prepareImageRegions();
+    // Registers the prepared regions against the reference frame. Runs on the guide worker thread, while no other
+    // image guiding function is called.
+    phase_shift_t registerImageRegions();
+    // Shift used by the next performProcessing() call
+    void setImageShift(const phase_shift_t &shift) { imageShift = shift; }
+
+    // Multi-star guiding
+    bool isMultiStarEnabled() const;
+    void setMultiStarEnabled(bool value);
+    const QVector<guide_star_t> &getMultiStars() const { return multiStars; }
+
+    // Processing latency of the last frame in milliseconds
+    double getLastLatency() const { return lastLatency; }
+    // Star detection and axes processing are marked on the guide loop latency recorder
+    void setLatencyRecorder(Ekos::GuideLatency *recorder) { latencyRecorder = recorder; }
+    // Write the guide loop stage latencies of the last guided frame to the latency log
+    void logLatency(const QList<double> &stages);
+
     void setRegionAxis(const uint32_t &value);
 
   signals:
@@ -180,8 +234,17 @@ class cgmath : public QObject
     template <typename T>
     Vector findLocalStarPosition(void) const;
 
-    // Creates a new float image from the guideView image data. The returned image MUST be deleted later or memory will leak.
-    float *createFloatImage(FITSData *target=nullptr) const;
+    // Computes the centroids of all multi-star reference stars in a single pass over the native image buffer
+    template <typename T>
+    void findMultiStarCentroids(QVector<guide_star_t> &stars, int boxSize) const;
+    void findMultiStarCentroids(QVector<guide_star_t> &stars, int boxSize) const;
+    // Select secondary reference stars around the guide star using PSFAutoFind
+    void selectMultiStars(const Vector &guideStarPosition);
+    // Combine the drift of the guide star with the drift of the secondary stars
+    Vector combineMultiStarDrift(const Vector &guideStarPosition);
+
+    // Converts the guideView image data (or target if set) to float into buffer. The buffer is only reallocated when the frame grows.
+    bool createFloatImage(QVector<float> &buffer, FITSData *target=nullptr) const;
 
     void do_ticks(void);
     Vector point2arcsec(const Vector &p) const;
@@ -191,6 +254,7 @@ class cgmath : public QObject
 
     // Logging
     void createGuideLog();
+    void logLatencyHistogram();
 
     /// Global channel ticker
     uint32_t ticks { 0 };
@@ -245,15 +309,35 @@ class cgmath : public QObject
 
     // Image Guide
     bool imageGuideEnabled { false };
-    // Partition guideView image into NxN square regions each of size axis*axis. The returned vector contains pointers to
-    // the newly allocated square images. It MUST be deleted later by delete[] or memory will leak.
-    QVector<float *> partitionImage() const;
+    // Partition guideView image into NxN square regions each of size axis*axis. The regions are stored back to back
+    // in regions, which is reused between frames.
+    bool partitionImage(QVector<float> &regions) const;
     uint32_t regionAxis { 64 };
-    QVector<float *> referenceRegions;
+    QVector<float> imageRegions;
+    // One phase correlator per region, holding the region reference spectrum and FFT plan
+    QVector<PhaseCorrelation> regionCorrelators;
+    phase_shift_t imageShift { 0, 0, 0 };
+
+    // Star auto find work buffers, kept between calls
+    QVector<float> psfImage;
+    QVector<float> psfConvolution;
+
+    // Multi-star guiding
+    bool multiStarEnabled { false };
+    bool multiStarNeedsReference { true };
+    QVector<guide_star_t> multiStars;
 
     // dithering
     double ditherRate[2];
 
+    // Processing latency
+    QElapsedTimer latencyTimer;
+    double lastLatency { 0 };
+    uint32_t latencyHistogram[LATENCY_BIN_CNT];
+    Ekos::GuideLatency *latencyRecorder { nullptr };
+
     QFile logFile;
+    // Stage latencies go to their own log so every row of the guide log follows its header
+    QFile latencyLogFile;
     QTime logTime;
 };
@@ -13,6 +13,7 @@
 
 #include "ekos_guide_debug.h"
 #include "gmath.h"
+#include "../guidelatency.h"
 #include "Options.h"
 #include "auxiliary/kspaths.h"
 #include "fitsviewer/fitsdata.h"
@@ -24,6 +25,7 @@
 #include <random>
 #include <chrono>
 #include <QTimer>
+#include <QtConcurrent>
 
 #define MAX_GUIDE_STARS           10
 
@@ -35,6 +37,9 @@ InternalGuider::InternalGuider()
     pmath.reset(new cgmath());
     connect(pmath.get(), SIGNAL(newStarPosition(QVector3D,bool)), this, SIGNAL(newStarPosition(QVector3D,bool)));
 
+    m_GuideWorker.setMaxThreadCount(1);
+    connect(&m_ImageGuideWatcher, &QFutureWatcher<phase_shift_t>::finished, this, &InternalGuider::processImageGuidingShift);
+
     state = GUIDE_IDLE;
 }
 
@@ -53,6 +58,10 @@ bool InternalGuider::guide()
 
     guideFrame->disconnect(this);
 
+    // Do not replace the image guiding references while a frame from a previous run is still being registered
+    m_ImageGuideWatcher.waitForFinished();
+
+    pmath->setMultiStarEnabled(Options::guideMultiStarEnabled() && !m_ImageGuideEnabled);
     pmath->start();
 
     m_starLostCounter = 0;
@@ -114,6 +123,7 @@ bool InternalGuider::abort()
     accumulator.first = accumulator.second = 0;
 
     pmath->suspend(false);
+    pmath->stop();
     state = GUIDE_IDLE;
 
     return true;
@@ -1035,6 +1045,8 @@ bool InternalGuider::processGuiding()
         emit newPulse(out->pulse_dir[GUIDE_RA] , out->pulse_length[GUIDE_RA],
                       out->pulse_dir[GUIDE_DEC], out->pulse_length[GUIDE_DEC]);
 
+        commitLatency();
+
         // Wait until pulse is over before capturing an image
         const int waitMS = qMax(out->pulse_length[GUIDE_RA], out->pulse_length[GUIDE_DEC]);
         // If less than MAX_IMMEDIATE_CAPTURE ms, then capture immediately
@@ -1049,7 +1061,10 @@ bool InternalGuider::processGuiding()
             emit frameCaptureRequested();
     }
     else
+    {
+        commitLatency();
         emit frameCaptureRequested();
+    }
 
     if (state == GUIDE_DITHERING || state == GUIDE_MANUAL_DITHERING)
         return true;
@@ -1081,12 +1096,44 @@ bool InternalGuider::processGuiding()
     return true;
 }
 
+void InternalGuider::setLatencyRecorder(GuideLatency *recorder)
+{
+    m_Latency = recorder;
+    pmath->setLatencyRecorder(recorder);
+}
+
+void InternalGuider::commitLatency()
+{
+    // The next frame capture starts a new latency record, so the current one is published as soon as the pulse is out
+    if (m_Latency && m_Latency->commit())
+        pmath->logLatency(m_Latency->last());
+}
+
 bool InternalGuider::processImageGuiding()
+{
+    // Only one frame is registered at a time. The next frame is requested once the current one is processed.
+    if (m_ImageGuideWatcher.isRunning())
+        return true;
+
+    // Regions are copied from the guide frame here, the FFT registration runs on the guide worker thread
+    pmath->prepareImageRegions();
+    m_ImageGuideWatcher.setFuture(QtConcurrent::run(&m_GuideWorker, pmath.get(), &cgmath::registerImageRegions));
+
+    return true;
+}
+
+void InternalGuider::processImageGuidingShift()
 {
     static int maxPulseCounter = 0;
     const cproc_out_params *out;
     uint32_t tick = 0;
 
+    // Guiding might have been stopped or suspended while the frame was registered
+    if (state < GUIDE_GUIDING || state == GUIDE_SUSPENDED)
+        return;
+
+    pmath->setImageShift(m_ImageGuideWatcher.result());
+
     // calc math. it tracks square
     pmath->performProcessing();
 
@@ -1094,7 +1141,7 @@ bool InternalGuider::processImageGuiding()
     {
         emit newLog(i18n("Lost track of phase shift."));
         abort();
-        return false;
+        return;
     }
     else
         m_starLostCounter = 0;
@@ -1114,16 +1161,18 @@ bool InternalGuider::processImageGuiding()
         emit newLog(i18n("Lost track of phase shift. Aborting guiding..."));
         abort();
         maxPulseCounter = 0;
-        return false;
+        return;
     }
 
     emit newPulse(out->pulse_dir[GUIDE_RA], out->pulse_length[GUIDE_RA], out->pulse_dir[GUIDE_DEC],
                   out->pulse_length[GUIDE_DEC]);
 
+    commitLatency();
+
     emit frameCaptureRequested();
 
     if (state == GUIDE_DITHERING || state == GUIDE_MANUAL_DITHERING)
-        return true;
+        return;
 
     tick = pmath->getTicks();
 
@@ -1136,8 +1185,6 @@ bool InternalGuider::processImageGuiding()
 
         emit newAxisSigma(out->sigma[GUIDE_RA], out->sigma[GUIDE_DEC]);
     }
-
-    return true;
 }
 
 bool InternalGuider::isImageGuideEnabled() const
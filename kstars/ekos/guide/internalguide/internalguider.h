@@ -12,12 +12,15 @@
 #pragma once
 
 #include "matr.h"
+#include "phasecorrelation.h"
 #include "indi/indicommon.h"
 #include "../guideinterface.h"
 
 #include <QFile>
+#include <QFutureWatcher>
 #include <QPointer>
 #include <QQueue>
+#include <QThreadPool>
 #include <QTime>
 
 #include <memory>
@@ -30,6 +33,8 @@ class Edge;
 
 namespace Ekos
 {
+class GuideLatency;
+
 class InternalGuider : public GuideInterface
 {
     Q_OBJECT
@@ -92,6 +97,9 @@ class InternalGuider : public GuideInterface
     // Guide View
     void setGuideView(FITSView *guideView);
 
+    // Guide loop latency, frames are committed once their pulse is dispatched
+    void setLatencyRecorder(GuideLatency *recorder);
+
     // Region Axis
     void setRegionAxis(uint32_t value);
 
@@ -127,6 +135,8 @@ class InternalGuider : public GuideInterface
   protected slots:
     void trackingStarSelected(int x, int y);
     void setDitherSettled();
+    // Continue image guiding once the guide worker registered the frame
+    void processImageGuidingShift();
 
   signals:
     void newPulse(GuideDirection ra_dir, int ra_msecs, GuideDirection dec_dir, int dec_msecs);
@@ -145,10 +155,14 @@ class InternalGuider : public GuideInterface
     // Image Guiding
     bool processImageGuiding();
 
+    // Publish the latency of the frame just guided and write it to the guide log
+    void commitLatency();
+
     void reset();
 
     std::unique_ptr<cgmath> pmath;
     QPointer<FITSView> guideFrame;
+    GuideLatency *m_Latency { nullptr };
     bool m_isStarted { false };
     bool m_isSubFramed { false };
     bool m_isFirstFrame { false };
@@ -156,6 +170,10 @@ class InternalGuider : public GuideInterface
     bool m_ImageGuideEnabled { false };
     int m_starLostCounter { 0 };
 
+    // Image guiding frames are registered on this single thread pool, away from the GUI thread
+    QThreadPool m_GuideWorker;
+    QFutureWatcher<phase_shift_t> m_ImageGuideWatcher;
+
     QFile logFile;    
     uint32_t guideBoxSize { 32 };    
 
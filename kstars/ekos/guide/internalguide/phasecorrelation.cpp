@@ -0,0 +1,217 @@
+/*  Phase Correlation Image Registration
+    Copyright (C) 2020 KStars Developers
+
+    This application is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public
+    License as published by the Free Software Foundation; either
+    version 2 of the License, or (at your option) any later version.
+ */
+
+#include "phasecorrelation.h"
+
+#include <algorithm>
+#include <cmath>
+
+PhaseCorrelation::PhaseCorrelation(uint32_t size)
+{
+    if (size > 0)
+        setSize(size);
+}
+
+bool PhaseCorrelation::setSize(uint32_t size)
+{
+    if (size == m_Size)
+        return true;
+
+    // Radix-2 only
+    if (size < 2 || (size & (size - 1)) != 0)
+        return false;
+
+    uint32_t bits = 0;
+    while ((1u << bits) < size)
+        bits++;
+
+    m_BitReverse.resize(size);
+    for (uint32_t i = 0; i < size; i++)
+    {
+        uint32_t reversed = 0;
+        for (uint32_t b = 0; b < bits; b++)
+        {
+            if (i & (1u << b))
+                reversed |= 1u << (bits - 1 - b);
+        }
+        m_BitReverse[i] = reversed;
+    }
+
+    m_Twiddles.resize(size / 2);
+    for (uint32_t k = 0; k < size / 2; k++)
+    {
+        const double angle = -2 * M_PI * k / size;
+        m_Twiddles[k]      = std::complex<float>(cos(angle), sin(angle));
+    }
+
+    // Hann window to suppress the edge discontinuity of the periodic FFT
+    m_Window.resize(size);
+    for (uint32_t i = 0; i < size; i++)
+        m_Window[i] = 0.5 * (1 - cos(2 * M_PI * i / (size - 1)));
+
+    m_Reference.resize(size * size);
+    m_Work.resize(size * size);
+    m_Column.resize(size);
+
+    m_Size         = size;
+    m_HasReference = false;
+
+    return true;
+}
+
+void PhaseCorrelation::load(const float *image, std::complex<float> *target) const
+{
+    const uint32_t n = m_Size;
+
+    double sum = 0;
+    for (uint32_t i = 0; i < n * n; i++)
+        sum += image[i];
+
+    const float mean = sum / (n * n);
+
+    for (uint32_t y = 0; y < n; y++)
+    {
+        const float *row         = image + y * n;
+        std::complex<float> *out = target + y * n;
+        const float wy           = m_Window[y];
+        for (uint32_t x = 0; x < n; x++)
+            out[x] = std::complex<float>((row[x] - mean) * wy * m_Window[x], 0);
+    }
+}
+
+void PhaseCorrelation::fft(std::complex<float> *data, bool inverse) const
+{
+    const uint32_t n = m_Size;
+
+    for (uint32_t i = 0; i < n; i++)
+    {
+        const uint32_t j = m_BitReverse[i];
+        if (i < j)
+            std::swap(data[i], data[j]);
+    }
+
+    for (uint32_t length = 2; length <= n; length <<= 1)
+    {
+        const uint32_t half = length / 2;
+        const uint32_t step = n / length;
+        for (uint32_t i = 0; i < n; i += length)
+        {
+            for (uint32_t k = 0; k < half; k++)
+            {
+                const std::complex<float> w = inverse ? std::conj(m_Twiddles[k * step]) : m_Twiddles[k * step];
+                const std::complex<float> t = w * data[i + k + half];
+                data[i + k + half]          = data[i + k] - t;
+                data[i + k] += t;
+            }
+        }
+    }
+}
+
+void PhaseCorrelation::fft2D(std::complex<float> *data, bool inverse)
+{
+    const uint32_t n = m_Size;
+
+    for (uint32_t y = 0; y < n; y++)
+        fft(data + y * n, inverse);
+
+    // Columns are copied into a contiguous buffer to keep the butterflies cache friendly
+    std::complex<float> *column = m_Column.data();
+    for (uint32_t x = 0; x < n; x++)
+    {
+        for (uint32_t y = 0; y < n; y++)
+            column[y] = data[y * n + x];
+
+        fft(column, inverse);
+
+        for (uint32_t y = 0; y < n; y++)
+            data[y * n + x] = column[y];
+    }
+}
+
+void PhaseCorrelation::setReference(const float *image)
+{
+    if (m_Size == 0)
+        return;
+
+    load(image, m_Reference.data());
+    fft2D(m_Reference.data(), false);
+    m_HasReference = true;
+}
+
+bool PhaseCorrelation::registerImage(const float *image, phase_shift_t &shift)
+{
+    shift.dx = shift.dy = shift.confidence = 0;
+
+    if (m_HasReference == false)
+        return false;
+
+    const int n = m_Size;
+    std::complex<float> *work = m_Work.data();
+    const std::complex<float> *reference = m_Reference.constData();
+
+    load(image, work);
+    fft2D(work, false);
+
+    // Cross power spectrum whitened by the square root of its magnitude. Full whitening amplifies the noise in the
+    // high frequencies where stars carry no signal, while no whitening gives a broad peak on extended objects.
+    double spectrumSum = 0;
+    for (int i = 0; i < n * n; i++)
+    {
+        const std::complex<float> cross = work[i] * std::conj(reference[i]);
+        const float magnitude           = std::sqrt(std::abs(cross));
+        work[i] = magnitude > 1e-12f ? cross / magnitude : std::complex<float>(0, 0);
+        spectrumSum += magnitude;
+    }
+
+    fft2D(work, true);
+
+    int peakX = 0, peakY = 0;
+    float peak = work[0].real();
+    for (int y = 0; y < n; y++)
+    {
+        for (int x = 0; x < n; x++)
+        {
+            if (work[y * n + x].real() > peak)
+            {
+                peak  = work[y * n + x].real();
+                peakX = x;
+                peakY = y;
+            }
+        }
+    }
+
+    // Sub-pixel peak location from a parabola through the peak and its neighbours. The surface is periodic.
+    auto value = [&](int x, int y)
+    {
+        return work[((y + n) % n) * n + (x + n) % n].real();
+    };
+    auto interpolate = [](float left, float center, float right) -> float
+    {
+        const float denominator = left - 2 * center + right;
+        if (denominator >= 0)
+            return 0.0f;
+        return std::max(-0.5f, std::min(0.5f, 0.5f * (left - right) / denominator));
+    };
+
+    double dx = peakX + interpolate(value(peakX - 1, peakY), peak, value(peakX + 1, peakY));
+    double dy = peakY + interpolate(value(peakX, peakY - 1), peak, value(peakX, peakY + 1));
+
+    // Shifts beyond half the image wrap around to negative shifts
+    if (dx > n / 2)
+        dx -= n;
+    if (dy > n / 2)
+        dy -= n;
+
+    shift.dx = dx;
+    shift.dy = dy;
+    // A perfect match peaks at the sum of the whitened spectrum magnitudes
+    shift.confidence = spectrumSum > 0 ? std::max(0.0, std::min(1.0, peak / spectrumSum)) : 0;
+
+    return true;
+}
@@ -0,0 +1,84 @@
+/*  Phase Correlation Image Registration
+    Copyright (C) 2020 KStars Developers
+
+    This application is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public
+    License as published by the Free Software Foundation; either
+    version 2 of the License, or (at your option) any later version.
+ */
+
+#pragma once
+
+#include <QVector>
+
+#include <complex>
+#include <cstdint>
+
+// Shift of an image relative to the reference image
+typedef struct
+{
+    /// X shift in pixels
+    double dx;
+    /// Y shift in pixels
+    double dy;
+    /// Height of the normalized correlation peak, 1 for a perfect match and near 0 for no match
+    double confidence;
+} phase_shift_t;
+
+/**
+ * @class PhaseCorrelation
+ * Registers square images against a reference image using FFT based phase correlation.
+ *
+ * The FFT plan (bit reversal table, twiddle factors and window) is built once for a given size,
+ * and all work buffers are kept between calls so registering a frame does not allocate memory.
+ * A PhaseCorrelation object is not thread safe, but it may be used from any single thread at a time.
+ */
+class PhaseCorrelation
+{
+  public:
+    explicit PhaseCorrelation(uint32_t size = 0);
+
+    /**
+     * @brief setSize Prepare the FFT plan and buffers for size x size images.
+     * @param size Image axis, must be a power of 2.
+     * @return True if the size is valid, false otherwise.
+     */
+    bool setSize(uint32_t size);
+    uint32_t size() const { return m_Size; }
+
+    /**
+     * @brief setReference Set the reference image all later images are registered against.
+     * @param image size x size image, row major.
+     */
+    void setReference(const float *image);
+    bool hasReference() const { return m_HasReference; }
+
+    /**
+     * @brief registerImage Find the shift of image relative to the reference image.
+     * @param image size x size image, row major.
+     * @param shift Sub-pixel shift and confidence of the match.
+     * @return True if a reference is set and the image was registered, false otherwise.
+     */
+    bool registerImage(const float *image, phase_shift_t &shift);
+
+  private:
+    // Copy image into target with its mean removed and the window applied
+    void load(const float *image, std::complex<float> *target) const;
+    // In place radix-2 FFT of one row of m_Size elements
+    void fft(std::complex<float> *data, bool inverse) const;
+    // In place 2D FFT of m_Size x m_Size elements
+    void fft2D(std::complex<float> *data, bool inverse);
+
+    uint32_t m_Size { 0 };
+    bool m_HasReference { false };
+
+    // Plan
+    QVector<uint32_t> m_BitReverse;
+    QVector<std::complex<float>> m_Twiddles;
+    QVector<float> m_Window;
+
+    // Buffers
+    QVector<std::complex<float>> m_Reference;
+    QVector<std::complex<float>> m_Work;
+    QVector<std::complex<float>> m_Column;
+};
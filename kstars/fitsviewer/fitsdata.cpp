@@ -87,8 +87,9 @@ FITSData::FITSData(const FITSData * other)
     this->m_DataType = other->m_DataType;
     this->m_Channels = other->m_Channels;
     memcpy(&stats, &(other->stats), sizeof(stats));
-    m_ImageBuffer = new uint8_t[stats.samples_per_channel * m_Channels * stats.bytesPerPixel];
-    memcpy(m_ImageBuffer, other->m_ImageBuffer, stats.samples_per_channel * m_Channels * stats.bytesPerPixel);
+    m_ImageBufferSize = stats.samples_per_channel * m_Channels * stats.bytesPerPixel;
+    m_ImageStorage = ImageBufferPool::Instance()->copy(other->m_ImageBuffer, m_ImageBufferSize);
+    m_ImageBuffer = m_ImageStorage.data();
 }
 
 FITSData::~FITSData()
@@ -134,6 +135,7 @@ void FITSData::loadCommon(const QString &inFilename)
         fits_flush_file(fptr, &status);
         fits_close_file(fptr, &status);
         fptr = nullptr;
+        m_MemoryFile.reset();
 
         // If current file is temporary AND
         // Auto Remove Temporary File is Set AND
@@ -149,10 +151,21 @@ void FITSData::loadCommon(const QString &inFilename)
 
 bool FITSData::loadFITSFromMemory(const QString &inFilename, void *fits_buffer,
                                   size_t fits_buffer_size, bool silent)
+{
+    // CFITSIO keeps reading the memory file after loading, so callers are free to release their buffer
+    ImageBuffer buffer = ImageBufferPool::Instance()->copy(fits_buffer, fits_buffer_size);
+    if (buffer.isNull())
+        return false;
+
+    return loadFITSFromMemory(inFilename, buffer, silent);
+}
+
+bool FITSData::loadFITSFromMemory(const QString &inFilename, const ImageBuffer &fits_buffer, bool silent)
 {
     loadCommon(inFilename);
     qCInfo(KSTARS_FITS) << "Reading FITS file buffer ";
-    return privateLoad(fits_buffer, fits_buffer_size, silent);
+    m_MemoryFile = fits_buffer;
+    return privateLoad(m_MemoryFile.data(), m_MemoryFile.size(), silent);
 }
 
 QFuture<bool> FITSData::loadFITS(const QString &inFilename, bool silent)
@@ -322,7 +335,8 @@ bool FITSData::privateLoad(void *fits_buffer, size_t fits_buffer_size, bool sile
         m_Channels = 1;
 
     m_ImageBufferSize = stats.samples_per_channel * m_Channels * stats.bytesPerPixel;
-    m_ImageBuffer = new uint8_t[m_ImageBufferSize];
+    m_ImageStorage = ImageBufferPool::Instance()->acquire(m_ImageBufferSize);
+    m_ImageBuffer = m_ImageStorage.data();
     if (m_ImageBuffer == nullptr)
     {
         qCWarning(KSTARS_FITS) << "FITSData: Not enough memory for image_buffer channel. Requested: "
@@ -448,6 +462,7 @@ int FITSData::saveFITS(const QString &newFilename)
     status = 0;
 
     fptr = new_fptr;
+    m_MemoryFile.reset();
 
     if (fits_movabs_hdu(fptr, 1, &exttype, &status))
     {
@@ -540,7 +555,7 @@ int FITSData::saveFITS(const QString &newFilename)
 
 void FITSData::clearImageBuffers()
 {
-    delete[] m_ImageBuffer;
+    m_ImageStorage.reset();
     m_ImageBuffer = nullptr;
     //m_BayerBuffer = nullptr;
 }
@@ -1000,7 +1015,14 @@ int FITSData::findCannyStar(FITSData * data, const QRect &boundary)
     uint32_t offset = subX + subY * dataWidth;
 
     // #2 Create new buffer
-    auto * buffer = new uint8_t[size * BBP];
+    ImageBuffer boundedBuffer = ImageBufferPool::Instance()->acquire(size * BBP);
+    if (boundedBuffer.isNull())
+    {
+        qWarning() << "Unable to allocate memory for canny star buffer!";
+        return 0;
+    }
+
+    uint8_t * buffer = boundedBuffer.data();
     // If there is no offset, copy whole buffer in one go
     if (offset == 0)
         memcpy(buffer, data->getImageBuffer(), size * BBP);
@@ -1030,7 +1052,7 @@ int FITSData::findCannyStar(FITSData * data, const QRect &boundary)
     boundedImage->setProperty("dataType", data->property("dataType"));
 
     // #4 Set image buffer and calculate stats.
-    boundedImage->setImageBuffer(buffer);
+    boundedImage->setImageBuffer(boundedBuffer);
 
     boundedImage->calculateStats(true);
 
@@ -2724,7 +2746,7 @@ bool FITSData::rotFITS(int rotate, int mirror)
 {
     int ny, nx;
     int x1, y1, x2, y2;
-    uint8_t * rotimage = nullptr;
+    ImageBuffer rotimage;
     int offset        = 0;
 
     if (rotate == 1)
@@ -2742,15 +2764,15 @@ bool FITSData::rotFITS(int rotate, int mirror)
     int BBP = stats.bytesPerPixel;
 
     /* Allocate buffer for rotated image */
-    rotimage = new uint8_t[stats.samples_per_channel * m_Channels * BBP];
+    rotimage = ImageBufferPool::Instance()->acquire(stats.samples_per_channel * m_Channels * BBP);
 
-    if (rotimage == nullptr)
+    if (rotimage.isNull())
     {
         qWarning() << "Unable to allocate memory for rotated image buffer!";
         return false;
     }
 
-    auto * rotBuffer = reinterpret_cast<T *>(rotimage);
+    auto * rotBuffer = reinterpret_cast<T *>(rotimage.data());
     auto * buffer    = reinterpret_cast<T *>(m_ImageBuffer);
 
     /* Mirror image without rotation */
@@ -2965,8 +2987,8 @@ bool FITSData::rotFITS(int rotate, int mirror)
         }
     }
 
-    delete[] m_ImageBuffer;
-    m_ImageBuffer = rotimage;
+    m_ImageStorage = rotimage;
+    m_ImageBuffer = m_ImageStorage.data();
 
     return true;
 }
@@ -3259,10 +3281,10 @@ uint8_t * FITSData::getImageBuffer()
     return m_ImageBuffer;
 }
 
-void FITSData::setImageBuffer(uint8_t * buffer)
+void FITSData::setImageBuffer(const ImageBuffer &buffer)
 {
-    delete[] m_ImageBuffer;
-    m_ImageBuffer = buffer;
+    m_ImageStorage = buffer;
+    m_ImageBuffer = m_ImageStorage.data();
 }
 
 bool FITSData::checkDebayer()
@@ -3356,10 +3378,11 @@ bool FITSData::debayer_8bit()
     dc1394error_t error_code;
 
     uint32_t rgb_size = stats.samples_per_channel * 3 * stats.bytesPerPixel;
-    auto * destinationBuffer = new uint8_t[rgb_size];
+    // Returned to the pool when done, the next frame reuses it
+    ImageBuffer destinationBuffer = ImageBufferPool::Instance()->acquire(rgb_size);
 
     auto * bayer_source_buffer      = reinterpret_cast<uint8_t *>(m_ImageBuffer);
-    auto * bayer_destination_buffer = reinterpret_cast<uint8_t *>(destinationBuffer);
+    auto * bayer_destination_buffer = reinterpret_cast<uint8_t *>(destinationBuffer.data());
 
     if (bayer_destination_buffer == nullptr)
     {
@@ -3388,18 +3411,16 @@ bool FITSData::debayer_8bit()
     {
         KSNotification::error(i18n("Debayer failed (%1)", error_code), i18n("Debayer error"));
         m_Channels = 1;
-        delete[] destinationBuffer;
         return false;
     }
 
     if (m_ImageBufferSize != rgb_size)
     {
-        delete[] m_ImageBuffer;
-        m_ImageBuffer = new uint8_t[rgb_size];
+        m_ImageStorage = ImageBufferPool::Instance()->acquire(rgb_size);
+        m_ImageBuffer = m_ImageStorage.data();
 
         if (m_ImageBuffer == nullptr)
         {
-            delete[] destinationBuffer;
             KSNotification::error(i18n("Unable to allocate memory for temporary bayer buffer."), i18n("Debayer error"));
             return false;
         }
@@ -3424,7 +3445,6 @@ bool FITSData::debayer_8bit()
     }
 
     m_Channels = (m_Mode == FITS_NORMAL) ? 3 : 1;
-    delete[] destinationBuffer;
     return true;
 }
 
@@ -3433,10 +3453,11 @@ bool FITSData::debayer_16bit()
     dc1394error_t error_code;
 
     uint32_t rgb_size = stats.samples_per_channel * 3 * stats.bytesPerPixel;
-    auto * destinationBuffer = new uint8_t[rgb_size];
+    // Returned to the pool when done, the next frame reuses it
+    ImageBuffer destinationBuffer = ImageBufferPool::Instance()->acquire(rgb_size);
 
     auto * bayer_source_buffer      = reinterpret_cast<uint16_t *>(m_ImageBuffer);
-    auto * bayer_destination_buffer = reinterpret_cast<uint16_t *>(destinationBuffer);
+    auto * bayer_destination_buffer = reinterpret_cast<uint16_t *>(destinationBuffer.data());
 
     if (bayer_destination_buffer == nullptr)
     {
@@ -3465,18 +3486,16 @@ bool FITSData::debayer_16bit()
     {
         KSNotification::error(i18n("Debayer failed (%1)", error_code), i18n("Debayer error"));
         m_Channels = 1;
-        delete[] destinationBuffer;
         return false;
     }
 
     if (m_ImageBufferSize != rgb_size)
     {
-        delete[] m_ImageBuffer;
-        m_ImageBuffer = new uint8_t[rgb_size];
+        m_ImageStorage = ImageBufferPool::Instance()->acquire(rgb_size);
+        m_ImageBuffer = m_ImageStorage.data();
 
         if (m_ImageBuffer == nullptr)
         {
-            delete[] destinationBuffer;
             KSNotification::error(i18n("Unable to allocate memory for temporary bayer buffer."), i18n("Debayer error"));
             return false;
         }
@@ -3501,7 +3520,6 @@ bool FITSData::debayer_16bit()
     }
 
     m_Channels = (m_Mode == FITS_NORMAL) ? 3 : 1;
-    delete[] destinationBuffer;
     return true;
 }
 
@@ -4334,9 +4352,9 @@ exit:
 }
 
 template <typename T>
-void FITSData::getFloatBuffer(float * buffer, int x, int y, int w, int h)
+void FITSData::getFloatBuffer(float * buffer, int x, int y, int w, int h) const
 {
-    auto * rawBuffer = reinterpret_cast<T *>(m_ImageBuffer);
+    auto * rawBuffer = reinterpret_cast<const T *>(m_ImageBuffer);
 
     float * floatPtr = buffer;
 
@@ -4353,6 +4371,47 @@ void FITSData::getFloatBuffer(float * buffer, int x, int y, int w, int h)
     }
 }
 
+bool FITSData::getFloatRegion(float * buffer, const QRect &region) const
+{
+    QRect area = region.isNull() ? QRect(0, 0, stats.width, stats.height) : region;
+
+    if (buffer == nullptr || m_ImageBuffer == nullptr || area.isValid() == false ||
+            QRect(0, 0, stats.width, stats.height).contains(area) == false)
+        return false;
+
+    switch (m_DataType)
+    {
+        case TBYTE:
+            getFloatBuffer<uint8_t>(buffer, area.x(), area.y(), area.width(), area.height());
+            break;
+        case TSHORT:
+            getFloatBuffer<int16_t>(buffer, area.x(), area.y(), area.width(), area.height());
+            break;
+        case TUSHORT:
+            getFloatBuffer<uint16_t>(buffer, area.x(), area.y(), area.width(), area.height());
+            break;
+        case TLONG:
+            getFloatBuffer<int32_t>(buffer, area.x(), area.y(), area.width(), area.height());
+            break;
+        case TULONG:
+            getFloatBuffer<uint32_t>(buffer, area.x(), area.y(), area.width(), area.height());
+            break;
+        case TFLOAT:
+            getFloatBuffer<float>(buffer, area.x(), area.y(), area.width(), area.height());
+            break;
+        case TLONGLONG:
+            getFloatBuffer<int64_t>(buffer, area.x(), area.y(), area.width(), area.height());
+            break;
+        case TDOUBLE:
+            getFloatBuffer<double>(buffer, area.x(), area.y(), area.width(), area.height());
+            break;
+        default:
+            return false;
+    }
+
+    return true;
+}
+
 void FITSData::saveStatistics(Statistic &other)
 {
     other = stats;
@@ -23,6 +23,7 @@
 
 #include "bayer.h"
 #include "fitscommon.h"
+#include "imagebuffer.h"
 
 #ifdef WIN32
 // This header must be included before fitsio.h to avoid compiler errors with Visual Studio
@@ -58,6 +59,41 @@ typedef struct
     float dec;
 } wcs_point;
 
+/** Maps a native pixel type to the CFITSIO data type used by FITSData to store it */
+template <typename T> struct FITSPixelType;
+template <> struct FITSPixelType<uint8_t>
+{
+    static const uint32_t dataType = TBYTE;
+};
+template <> struct FITSPixelType<int16_t>
+{
+    static const uint32_t dataType = TSHORT;
+};
+template <> struct FITSPixelType<uint16_t>
+{
+    static const uint32_t dataType = TUSHORT;
+};
+template <> struct FITSPixelType<int32_t>
+{
+    static const uint32_t dataType = TLONG;
+};
+template <> struct FITSPixelType<uint32_t>
+{
+    static const uint32_t dataType = TULONG;
+};
+template <> struct FITSPixelType<float>
+{
+    static const uint32_t dataType = TFLOAT;
+};
+template <> struct FITSPixelType<int64_t>
+{
+    static const uint32_t dataType = TLONGLONG;
+};
+template <> struct FITSPixelType<double>
+{
+    static const uint32_t dataType = TDOUBLE;
+};
+
 class Edge
 {
     public:
@@ -160,6 +196,15 @@ class FITSData : public QObject
          */
         bool loadFITSFromMemory(const QString &inFilename, void *fits_buffer,
                                 size_t fits_buffer_size, bool silent);
+
+        /**
+         * @brief loadFITSFromMemory Loading FITS from a shared buffer without copying it.
+         * @param inFilename Potential future path to FITS file (or compressed fits.gz), stored in a fitsdata class variable
+         * @param fits_buffer The buffer containing the fits data. It is referenced for as long as the FITS file stays open.
+         * @param silent If set, error messages are ignored. If set to false, the error message will get displayed in a popup.
+         * @return bool indicating success or failure.
+         */
+        bool loadFITSFromMemory(const QString &inFilename, const ImageBuffer &fits_buffer, bool silent);
         /* Save FITS */
         int saveFITS(const QString &newFilename);
         /* Rescale image lineary from image_buffer, fit to window if desired */
@@ -171,9 +216,27 @@ class FITSData : public QObject
 
         // Access functions
         void clearImageBuffers();
-        void setImageBuffer(uint8_t *buffer);
+        void setImageBuffer(const ImageBuffer &buffer);
         uint8_t *getImageBuffer();
 
+        /**
+         * @brief getImageView Typed view of the image buffer. No data is copied.
+         * @return Pointer to the first pixel of the first channel, or nullptr if T does not match the image data type.
+         */
+        template <typename T>
+        const T *getImageView() const
+        {
+            return (FITSPixelType<T>::dataType == m_DataType) ? reinterpret_cast<const T *>(m_ImageBuffer) : nullptr;
+        }
+
+        /**
+         * @brief getFloatRegion Convert a region of the first channel to float.
+         * @param buffer Caller owned buffer of at least region width * region height floats. It can be reused across frames.
+         * @param region Region to convert. If null, the whole first channel is converted.
+         * @return True if the region is within the image and the data type is supported, false otherwise.
+         */
+        bool getFloatRegion(float *buffer, const QRect &region = QRect()) const;
+
         // Statistics
         void saveStatistics(Statistic &other);
         void restoreStatistics(Statistic &other);
@@ -297,7 +360,7 @@ class FITSData : public QObject
 
         // Use SEP (Sextractor Library) to find stars
         template <typename T>
-        void getFloatBuffer(float *buffer, int x, int y, int w, int h);
+        void getFloatBuffer(float *buffer, int x, int y, int w, int h) const;
         int findSEPStars(const QRect &boundary = QRect());
 
         // Apply ring filter to searched stars
@@ -506,6 +569,10 @@ class FITSData : public QObject
         uint8_t m_Channels { 1 };
         /// Generic data image buffer
         uint8_t *m_ImageBuffer { nullptr };
+        /// Pooled memory holding the above buffer
+        ImageBuffer m_ImageStorage;
+        /// FITS file the CFITSIO memory file reads from, kept while fptr is open
+        ImageBuffer m_MemoryFile;
         /// Above buffer size in bytes
         uint32_t m_ImageBufferSize { 0 };
         /// Is this a temporary file or one loaded from disk?
@@ -599,9 +599,9 @@ bool FITSHistogramCommand::reverseDelta()
         imageData->width() * imageData->height() * imageData->channels();
     unsigned long totalBytes = totalPixels * imageData->getBytesPerPixel();
 
-    auto * output_image = new uint8_t[totalBytes];
+    ImageBuffer output_image = ImageBufferPool::Instance()->acquire(totalBytes);
 
-    if (output_image == nullptr)
+    if (output_image.isNull())
     {
         qWarning() << "Error! not enough memory to create output image" << endl;
         return false;
@@ -611,7 +611,6 @@ bool FITSHistogramCommand::reverseDelta()
 
     if (raw_delta == nullptr)
     {
-        delete[] output_image;
         qWarning() << "Error! not enough memory to create image delta" << endl;
         return false;
     }
@@ -621,13 +620,13 @@ bool FITSHistogramCommand::reverseDelta()
     {
         qCCritical(KSTARS_FITS)
                 << "FITSHistogram compression error in reverseDelta()";
-        delete[] output_image;
         delete[] raw_delta;
         return false;
     }
 
+    uint8_t * output_buffer = output_image.data();
     for (unsigned int i = 0; i < totalBytes; i++)
-        output_image[i] = raw_delta[i] ^ image_buffer[i];
+        output_buffer[i] = raw_delta[i] ^ image_buffer[i];
 
     imageData->setImageBuffer(output_image);
 
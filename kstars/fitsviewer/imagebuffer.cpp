@@ -0,0 +1,155 @@
+/*  Pooled Image Buffers
+    Copyright (C) 2020 KStars Developers
+
+    This application is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public
+    License as published by the Free Software Foundation; either
+    version 2 of the License, or (at your option) any later version.
+ */
+
+#include "imagebuffer.h"
+
+#include <fits_debug.h>
+
+#include <QMutexLocker>
+
+#include <cstring>
+#include <new>
+
+// free memory kept for reuse by default, enough for a few full frames of large sensors
+#define IMAGE_BUFFER_POOL_LIMIT (512 * 1024 * 1024)
+
+ImageBufferPool *ImageBufferPool::Instance()
+{
+    // Never deleted, buffers may outlive static destruction
+    static ImageBufferPool *pool = new ImageBufferPool();
+    return pool;
+}
+
+ImageBufferPool::ImageBufferPool() : m_Limit(IMAGE_BUFFER_POOL_LIMIT)
+{
+    memset(&m_Statistics, 0, sizeof(m_Statistics));
+}
+
+ImageBuffer ImageBufferPool::acquire(size_t size)
+{
+    ImageBuffer buffer;
+    if (size == 0)
+        return buffer;
+
+    uint8_t *block  = nullptr;
+    size_t capacity = 0;
+
+    {
+        QMutexLocker locker(&m_Mutex);
+
+        m_Statistics.acquired++;
+
+        // Smallest free block that fits without wasting more than a quarter of it
+        int best = -1;
+        for (int i = 0; i < m_Free.count(); i++)
+        {
+            const size_t blockCapacity = m_Free[i].capacity;
+            if (blockCapacity >= size && blockCapacity <= size + size / 4 &&
+                    (best < 0 || blockCapacity < m_Free[best].capacity))
+                best = i;
+        }
+
+        if (best >= 0)
+        {
+            block    = m_Free[best].data;
+            capacity = m_Free[best].capacity;
+            m_Free.removeAt(best);
+            m_Statistics.reused++;
+            m_Statistics.retainedBytes -= capacity;
+        }
+    }
+
+    if (block == nullptr)
+    {
+        capacity = size;
+        block    = new (std::nothrow) uint8_t[capacity];
+
+        // Free blocks of other sizes may be all that stands in the way
+        if (block == nullptr)
+        {
+            trim();
+            block = new (std::nothrow) uint8_t[capacity];
+        }
+
+        if (block == nullptr)
+        {
+            qCWarning(KSTARS_FITS) << "Not enough memory for image buffer. Requested:" << size << "bytes.";
+            return buffer;
+        }
+
+        QMutexLocker locker(&m_Mutex);
+        m_Statistics.allocatedBytes += capacity;
+        qCDebug(KSTARS_FITS) << "Allocated image buffer of" << capacity << "bytes," << m_Statistics.allocatedBytes
+                             << "bytes allocated in total.";
+    }
+
+    buffer.m_Data.reset(block, [this, capacity](uint8_t * data)
+    {
+        release(data, capacity);
+    });
+    buffer.m_Size = size;
+
+    return buffer;
+}
+
+ImageBuffer ImageBufferPool::copy(const void *data, size_t size)
+{
+    ImageBuffer buffer = acquire(size);
+    if (buffer.isNull() == false)
+        memcpy(buffer.data(), data, size);
+
+    return buffer;
+}
+
+void ImageBufferPool::release(uint8_t *block, size_t capacity)
+{
+    QMutexLocker locker(&m_Mutex);
+
+    if (capacity > m_Limit)
+    {
+        m_Statistics.allocatedBytes -= capacity;
+        delete [] block;
+        return;
+    }
+
+    m_Free.append({ block, capacity });
+    m_Statistics.retainedBytes += capacity;
+
+    evict(m_Limit);
+}
+
+void ImageBufferPool::evict(size_t limit)
+{
+    while (m_Statistics.retainedBytes > limit && m_Free.isEmpty() == false)
+    {
+        const block_t oldest = m_Free.takeFirst();
+        m_Statistics.retainedBytes -= oldest.capacity;
+        m_Statistics.allocatedBytes -= oldest.capacity;
+        delete [] oldest.data;
+    }
+}
+
+void ImageBufferPool::setLimit(size_t bytes)
+{
+    QMutexLocker locker(&m_Mutex);
+    m_Limit = bytes;
+    evict(m_Limit);
+}
+
+void ImageBufferPool::trim()
+{
+    QMutexLocker locker(&m_Mutex);
+    evict(0);
+}
+
+ImageBufferPool::Statistics ImageBufferPool::statistics() const
+{
+    QMutexLocker locker(&m_Mutex);
+    return m_Statistics;
+}
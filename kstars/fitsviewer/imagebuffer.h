@@ -0,0 +1,122 @@
+/*  Pooled Image Buffers
+    Copyright (C) 2020 KStars Developers
+
+    This application is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public
+    License as published by the Free Software Foundation; either
+    version 2 of the License, or (at your option) any later version.
+ */
+
+#pragma once
+
+#include <QList>
+#include <QMutex>
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+/**
+ * @class ImageBuffer
+ * Reference counted handle to a block of image memory acquired from ImageBufferPool.
+ *
+ * Copying a handle shares the memory, the data itself is never copied. When the last handle goes away the block
+ * returns to the pool, so the next frame of the same size reuses it instead of allocating again.
+ */
+class ImageBuffer
+{
+    public:
+        ImageBuffer() = default;
+
+        uint8_t *data() const
+        {
+            return m_Data.get();
+        }
+        size_t size() const
+        {
+            return m_Size;
+        }
+        bool isNull() const
+        {
+            return !m_Data;
+        }
+        void reset()
+        {
+            m_Data.reset();
+            m_Size = 0;
+        }
+
+    private:
+        friend class ImageBufferPool;
+
+        std::shared_ptr<uint8_t> m_Data;
+        size_t m_Size { 0 };
+};
+
+/**
+ * @class ImageBufferPool
+ * Thread safe pool of large memory blocks shared by the CCD, FITSData and the viewers.
+ *
+ * Capture loops allocate the same few frame sized blocks over and over. Released blocks are kept up to a limit and
+ * handed out again for requests of about the same size, least recently released blocks are freed first.
+ */
+class ImageBufferPool
+{
+    public:
+        typedef struct
+        {
+            // Buffers handed out
+            quint64 acquired;
+            // Buffers served from a released block
+            quint64 reused;
+            // Bytes currently allocated, in use or free
+            quint64 allocatedBytes;
+            // Bytes of free blocks kept for reuse
+            quint64 retainedBytes;
+        } Statistics;
+
+        static ImageBufferPool *Instance();
+
+        /**
+         * @brief acquire Get a buffer of size bytes, its content is undefined.
+         * @return A null buffer if the memory could not be allocated.
+         */
+        ImageBuffer acquire(size_t size);
+
+        /**
+         * @brief copy Get a buffer holding a copy of data.
+         * @return A null buffer if the memory could not be allocated.
+         */
+        ImageBuffer copy(const void *data, size_t size);
+
+        /**
+         * @brief setLimit Set the largest amount of free memory kept for reuse.
+         */
+        void setLimit(size_t bytes);
+
+        /**
+         * @brief trim Free all blocks that are not in use.
+         */
+        void trim();
+
+        Statistics statistics() const;
+
+    private:
+        ImageBufferPool();
+
+        void release(uint8_t *block, size_t capacity);
+        // Must be called with the mutex locked
+        void evict(size_t limit);
+
+        typedef struct
+        {
+            uint8_t *data;
+            size_t capacity;
+        } block_t;
+
+        mutable QMutex m_Mutex;
+        // Least recently released first
+        QList<block_t> m_Free;
+        size_t m_Limit { 0 };
+        Statistics m_Statistics;
+};
@@ -24,6 +24,8 @@
 #include <QString>
 #include <QImage>
 #include <QDebug>
+#include <QHash>
+#include <QPair>
 
 #define HIPS_FRAME_EQT          0
 #define HIPS_FRAME_GAL          1
@@ -59,4 +61,15 @@ typedef struct
 
 Q_DECLARE_METATYPE(pixCacheKey_t)
 
+// Shared by the memory cache, the tile store and the download sets
+inline uint qHash(const pixCacheKey_t &key, uint seed = 0)
+{
+  return qHash(qMakePair(key.uid, qMakePair(key.level, key.pix)), seed);
+}
+
+inline bool operator==(const pixCacheKey_t &k1, const pixCacheKey_t &k2)
+{
+  return (k1.uid == k2.uid) && (k1.level == k2.level) && (k1.pix == k2.pix);
+}
+
 #endif // HIPS_H
@@ -20,6 +20,7 @@
 
 #include "hipsmanager.h"
 
+#include "healpix.h"
 #include "auxiliary/kspaths.h"
 #include "auxiliary/ksuserdb.h"
 #include "kstars.h"
@@ -27,28 +28,33 @@
 #include "kstars_debug.h"
 #include "Options.h"
 #include "skymap.h"
+#include "skyobjects/skypoint.h"
 
 #include <KConfigDialog>
 
 #include <QTime>
 #include <QHash>
-#include <QNetworkDiskCache>
+#include <QFutureWatcher>
+#include <QDir>
 #include <QPainter>
+#include <QThread>
+#include <QtConcurrent>
+
+#include <cmath>
+
+// lowest order drawn from tiles rather than the all sky image
+#define HIPS_MIN_ORDER 3
+// most tiles prefetched at once
+#define HIPS_MAX_PREFETCH 16
+// milliseconds to gather decoded tiles into one repaint
+#define HIPS_REPAINT_DELAY 100
+// most tiles one seeding request may queue
+#define HIPS_MAX_SEED_TILES 50000
+// seeding downloads running at once
+#define HIPS_MAX_SEED_DOWNLOADS 8
 
-static QNetworkDiskCache *g_discCache = nullptr;
 static UrlFileDownload *g_download = nullptr;
 
-static int qHash(const pixCacheKey_t &key, uint seed)
-{
-  return qHash(QString("%1_%2_%3").arg(key.level).arg(key.pix).arg(key.uid), seed);
-}
-
-
-inline bool operator==(const pixCacheKey_t &k1, const pixCacheKey_t &k2)
-{
-  return (k1.uid == k2.uid) && (k1.level == k2.level) && (k1.pix == k2.pix);
-}
-
 HIPSManager * HIPSManager::_HIPSManager = nullptr;
 
 HIPSManager *HIPSManager::Instance()
@@ -61,26 +67,34 @@ HIPSManager *HIPSManager::Instance()
 
 HIPSManager::HIPSManager() : QObject(KStars::Instance())
 {
-    if (g_discCache == nullptr)
-    {
-      g_discCache = new QNetworkDiskCache();
-    }
-
     if (g_download == nullptr)
     {
-      g_download = new UrlFileDownload(this, g_discCache);
+      g_download = new UrlFileDownload(this);
 
       connect(g_download, SIGNAL(sigDownloadDone(QNetworkReply::NetworkError,QByteArray&,pixCacheKey_t&)),
                     this, SLOT(slotDone(QNetworkReply::NetworkError,QByteArray&,pixCacheKey_t&)));
     }
 
-    //g_discCache->setCacheDirectory(QStandardPaths::writableLocation(QStandardPaths::DataLocation) + "/cache/hips");
-    g_discCache->setCacheDirectory(KSPaths::writableLocation(QStandardPaths::GenericCacheLocation) + "hips");
-    //g_discCache->setMaximumCacheSize(setting("hips_net_cache").toLongLong());
-    //m_cache.setMaxCost(setting("hips_mem_cache").toInt());
-    g_discCache->setMaximumCacheSize(Options::hIPSNetCache()*1024*1024);
+    QString cachePath = KSPaths::writableLocation(QStandardPaths::GenericCacheLocation) + "hips";
+
+    // Tiles used to be kept by QNetworkDiskCache, which the tile store replaces
+    QDir(cachePath + "/data8").removeRecursively();
+    QDir(cachePath + "/prepared").removeRecursively();
+
+    m_tileStore.setMaximumSize(static_cast<qint64>(Options::hIPSNetCache())*1024*1024);
+    m_tileStore.open(cachePath);
     m_cache.setMaxCost(Options::hIPSMemoryCache()*1024*1024);
 
+    m_decodePool.setMaxThreadCount(qMax(1, QThread::idealThreadCount() - 1));
+
+    m_repaintTimer.setSingleShot(true);
+    m_repaintTimer.setInterval(HIPS_REPAINT_DELAY);
+    connect(&m_repaintTimer, &QTimer::timeout, this, [this]()
+    {
+        if (SkyMap::Instance())
+            SkyMap::Instance()->forceUpdate();
+        emit sigRepaint();
+    });
 }
 
 void HIPSManager::showSettings()
@@ -112,6 +126,9 @@ void HIPSManager::showSettings()
 
 void HIPSManager::slotApply()
 {
+    m_tileStore.setMaximumSize(static_cast<qint64>(Options::hIPSNetCache())*1024*1024);
+    m_cache.setMaxCost(Options::hIPSMemoryCache()*1024*1024);
+
     readSources();
     KStars::Instance()->repopulateHIPS();
     SkyMap::Instance()->forceUpdate();
@@ -119,7 +136,7 @@ void HIPSManager::slotApply()
 
 qint64 HIPSManager::getDiscCacheSize() const
 {
-    return g_discCache->cacheSize();
+    return m_tileStore.size();
 }
 
 void HIPSManager::readSources()
@@ -162,33 +179,6 @@ QImage *HIPSManager::getPix(bool allsky, int level, int pix, bool &freeImage)
 
   pixCacheItem_t *item = getCacheItem(key);
 
-  if (m_downloadMap.contains(key))
-  { // downloading
-
-    // try render (level - 1) while downloading
-    key.level = level - 1;
-    key.pix = pix / 4;
-    pixCacheItem_t *item = getCacheItem(key);
-
-    if (item != nullptr)
-    {
-      QImage *cacheImage = item->image;
-      int size = m_currentTileWidth >> 1;
-      int offset = cacheImage->width() / size;
-      QImage *image = cacheImage;
-
-      int index[4] = {0, 2, 1, 3};
-
-      int ox = index[pix % 4] % offset;
-      int oy = index[pix % 4] / offset;
-
-      QImage *newImage = new QImage(image->copy(ox * size, oy * size, size, size));
-      freeImage = true;
-      return newImage;
-    }        
-    return nullptr;
-  }    
-
   if (item != nullptr)
   {        
     QImage *cacheImage = item->image;
@@ -212,13 +202,142 @@ QImage *HIPSManager::getPix(bool allsky, int level, int pix, bool &freeImage)
     return cacheImage;
   }
 
+  if (m_downloadMap.contains(key) == false)
+  {
+    download(key, allsky, QNetworkRequest::NormalPriority);
+  }
+  else
+  {
+    // Needed now, it no longer counts against the prefetch limit
+    m_prefetchMap.remove(key);
+
+    // A tile being seeded is decoded once it arrives
+    if (m_seedMap.contains(key))
+    {
+      m_seedWanted.insert(key);
+    }
+  }
+
+  if (allsky)
+  {
+    return nullptr;
+  }
+
+  // try render a lower order while downloading and decoding
+  return getPlaceholder(level, pix, freeImage);
+}
+
+void HIPSManager::prefetch(int level, int pix)
+{
+  if (m_currentSource.isEmpty() || pix < 0 || level < HIPS_MIN_ORDER || level > m_currentOrder)
+  {
+    return;
+  }
+
+  if (m_prefetchMap.count() >= HIPS_MAX_PREFETCH)
+  {
+    return;
+  }
+
+  pixCacheKey_t key;
+
+  key.level = level;
+  key.pix = pix;
+  key.uid = m_uid;
+
+  if (m_cache.contains(key) || m_downloadMap.contains(key))
+  {
+    return;
+  }
+
+  m_prefetchMap.insert(key);
+  download(key, false, QNetworkRequest::LowPriority);
+}
+
+QImage *HIPSManager::getPlaceholder(int level, int pix, bool &freeImage)
+{
+  pixCacheKey_t key;
+  key.uid = m_uid;
+
+  for (int depth = 1; level - depth >= HIPS_MIN_ORDER; depth++)
+  {
+    key.level = level - depth;
+    key.pix = pix >> (2 * depth);
+
+    pixCacheItem_t *item = getCacheItem(key);
+
+    if (item == nullptr)
+    {
+      // The parent covers four tiles and arrives quickly, ask for it ahead of the rest
+      if (depth == 1)
+      {
+        if (m_downloadMap.contains(key) == false)
+        {
+          download(key, false, QNetworkRequest::HighPriority);
+        }
+        else if (m_seedMap.contains(key))
+        {
+          m_seedWanted.insert(key);
+        }
+      }
+      continue;
+    }
+
+    QImage *cacheImage = item->image;
+    int size = cacheImage->width() >> depth;
+
+    if (size < 1)
+    {
+      return nullptr;
+    }
+
+    // Children of a tile are its quarters, descend one quarter per order
+    int index[4] = {0, 2, 1, 3};
+    int ox = 0;
+    int oy = 0;
+
+    for (int i = 0; i < depth; i++)
+    {
+      int child = index[(pix >> (2 * i)) & 3];
+
+      ox += (child % 2) << i;
+      oy += (child / 2) << i;
+    }
+
+    QImage *newImage = new QImage(cacheImage->copy(ox * size, oy * size, size, size));
+    freeImage = true;
+    return newImage;
+  }
+
+  return nullptr;
+}
+
+void HIPSManager::download(const pixCacheKey_t &key, bool allsky, QNetworkRequest::Priority priority)
+{
+  QByteArray data;
+
+  // Stored tiles need no network request. The sky map asks for them while it is drawn, so they are decoded once
+  // the render pass is over: reserving their cost may evict the images it is still using
+  if (m_tileStore.find(key, data))
+  {
+    m_downloadMap.insert(key);
+    QTimer::singleShot(0, this, [this, key, data]()
+    {
+      if (m_downloadMap.contains(key))
+      {
+        decode(key, data);
+      }
+    });
+    return;
+  }
+
   QString path;          
 
   if (!allsky)
   {
-    int dir = (pix / 10000) * 10000;
+    int dir = (key.pix / 10000) * 10000;
 
-    path = "/Norder" + QString::number(level) + "/Dir" + QString::number(dir) + "/Npix" + QString::number(pix) +
+    path = "/Norder" + QString::number(key.level) + "/Dir" + QString::number(dir) + "/Npix" + QString::number(key.pix) +
            '.' + m_currentFormat;
   }
   else
@@ -228,10 +347,57 @@ QImage *HIPSManager::getPix(bool allsky, int level, int pix, bool &freeImage)
 
   QUrl downloadURL(m_currentURL);
   downloadURL.setPath(downloadURL.path() + path);
-  g_download->begin(downloadURL, key);
+  g_download->begin(downloadURL, key, priority);
   m_downloadMap.insert(key);    
+}
+
+void HIPSManager::decode(const pixCacheKey_t &key, const QByteArray &data)
+{
+  const int cost = decodeCost(key);
+  m_cache.reserve(cost);
+
+  auto *watcher = new QFutureWatcher<QImage>(this);
+
+  connect(watcher, &QFutureWatcher<QImage>::finished, this, [this, watcher, key, cost]()
+  {
+    pixCacheKey_t cacheKey = key;
+    QImage image = watcher->result();
 
-  return nullptr; 
+    watcher->deleteLater();
+    m_cache.release(cost);
+    m_downloadMap.remove(cacheKey);
+    m_prefetchMap.remove(cacheKey);
+
+    if (image.isNull())
+    {
+      qCWarning(KSTARS) << "no image" << cacheKey.level << cacheKey.pix;
+      return;
+    }
+
+    auto *item = new pixCacheItem_t;
+    item->image = new QImage(image);
+    addToMemoryCache(cacheKey, item);
+
+    m_repaintTimer.start();
+  });
+
+  watcher->setFuture(QtConcurrent::run(&m_decodePool, [data]()
+  {
+    QImage image;
+    image.loadFromData(data);
+    return image;
+  }));
+}
+
+int HIPSManager::decodeCost(const pixCacheKey_t &key) const
+{
+  // The all sky image holds the 768 tiles of order 3 at 64 pixels each
+  if (key.level == 0)
+  {
+    return 768 * 64 * 64 * 4;
+  }
+
+  return m_currentTileWidth * m_currentTileWidth * 4;
 }
 
 
@@ -326,34 +492,165 @@ bool HIPSManager::parseProperties(hipsParams_t *param, const QString &filename,
 
 void HIPSManager::cancelAll()
 {
+  m_seedQueue.clear();
+  m_seedQueued.clear();
   g_download->abortAll();
+  m_prefetchMap.clear();
 }
 
 void HIPSManager::clearDiscCache()
 {
-  g_discCache->clear();
+  m_tileStore.clear();
 }
 
-void HIPSManager::slotDone(QNetworkReply::NetworkError error, QByteArray &data, pixCacheKey_t &key)
-{    
-  if (error == QNetworkReply::NoError)
+int HIPSManager::seedRegion(const SkyPoint &center, double radius, int minOrder, int maxOrder)
+{
+  if (m_currentSource.isEmpty())
   {
-    m_downloadMap.remove(key);
+    return 0;
+  }
 
-    auto *item = new pixCacheItem_t;
+  HEALPix healpix;
+  const double ra = center.ra0().radians();
+  const double de = center.dec0().radians();
+  const double range = radius * dms::DegToRad;
+  int queued = 0;
+
+  for (int order = qMax(minOrder, HIPS_MIN_ORDER); order <= qMin(maxOrder, static_cast<int>(m_currentOrder)); order++)
+  {
+    // Tiles are about this many radians across, any corner that close to the region may cover part of it
+    const double tileSize = 1.5 / (1 << order);
+    QList<pixCacheKey_t> tiles;
+    QSet<int> visited;
+    QList<int> pending { healpix.getPix(order, ra, de) };
+
+    // The walk stops as soon as the order is known to be too large, a deep order covers a huge number of tiles
+    while (pending.isEmpty() == false && queued + tiles.count() <= HIPS_MAX_SEED_TILES)
+    {
+      const int pix = pending.takeFirst();
 
-    item->image = new QImage();
-    if (item->image->loadFromData(data))
-    {      
-      addToMemoryCache(key, item);
+      if (pix < 0 || visited.contains(pix))
+      {
+        continue;
+      }
 
-      //SkyMap::Instance()->forceUpdate();
+      const bool first = visited.isEmpty();
+      visited.insert(pix);
+
+      SkyPoint corners[4];
+      healpix.getCornerPoints(order, pix, corners);
+
+      bool inside = first;
+      for (const SkyPoint &corner : corners)
+      {
+        const double cosDistance = std::sin(de) * std::sin(corner.dec0().radians()) +
+                                   std::cos(de) * std::cos(corner.dec0().radians()) * std::cos(ra - corner.ra0().radians());
+        if (std::acos(qBound(-1.0, cosDistance, 1.0)) <= range + tileSize)
+        {
+          inside = true;
+        }
+      }
+
+      if (inside == false)
+      {
+        continue;
+      }
+
+      pixCacheKey_t key;
+      key.level = order;
+      key.pix = pix;
+      key.uid = m_uid;
+
+      if (m_tileStore.contains(key) == false && m_seedMap.contains(key) == false && m_seedQueued.contains(key) == false)
+      {
+        tiles.append(key);
+      }
+
+      int dirs[8];
+      healpix.neighbours(1 << order, pix, dirs);
+      for (int dir : dirs)
+      {
+        pending.append(dir);
+      }
     }
-    else
+
+    if (queued + tiles.count() > HIPS_MAX_SEED_TILES)
     {
-      delete item;
-      qCWarning(KSTARS) << "no image" << data;
+      qCWarning(KSTARS) << "HiPS seeding stops before order" << order << "which needs more than"
+                        << HIPS_MAX_SEED_TILES - queued << "tiles";
+      break;
     }
+
+    m_seedQueue.append(tiles);
+    for (const pixCacheKey_t &key : tiles)
+    {
+      m_seedQueued.insert(key);
+    }
+    queued += tiles.count();
+  }
+
+  if (m_seedMap.isEmpty() && m_seedQueue.count() == queued)
+  {
+    m_seedDone = 0;
+    m_seedTotal = 0;
+  }
+
+  m_seedTotal += queued;
+  qCInfo(KSTARS) << "Seeding" << queued << "HiPS tiles into the tile store";
+
+  seedNext();
+  emit sigSeedProgress(m_seedDone, m_seedTotal);
+
+  return queued;
+}
+
+void HIPSManager::seedNext()
+{
+  while (m_seedMap.count() < HIPS_MAX_SEED_DOWNLOADS && m_seedQueue.isEmpty() == false)
+  {
+    pixCacheKey_t key = m_seedQueue.takeFirst();
+    m_seedQueued.remove(key);
+
+    // Skip tiles of another survey, already stored, or already downloading for the sky map
+    if (key.uid != m_uid || m_tileStore.contains(key) || m_downloadMap.contains(key))
+    {
+      m_seedDone++;
+      continue;
+    }
+
+    m_seedMap.insert(key);
+    download(key, false, QNetworkRequest::LowPriority);
+  }
+}
+
+void HIPSManager::slotDone(QNetworkReply::NetworkError error, QByteArray &data, pixCacheKey_t &key)
+{    
+  m_prefetchMap.remove(key);
+
+  // Local surveys are already on disk
+  if (error == QNetworkReply::NoError && m_currentURL.isLocalFile() == false)
+  {
+    m_tileStore.insert(key, data);
+  }
+
+  if (m_seedMap.remove(key))
+  {
+    m_seedDone++;
+    seedNext();
+    emit sigSeedProgress(m_seedDone, m_seedTotal);
+
+    // Seeded tiles only go to the store, unless the sky map asked for them while they downloaded
+    if (m_seedWanted.remove(key) == false)
+    {
+      m_downloadMap.remove(key);
+      return;
+    }
+  }
+
+  if (error == QNetworkReply::NoError)
+  {
+    // The key stays in the download map until the image is decoded, so its parent is drawn meanwhile
+    decode(key, data);
   }
   else
   {
@@ -417,34 +714,12 @@ bool HIPSManager::setCurrentSource(const QString &title)
         return true;
     }
 
-    for (QMap<QString,QString> &source : m_hipsSources)
+    for (const QMap<QString,QString> &source : m_hipsSources)
     {
         if (source.value("obs_title") == title)
         {
-            m_currentSource = source;
-            m_currentFormat = source.value("hips_tile_format");
-            if (m_currentFormat.contains("jpeg"))
-                m_currentFormat = "jpg";
-            else if (m_currentFormat.contains("png"))
-                m_currentFormat = "png";
-            else
-            {
-                qCWarning(KSTARS) << "FITS HIPS images are not currently supported.";
+            if (setSource(source) == false)
                 return false;
-            }
-
-            m_currentOrder = source.value("hips_order").toInt();
-            m_currentTileWidth = source.value("hips_tile_width").toInt();
-
-            if (source.value("hips_frame") == "equatorial")
-                m_currentFrame = HIPS_EQUATORIAL_FRAME;
-            else if (source.value("hips_frame") == "galactic")
-                m_currentFrame = HIPS_GALACTIC_FRAME;
-            else
-                m_currentFrame = HIPS_OTHER_FRAME;
-
-            m_currentURL = QUrl(source.value("hips_service_url"));
-            m_uid = qHash(m_currentURL);
 
             Options::setHIPSSource(title);
             Options::setShowHIPS(true);
@@ -456,6 +731,38 @@ bool HIPSManager::setCurrentSource(const QString &title)
     return false;
 }
 
+bool HIPSManager::setSource(const QMap<QString,QString> &source)
+{
+    QString format = source.value("hips_tile_format");
+    if (format.contains("jpeg"))
+        format = "jpg";
+    else if (format.contains("png"))
+        format = "png";
+    else
+    {
+        qCWarning(KSTARS) << "FITS HIPS images are not currently supported.";
+        return false;
+    }
+
+    m_currentSource = source;
+    m_currentFormat = format;
+    m_currentOrder = source.value("hips_order").toInt();
+    m_currentTileWidth = source.value("hips_tile_width").toInt();
+
+    if (source.value("hips_frame") == "equatorial")
+        m_currentFrame = HIPS_EQUATORIAL_FRAME;
+    else if (source.value("hips_frame") == "galactic")
+        m_currentFrame = HIPS_GALACTIC_FRAME;
+    else
+        m_currentFrame = HIPS_OTHER_FRAME;
+
+    // Surveys may also be read from a local directory, which is handy without a network
+    m_currentURL = QUrl::fromUserInput(source.value("hips_service_url"));
+    m_uid = qHash(m_currentURL);
+
+    return true;
+}
+
 void RemoveTimer::setKey(const pixCacheKey_t &key)
 {
     m_key = key;
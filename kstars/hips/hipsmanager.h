@@ -21,11 +21,14 @@
 #pragma once
 
 #include "hips.h"
+#include "hipstilestore.h"
 #include "opships.h"
 #include "pixcache.h"
 #include "urlfiledownload.h"
 
 #include <QObject>
+#include <QThreadPool>
+#include <QTimer>
 
 #include <memory>
 
@@ -54,6 +57,8 @@ private slots:
   }
 };
 
+class SkyPoint;
+
 class HIPSManager : public QObject
 {
   Q_OBJECT
@@ -64,9 +69,27 @@ public:
   typedef enum { HIPS_EQUATORIAL_FRAME, HIPS_GALACTIC_FRAME, HIPS_OTHER_FRAME } HIPSFrame;
 
   QImage *getPix(bool allsky, int level, int pix, bool &freeImage);
+  // Request a tile before it becomes visible, at most HIPS_MAX_PREFETCH at a time
+  void prefetch(int level, int pix);
+
+  /**
+   * @brief seedRegion Download the tiles around a point into the tile store, for use without a network.
+   * @param center J2000 center of the region.
+   * @param radius Radius of the region in degrees.
+   * @return Number of tiles queued. Orders that would exceed HIPS_MAX_SEED_TILES are left out.
+   */
+  int seedRegion(const SkyPoint &center, double radius, int minOrder, int maxOrder);
 
   void readSources();
 
+  /**
+   * @brief setSource Draw a survey that need not be in the user database, such as a local copy.
+   * @param source Keys of the survey properties: hips_service_url, hips_order, hips_tile_width, hips_tile_format
+   * and hips_frame.
+   * @return False if the tile format is not supported.
+   */
+  bool setSource(const QMap<QString,QString> &source);
+
   void cancelAll();
   void clearDiscCache();  
 
@@ -88,6 +111,7 @@ public slots:
 
 signals:
   void sigRepaint();
+  void sigSeedProgress(int done, int total);
 
 private slots:
   void slotDone(QNetworkReply::NetworkError error, QByteArray &data, pixCacheKey_t &key);
@@ -101,10 +125,32 @@ private:
 
   // Cache
   PixCache m_cache;
+  HIPSTileStore m_tileStore;
+  // Tiles being downloaded or decoded
   QSet <pixCacheKey_t> m_downloadMap;
+  QSet <pixCacheKey_t> m_prefetchMap;
+
+  // Tiles waiting to be seeded into the store, and those downloading
+  QList <pixCacheKey_t> m_seedQueue;
+  // Same keys as the queue, so a region is checked against it without a scan per tile
+  QSet <pixCacheKey_t> m_seedQueued;
+  QSet <pixCacheKey_t> m_seedMap;
+  // Tiles being seeded that the sky map is also waiting for
+  QSet <pixCacheKey_t> m_seedWanted;
+  int m_seedDone { 0 };
+  int m_seedTotal { 0 };
+
+  // Decoding runs off the GUI thread, finished tiles are shown in one repaint
+  QThreadPool m_decodePool;
+  QTimer m_repaintTimer;
 
   void addToMemoryCache(pixCacheKey_t &key, pixCacheItem_t *item);
   pixCacheItem_t *getCacheItem(pixCacheKey_t &key);
+  void download(const pixCacheKey_t &key, bool allsky, QNetworkRequest::Priority priority);
+  void decode(const pixCacheKey_t &key, const QByteArray &data);
+  int decodeCost(const pixCacheKey_t &key) const;
+  QImage *getPlaceholder(int level, int pix, bool &freeImage);
+  void seedNext();
 
   // List of all sources in the database
   QList<QMap<QString,QString>> m_hipsSources;
@@ -27,14 +27,57 @@
 #include "skyqpainter.h"
 #include "projections/projector.h"
 
+#include <QElapsedTimer>
+#include <QThread>
+#include <QtConcurrent>
+
+#include <algorithm>
+
+// slowest tiles listed in the frame timing log
+#define HIPS_SLOWEST_TILES 3
+// frames of panning to look ahead when prefetching
+#define HIPS_PREFETCH_LEAD 3
+
+// UV Mapping to apply image unto the destination image
+// 4x4 = 16 points are mapped from the source image unto the destination image.
+// Starting from each grandchild pixel, each pix polygon is mapped accordingly.
+// For example, pixel 357 will have 4 child pixels, each of them will have 4 childs pixels and so
+// on. Each healpix pixel appears roughly as a diamond on the sky map.
+// The corners points for HealPIX moves from NORTH -> EAST -> SOUTH -> WEST
+// Hence first point is 0.25, 0.25 in UV coordinate system.
+// Depending on the selected algorithm, the mapping will either utilize nearest neighbour
+// or bilinear interpolation.
+static QPointF uv[16][4] = {{QPointF(.25, .25), QPointF(0.25, 0), QPointF(0, .0),QPointF(0, .25)},
+                            {QPointF(.25, .5), QPointF(0.25, 0.25), QPointF(0, .25),QPointF(0, .5)},
+                            {QPointF(.5, .25), QPointF(0.5, 0), QPointF(.25, .0),QPointF(.25, .25)},
+                            {QPointF(.5, .5), QPointF(0.5, 0.25), QPointF(.25, .25),QPointF(.25, .5)},
+
+                            {QPointF(.25, .75), QPointF(0.25, 0.5), QPointF(0, 0.5), QPointF(0, .75)},
+                            {QPointF(.25, 1), QPointF(0.25, 0.75), QPointF(0, .75),QPointF(0, 1)},
+                            {QPointF(.5, .75), QPointF(0.5, 0.5), QPointF(.25, .5),QPointF(.25, .75)},
+                            {QPointF(.5, 1), QPointF(0.5, 0.75), QPointF(.25, .75),QPointF(.25, 1)},
+
+                            {QPointF(.75, .25), QPointF(0.75, 0), QPointF(0.5, .0),QPointF(0.5, .25)},
+                            {QPointF(.75, .5), QPointF(0.75, 0.25), QPointF(0.5, .25),QPointF(0.5, .5)},
+                            {QPointF(1, .25), QPointF(1, 0), QPointF(.75, .0),QPointF(.75, .25)},
+                            {QPointF(1, .5), QPointF(1, 0.25), QPointF(.75, .25),QPointF(.75, .5)},
+
+                            {QPointF(.75, .75), QPointF(0.75, 0.5), QPointF(0.5, .5),QPointF(0.5, .75)},
+                            {QPointF(.75, 1), QPointF(0.75, 0.75), QPointF(0.5, .75),QPointF(0.5, 1)},
+                            {QPointF(1, .75), QPointF(1, 0.5), QPointF(.75, .5),QPointF(.75, .75)},
+                            {QPointF(1, 1), QPointF(1, 0.75), QPointF(.75, .75),QPointF(.75, 1)},
+                           };
+
 HIPSRenderer::HIPSRenderer()
 {
-    m_scanRender.reset(new ScanRender());
     m_HEALpix.reset(new HEALPix());
 }
 
 bool HIPSRenderer::render(uint16_t w, uint16_t h, QImage *hipsImage, const Projector *m_proj)
 {
+  QElapsedTimer frameTimer;
+  frameTimer.start();
+
   gridColor = KStarsData::Instance()->colorScheme()->colorNamed("HIPSGridColor").name();
 
   m_projector = m_proj;
@@ -53,10 +96,18 @@ bool HIPSRenderer::render(uint16_t w, uint16_t h, QImage *hipsImage, const Proje
   }
 
   m_renderedMap.clear();
+  m_tiles.clear();
   m_rendered = 0;
   m_blocks = 0;
   m_size = 0;
 
+  m_frame.tiles = 0;
+  m_frame.bands = 0;
+  m_frame.collect = 0;
+  m_frame.raster = 0;
+  m_frame.total = 0;
+  m_frame.timing.clear();
+
   SkyPoint center = SkyMap::Instance()->getCenterPoint();
   center.deprecess(KStarsData::Instance()->updateNum());
 
@@ -100,12 +151,101 @@ bool HIPSRenderer::render(uint16_t w, uint16_t h, QImage *hipsImage, const Proje
   if (size < 0)
       size = HIPSManager::Instance()->getCurrentTileWidth();
 
-  bool old = m_scanRender->isBilinearInterpolationEnabled();
-  m_scanRender->setBilinearInterpolationEnabled(Options::hIPSBiLinearInterpolation() && (size >= HIPSManager::Instance()->getCurrentTileWidth() || allSky));
-
+  // Collect the visible tiles first. HIPSManager is not thread safe, so the tiles are fetched
+  // and projected here and only the rasterisation is spread over the bands.
   renderRec(allSky, level, centerPix, hipsImage);
 
-  m_scanRender->setBilinearInterpolationEnabled(old);
+  if (allSky == false)
+    prefetch(level, ra, de);
+
+  m_frame.collect = frameTimer.nsecsElapsed() / 1000;
+  m_frame.tiles = m_tiles.count();
+
+  // Split the destination in horizontal bands so each thread writes its own rows
+  int bands = qBound(1, QThread::idealThreadCount(), qMax(1, hipsImage->height() / HIPS_MIN_BAND_HEIGHT));
+  if (m_tiles.isEmpty())
+    bands = 0;
+
+  bool bilinear = Options::hIPSBiLinearInterpolation() && (size >= HIPSManager::Instance()->getCurrentTileWidth() || allSky);
+
+  while (static_cast<int>(m_scanRenders.size()) < bands)
+    m_scanRenders.emplace_back(new ScanRender());
+  m_bandTiming.resize(bands);
+
+  if (bands > 0)
+  {
+    QElapsedTimer rasterTimer;
+    rasterTimer.start();
+
+    const int rows = hipsImage->height() / bands;
+    QList<QFuture<void>> futures;
+
+    // bits() may detach the image, so it is only called here and the bands share the pixels
+    bkTarget_t target;
+    target.bits   = reinterpret_cast<quint32 *>(hipsImage->bits());
+    target.stride = hipsImage->bytesPerLine() / static_cast<int>(sizeof(quint32));
+    target.width  = hipsImage->width();
+    target.height = hipsImage->height();
+
+    for (int i = 0; i < bands; i++)
+    {
+      m_scanRenders[i]->setBilinearInterpolationEnabled(bilinear);
+
+      const int minY = i * rows;
+      const int maxY = (i == bands - 1) ? hipsImage->height() : minY + rows;
+
+      // The last band is rasterised on this thread while the others run in the pool
+      if (i == bands - 1)
+        rasterBand(i, minY, maxY, target);
+      else
+        futures.append(QtConcurrent::run(this, &HIPSRenderer::rasterBand, i, minY, maxY, target));
+    }
+
+    for (QFuture<void> &future : futures)
+      future.waitForFinished();
+
+    m_frame.raster = rasterTimer.nsecsElapsed() / 1000;
+    m_frame.bands = bands;
+  }
+
+  for (int i = 0; i < m_tiles.count(); i++)
+  {
+    tile_t &tile = m_tiles[i];
+
+    qint64 raster = 0;
+    for (int j = 0; j < bands; j++)
+      raster += m_bandTiming[j][i];
+    m_frame.timing[i].raster = raster;
+
+    if (Options::hIPSShowGrid())
+      drawGrid(tile, hipsImage);
+
+    if (tile.freeImage)
+    {
+      delete tile.image;
+    }
+  }
+
+  m_tiles.clear();
+  m_frame.total = frameTimer.nsecsElapsed() / 1000;
+
+  if (m_frame.timing.isEmpty() == false)
+  {
+    QVector<tileTiming_t> slowest = m_frame.timing;
+    const int count = std::min(slowest.count(), HIPS_SLOWEST_TILES);
+    std::partial_sort(slowest.begin(), slowest.begin() + count, slowest.end(), [](const tileTiming_t &a, const tileTiming_t &b)
+    {
+      return a.prepare + a.raster > b.prepare + b.raster;
+    });
+
+    QStringList tiles;
+    for (int i = 0; i < count; i++)
+      tiles << QString("%1/%2 %3+%4us").arg(slowest[i].pix).arg(slowest[i].level).arg(slowest[i].prepare).arg(slowest[i].raster);
+
+    qCDebug(KSTARS) << QString("HiPS frame: %1 tiles %2 rendered, collect %3us, raster %4us on %5 bands, total %6us, slowest %7")
+                       .arg(m_blocks).arg(m_rendered).arg(m_frame.collect).arg(m_frame.raster).arg(m_frame.bands)
+                       .arg(m_frame.total).arg(tiles.join(", "));
+  }
 
   return true;
 }
@@ -134,16 +274,27 @@ void HIPSRenderer::renderRec(bool allsky, int level, int pix, QImage *pDest)
 
 bool HIPSRenderer::renderPix(bool allsky, int level, int pix, QImage *pDest)
 {
+  Q_UNUSED(pDest);
+
+  QElapsedTimer timer;
+  timer.start();
+
+  tile_t tile;
   SkyPoint cornerSkyCoords[4];
-  QPointF cornerScreenCoords[4];
-  bool freeImage = false;
+
+  tile.level = level;
+  tile.pix = pix;
+  tile.image = nullptr;
+  tile.freeImage = false;
+  tile.top = 0;
+  tile.bottom = -1;
 
   m_HEALpix->getCornerPoints(level, pix, cornerSkyCoords);
   bool isVisible = false;
 
   for (int i=0; i < 4; i++)
   {
-      cornerScreenCoords[i] = m_projector->toScreen(&cornerSkyCoords[i]);
+      tile.corners[i] = m_projector->toScreen(&cornerSkyCoords[i]);
       isVisible |= m_projector->checkVisibility(&cornerSkyCoords[i]);
   }  
 
@@ -159,48 +310,19 @@ bool HIPSRenderer::renderPix(bool allsky, int level, int pix, QImage *pDest)
       trfProjectPointNoCheck(&pts[i]);
     } */
 
-    QImage *image = HIPSManager::Instance()->getPix(allsky, level, pix, freeImage);
+    // Cached images stay valid for the whole frame, the cache only changes when a download finishes
+    tile.image = HIPSManager::Instance()->getPix(allsky, level, pix, tile.freeImage);
 
-    if (image)      
+    if (tile.image)
     {
       m_rendered++;
 
       #if QT_VERSION >= QT_VERSION_CHECK(5,10,0)
-      m_size += image->sizeInBytes();
+      m_size += tile.image->sizeInBytes();
       #else
-      m_size += image->byteCount();
+      m_size += tile.image->byteCount();
       #endif
 
-      // UV Mapping to apply image unto the destination image
-      // 4x4 = 16 points are mapped from the source image unto the destination image.
-      // Starting from each grandchild pixel, each pix polygon is mapped accordingly.
-      // For example, pixel 357 will have 4 child pixels, each of them will have 4 childs pixels and so
-      // on. Each healpix pixel appears roughly as a diamond on the sky map.
-      // The corners points for HealPIX moves from NORTH -> EAST -> SOUTH -> WEST
-      // Hence first point is 0.25, 0.25 in UV coordinate system.
-      // Depending on the selected algorithm, the mapping will either utilize nearest neighbour
-      // or bilinear interpolation.
-      QPointF uv[16][4] = {{QPointF(.25, .25), QPointF(0.25, 0), QPointF(0, .0),QPointF(0, .25)},
-                           {QPointF(.25, .5), QPointF(0.25, 0.25), QPointF(0, .25),QPointF(0, .5)},
-                           {QPointF(.5, .25), QPointF(0.5, 0), QPointF(.25, .0),QPointF(.25, .25)},
-                           {QPointF(.5, .5), QPointF(0.5, 0.25), QPointF(.25, .25),QPointF(.25, .5)},
-
-                           {QPointF(.25, .75), QPointF(0.25, 0.5), QPointF(0, 0.5), QPointF(0, .75)},
-                           {QPointF(.25, 1), QPointF(0.25, 0.75), QPointF(0, .75),QPointF(0, 1)},
-                           {QPointF(.5, .75), QPointF(0.5, 0.5), QPointF(.25, .5),QPointF(.25, .75)},
-                           {QPointF(.5, 1), QPointF(0.5, 0.75), QPointF(.25, .75),QPointF(.25, 1)},
-
-                           {QPointF(.75, .25), QPointF(0.75, 0), QPointF(0.5, .0),QPointF(0.5, .25)},
-                           {QPointF(.75, .5), QPointF(0.75, 0.25), QPointF(0.5, .25),QPointF(0.5, .5)},
-                           {QPointF(1, .25), QPointF(1, 0), QPointF(.75, .0),QPointF(.75, .25)},
-                           {QPointF(1, .5), QPointF(1, 0.25), QPointF(.75, .25),QPointF(.75, .5)},
-
-                           {QPointF(.75, .75), QPointF(0.75, 0.5), QPointF(0.5, .5),QPointF(0.5, .75)},
-                           {QPointF(.75, 1), QPointF(0.75, 0.75), QPointF(0.5, .75),QPointF(0.5, 1)},
-                           {QPointF(1, .75), QPointF(1, 0.5), QPointF(.75, .5),QPointF(.75, .75)},
-                           {QPointF(1, 1), QPointF(1, 0.75), QPointF(.75, .75),QPointF(.75, 1)},
-                          };
-
       int childPixelID[4];
 
       // Find all the 4 children of the current pixel
@@ -217,42 +339,120 @@ bool HIPSRenderer::renderPix(bool allsky, int level, int pix, QImage *pDest)
         // system.
         m_HEALpix->getPixChilds(id, grandChildPixelID);
 
-        QPointF fineScreenCoords[4];
-
         for (int id2 : grandChildPixelID)
         {
           SkyPoint fineSkyPoints[4];
           m_HEALpix->getCornerPoints(level + 2, id2, fineSkyPoints);
 
           for (int i = 0; i < 4; i++)
-              fineScreenCoords[i] = m_projector->toScreen(&fineSkyPoints[i]);
-          m_scanRender->renderPolygon(3, fineScreenCoords, pDest, image, uv[j]);
+          {
+              tile.fine[j][i] = m_projector->toScreen(&fineSkyPoints[i]);
+
+              if (j == 0 && i == 0)
+                tile.top = tile.bottom = tile.fine[j][i].y();
+              tile.top = std::min(tile.top, tile.fine[j][i].y());
+              tile.bottom = std::max(tile.bottom, tile.fine[j][i].y());
+          }
           j++;
         }
       }
-
-      if (freeImage)
-      {
-        delete image;
-      }
     }
 
-    if (Options::hIPSShowGrid())
-    {
-      QPainter p(pDest);
-      p.setRenderHint(QPainter::Antialiasing);
-      p.setPen(gridColor);
-
-      p.drawLine(cornerScreenCoords[0].x(), cornerScreenCoords[0].y(), cornerScreenCoords[1].x(), cornerScreenCoords[1].y());
-      p.drawLine(cornerScreenCoords[1].x(), cornerScreenCoords[1].y(), cornerScreenCoords[2].x(), cornerScreenCoords[2].y());
-      p.drawLine(cornerScreenCoords[2].x(), cornerScreenCoords[2].y(), cornerScreenCoords[3].x(), cornerScreenCoords[3].y());
-      p.drawLine(cornerScreenCoords[3].x(), cornerScreenCoords[3].y(), cornerScreenCoords[0].x(), cornerScreenCoords[0].y());
-      p.drawText((cornerScreenCoords[0].x() + cornerScreenCoords[1].x() + cornerScreenCoords[2].x() + cornerScreenCoords[3].x()) / 4,
-                         (cornerScreenCoords[0].y() + cornerScreenCoords[1].y() + cornerScreenCoords[2].y() + cornerScreenCoords[3].y()) / 4, QString::number(pix) + " / " + QString::number(level));
-    }
+    // Tiles without an image are kept for the grid
+    m_tiles.append(tile);
+    m_frame.timing.append({ level, pix, timer.nsecsElapsed() / 1000, 0 });
 
     return true;
   }
 
   return false;
 }
+
+void HIPSRenderer::prefetch(int level, double ra, double de)
+{
+  const bool panning = (level == m_lastLevel) && (ra != m_lastRA || de != m_lastDE);
+
+  double dra = ra - m_lastRA;
+  if (dra > M_PI)
+    dra -= 2 * M_PI;
+  else if (dra < -M_PI)
+    dra += 2 * M_PI;
+  double dde = de - m_lastDE;
+
+  m_lastLevel = level;
+  m_lastRA = ra;
+  m_lastDE = de;
+
+  if (panning == false)
+    return;
+
+  // Where the center will be a few frames from now if the pan goes on
+  double nextRA = ra + dra * HIPS_PREFETCH_LEAD;
+  double nextDE = qBound(-M_PI / 2, de + dde * HIPS_PREFETCH_LEAD, M_PI / 2);
+
+  if (nextRA < 0)
+    nextRA += 2 * M_PI;
+  else if (nextRA >= 2 * M_PI)
+    nextRA -= 2 * M_PI;
+
+  int pix = m_HEALpix->getPix(level, nextRA, nextDE);
+  int dirs[8];
+
+  m_HEALpix->neighbours(1 << level, pix, dirs);
+
+  HIPSManager::Instance()->prefetch(level, pix);
+  for (int dir : dirs)
+  {
+    if (m_renderedMap.contains(dir) == false)
+      HIPSManager::Instance()->prefetch(level, dir);
+  }
+
+  // Zooming in after a pan needs the next order of the same area
+  int childPixelID[4];
+  m_HEALpix->getPixChilds(pix, childPixelID);
+  for (int id : childPixelID)
+    HIPSManager::Instance()->prefetch(level + 1, id);
+}
+
+void HIPSRenderer::rasterBand(int band, int minY, int maxY, const bkTarget_t &target)
+{
+  ScanRender *scanRender = m_scanRenders[band].get();
+  QVector<qint64> &timing = m_bandTiming[band];
+  QElapsedTimer timer;
+
+  scanRender->setClipBand(minY, maxY);
+  timing.fill(0, m_tiles.count());
+
+  for (int i = 0; i < m_tiles.count(); i++)
+  {
+    tile_t &tile = m_tiles[i];
+
+    if (tile.image == nullptr)
+      continue;
+
+    // Skip tiles that lie entirely outside this band
+    if (tile.bottom < minY || tile.top >= maxY)
+      continue;
+
+    timer.start();
+    for (int j = 0; j < 16; j++)
+      scanRender->renderPolygon(3, tile.fine[j], target, tile.image, uv[j]);
+    timing[i] = timer.nsecsElapsed() / 1000;
+  }
+}
+
+void HIPSRenderer::drawGrid(const tile_t &tile, QImage *pDest)
+{
+  const QPointF *cornerScreenCoords = tile.corners;
+
+  QPainter p(pDest);
+  p.setRenderHint(QPainter::Antialiasing);
+  p.setPen(gridColor);
+
+  p.drawLine(cornerScreenCoords[0].x(), cornerScreenCoords[0].y(), cornerScreenCoords[1].x(), cornerScreenCoords[1].y());
+  p.drawLine(cornerScreenCoords[1].x(), cornerScreenCoords[1].y(), cornerScreenCoords[2].x(), cornerScreenCoords[2].y());
+  p.drawLine(cornerScreenCoords[2].x(), cornerScreenCoords[2].y(), cornerScreenCoords[3].x(), cornerScreenCoords[3].y());
+  p.drawLine(cornerScreenCoords[3].x(), cornerScreenCoords[3].y(), cornerScreenCoords[0].x(), cornerScreenCoords[0].y());
+  p.drawText((cornerScreenCoords[0].x() + cornerScreenCoords[1].x() + cornerScreenCoords[2].x() + cornerScreenCoords[3].x()) / 4,
+             (cornerScreenCoords[0].y() + cornerScreenCoords[1].y() + cornerScreenCoords[2].y() + cornerScreenCoords[3].y()) / 4, QString::number(tile.pix) + " / " + QString::number(tile.level));
+}
@@ -24,31 +24,86 @@
 #include "hipsmanager.h"
 #include "scanrender.h"
 
+#include <QVector>
+
 #include <memory>
+#include <vector>
 
 class Projector;
 
+// smallest band of screen rows worth giving its own thread
+#define HIPS_MIN_BAND_HEIGHT 64
+
 class HIPSRenderer : public QObject
 {
   Q_OBJECT
 public:
+  typedef struct
+  {
+    int level;
+    int pix;
+    // Microseconds to fetch and project the tile, and to rasterise it summed over all bands
+    qint64 prepare;
+    qint64 raster;
+  } tileTiming_t;
+
+  typedef struct
+  {
+    int tiles;
+    int bands;
+    // Microseconds spent collecting the visible tiles, rasterising them and in total
+    qint64 collect;
+    qint64 raster;
+    qint64 total;
+    QVector<tileTiming_t> timing;
+  } frameTiming_t;
+
   explicit HIPSRenderer();
   //void render(mapView_t *view, CSkPainter *painter, QImage *pDest);
   bool render(uint16_t w, uint16_t h, QImage *hipsImage, const Projector *m_proj);
   void renderRec(bool allsky, int level, int pix, QImage *pDest);
   bool renderPix(bool allsky, int level, int pix, QImage *pDest);
 
+  const frameTiming_t &lastFrame() const { return m_frame; }
+
 signals:
 
 public slots:
 
-private:  
+private:
+  // A visible tile and its 16 grandchildren projected on screen, ready to be rasterised by any band
+  typedef struct
+  {
+    int level;
+    int pix;
+    QImage *image;
+    bool freeImage;
+    QPointF corners[4];
+    QPointF fine[16][4];
+    // Screen rows covered by the grandchildren
+    double top;
+    double bottom;
+  } tile_t;
+
+  void rasterBand(int band, int minY, int maxY, const bkTarget_t &target);
+  void prefetch(int level, double ra, double de);
+  void drawGrid(const tile_t &tile, QImage *pDest);
+
   int m_blocks { 0 };
   int m_rendered { 0 };
   int m_size { 0 };
   QSet<int>  m_renderedMap;
+  QVector<tile_t> m_tiles;
+  // Raster microseconds of each tile per band, merged once all bands are done
+  std::vector<QVector<qint64>> m_bandTiming;
+  frameTiming_t m_frame;
   std::unique_ptr<HEALPix> m_HEALpix;
-  std::unique_ptr<ScanRender> m_scanRender;
+  // One scan converter per band, they keep the scanlines of the polygon being filled
+  std::vector<std::unique_ptr<ScanRender>> m_scanRenders;
   const Projector *m_projector;
   QColor gridColor;
+  // Center of the previous frame, to follow the pan direction
+  int m_lastLevel { -1 };
+  double m_lastRA { 0 };
+  double m_lastDE { 0 };
 };
@@ -0,0 +1,560 @@
+/*  HiPS Tile Store
+    Copyright (C) 2020 KStars Developers
+
+    This application is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public
+    License as published by the Free Software Foundation; either
+    version 2 of the License, or (at your option) any later version.
+ */
+
+#include "hipstilestore.h"
+
+#include "kstars_debug.h"
+
+#include <QDataStream>
+#include <QDir>
+#include <QSaveFile>
+#include <QVector>
+#include <QtConcurrent>
+
+#include <algorithm>
+
+// "HIPS" in front of every record of the data file
+#define HIPS_STORE_MAGIC 0x53504948
+// "HIDX" at the start of the index file
+#define HIPS_INDEX_MAGIC 0x58444948
+#define HIPS_INDEX_VERSION 1
+// tiles inserted between saves of the index
+#define HIPS_INDEX_SYNC 64
+
+HIPSTileStore::HIPSTileStore()
+{
+  QObject::connect(&m_compaction, &QFutureWatcher<QVector<qint64>>::finished, [this]()
+  {
+    finishCompaction();
+  });
+}
+
+HIPSTileStore::~HIPSTileStore()
+{
+  close();
+}
+
+bool HIPSTileStore::open(const QString &directory)
+{
+  close();
+
+  m_directory = directory;
+  QDir().mkpath(directory);
+
+  m_data.setFileName(QDir(directory).filePath("tiles.dat"));
+  if (m_data.open(QIODevice::ReadWrite) == false)
+  {
+    qCWarning(KSTARS) << "Cannot open HiPS tile store" << m_data.fileName() << m_data.errorString();
+    return false;
+  }
+
+  if (loadIndex() == false)
+  {
+    rebuildIndex();
+  }
+
+  map();
+
+  if (m_data.size() - m_liveBytes > m_liveBytes / 2)
+  {
+    compact();
+  }
+
+  qCDebug(KSTARS) << "HiPS tile store has" << m_index.count() << "tiles in" << m_liveBytes << "bytes";
+  return true;
+}
+
+void HIPSTileStore::close()
+{
+  if (m_data.isOpen() == false)
+  {
+    return;
+  }
+
+  cancelCompaction();
+  saveIndex();
+  unmap();
+  m_data.close();
+
+  m_index.clear();
+  m_liveBytes = 0;
+}
+
+bool HIPSTileStore::contains(const pixCacheKey_t &key) const
+{
+  return m_index.contains(key);
+}
+
+bool HIPSTileStore::find(const pixCacheKey_t &key, QByteArray &data)
+{
+  auto entry = m_index.find(key);
+
+  if (entry == m_index.end())
+  {
+    return false;
+  }
+
+  const qint64 offset = entry->offset + sizeof(record_t);
+
+  // Tiles appended since the file was last mapped are past its end
+  if (offset + entry->size > m_mapSize)
+  {
+    map();
+  }
+
+  if (m_map != nullptr && offset + entry->size <= m_mapSize)
+  {
+    data = QByteArray(reinterpret_cast<const char *>(m_map + offset), entry->size);
+  }
+  else
+  {
+    // The file could not be mapped, read it instead
+    if (m_data.seek(offset) == false)
+    {
+      return false;
+    }
+
+    data = m_data.read(entry->size);
+  }
+
+  if (data.size() != static_cast<int>(entry->size))
+  {
+    qCWarning(KSTARS) << "HiPS tile store cannot read tile" << key.level << key.pix;
+    m_liveBytes -= sizeof(record_t) + entry->size;
+    m_index.erase(entry);
+    return false;
+  }
+
+  entry->lastUsed = ++m_clock;
+  return true;
+}
+
+void HIPSTileStore::insert(const pixCacheKey_t &key, const QByteArray &data)
+{
+  if (m_data.isOpen() == false || data.isEmpty())
+  {
+    return;
+  }
+
+  record_t record;
+  record.magic = HIPS_STORE_MAGIC;
+  record.size  = data.size();
+  record.uid   = key.uid;
+  record.level = key.level;
+  record.pix   = key.pix;
+
+  const qint64 offset = m_data.size();
+
+  if (m_data.seek(offset) == false ||
+      m_data.write(reinterpret_cast<const char *>(&record), sizeof(record)) != sizeof(record) ||
+      m_data.write(data) != data.size() || m_data.flush() == false)
+  {
+    qCWarning(KSTARS) << "HiPS tile store write failed" << m_data.errorString();
+    m_data.resize(offset);
+    return;
+  }
+
+  // A tile stored again leaves its old record behind until the next compaction
+  auto previous = m_index.constFind(key);
+  if (previous != m_index.constEnd())
+  {
+    m_liveBytes -= sizeof(record_t) + previous->size;
+  }
+
+  m_index.insert(key, { offset, record.size, ++m_clock });
+  m_liveBytes += sizeof(record_t) + record.size;
+
+  evict();
+
+  if (++m_unsaved >= HIPS_INDEX_SYNC)
+  {
+    saveIndex();
+  }
+}
+
+void HIPSTileStore::clear()
+{
+  if (m_data.isOpen() == false)
+  {
+    return;
+  }
+
+  cancelCompaction();
+  unmap();
+  m_data.resize(0);
+
+  m_index.clear();
+  m_liveBytes = 0;
+
+  saveIndex();
+}
+
+void HIPSTileStore::setMaximumSize(qint64 size)
+{
+  m_maxSize = size;
+  evict();
+}
+
+bool HIPSTileStore::map()
+{
+  unmap();
+
+  m_mapSize = m_data.size();
+
+  if (m_mapSize == 0)
+  {
+    return true;
+  }
+
+  m_map = m_data.map(0, m_mapSize);
+
+  if (m_map == nullptr)
+  {
+    qCWarning(KSTARS) << "Cannot map HiPS tile store" << m_data.errorString();
+    m_mapSize = 0;
+    return false;
+  }
+
+  return true;
+}
+
+void HIPSTileStore::unmap()
+{
+  if (m_map != nullptr)
+  {
+    m_data.unmap(m_map);
+  }
+
+  m_map = nullptr;
+  m_mapSize = 0;
+}
+
+bool HIPSTileStore::loadIndex()
+{
+  QFile file(QDir(m_directory).filePath("tiles.idx"));
+
+  if (file.open(QIODevice::ReadOnly) == false)
+  {
+    return false;
+  }
+
+  QDataStream in(&file);
+
+  quint32 magic = 0, version = 0;
+  qint64 dataSize = 0;
+  quint64 clock = 0;
+  qint32 count = 0;
+
+  in >> magic >> version >> dataSize >> clock >> count;
+
+  // The data file changed after the index was saved, for example when KStars did not exit cleanly
+  if (magic != HIPS_INDEX_MAGIC || version != HIPS_INDEX_VERSION || dataSize != m_data.size())
+  {
+    return false;
+  }
+
+  m_index.clear();
+  m_index.reserve(count);
+  m_liveBytes = 0;
+
+  for (int i = 0; i < count; i++)
+  {
+    pixCacheKey_t key;
+    entry_t entry;
+
+    in >> key.uid >> key.level >> key.pix >> entry.offset >> entry.size >> entry.lastUsed;
+
+    if (in.status() != QDataStream::Ok || entry.offset + static_cast<qint64>(sizeof(record_t)) + entry.size > dataSize)
+    {
+      m_index.clear();
+      m_liveBytes = 0;
+      return false;
+    }
+
+    m_index.insert(key, entry);
+    m_liveBytes += sizeof(record_t) + entry.size;
+  }
+
+  m_clock = clock;
+  return true;
+}
+
+void HIPSTileStore::saveIndex()
+{
+  QSaveFile file(QDir(m_directory).filePath("tiles.idx"));
+
+  if (file.open(QIODevice::WriteOnly) == false)
+  {
+    qCWarning(KSTARS) << "Cannot save HiPS tile store index" << file.errorString();
+    return;
+  }
+
+  QDataStream out(&file);
+
+  out << static_cast<quint32>(HIPS_INDEX_MAGIC) << static_cast<quint32>(HIPS_INDEX_VERSION) << m_data.size()
+      << m_clock << static_cast<qint32>(m_index.count());
+
+  for (auto entry = m_index.constBegin(); entry != m_index.constEnd(); ++entry)
+  {
+    out << entry.key().uid << entry.key().level << entry.key().pix << entry->offset << entry->size << entry->lastUsed;
+  }
+
+  if (file.commit() == false)
+  {
+    qCWarning(KSTARS) << "Cannot save HiPS tile store index" << file.errorString();
+    return;
+  }
+
+  m_unsaved = 0;
+}
+
+void HIPSTileStore::rebuildIndex()
+{
+  m_index.clear();
+  m_liveBytes = 0;
+  m_clock = 0;
+
+  const qint64 dataSize = m_data.size();
+  qint64 offset = 0;
+
+  while (offset + static_cast<qint64>(sizeof(record_t)) <= dataSize)
+  {
+    record_t record;
+
+    if (m_data.seek(offset) == false ||
+        m_data.read(reinterpret_cast<char *>(&record), sizeof(record)) != sizeof(record) ||
+        record.magic != HIPS_STORE_MAGIC || offset + static_cast<qint64>(sizeof(record)) + record.size > dataSize)
+    {
+      break;
+    }
+
+    pixCacheKey_t key;
+    key.uid = record.uid;
+    key.level = record.level;
+    key.pix = record.pix;
+
+    auto previous = m_index.constFind(key);
+    if (previous != m_index.constEnd())
+    {
+      m_liveBytes -= sizeof(record_t) + previous->size;
+    }
+
+    // Usage is lost with the index, later tiles count as more recent
+    m_index.insert(key, { offset, record.size, ++m_clock });
+    m_liveBytes += sizeof(record_t) + record.size;
+
+    offset += sizeof(record) + record.size;
+  }
+
+  // Drop a record torn by a crash while it was written
+  if (offset < dataSize)
+  {
+    qCWarning(KSTARS) << "HiPS tile store truncated at" << offset << "of" << dataSize << "bytes";
+    m_data.resize(offset);
+  }
+
+  qCInfo(KSTARS) << "Rebuilt HiPS tile store index with" << m_index.count() << "tiles";
+  saveIndex();
+}
+
+void HIPSTileStore::evict()
+{
+  if (m_maxSize <= 0 || m_liveBytes <= m_maxSize)
+  {
+    return;
+  }
+
+  QVector<QPair<quint64, pixCacheKey_t>> ages;
+  ages.reserve(m_index.count());
+
+  for (auto entry = m_index.constBegin(); entry != m_index.constEnd(); ++entry)
+  {
+    ages.append(qMakePair(entry->lastUsed, entry.key()));
+  }
+
+  std::sort(ages.begin(), ages.end(), [](const QPair<quint64, pixCacheKey_t> &a, const QPair<quint64, pixCacheKey_t> &b)
+  {
+    return a.first < b.first;
+  });
+
+  // Drop to 90% of the maximum so eviction does not run again on the next insert
+  const qint64 target = m_maxSize / 10 * 9;
+
+  for (const QPair<quint64, pixCacheKey_t> &age : ages)
+  {
+    if (m_liveBytes <= target)
+    {
+      break;
+    }
+
+    m_liveBytes -= sizeof(record_t) + m_index.value(age.second).size;
+    m_index.remove(age.second);
+  }
+
+  if (m_data.size() - m_liveBytes > m_liveBytes / 2)
+  {
+    compact();
+  }
+}
+
+void HIPSTileStore::compact()
+{
+  if (m_compaction.isRunning())
+  {
+    return;
+  }
+
+  m_moves.clear();
+  m_moves.reserve(m_index.count());
+
+  for (auto entry = m_index.constBegin(); entry != m_index.constEnd(); ++entry)
+  {
+    m_moves.append({ entry.key(), entry->offset, static_cast<qint64>(sizeof(record_t) + entry->size) });
+  }
+
+  // Keep the records in file order so the copy reads sequentially
+  std::sort(m_moves.begin(), m_moves.end(), [](const move_t &a, const move_t &b)
+  {
+    return a.offset < b.offset;
+  });
+
+  // Tiles inserted while the copy runs are appended past this size, finishCompaction() copies them
+  m_compactedSize = m_data.size();
+  m_compaction.setFuture(QtConcurrent::run(&HIPSTileStore::copyRecords, m_data.fileName(),
+                                           QDir(m_directory).filePath("tiles.dat.new"), m_moves));
+}
+
+QVector<qint64> HIPSTileStore::copyRecords(const QString &source, const QString &target, const QVector<move_t> &moves)
+{
+  QFile data(source);
+  QFile compacted(target);
+
+  if (data.open(QIODevice::ReadOnly) == false ||
+      compacted.open(QIODevice::WriteOnly | QIODevice::Truncate) == false)
+  {
+    qCWarning(KSTARS) << "Cannot compact HiPS tile store" << data.errorString() << compacted.errorString();
+    return QVector<qint64>();
+  }
+
+  QVector<qint64> offsets;
+  offsets.reserve(moves.count());
+  qint64 offset = 0;
+
+  for (const move_t &move : moves)
+  {
+    QByteArray record;
+
+    if (data.seek(move.offset))
+    {
+      record = data.read(move.bytes);
+    }
+
+    if (record.size() != move.bytes || compacted.write(record) != move.bytes)
+    {
+      qCWarning(KSTARS) << "Cannot compact HiPS tile store" << compacted.errorString();
+      compacted.remove();
+      return QVector<qint64>();
+    }
+
+    offsets.append(offset);
+    offset += move.bytes;
+  }
+
+  return offsets;
+}
+
+void HIPSTileStore::finishCompaction()
+{
+  const QVector<qint64> copied = m_compaction.result();
+  QFile compacted(QDir(m_directory).filePath("tiles.dat.new"));
+
+  // Nothing to swap in if the copy failed or the store was closed meanwhile
+  if (m_data.isOpen() == false || m_moves.isEmpty() || copied.count() != m_moves.count())
+  {
+    m_moves.clear();
+    compacted.remove();
+    return;
+  }
+
+  QHash<pixCacheKey_t, qint64> offsets;
+  for (int i = 0; i < m_moves.count(); i++)
+  {
+    offsets.insert(m_moves[i].key, copied[i]);
+  }
+  m_moves.clear();
+
+  if (compacted.open(QIODevice::Append) == false)
+  {
+    qCWarning(KSTARS) << "Cannot compact HiPS tile store" << compacted.errorString();
+    compacted.remove();
+    return;
+  }
+
+  // Tiles stored while the copy ran are still in the old file only, tiles evicted meanwhile are left out
+  for (auto entry = m_index.constBegin(); entry != m_index.constEnd(); ++entry)
+  {
+    if (entry->offset < m_compactedSize)
+    {
+      continue;
+    }
+
+    const qint64 bytes = sizeof(record_t) + entry->size;
+    QByteArray record;
+
+    if (m_data.seek(entry->offset))
+    {
+      record = m_data.read(bytes);
+    }
+
+    offsets.insert(entry.key(), compacted.pos());
+
+    if (record.size() != bytes || compacted.write(record) != bytes)
+    {
+      qCWarning(KSTARS) << "Cannot compact HiPS tile store" << compacted.errorString();
+      compacted.remove();
+      return;
+    }
+  }
+
+  compacted.close();
+
+  unmap();
+  m_data.close();
+
+  if (QFile::remove(m_data.fileName()) == false || compacted.rename(m_data.fileName()) == false)
+  {
+    qCWarning(KSTARS) << "Cannot replace HiPS tile store" << m_data.fileName();
+    m_data.open(QIODevice::ReadWrite);
+    rebuildIndex();
+    map();
+    return;
+  }
+
+  m_data.open(QIODevice::ReadWrite);
+
+  for (auto entry = m_index.begin(); entry != m_index.end(); ++entry)
+  {
+    entry->offset = offsets.value(entry.key());
+  }
+
+  map();
+  saveIndex();
+}
+
+void HIPSTileStore::cancelCompaction()
+{
+  if (m_moves.isEmpty())
+  {
+    return;
+  }
+
+  m_compaction.waitForFinished();
+  m_moves.clear();
+  QFile::remove(QDir(m_directory).filePath("tiles.dat.new"));
+}
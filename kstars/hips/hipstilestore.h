@@ -0,0 +1,109 @@
+/*  HiPS Tile Store
+    Copyright (C) 2020 KStars Developers
+
+    This application is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public
+    License as published by the Free Software Foundation; either
+    version 2 of the License, or (at your option) any later version.
+ */
+
+#pragma once
+
+#include "hips.h"
+
+#include <QFile>
+#include <QFutureWatcher>
+#include <QHash>
+#include <QString>
+#include <QVector>
+
+/**
+ * @class HIPSTileStore
+ * @short Packed on-disk store of encoded HiPS tiles keyed by survey uid, order and pix.
+ *
+ * Tiles are appended to a single data file, each behind a small record header, and read back through a memory
+ * map. An index file maps every key to its record and the last time it was used. Once the tiles exceed the
+ * maximum size the least recently used ones are dropped, and the data file is compacted when the space they
+ * leave behind grows to half the live tiles. The compaction copies the tiles on a worker thread while tiles are
+ * still read and appended, and the copy replaces the data file once it is done. If the index is lost or does not
+ * match the data file, it is rebuilt from the record headers.
+ *
+ * The store is not thread safe, HIPSManager uses it from the GUI thread only.
+ */
+class HIPSTileStore
+{
+public:
+  HIPSTileStore();
+  ~HIPSTileStore();
+
+  bool open(const QString &directory);
+  // Save the index and release the files
+  void close();
+
+  bool contains(const pixCacheKey_t &key) const;
+  // Copy the encoded tile into data and mark it as used
+  bool find(const pixCacheKey_t &key, QByteArray &data);
+  void insert(const pixCacheKey_t &key, const QByteArray &data);
+  void clear();
+
+  void setMaximumSize(qint64 size);
+  // Bytes used by the tiles in the index, without the space left by dropped tiles
+  qint64 size() const { return m_liveBytes; }
+  int count() const { return m_index.count(); }
+
+private:
+  // Header in front of each tile in the data file
+  typedef struct
+  {
+    quint32 magic;
+    quint32 size;
+    qint64  uid;
+    qint32  level;
+    qint32  pix;
+  } record_t;
+
+  typedef struct
+  {
+    qint64  offset;
+    quint32 size;
+    quint64 lastUsed;
+  } entry_t;
+
+  // A record copied by the compaction
+  typedef struct
+  {
+    pixCacheKey_t key;
+    qint64 offset;
+    // Header included
+    qint64 bytes;
+  } move_t;
+
+  bool map();
+  void unmap();
+  bool loadIndex();
+  void saveIndex();
+  void rebuildIndex();
+  void evict();
+  void compact();
+  void finishCompaction();
+  // Wait for a running compaction and drop its copy
+  void cancelCompaction();
+  // Runs on the worker, returns the offsets of the records in the copy or nothing if it failed
+  static QVector<qint64> copyRecords(const QString &source, const QString &target, const QVector<move_t> &moves);
+
+  QString m_directory;
+  QFile m_data;
+  uchar *m_map { nullptr };
+  qint64 m_mapSize { 0 };
+  QHash<pixCacheKey_t, entry_t> m_index;
+  qint64 m_maxSize { 0 };
+  qint64 m_liveBytes { 0 };
+  // Increases on every use, the smallest lastUsed is the least recently used tile
+  quint64 m_clock { 0 };
+  int m_unsaved { 0 };
+
+  QFutureWatcher<QVector<qint64>> m_compaction;
+  // Records being copied, and the size of the data file when the copy started
+  QVector<move_t> m_moves;
+  qint64 m_compactedSize { 0 };
+};
@@ -11,6 +11,7 @@
 #include "opships.h"
 
 #include "kstars.h"
+#include "kstarsdata.h"
 #include "hipsmanager.h"
 #include "Options.h"
 #include "skymap.h"
@@ -26,6 +27,8 @@
 #include <QPushButton>
 #include <QStringList>
 
+#include <cmath>
+
 static const QStringList hipsKeys = { "ID", "obs_title", "obs_description", "hips_order", "hips_frame", "hips_tile_width", "hips_tile_format", "hips_service_url", "moc_sky_fraction"};
 
 OpsHIPSDisplay::OpsHIPSDisplay() : QFrame(KStars::Instance())
@@ -36,6 +39,34 @@ OpsHIPSDisplay::OpsHIPSDisplay() : QFrame(KStars::Instance())
 OpsHIPSCache::OpsHIPSCache() : QFrame(KStars::Instance())
 {
     setupUi(this);
+
+    connect(seedB, &QPushButton::clicked, this, &OpsHIPSCache::slotSeed);
+    connect(HIPSManager::Instance(), &HIPSManager::sigSeedProgress, this, &OpsHIPSCache::seedProgress);
+}
+
+void OpsHIPSCache::slotSeed()
+{
+    SkyPoint center = SkyMap::Instance()->getCenterPoint();
+    center.deprecess(KStarsData::Instance()->updateNum());
+
+    // The region is the circle through the corners of the map, half its diagonal away from the center
+    SkyMap *map = SkyMap::Instance();
+    const double halfDiagonal = std::hypot(map->width(), map->height()) / 2;
+    const double radius = halfDiagonal / Options::zoomFactor() / dms::DegToRad;
+
+    // Orders finer than the view are what zooming in needs
+    const int queued = HIPSManager::Instance()->seedRegion(center, radius, 0, HIPSManager::Instance()->getCurrentOrder());
+
+    if (queued == 0)
+        seedStatusLabel->setText(i18n("All tiles of the view are already saved."));
+}
+
+void OpsHIPSCache::seedProgress(int done, int total)
+{
+    if (done >= total)
+        seedStatusLabel->setText(i18np("Saved %1 tile.", "Saved %1 tiles.", total));
+    else
+        seedStatusLabel->setText(i18n("Saving tiles: %1 of %2", done, total));
 }
 
 OpsHIPS::OpsHIPS() : QFrame(KStars::Instance())
@@ -30,6 +30,10 @@ class OpsHIPSCache : public QFrame, public Ui::OpsHIPSCache
 
   public:
     explicit OpsHIPSCache();
+
+  protected slots:
+    void slotSeed();
+    void seedProgress(int done, int total);
 };
 
 /**
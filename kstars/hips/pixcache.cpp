@@ -18,11 +18,6 @@
 
 #include "pixcache.h"
 
-static int qHash(const pixCacheKey_t &key, uint seed)
-{
-  return qHash(QString("%1_%2_%3").arg(key.level).arg(key.pix).arg(key.uid), seed);
-}
-
 inline bool operator<(const pixCacheKey_t &k1, const pixCacheKey_t &k2)
 {
   if (k1.uid != k2.uid)
@@ -38,14 +33,9 @@ inline bool operator<(const pixCacheKey_t &k1, const pixCacheKey_t &k2)
   return k1.pix < k2.pix;
 }
 
-inline bool operator==(const pixCacheKey_t &k1, const pixCacheKey_t &k2)
-{
-  return (k1.uid == k2.uid) && (k1.level == k2.level) && (k1.pix == k2.pix);
-}
-
 void PixCache::add(pixCacheKey_t &key, pixCacheItem_t *item, int cost)
 {
-  Q_ASSERT(cost < m_cache.maxCost());
+  Q_ASSERT(cost < m_maxCost);
 
   m_cache.insert(key, item, cost);
 }
@@ -55,18 +45,42 @@ pixCacheItem_t *PixCache::get(pixCacheKey_t &key)
   return m_cache.object(key);
 }
 
+bool PixCache::contains(const pixCacheKey_t &key) const
+{
+  return m_cache.contains(key);
+}
+
 void PixCache::setMaxCost(int maxCost)
 {
-  m_cache.setMaxCost(maxCost);
+  m_maxCost = maxCost;
+  updateMaxCost();
+}
+
+void PixCache::reserve(int cost)
+{
+  m_pending += cost;
+  updateMaxCost();
+}
+
+void PixCache::release(int cost)
+{
+  m_pending = qMax(0, m_pending - cost);
+  updateMaxCost();
+}
+
+void PixCache::updateMaxCost()
+{
+  // Decoded images are evicted as soon as the pending ones would not fit
+  m_cache.setMaxCost(qMax(0, m_maxCost - m_pending));
 }
 
 void PixCache::printCache()
 {
   qDebug() << " -- cache ---------------";
-  qDebug() << m_cache.size() << m_cache.totalCost() << m_cache.maxCost();
+  qDebug() << m_cache.size() << m_cache.totalCost() << m_pending << m_maxCost;
 }
 
 int PixCache::used()
 {
-  return m_cache.totalCost();
+  return m_cache.totalCost() + m_pending;
 }
@@ -29,11 +29,19 @@ public:
 
   void add(pixCacheKey_t &key, pixCacheItem_t *item, int cost);
   pixCacheItem_t *get(pixCacheKey_t &key);
+  bool contains(const pixCacheKey_t &key) const;
   void setMaxCost(int maxCost);
+  // Hold room for an image still being decoded, so it does not overrun the cache once added
+  void reserve(int cost);
+  void release(int cost);
   void printCache();
   int  used();
 
 private:  
+  void updateMaxCost();
+
   QCache <pixCacheKey_t, pixCacheItem_t> m_cache;
+  int m_maxCost { 0 };
+  int m_pending { 0 };
 };
 
@@ -51,6 +51,14 @@ bool ScanRender::isBilinearInterpolationEnabled()
   return(bBilinear);
 }
 
+///////////////////////////////////////////////////
+void ScanRender::setClipBand(int minY, int maxY)
+///////////////////////////////////////////////////
+{
+  m_clipMinY = minY;
+  m_clipMaxY = maxY;
+}
+
 ///////////////////////////////////////////////
 void ScanRender::resetScanPoly(int sx, int sy)
 ///////////////////////////////////////////////
@@ -66,6 +74,8 @@ void ScanRender::resetScanPoly(int sx, int sy)
 
   m_sx = sx;
   m_sy = sy;
+  m_minY = qMax(0, m_clipMinY);
+  m_maxY = qMin(sy, m_clipMaxY);
 }
 
 //////////////////////////////////////////////////////////
@@ -85,12 +95,12 @@ void ScanRender::scanLine(int x1, int y1, int x2, int y2)
     side = 1;
   }
 
-  if (y2 < 0)
+  if (y2 < m_minY)
   {
     return; // offscreen
   }
 
-  if (y1 >= m_sy)
+  if (y1 >= m_maxY)
   {
     return; // offscreen
   }
@@ -106,17 +116,17 @@ void ScanRender::scanLine(int x1, int y1, int x2, int y2)
   float x = x1;
   int   y;
 
-  if (y2 >= m_sy)
+  if (y2 >= m_maxY)
   {
-    y2 = m_sy - 1;
+    y2 = m_maxY - 1;
   }
 
-  if (y1 < 0)
+  if (y1 < m_minY)
   { // partially off screen
-    float m = (float) -y1;
+    float m = (float) (m_minY - y1);
 
     x += dx * m;
-    y1 = 0;
+    y1 = m_minY;
   }
 
   int minY = qMin(y1, y2);
@@ -180,9 +190,9 @@ void ScanRender::scanLine(int x1, int y1, int x2, int y2, float u1, float v1, fl
     side = 1;
   }
 
-  if (y2 < 0)
+  if (y2 < m_minY)
     return; // offscreen
-  if (y1 >= m_sy)
+  if (y1 >= m_maxY)
     return; // offscreen
 
   float dy = (float)(y2 - y1);
@@ -194,8 +204,8 @@ void ScanRender::scanLine(int x1, int y1, int x2, int y2, float u1, float v1, fl
   float x = x1;
   int   y;
 
-  if (y2 >= m_sy)
-    y2 = m_sy - 1;
+  if (y2 >= m_maxY)
+    y2 = m_maxY - 1;
 
   float duv[2];
   float uv[2] = {u1, v1};
@@ -203,15 +213,15 @@ void ScanRender::scanLine(int x1, int y1, int x2, int y2, float u1, float v1, fl
   duv[0] = (u2 - u1) / dy;
   duv[1] = (v2 - v1) / dy;
 
-  if (y1 < 0)
+  if (y1 < m_minY)
   { // partially off screen
-    float m = (float) -y1;
+    float m = (float) (m_minY - y1);
 
     uv[0] += duv[0] * m;
     uv[1] += duv[1] * m;
 
     x += dx * m;
-    y1 = 0;
+    y1 = m_minY;
   }
 
   int minY = qMin(y1, y2);
@@ -237,12 +247,12 @@ void ScanRender::scanLine(int x1, int y1, int x2, int y2, float u1, float v1, fl
 
 
 ////////////////////////////////////////////////////////
-void ScanRender::renderPolygon(QColor col, QImage *dst)
+void ScanRender::renderPolygon(QColor col, const bkTarget_t &dst)
 ////////////////////////////////////////////////////////
 { 
   quint32   c = col.rgb();
-  quint32  *bits = (quint32 *)dst->bits();
-  int       dw = dst->width();
+  quint32  *bits = dst.bits;
+  int       dw = dst.stride;
   bkScan_t *scan = scLR;
 
   for (int y = plMinY; y <= plMaxY; y++)
@@ -284,12 +294,12 @@ void ScanRender::renderPolygon(QColor col, QImage *dst)
 
 
 /////////////////////////////////////////////////////////////
-void ScanRender::renderPolygonAlpha(QColor col, QImage *dst)
+void ScanRender::renderPolygonAlpha(QColor col, const bkTarget_t &dst)
 /////////////////////////////////////////////////////////////
 {
   quint32   c = col.rgba();
-  quint32  *bits = (quint32 *)dst->bits();
-  int       dw = dst->width();
+  quint32  *bits = dst.bits;
+  int       dw = dst.stride;
   bkScan_t *scan = scLR;
   float     a = qAlpha(c) / 256.0f;
   int       rc = qRed(c);
@@ -336,7 +346,7 @@ void ScanRender::setOpacity(float opacity)
 }
 
 /////////////////////////////////////////////////////////
-void ScanRender::renderPolygon(QImage *dst, QImage *src)
+void ScanRender::renderPolygon(const bkTarget_t &dst, QImage *src)
 /////////////////////////////////////////////////////////
 {
   if (bBilinear)
@@ -345,7 +355,7 @@ void ScanRender::renderPolygon(QImage *dst, QImage *src)
     renderPolygonNI(dst, src);
 }
 
-void ScanRender::renderPolygon(int interpolation, QPointF *pts, QImage *pDest, QImage *pSrc, QPointF *uv)
+void ScanRender::renderPolygon(int interpolation, QPointF *pts, const bkTarget_t &dst, QImage *pSrc, QPointF *uv)
 {
   QPointF Auv = uv[0];
   QPointF Buv = uv[1];
@@ -354,12 +364,12 @@ void ScanRender::renderPolygon(int interpolation, QPointF *pts, QImage *pDest, Q
 
   if (interpolation < 2)
   {
-    resetScanPoly(pDest->width(), pDest->height());
+    resetScanPoly(dst.width, dst.height);
     scanLine(pts[0].x(), pts[0].y(), pts[1].x(), pts[1].y(), 1, 1, 1, 0);
     scanLine(pts[1].x(), pts[1].y(), pts[2].x(), pts[2].y(), 1, 0, 0, 0);
     scanLine(pts[2].x(), pts[2].y(), pts[3].x(), pts[3].y(), 0, 0, 0, 1);
     scanLine(pts[3].x(), pts[3].y(), pts[0].x(), pts[0].y(), 0, 1, 1, 1);
-    renderPolygon(pDest, pSrc);
+    renderPolygon(dst, pSrc);
     return;
   }
 
@@ -398,12 +408,12 @@ void ScanRender::renderPolygon(int interpolation, QPointF *pts, QImage *pDest, Q
       QPointF D1 = Q1 + j * (Q2 - Q1) / interpolation;
       QPointF D1uv = Q1uv + j * (Q2uv - Q1uv) / interpolation;
 
-      resetScanPoly(pDest->width(), pDest->height());
+      resetScanPoly(dst.width, dst.height);
       scanLine(A1.x(), A1.y(), B1.x(), B1.y(), A1uv.x(), A1uv.y(), B1uv.x(), B1uv.y());
       scanLine(B1.x(), B1.y(), C1.x(), C1.y(), B1uv.x(), B1uv.y(), C1uv.x(), C1uv.y());
       scanLine(C1.x(), C1.y(), D1.x(), D1.y(), C1uv.x(), C1uv.y(), D1uv.x(), D1uv.y());
       scanLine(D1.x(), D1.y(), A1.x(), A1.y(), D1uv.x(), D1uv.y(), A1uv.x(), A1uv.y());
-      renderPolygon(pDest, pSrc);
+      renderPolygon(dst, pSrc);
 
       //p->drawLine(A1, B1);
       //p->drawLine(B1, C1);
@@ -414,16 +424,16 @@ void ScanRender::renderPolygon(int interpolation, QPointF *pts, QImage *pDest, Q
 }
 
 ///////////////////////////////////////////////////////////
-void ScanRender::renderPolygonNI(QImage *dst, QImage *src)
+void ScanRender::renderPolygonNI(const bkTarget_t &dst, QImage *src)
 ///////////////////////////////////////////////////////////
 {
-  int w = dst->width();
+  int w = dst.width;
   int sw = src->width();
   int sh = src->height();
   float tsx = src->width() - 1;
   float tsy = src->height() - 1;
   const quint32 *bitsSrc = (quint32 *)src->constBits();
-  quint32 *bitsDst = (quint32 *)dst->bits();
+  quint32 *bitsDst = dst.bits;
   bkScan_t *scan = scLR;
   bool bw = src->format() == QImage::Format_Indexed8 || src->format() == QImage::Format_Grayscale8;      
 
@@ -471,7 +481,7 @@ void ScanRender::renderPolygonNI(QImage *dst, QImage *src)
     duv[0] *= tsx;
     duv[1] *= tsy;
 
-    quint32 *pDst = bitsDst + (y * w) + px1;
+    quint32 *pDst = bitsDst + (y * dst.stride) + px1;
 
     int fuv[2];
     int fduv[2];
@@ -516,24 +526,38 @@ void ScanRender::renderPolygonNI(QImage *dst, QImage *src)
 }
 
 
+/////////////////////////////////////////////////////////////////////////////////////////////////
+static inline quint32 bilinearRGB(quint32 a, quint32 b, quint32 c, quint32 d, quint32 fx, quint32 fy)
+/////////////////////////////////////////////////////////////////////////////////////////////////
+{
+  // Weights of the four neighbours out of 256, they always add up to 256
+  const quint32 wd = (fx * fy) >> 8;
+  const quint32 wb = fx - wd;
+  const quint32 wc = fy - wd;
+  const quint32 wa = 256 - fx - fy + wd;
+
+  // Red and blue are blended together in one register and green in another, none can overflow into the next
+  const quint32 rb = ((a & 0xff00ff) * wa + (b & 0xff00ff) * wb + (c & 0xff00ff) * wc + (d & 0xff00ff) * wd) >> 8;
+  const quint32 g  = ((a & 0x00ff00) * wa + (b & 0x00ff00) * wb + (c & 0x00ff00) * wc + (d & 0x00ff00) * wd) >> 8;
+
+  return 0xff000000 | (rb & 0xff00ff) | (g & 0x00ff00);
+}
+
 ///////////////////////////////////////////////////////////
-void ScanRender::renderPolygonBI(QImage *dst, QImage *src)
+void ScanRender::renderPolygonBI(const bkTarget_t &dst, QImage *src)
 ///////////////////////////////////////////////////////////
 {
-  int w = dst->width();
+  int w = dst.width;
   int sw = src->width();
   int sh = src->height();
   float tsx = src->width() - 1;
   float tsy = src->height() - 1;
   const quint32 *bitsSrc = (quint32 *)src->constBits();
   const uchar *bitsSrc8 = (uchar *)src->constBits();
-  quint32 *bitsDst = (quint32 *)dst->bits();
+  quint32 *bitsDst = dst.bits;
   bkScan_t *scan = scLR;
   bool bw = src->format() == QImage::Format_Indexed8 || src->format() == QImage::Format_Grayscale8;
 
-#ifdef PARALLEL_OMP
-  #pragma omp parallel for
-#endif
   for (int y = plMinY; y <= plMaxY; y++)
   {
     if (scan[y].scan[0] > scan[y].scan[1])
@@ -571,86 +595,53 @@ void ScanRender::renderPolygonBI(QImage *dst, QImage *src)
     if (px2 >= w)
       px2 = w - 1;
 
-    uv[0] *= tsx;
-    uv[1] *= tsy;
+    // Texture coordinates step in 16.16 fixed point, the top 8 bits of the fraction weight the neighbours
+    int fuv[2];
+    int fduv[2];
 
-    duv[0] *= tsx;
-    duv[1] *= tsy;
+    fuv[0] = uv[0] * tsx * 65536;
+    fuv[1] = uv[1] * tsy * 65536;
 
-    int size = sw * sh;
+    fduv[0] = duv[0] * tsx * 65536;
+    fduv[1] = duv[1] * tsy * 65536;
 
-    quint32 *pDst = bitsDst + (y * w) + px1;
-    if (bw)
-    {
-      for (int x = px1; x < px2; x++)
-      {
-        float x_diff = uv[0] - static_cast<int>(uv[0]);
-        float y_diff = uv[1] - static_cast<int>(uv[1]);
-        float x_1diff = 1 - x_diff;
-        float y_1diff = 1 - y_diff;
-
-        int index = ((int)uv[0] + ((int)uv[1] * sw));
+    quint32 *pDst = bitsDst + (y * dst.stride) + px1;
 
-        uchar a = bitsSrc8[index];
-        uchar b = bitsSrc8[(index + 1) % size];
-        uchar c = bitsSrc8[(index + sw) % size];
-        uchar d = bitsSrc8[(index + sw + 1) % size];
+    for (int x = px1; x < px2; x++)
+    {
+      int sx = CLAMP(fuv[0] >> 16, 0, sw - 1);
+      int sy = CLAMP(fuv[1] >> 16, 0, sh - 1);
+      quint32 fx = (fuv[0] >> 8) & 0xff;
+      quint32 fy = (fuv[1] >> 8) & 0xff;
 
-        int val = (a&0xff)*(x_1diff)*(y_1diff) + (b&0xff)*(x_diff)*(y_1diff) +
-                  (c&0xff)*(y_diff)*(x_1diff)   + (d&0xff)*(x_diff*y_diff);
+      // Neighbours past the last column or row repeat the edge instead of wrapping around
+      int right = (sx < sw - 1) ? 1 : 0;
+      int below = (sy < sh - 1) ? sw : 0;
+      int index = sx + sy * sw;
 
-        *pDst = 0xff000000 |
-                ((((int)val)<<16)&0xff0000) |
-                ((((int)val)<<8)&0xff00) |
-                ((int)val) ;
-        pDst++;
+      if (bw)
+      {
+        const quint32 wd = (fx * fy) >> 8;
+        const quint32 val = (bitsSrc8[index] * (256 - fx - fy + wd) + bitsSrc8[index + right] * (fx - wd) +
+                             bitsSrc8[index + below] * (fy - wd) + bitsSrc8[index + below + right] * wd) >> 8;
 
-        uv[0] += duv[0];
-        uv[1] += duv[1];
+        *pDst = 0xff000000 | (val * 0x010101);
       }
-    }
-    else
-    {
-      for (int x = px1; x < px2; x++)
+      else
       {
-        float x_diff = uv[0] - static_cast<int>(uv[0]);
-        float y_diff = uv[1] - static_cast<int>(uv[1]);
-        float x_1diff = 1 - x_diff;
-        float y_1diff = 1 - y_diff;
-
-        int index = ((int)uv[0] + ((int)uv[1] * sw));
-
-        quint32 a = bitsSrc[index];
-        quint32 b = bitsSrc[(index + 1) % size];
-        quint32 c = bitsSrc[(index + sw) % size];
-        quint32 d = bitsSrc[(index + sw + 1) % size];
-
-        int qxy1 = (x_1diff * y_1diff) * 65536;
-        int qxy2 =(x_diff * y_1diff) * 65536;
-        int qxy = (x_diff * y_diff) * 65536;
-        int qyx1 = (y_diff * x_1diff) * 65536;
-
-        // blue element
-        int blue = ((a&0xff)*(qxy1) + (b&0xff)*(qxy2) + (c&0xff)*(qyx1)  + (d&0xff)*(qxy)) >> 16;
-
-        // green element
-        int green = (((a>>8)&0xff)*(qxy1) + ((b>>8)&0xff)*(qxy2) + ((c>>8)&0xff)*(qyx1)  + ((d>>8)&0xff)*(qxy)) >> 16;
-
-        // red element
-        int red = (((a>>16)&0xff)*(qxy1) + ((b>>16)&0xff)*(qxy2) +((c>>16)&0xff)*(qyx1)  + ((d>>16)&0xff)*(qxy)) >> 16;
-
-        *pDst = 0xff000000 | (((red)<<16)&0xff0000) | (((green)<<8)&0xff00) | (blue);
+        *pDst = bilinearRGB(bitsSrc[index], bitsSrc[index + right], bitsSrc[index + below],
+                            bitsSrc[index + below + right], fx, fy);
+      }
 
-        pDst++;
+      pDst++;
 
-        uv[0] += duv[0];
-        uv[1] += duv[1];
-      }
+      fuv[0] += fduv[0];
+      fuv[1] += fduv[1];
     }
   }
 }
 
-void ScanRender::renderPolygonAlpha(QImage *dst, QImage *src)
+void ScanRender::renderPolygonAlpha(const bkTarget_t &dst, QImage *src)
 {
   if (bBilinear)
     renderPolygonAlphaBI(dst, src);
@@ -659,15 +650,15 @@ void ScanRender::renderPolygonAlpha(QImage *dst, QImage *src)
 }
 
 
-void ScanRender::renderPolygonAlphaBI(QImage *dst, QImage *src)
+void ScanRender::renderPolygonAlphaBI(const bkTarget_t &dst, QImage *src)
 {
-  int w = dst->width();
+  int w = dst.width;
   int sw = src->width();
   int sh = src->height();
   float tsx = src->width() - 1;
   float tsy = src->height() - 1;
   const quint32 *bitsSrc = (quint32 *)src->constBits();  
-  quint32 *bitsDst = (quint32 *)dst->bits();
+  quint32 *bitsDst = dst.bits;
   bkScan_t *scan = scLR;
   bool bw = src->format() == QImage::Format_Indexed8;
   float opacity = (m_opacity / 65536.) * 0.00390625f;
@@ -720,7 +711,7 @@ void ScanRender::renderPolygonAlphaBI(QImage *dst, QImage *src)
 
     int size = sw * sh;
 
-    quint32 *pDst = bitsDst + (y * w) + px1;
+    quint32 *pDst = bitsDst + (y * dst.stride) + px1;
     if (bw)
     {
       /*
@@ -809,15 +800,15 @@ void ScanRender::renderPolygonAlphaBI(QImage *dst, QImage *src)
 
 
 ////////////////////////////////////////////////////////////////
-void ScanRender::renderPolygonAlphaNI(QImage *dst, QImage *src)
+void ScanRender::renderPolygonAlphaNI(const bkTarget_t &dst, QImage *src)
 ////////////////////////////////////////////////////////////////
 {
-  int w = dst->width();
+  int w = dst.width;
   int sw = src->width();
   float tsx = src->width() - 1;
   float tsy = src->height() - 1;
   const quint32 *bitsSrc = (quint32 *)src->constBits();
-  quint32 *bitsDst = (quint32 *)dst->bits();
+  quint32 *bitsDst = dst.bits;
   bkScan_t *scan = scLR;
   float opacity = 0.00390625f * m_opacity;    
 
@@ -861,7 +852,7 @@ void ScanRender::renderPolygonAlphaNI(QImage *dst, QImage *src)
     if (px2 >= w)
       px2 = w - 1;
 
-    quint32 *pDst = bitsDst + (y * w) + px1;
+    quint32 *pDst = bitsDst + (y * dst.stride) + px1;
 
     uv[0] *= tsx;
     uv[1] *= tsy;
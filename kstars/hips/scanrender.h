@@ -31,6 +31,17 @@ typedef struct
   float uv[2][2];
 } bkScan_t;
 
+// Pixels of the destination image, taken once on the thread that owns it so renderers of other bands never
+// call into the image while it is being written
+typedef struct
+{
+  quint32 *bits;
+  // pixels from one row to the next
+  int      stride;
+  int      width;
+  int      height;
+} bkTarget_t;
+
 
 class ScanRender
 {
@@ -38,21 +49,23 @@ class ScanRender
     explicit ScanRender(void);
     void setBilinearInterpolationEnabled(bool enable);
     bool isBilinearInterpolationEnabled(void);
+    // Only rows minY to maxY - 1 are rasterised, so several renderers can fill disjoint bands of one image
+    void setClipBand(int minY, int maxY);
     void resetScanPoly(int sx, int sy);
     void scanLine(int x1, int y1, int x2, int y2);
     void scanLine(int x1, int y1, int x2, int y2, float u1, float v1, float u2, float v2);
-    void renderPolygon(QColor col, QImage *dst);
-    void renderPolygon(QImage *dst, QImage *src);
-    void renderPolygon(int interpolation, QPointF *pts, QImage *pDest, QImage *pSrc, QPointF *uv);
+    void renderPolygon(QColor col, const bkTarget_t &dst);
+    void renderPolygon(const bkTarget_t &dst, QImage *src);
+    void renderPolygon(int interpolation, QPointF *pts, const bkTarget_t &dst, QImage *pSrc, QPointF *uv);
 
-    void renderPolygonNI(QImage *dst, QImage *src);
-    void renderPolygonBI(QImage *dst, QImage *src);
+    void renderPolygonNI(const bkTarget_t &dst, QImage *src);
+    void renderPolygonBI(const bkTarget_t &dst, QImage *src);
 
-    void renderPolygonAlpha(QImage *dst, QImage *src);
-    void renderPolygonAlphaBI(QImage *dst, QImage *src);
-    void renderPolygonAlphaNI(QImage *dst, QImage *src);
+    void renderPolygonAlpha(const bkTarget_t &dst, QImage *src);
+    void renderPolygonAlphaBI(const bkTarget_t &dst, QImage *src);
+    void renderPolygonAlphaNI(const bkTarget_t &dst, QImage *src);
 
-    void renderPolygonAlpha(QColor col, QImage *dst);
+    void renderPolygonAlpha(QColor col, const bkTarget_t &dst);
     void setOpacity(float opacity);
 
 private:
@@ -61,6 +74,11 @@ private:
     int      plMaxY { 0 };
     int      m_sx { 0 };
     int      m_sy { 0 };
+    int      m_clipMinY { 0 };
+    int      m_clipMaxY { MAX_BK_SCANLINES };
+    // Rows of the current polygon that may be rasterised
+    int      m_minY { 0 };
+    int      m_maxY { 0 };
     bkScan_t scLR[MAX_BK_SCANLINES];
     bool     bBilinear { false };
 };
@@ -21,17 +21,17 @@
 #include "urlfiledownload.h"
 #include <QDebug>
 
-UrlFileDownload::UrlFileDownload(QObject *parent, QNetworkDiskCache *cache) : QObject(parent)
+UrlFileDownload::UrlFileDownload(QObject *parent) : QObject(parent)
 {    
   connect(&m_manager, SIGNAL(finished(QNetworkReply*)), this, SLOT(downloadFinished(QNetworkReply*)));
-
-  m_manager.setCache(cache);
 }
 
-void UrlFileDownload::begin(const QUrl &url, const pixCacheKey_t &key)
+void UrlFileDownload::begin(const QUrl &url, const pixCacheKey_t &key, QNetworkRequest::Priority priority)
 {
+  // Tiles are cached by HIPSTileStore
   QNetworkRequest request(url);
-  request.setAttribute(QNetworkRequest::CacheLoadControlAttribute, QNetworkRequest::PreferCache);
+  request.setAttribute(QNetworkRequest::CacheLoadControlAttribute, QNetworkRequest::AlwaysNetwork);
+  request.setPriority(priority);
 
   QNetworkReply *reply = m_manager.get(request);
 
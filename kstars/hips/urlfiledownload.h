@@ -29,8 +29,8 @@ class UrlFileDownload : public QObject
 {
   Q_OBJECT
 public:
-  explicit UrlFileDownload(QObject *parent, QNetworkDiskCache *cache);
-  void begin(const QUrl &url, const pixCacheKey_t &key);
+  explicit UrlFileDownload(QObject *parent);
+  void begin(const QUrl &url, const pixCacheKey_t &key, QNetworkRequest::Priority priority = QNetworkRequest::NormalPriority);
   void abortAll();
 
 signals:
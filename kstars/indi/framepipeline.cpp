@@ -0,0 +1,217 @@
+/*  Captured Frame Pipeline
+    Copyright (C) 2020 KStars Developers
+
+    This application is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public
+    License as published by the Free Software Foundation; either
+    version 2 of the License, or (at your option) any later version.
+ */
+
+#include "framepipeline.h"
+
+#include "fitsviewer/fitsdata.h"
+
+#include "indi_debug.h"
+
+#include <QCoreApplication>
+#include <QMutexLocker>
+#include <QStringList>
+#include <QtConcurrent>
+
+#include <cstring>
+
+FramePipeline::FramePipeline(const std::function<bool(const frame_t &frame)> &writer, QObject *parent)
+    : QObject(parent), m_Writer(writer)
+{
+    m_Worker.setMaxThreadCount(1);
+    memset(&m_Statistics, 0, sizeof(m_Statistics));
+}
+
+FramePipeline::~FramePipeline()
+{
+    // Frames still queued are written, captured data is never dropped
+    m_Worker.waitForDone();
+
+    for (frame_t &frame : m_Ready)
+        delete frame.data;
+}
+
+void FramePipeline::submit(const frame_t &frame)
+{
+    QMutexLocker locker(&m_Mutex);
+
+    m_Queue.append(frame);
+    frame_t &queued = m_Queue.last();
+    queued.written = false;
+    queued.data    = nullptr;
+    queued.hfr     = -1;
+    queued.queued  = 0;
+    memset(queued.timing, 0, sizeof(queued.timing));
+    queued.timer.start();
+
+    m_Pending.append(frame.filename);
+    m_Statistics.deepest = qMax(m_Statistics.deepest, m_Pending.count());
+
+    if (m_Running == false)
+    {
+        m_Running = true;
+        QtConcurrent::run(&m_Worker, this, &FramePipeline::processLoop);
+    }
+}
+
+void FramePipeline::processLoop()
+{
+    while (true)
+    {
+        frame_t frame;
+
+        {
+            QMutexLocker locker(&m_Mutex);
+            if (m_Queue.isEmpty())
+            {
+                m_Running = false;
+                return;
+            }
+
+            frame = m_Queue.takeFirst();
+        }
+
+        process(frame);
+
+        QMutexLocker locker(&m_Mutex);
+        m_Ready.append(frame);
+
+        // The GUI takes all ready frames when it gets to them, one notification is enough
+        if (m_ReadyNotified == false)
+        {
+            m_ReadyNotified = true;
+            emit frameReady();
+        }
+    }
+}
+
+void FramePipeline::process(frame_t &frame)
+{
+    frame.queued = frame.timer.elapsed();
+
+    QElapsedTimer timer;
+    timer.start();
+
+    frame.written = m_Writer(frame);
+    frame.timing[STAGE_WRITE] = timer.elapsed();
+
+    if (frame.written == false || frame.load == false)
+        return;
+
+    timer.restart();
+
+    // Loading from the buffer computes the statistics
+    FITSData *data = new FITSData(frame.mode);
+    if (data->loadFITSFromMemory(frame.filename, frame.buffer, true) == false)
+    {
+        qCWarning(KSTARS_INDI) << "Failed to load captured frame" << frame.filename;
+        delete data;
+        return;
+    }
+    frame.timing[STAGE_STATS] = timer.elapsed();
+
+    if (frame.findStars)
+    {
+        timer.restart();
+        // Viewers find the stars already searched and do not search them again on the GUI thread
+        if (data->findStars() >= 0)
+            frame.hfr = data->getHFR();
+        frame.timing[STAGE_HFR] = timer.elapsed();
+    }
+
+    // Handed to the GUI thread, which owns it from now on
+    data->moveToThread(QCoreApplication::instance()->thread());
+    frame.data = data;
+}
+
+bool FramePipeline::takeFrame(frame_t &frame)
+{
+    QMutexLocker locker(&m_Mutex);
+
+    if (m_Ready.isEmpty())
+    {
+        m_ReadyNotified = false;
+        return false;
+    }
+
+    frame = m_Ready.takeFirst();
+    return true;
+}
+
+void FramePipeline::finish(const frame_t &frame)
+{
+    QMutexLocker locker(&m_Mutex);
+
+    m_Pending.removeOne(frame.filename);
+
+    m_Statistics.frames++;
+    if (frame.written == false)
+        m_Statistics.failed++;
+    m_Statistics.queued += frame.queued;
+    for (int i = 0; i < STAGE_COUNT; i++)
+    {
+        m_Statistics.total[i] += frame.timing[i];
+        m_Statistics.longest[i] = qMax(m_Statistics.longest[i], frame.timing[i]);
+    }
+
+    qCDebug(KSTARS_INDI) << "Processed" << frame.filename << "in" << frame.timer.elapsed() << "ms, queued"
+                         << frame.queued << "ms, write" << frame.timing[STAGE_WRITE] << "ms, stats"
+                         << frame.timing[STAGE_STATS] << "ms, HFR" << frame.timing[STAGE_HFR] << "ms, preview"
+                         << frame.timing[STAGE_PREVIEW] << "ms, upload" << frame.timing[STAGE_UPLOAD] << "ms,"
+                         << m_Pending.count() << "frames pending.";
+
+    // Averages so far whenever the pipeline drains, e.g. at the end of each sequence job
+    if (m_Pending.isEmpty())
+    {
+        QStringList averages;
+        for (int i = 0; i < STAGE_COUNT; i++)
+            averages << QString("%1 %2 ms (max %3 ms)").arg(stageName(static_cast<Stage>(i)))
+                     .arg(m_Statistics.total[i] / static_cast<double>(m_Statistics.frames), 0, 'f', 1)
+                     .arg(m_Statistics.longest[i]);
+
+        qCInfo(KSTARS_INDI) << "Frame pipeline processed" << m_Statistics.frames << "frames, up to"
+                            << m_Statistics.deepest << "at once, average" << averages.join(", ");
+    }
+}
+
+int FramePipeline::pending() const
+{
+    QMutexLocker locker(&m_Mutex);
+    return m_Pending.count();
+}
+
+bool FramePipeline::isPending(const QString &filename) const
+{
+    QMutexLocker locker(&m_Mutex);
+    return m_Pending.contains(filename);
+}
+
+FramePipeline::Statistics FramePipeline::statistics() const
+{
+    QMutexLocker locker(&m_Mutex);
+    return m_Statistics;
+}
+
+const char *FramePipeline::stageName(Stage stage)
+{
+    switch (stage)
+    {
+        case STAGE_WRITE:
+            return "write";
+        case STAGE_STATS:
+            return "stats";
+        case STAGE_HFR:
+            return "HFR";
+        case STAGE_PREVIEW:
+            return "preview";
+        case STAGE_UPLOAD:
+            return "upload";
+        default:
+            return "";
+    }
+}
@@ -0,0 +1,151 @@
+/*  Captured Frame Pipeline
+    Copyright (C) 2020 KStars Developers
+
+    This application is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public
+    License as published by the Free Software Foundation; either
+    version 2 of the License, or (at your option) any later version.
+ */
+
+#pragma once
+
+#include "fitsviewer/fitscommon.h"
+#include "fitsviewer/imagebuffer.h"
+
+#include <QElapsedTimer>
+#include <QList>
+#include <QMutex>
+#include <QObject>
+#include <QString>
+#include <QThreadPool>
+
+#include <functional>
+
+class FITSData;
+
+namespace ISD
+{
+class CCDChip;
+}
+
+/**
+ * @class FramePipeline
+ * Post-processes captured FITS frames while the camera takes the next exposure.
+ *
+ * Each frame goes through the stages write, stats, HFR, preview and upload in that order. Writing the file,
+ * loading the image with its statistics and finding its stars run on a single worker thread. The preview and
+ * upload stages touch the GUI, so the owner runs them on the GUI thread after taking the frame with takeFrame(),
+ * and hands it back with finish() along with how long they took.
+ *
+ * Frames stay in the pipeline from submit() to finish(). The owner bounds their number by holding back the next
+ * exposure while pending() exceeds the depth it allows, see ISD::CCD::setFramePipelineDepth().
+ */
+class FramePipeline : public QObject
+{
+        Q_OBJECT
+
+    public:
+        typedef enum
+        {
+            STAGE_WRITE,
+            STAGE_STATS,
+            STAGE_HFR,
+            STAGE_PREVIEW,
+            STAGE_UPLOAD,
+            STAGE_COUNT
+        } Stage;
+
+        typedef struct
+        {
+            ISD::CCDChip *chip;
+            QString filename;
+            // Filter name added to the FITS header
+            QString filter;
+            ImageBuffer buffer;
+            FITSMode mode;
+            // Load the image and its statistics for the preview
+            bool load;
+            // Find stars and measure their HFR, only if loaded
+            bool findStars;
+
+            // Set by the worker
+            bool written;
+            FITSData *data;
+            double hfr;
+            // Milliseconds spent in each stage
+            qint64 timing[STAGE_COUNT];
+            // Milliseconds between submit and the worker picking the frame up
+            qint64 queued;
+            // Started on submit
+            QElapsedTimer timer;
+        } frame_t;
+
+        typedef struct
+        {
+            // Frames finished
+            quint64 frames;
+            // Frames that could not be written
+            quint64 failed;
+            // Total and longest milliseconds spent in each stage
+            qint64 total[STAGE_COUNT];
+            qint64 longest[STAGE_COUNT];
+            // Total milliseconds frames waited for the worker
+            qint64 queued;
+            // Most frames in the pipeline at once
+            int deepest;
+        } Statistics;
+
+        /**
+         * @param writer Writes a frame buffer to its file and updates its FITS header, called from the worker.
+         */
+        explicit FramePipeline(const std::function<bool(const frame_t &frame)> &writer, QObject *parent = nullptr);
+        virtual ~FramePipeline() override;
+
+        /**
+         * @brief submit Queue a frame, which holds its own reference to the buffer so the caller can release the BLOB.
+         */
+        void submit(const frame_t &frame);
+
+        /**
+         * @brief takeFrame Take the oldest frame whose worker stages are done, ownership of its data goes to the caller.
+         * @return False if no frame is ready.
+         */
+        bool takeFrame(frame_t &frame);
+
+        /**
+         * @brief finish Record the timing of a frame taken with takeFrame() and remove it from the pipeline.
+         */
+        void finish(const frame_t &frame);
+
+        // Frames submitted and not finished yet
+        int pending() const;
+        // True if the file is still being processed, so it may not be on disk yet
+        bool isPending(const QString &filename) const;
+
+        Statistics statistics() const;
+
+        static const char *stageName(Stage stage);
+
+    signals:
+        // Emitted from the worker thread when a frame is ready and the previous ready ones were taken
+        void frameReady();
+
+    private:
+        void processLoop();
+        void process(frame_t &frame);
+
+        std::function<bool(const frame_t &frame)> m_Writer;
+
+        // Single worker so frames are written in the order they were captured
+        QThreadPool m_Worker;
+
+        mutable QMutex m_Mutex;
+        QList<frame_t> m_Queue;
+        QList<frame_t> m_Ready;
+        // Filenames of all frames between submit and finish
+        QList<QString> m_Pending;
+        bool m_Running { false };
+        bool m_ReadyNotified { false };
+
+        Statistics m_Statistics;
+};
@@ -77,7 +77,7 @@ void addFITSKeywords(const QString &filename, const QString &filter_used)
 }
 
 // Internal function to write an image blob to disk.
-bool WriteImageFileInternal(const QString &filename, char *buffer, const size_t size,
+bool WriteImageFileInternal(const QString &filename, const char *buffer, const size_t size,
                             bool add_fits_keywords, const QString &filter)
 {
     QFile file(filename);
@@ -916,6 +916,21 @@ CCD::CCD(GDInterface *iPtr) : DeviceDecorator(iPtr)
     m_Media.reset(new WSMedia(this));
     connect(m_Media.get(), &WSMedia::newFile, this, &CCD::setWSBLOB);
 
+    propertyIndex.add("CCD_EXPOSURE", CCD_PROPERTY_EXPOSURE, { "CCD_EXPOSURE_VALUE" });
+    propertyIndex.add("CCD_TEMPERATURE", CCD_PROPERTY_TEMPERATURE, { "CCD_TEMPERATURE_VALUE" });
+    propertyIndex.add("GUIDER_EXPOSURE", CCD_PROPERTY_GUIDER_EXPOSURE, { "GUIDER_EXPOSURE_VALUE" });
+    propertyIndex.add("FPS", CCD_PROPERTY_FPS);
+    const QList<QByteArray> guideStar = { "GUIDESTAR_X", "GUIDESTAR_Y", "GUIDESTAR_FIT" };
+    propertyIndex.add("CCD_RAPID_GUIDE_DATA", CCD_PROPERTY_RAPID_GUIDE_DATA, guideStar);
+    propertyIndex.add("GUIDER_RAPID_GUIDE_DATA", CCD_PROPERTY_GUIDER_RAPID_GUIDE_DATA, guideStar);
+
+    m_FramePipeline.reset(new FramePipeline([](const FramePipeline::frame_t &frame)
+    {
+        return WriteImageFileInternal(frame.filename, reinterpret_cast<const char *>(frame.buffer.data()),
+                                      frame.buffer.size(), true, frame.filter);
+    }));
+    connect(m_FramePipeline.get(), &FramePipeline::frameReady, this, &CCD::processFrames);
+
     connect(clientManager, &ClientManager::newBLOBManager, this, &CCD::setBLOBManager, Qt::UniqueConnection);
     m_LastNotificationTS = QDateTime::currentDateTime();
 }
@@ -926,8 +941,6 @@ CCD::~CCD()
         m_ImageViewerWindow->close();
     if (fileWriteThread.isRunning())
         fileWriteThread.waitForFinished();
-    if (fileWriteBuffer != nullptr)
-        delete [] fileWriteBuffer;
 }
 
 void CCD::setBLOBManager(const char *device, INDI::Property *prop)
@@ -1140,80 +1153,70 @@ void CCD::processLight(ILightVectorProperty *lvp)
 
 void CCD::processNumber(INumberVectorProperty *nvp)
 {
-    if (!strcmp(nvp->name, "CCD_EXPOSURE"))
-    {
-        INumber *np = IUFindNumber(nvp, "CCD_EXPOSURE_VALUE");
-        if (np)
-            emit newExposureValue(primaryChip.get(), np->value, nvp->s);
-        if (nvp->s == IPS_ALERT)
-            emit captureFailed();
-    }
-    else if (!strcmp(nvp->name, "CCD_TEMPERATURE"))
-    {
-        HasCooler   = true;
-        INumber *np = IUFindNumber(nvp, "CCD_TEMPERATURE_VALUE");
-        if (np)
-            emit newTemperatureValue(np->value);
-    }
-    else if (!strcmp(nvp->name, "GUIDER_EXPOSURE"))
-    {
-        INumber *np = IUFindNumber(nvp, "GUIDER_EXPOSURE_VALUE");
-        if (np)
-            emit newExposureValue(guideChip.get(), np->value, nvp->s);
-    }
-    else if (!strcmp(nvp->name, "FPS"))
-    {
-        emit newFPS(nvp->np[0].value, nvp->np[1].value);
-    }
-    else if (!strcmp(nvp->name, "CCD_RAPID_GUIDE_DATA"))
-    {
-        double dx = -1, dy = -1, fit = -1;
-        INumber *np = nullptr;
+    const PropertyIndex::entry_t property = propertyIndex.find(nvp);
 
-        if (nvp->s == IPS_ALERT)
+    switch (property.id)
+    {
+        case CCD_PROPERTY_EXPOSURE:
         {
-            emit newGuideStarData(primaryChip.get(), -1, -1, -1);
+            INumber *np = PropertyIndex::numberElement(nvp, property, 0);
+            if (np)
+                emit newExposureValue(primaryChip.get(), np->value, nvp->s);
+            if (nvp->s == IPS_ALERT)
+                emit captureFailed();
         }
-        else
+        break;
+
+        case CCD_PROPERTY_TEMPERATURE:
         {
-            np = IUFindNumber(nvp, "GUIDESTAR_X");
-            if (np)
-                dx = np->value;
-            np = IUFindNumber(nvp, "GUIDESTAR_Y");
-            if (np)
-                dy = np->value;
-            np = IUFindNumber(nvp, "GUIDESTAR_FIT");
+            HasCooler   = true;
+            INumber *np = PropertyIndex::numberElement(nvp, property, 0);
             if (np)
-                fit = np->value;
-
-            if (dx >= 0 && dy >= 0 && fit >= 0)
-                emit newGuideStarData(primaryChip.get(), dx, dy, fit);
+                emit newTemperatureValue(np->value);
         }
-    }
-    else if (!strcmp(nvp->name, "GUIDER_RAPID_GUIDE_DATA"))
-    {
-        double dx = -1, dy = -1, fit = -1;
-        INumber *np = nullptr;
+        break;
 
-        if (nvp->s == IPS_ALERT)
+        case CCD_PROPERTY_GUIDER_EXPOSURE:
         {
-            emit newGuideStarData(guideChip.get(), -1, -1, -1);
+            INumber *np = PropertyIndex::numberElement(nvp, property, 0);
+            if (np)
+                emit newExposureValue(guideChip.get(), np->value, nvp->s);
         }
-        else
+        break;
+
+        case CCD_PROPERTY_FPS:
+            emit newFPS(nvp->np[0].value, nvp->np[1].value);
+            break;
+
+        case CCD_PROPERTY_RAPID_GUIDE_DATA:
+        case CCD_PROPERTY_GUIDER_RAPID_GUIDE_DATA:
         {
-            np = IUFindNumber(nvp, "GUIDESTAR_X");
+            CCDChip *chip = (property.id == CCD_PROPERTY_RAPID_GUIDE_DATA) ? primaryChip.get() : guideChip.get();
+
+            if (nvp->s == IPS_ALERT)
+            {
+                emit newGuideStarData(chip, -1, -1, -1);
+                break;
+            }
+
+            double dx = -1, dy = -1, fit = -1;
+            INumber *np = PropertyIndex::numberElement(nvp, property, GUIDESTAR_X);
             if (np)
                 dx = np->value;
-            np = IUFindNumber(nvp, "GUIDESTAR_Y");
+            np = PropertyIndex::numberElement(nvp, property, GUIDESTAR_Y);
             if (np)
                 dy = np->value;
-            np = IUFindNumber(nvp, "GUIDESTAR_FIT");
+            np = PropertyIndex::numberElement(nvp, property, GUIDESTAR_FIT);
             if (np)
                 fit = np->value;
 
             if (dx >= 0 && dy >= 0 && fit >= 0)
-                emit newGuideStarData(guideChip.get(), dx, dy, fit);
+                emit newGuideStarData(chip, dx, dy, fit);
         }
+        break;
+
+        default:
+            break;
     }
 
     DeviceDecorator::processNumber(nvp);
@@ -1443,7 +1446,7 @@ bool CCD::generateFilename(const QString &format, bool batch_mode, QString *file
     return true;
 }
 
-bool CCD::writeImageFile(IBLOB *bp, const QString &format, bool is_fits,
+bool CCD::writeImageFile(IBLOB *bp, const ImageBuffer &fitsBuffer, const QString &format, bool is_fits,
                          bool batch_mode, QString *filename)
 {
     if (!generateFilename(format, batch_mode, filename))
@@ -1453,31 +1456,22 @@ bool CCD::writeImageFile(IBLOB *bp, const QString &format, bool is_fits,
     // Would need to deal with the raw conversion, etc.
     if (is_fits)
     {
-
         // Check if the last write is still ongoing, and if so wait.
-        // It is using the fileWriteBuffer.
+        // This keeps a slow disk from piling up frames in memory.
         if (fileWriteThread.isRunning())
         {
             fileWriteThread.waitForFinished();
         }
 
-        // Will write blob data in a separate thread, and can't depend on the blob
-        // memory, so copy it first.
-
-        // Check buffer size.
-        if (fileWriteBufferSize != bp->size)
+        // The write holds its own reference to the buffer the FITS data is loaded from,
+        // so the frame is not copied again. Probably too late to return an error if the file couldn't write.
+        const QString writeFilename = *filename;
+        const QString writeFilter   = filter;
+        fileWriteThread = QtConcurrent::run([fitsBuffer, writeFilename, writeFilter]()
         {
-            if (fileWriteBuffer != nullptr)
-                delete [] fileWriteBuffer;
-            fileWriteBufferSize = bp->size;
-            fileWriteBuffer = new char[fileWriteBufferSize];
-        }
-
-        // Copy memory, and write file on a separate thread.
-        // Probably too late to return an error if the file couldn't write.
-        memcpy(fileWriteBuffer, bp->blob, bp->size);
-        fileWriteThread = QtConcurrent::run(WriteImageFileInternal, *filename,
-                                            fileWriteBuffer, bp->size, is_fits, filter);
+            return WriteImageFileInternal(writeFilename, reinterpret_cast<const char *>(fitsBuffer.data()),
+                                          fitsBuffer.size(), true, writeFilter);
+        });
         filter = "";
     }
     else
@@ -1558,8 +1552,70 @@ void CCD::processBLOB(IBLOB *bp)
     else
         targetChip = primaryChip.get();
 
+    // Emitted before the image is written and loaded so clients can time the download separately
+    emit BLOBReceived(targetChip);
+
     //qCDebug(KSTARS_INDI) << "processBLOB() mode " << targetChip->getCaptureMode();
 
+    // FITS data is copied out of the BLOB once, the file writer and FITSData share that copy.
+    // Pooled so capture loops reuse the same memory for every frame.
+    ImageBuffer fitsBuffer;
+    if (BType == BLOB_FITS)
+    {
+        fitsBuffer = ImageBufferPool::Instance()->copy(bp->blob, bp->size);
+        if (fitsBuffer.isNull())
+        {
+            qCCritical(KSTARS_INDI) << "ISD:CCD Error: Not enough memory for FITS image of" << bp->size << "bytes.";
+            emit BLOBUpdated(nullptr);
+            return;
+        }
+    }
+
+#ifdef HAVE_CFITSIO
+    // Batch frames are written and previewed while the next exposure runs. Once used, every frame goes
+    // through the pipeline until it is empty so frames are always reported in the order they were captured.
+    if (BType == BLOB_FITS && targetChip->getCaptureMode() == FITS_NORMAL && targetChip->isBatchMode() &&
+            IsLooping == false && (m_FramePipelineDepth > 0 || m_FramePipeline->pending() > 0))
+    {
+        QString filename;
+        if (!generateFilename(format, true, &filename))
+        {
+            emit BLOBUpdated(nullptr);
+            return;
+        }
+
+        strncpy(BLOBFilename, filename.toLatin1(), MAXINDIFILENAME);
+        bp->aux0 = targetChip;
+        bp->aux1 = &BType;
+        bp->aux2 = BLOBFilename;
+
+        if (QDateTime::currentDateTime().secsTo(m_LastNotificationTS) <= -3)
+        {
+            KNotification::event(QLatin1String("FITSReceived"), i18n("Image file is received"));
+            m_LastNotificationTS = QDateTime::currentDateTime();
+        }
+
+        FramePipeline::frame_t frame;
+        frame.chip      = targetChip;
+        frame.filename  = filename;
+        frame.filter    = filter;
+        frame.buffer    = fitsBuffer;
+        frame.mode      = FITS_NORMAL;
+        // Nothing else looks at the image of a batch frame unless it is displayed
+        frame.load      = Options::useFITSViewer();
+        frame.findStars = frame.load && m_FITSViewerWindows && m_FITSViewerWindows->isStarsMarked();
+        filter = "";
+
+        m_FramePipeline->submit(frame);
+
+        if (m_FramePipeline->pending() <= m_FramePipelineDepth)
+            emit BLOBUpdated(bp);
+        else
+            m_DeferredBLOB = bp;
+        return;
+    }
+#endif
+
     // Create temporary name if ANY of the following conditions are met:
     // 1. file is preview or batch mode is not enabled
     // 2. file type is not FITS_NORMAL (focus, guide..etc)
@@ -1578,7 +1634,7 @@ void CCD::processBLOB(IBLOB *bp)
     // Create file name for others
     else
     {
-        if (!writeImageFile(bp, format, BType == BLOB_FITS, targetChip->isBatchMode(), &filename))
+        if (!writeImageFile(bp, fitsBuffer, format, BType == BLOB_FITS, targetChip->isBatchMode(), &filename))
         {
             emit BLOBUpdated(nullptr);
             return;
@@ -1685,7 +1741,7 @@ void CCD::processBLOB(IBLOB *bp)
     {
         FITSData *blob_fits_data = new FITSData(targetChip->getCaptureMode());
 
-        if (!blob_fits_data->loadFITSFromMemory(filename, bp->blob, bp->size, false))
+        if (!blob_fits_data->loadFITSFromMemory(filename, fitsBuffer, false))
         {
             // If reading the blob fails, we treat it the same as exposure failure
             // and recapture again if possible
@@ -1706,16 +1762,6 @@ void CCD::displayFits(CCDChip *targetChip, const QString &filename, IBLOB *bp, F
 {
     FITSMode captureMode = targetChip->getCaptureMode();
 
-    // Get or Create FITSViewer if we are using FITSViewer
-    // or if capture mode is calibrate since for now we are forced to open the file in the viewer
-    // this should be fixed in the future and should only use FITSData
-    if (Options::useFITSViewer() || targetChip->isBatchMode() == false)
-    {
-        if (m_FITSViewerWindows.isNull() &&
-                (captureMode == FITS_NORMAL || captureMode == FITS_CALIBRATE))
-            setupFITSViewerWindows();
-    }
-
     switch (captureMode)
     {
         case FITS_NORMAL:
@@ -1724,37 +1770,7 @@ void CCD::displayFits(CCDChip *targetChip, const QString &filename, IBLOB *bp, F
             // Check if we need to display the image
             if (Options::useFITSViewer() || targetChip->isBatchMode() == false)
             {
-                bool success;
-                int tabIndex;
-                int *tabID = (captureMode == FITS_NORMAL) ? &normalTabID : &calibrationTabID;
-                QUrl fileURL = QUrl::fromLocalFile(filename);
-                FITSScale captureFilter = targetChip->getCaptureFilter();
-                if (*tabID == -1 || Options::singlePreviewFITS() == false)
-                {
-                    // If image is preview and we should display all captured images in a
-                    // single tab called "Preview", then set the title to "Preview",
-                    // Otherwise, the title will be the captured image name
-                    QString previewTitle;
-                    if (targetChip->isBatchMode() == false && Options::singlePreviewFITS())
-                    {
-                        // If we are displaying all images from all cameras in a single FITS
-                        // Viewer window, then we prefix the camera name to the "Preview" string
-                        if (Options::singleWindowCapturedFITS())
-                            previewTitle = i18n("%1 Preview", getDeviceName());
-                        else
-                            // Otherwise, just use "Preview"
-                            previewTitle = i18n("Preview");
-                    }
-
-                    success = m_FITSViewerWindows->addFITSFromData(
-                                  blob_fits_data, fileURL, &tabIndex, captureMode, captureFilter,
-                                  previewTitle);
-                }
-                else
-                    success = m_FITSViewerWindows->updateFITSFromData(
-                                  blob_fits_data, fileURL, *tabID, &tabIndex, captureFilter);
-
-                if (!success)
+                if (!displayInViewer(targetChip, captureMode, filename, blob_fits_data))
                 {
                     // If opening file fails, we treat it the same as exposure failure
                     // and recapture again if possible
@@ -1762,16 +1778,16 @@ void CCD::displayFits(CCDChip *targetChip, const QString &filename, IBLOB *bp, F
                     emit newExposureValue(targetChip, 0, IPS_ALERT);
                     return;
                 }
-                *tabID = tabIndex;
-                targetChip->setImageView(m_FITSViewerWindows->getView(tabIndex), captureMode);
-                if (Options::focusFITSOnNewImage())
-                    m_FITSViewerWindows->raise();
 
                 emit BLOBUpdated(bp);
             }
             else
+            {
                 // If not displayed in FITS Viewer then we just inform that a blob was received.
                 emit BLOBUpdated(bp);
+                // Nothing else references the data, release it so its buffers go back to the pool.
+                delete blob_fits_data;
+            }
         }
         break;
 
@@ -1783,6 +1799,106 @@ void CCD::displayFits(CCDChip *targetChip, const QString &filename, IBLOB *bp, F
     }
 }
 
+bool CCD::displayInViewer(CCDChip *targetChip, FITSMode captureMode, const QString &filename, FITSData *data)
+{
+    // Get or Create FITSViewer if we are using FITSViewer
+    // or if capture mode is calibrate since for now we are forced to open the file in the viewer
+    // this should be fixed in the future and should only use FITSData
+    if (m_FITSViewerWindows.isNull())
+        setupFITSViewerWindows();
+
+    bool success;
+    int tabIndex;
+    int *tabID = (captureMode == FITS_NORMAL) ? &normalTabID : &calibrationTabID;
+    QUrl fileURL = QUrl::fromLocalFile(filename);
+    FITSScale captureFilter = targetChip->getCaptureFilter();
+    if (*tabID == -1 || Options::singlePreviewFITS() == false)
+    {
+        // If image is preview and we should display all captured images in a
+        // single tab called "Preview", then set the title to "Preview",
+        // Otherwise, the title will be the captured image name
+        QString previewTitle;
+        if (targetChip->isBatchMode() == false && Options::singlePreviewFITS())
+        {
+            // If we are displaying all images from all cameras in a single FITS
+            // Viewer window, then we prefix the camera name to the "Preview" string
+            if (Options::singleWindowCapturedFITS())
+                previewTitle = i18n("%1 Preview", getDeviceName());
+            else
+                // Otherwise, just use "Preview"
+                previewTitle = i18n("Preview");
+        }
+
+        success = m_FITSViewerWindows->addFITSFromData(data, fileURL, &tabIndex, captureMode, captureFilter,
+                  previewTitle);
+    }
+    else
+        success = m_FITSViewerWindows->updateFITSFromData(data, fileURL, *tabID, &tabIndex, captureFilter);
+
+    if (!success)
+        return false;
+
+    *tabID = tabIndex;
+    targetChip->setImageView(m_FITSViewerWindows->getView(tabIndex), captureMode);
+    if (Options::focusFITSOnNewImage())
+        m_FITSViewerWindows->raise();
+
+    return true;
+}
+
+void CCD::processFrames()
+{
+    FramePipeline::frame_t frame;
+    while (m_FramePipeline->takeFrame(frame))
+    {
+        QElapsedTimer timer;
+        timer.start();
+
+        if (frame.written)
+        {
+            // No main window when the camera is driven without the GUI, as the capture replay test does
+            if (KStars::Instance())
+                KStars::Instance()->statusBar()->showMessage(i18n("%1 file saved to %2", QString("FITS"),
+                        frame.filename), 0);
+            qCInfo(KSTARS_INDI) << "FITS file saved to" << frame.filename;
+            if (frame.hfr > 0)
+                qCDebug(KSTARS_INDI) << "HFR of" << frame.filename << "is" << frame.hfr;
+        }
+        else
+            qCCritical(KSTARS_INDI) << "ISD:CCD Error: Unable to save" << frame.filename;
+
+        if (frame.data && displayInViewer(frame.chip, frame.mode, frame.filename, frame.data) == false)
+            qCWarning(KSTARS_INDI) << "Failed to display" << frame.filename;
+        frame.timing[FramePipeline::STAGE_PREVIEW] = timer.elapsed();
+
+        timer.restart();
+        emit frameProcessed(frame.chip, frame.filename, frame.written);
+        frame.timing[FramePipeline::STAGE_UPLOAD] = timer.elapsed();
+
+        m_FramePipeline->finish(frame);
+
+        // Release the next exposure once there is room again
+        if (m_DeferredBLOB && m_FramePipeline->pending() <= m_FramePipelineDepth)
+        {
+            IBLOB *bp = m_DeferredBLOB;
+            m_DeferredBLOB = nullptr;
+            // Unless the held back frame was the one that could not be written
+            const bool failed = frame.written == false && frame.filename == static_cast<const char *>(bp->aux2);
+            emit BLOBUpdated(failed ? nullptr : bp);
+        }
+    }
+}
+
+bool CCD::isFramePending(const QString &filename) const
+{
+    return m_FramePipeline->isPending(filename);
+}
+
+FramePipeline::Statistics CCD::getFramePipelineStatistics() const
+{
+    return m_FramePipeline->statistics();
+}
+
 void CCD::loadImageInView(IBLOB *bp, ISD::CCDChip *targetChip, FITSData *data)
 {
     FITSMode mode = targetChip->getCaptureMode();
@@ -1808,6 +1924,8 @@ void CCD::loadImageInView(IBLOB *bp, ISD::CCDChip *targetChip, FITSData *data)
 
         emit BLOBUpdated(bp);
     }
+    else
+        delete data;
 }
 
 CCD::TransferFormat CCD::getTargetTransferFormat() const
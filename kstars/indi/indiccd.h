@@ -15,6 +15,8 @@
 #include "fitsviewer/fitscommon.h"
 #include "fitsviewer/fitsview.h"
 #include "fitsviewer/fitsviewer.h"
+#include "fitsviewer/imagebuffer.h"
+#include "framepipeline.h"
 
 #include <QStringList>
 #include <QPointer>
@@ -314,6 +316,22 @@ class CCD : public DeviceDecorator
         }
         bool setExposureLoopCount(uint32_t count);
 
+        /**
+         * @brief setFramePipelineDepth Let captured FITS frames of batch jobs be written and previewed while
+         * the next exposure runs. BLOBUpdated is held back while more than depth frames are in the pipeline.
+         * @param depth Frames allowed in the pipeline, 0 processes each frame before BLOBUpdated is emitted.
+         * Called before each exposure, so a frame still held back from an aborted capture is no longer reported.
+         */
+        void setFramePipelineDepth(int depth)
+        {
+            m_FramePipelineDepth = depth;
+            m_DeferredBLOB = nullptr;
+        }
+        // True if the file is still being written or previewed, frameProcessed is emitted once it is done
+        bool isFramePending(const QString &filename) const;
+        // Frames, failures and stage timings of the frame pipeline so far
+        FramePipeline::Statistics getFramePipelineStatistics() const;
+
         const QMap<QString, double> &getExposurePresets() const
         {
             return m_ExposurePresets;
@@ -336,6 +354,7 @@ class CCD : public DeviceDecorator
         //void FITSViewerClosed();
         void newTemperatureValue(double value);
         void newExposureValue(ISD::CCDChip *chip, double value, IPState state);
+        void BLOBReceived(ISD::CCDChip *chip);
         void newGuideStarData(ISD::CCDChip *chip, double dx, double dy, double fit);
         void newBLOBManager(INDI::Property *prop);
         void newRemoteFile(QString);
@@ -348,17 +367,36 @@ class CCD : public DeviceDecorator
         void previewJPEGGenerated(const QString &previewJPEG, QJsonObject metadata);
         void ready();
         void captureFailed();
+        // Emitted once a frame of the pipeline is written and previewed, success is false if it could not be written
+        void frameProcessed(ISD::CCDChip *chip, const QString &filename, bool success);
 
     private:
+        // Properties handled on update
+        enum
+        {
+            CCD_PROPERTY_EXPOSURE,
+            CCD_PROPERTY_TEMPERATURE,
+            CCD_PROPERTY_GUIDER_EXPOSURE,
+            CCD_PROPERTY_FPS,
+            CCD_PROPERTY_RAPID_GUIDE_DATA,
+            CCD_PROPERTY_GUIDER_RAPID_GUIDE_DATA
+        };
+        // Elements of the rapid guide data properties
+        enum { GUIDESTAR_X, GUIDESTAR_Y, GUIDESTAR_FIT };
+
         void processStream(IBLOB *bp);
         void loadImageInView(IBLOB *bp, ISD::CCDChip *targetChip, FITSData *data);
         bool generateFilename(const QString &format, bool batch_mode, QString *filename);
-        // Saves an image to disk on a separate thread.
-        bool writeImageFile(IBLOB *bp, const QString &format, bool is_fits,
+        // Saves an image to disk, on a separate thread for FITS images held in fitsBuffer.
+        bool writeImageFile(IBLOB *bp, const ImageBuffer &fitsBuffer, const QString &format, bool is_fits,
                             bool batch_mode, QString *filename);
         // Creates or finds the FITSViewer.
         void setupFITSViewerWindows();
         void displayFits(CCDChip *targetChip, const QString &filename, IBLOB *bp, FITSData *blob_fits_data);
+        // Adds or updates the tab of the image in the FITSViewer, takes ownership of the data.
+        bool displayInViewer(CCDChip *targetChip, FITSMode captureMode, const QString &filename, FITSData *data);
+        // Preview and upload stages of frames the pipeline is done with.
+        void processFrames();
 
         QString filter;
         bool ISOMode { true };
@@ -405,8 +443,12 @@ class CCD : public DeviceDecorator
         QPair<double, double> m_ExposurePresetsMinMax;
 
         // Used when writing the image fits file to disk in a separate thread.
-        char *fileWriteBuffer { nullptr };
-        int fileWriteBufferSize { 0 };
-        QFuture<void> fileWriteThread;
+        QFuture<bool> fileWriteThread;
+
+        // Post-processes batch FITS frames while the next exposure runs
+        std::unique_ptr<FramePipeline> m_FramePipeline;
+        int m_FramePipelineDepth { 0 };
+        // BLOB of the last frame, held back while the pipeline is full
+        IBLOB *m_DeferredBLOB { nullptr };
 };
 }
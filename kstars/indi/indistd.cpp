@@ -46,6 +46,10 @@ GenericDevice::GenericDevice(DeviceInfo &idv)
 
     dType = KSTARS_UNKNOWN;
 
+    propertyIndex.add("CONNECTION", GENERIC_CONNECTION, { "CONNECT" });
+    propertyIndex.add("GEOGRAPHIC_COORD", GENERIC_GEOGRAPHIC_COORD, { "LONG", "LAT", "ELEV" });
+    propertyIndex.add("WATCHDOG_HEARTBEAT", GENERIC_WATCHDOG_HEARTBEAT);
+
     registerDBusType();
 }
 
@@ -77,6 +81,7 @@ void GenericDevice::registerProperty(INDI::Property *prop)
     }
 
     properties.append(prop);
+    propertyIndex.insert(prop);
 
     emit propertyDefined(prop);
 
@@ -178,15 +183,18 @@ void GenericDevice::registerProperty(INDI::Property *prop)
 void GenericDevice::removeProperty(INDI::Property *prop)
 {
     properties.removeOne(prop);
+    propertyIndex.remove(prop);
 
     emit propertyDeleted(prop);
 }
 
 void GenericDevice::processSwitch(ISwitchVectorProperty *svp)
 {
-    if (!strcmp(svp->name, "CONNECTION"))
+    const PropertyIndex::entry_t property = propertyIndex.find(svp);
+
+    if (property.id == GENERIC_CONNECTION)
     {
-        ISwitch *conSP = IUFindSwitch(svp, "CONNECT");
+        ISwitch *conSP = PropertyIndex::switchElement(svp, property, 0);
 
         if (conSP == nullptr)
             return;
@@ -228,7 +236,9 @@ void GenericDevice::processNumber(INumberVectorProperty *nvp)
     //    uint32_t interface = getDriverInterface();
     //    Q_UNUSED(interface);
 
-    if (!strcmp(nvp->name, "GEOGRAPHIC_COORD") && nvp->s == IPS_OK &&
+    const PropertyIndex::entry_t property = propertyIndex.find(nvp);
+
+    if (property.id == GENERIC_GEOGRAPHIC_COORD && nvp->s == IPS_OK &&
             ( (Options::useMountSource() && (getDriverInterface() & INDI::BaseDevice::TELESCOPE_INTERFACE)) ||
               (Options::useGPSSource() && (getDriverInterface() & INDI::BaseDevice::GPS_INTERFACE))))
     {
@@ -236,7 +246,7 @@ void GenericDevice::processNumber(INumberVectorProperty *nvp)
         dms lng, lat;
         double elev = 0;
 
-        INumber *np = IUFindNumber(nvp, "LONG");
+        INumber *np = PropertyIndex::numberElement(nvp, property, GEO_LONG);
         if (!np)
             return;
 
@@ -246,7 +256,7 @@ void GenericDevice::processNumber(INumberVectorProperty *nvp)
         else
             lng.setD(np->value - 360.0);
 
-        np = IUFindNumber(nvp, "LAT");
+        np = PropertyIndex::numberElement(nvp, property, GEO_LAT);
         if (!np)
             return;
 
@@ -259,7 +269,7 @@ void GenericDevice::processNumber(INumberVectorProperty *nvp)
             return;
         }
 
-        np = IUFindNumber(nvp, "ELEV");
+        np = PropertyIndex::numberElement(nvp, property, GEO_ELEV);
         if (np)
             elev = np->value;
 
@@ -289,7 +299,7 @@ void GenericDevice::processNumber(INumberVectorProperty *nvp)
 
         KStars::Instance()->data()->setLocation(*geo);
     }
-    else if (!strcmp(nvp->name, "WATCHDOG_HEARTBEAT"))
+    else if (property.id == GENERIC_WATCHDOG_HEARTBEAT)
     {
         if (watchDogTimer == nullptr)
         {
@@ -1047,11 +1057,13 @@ void DeviceDecorator::processMessage(int messageID)
 
 void DeviceDecorator::registerProperty(INDI::Property * prop)
 {
+    propertyIndex.insert(prop);
     interfacePtr->registerProperty(prop);
 }
 
 void DeviceDecorator::removeProperty(INDI::Property * prop)
 {
+    propertyIndex.remove(prop);
     interfacePtr->removeProperty(prop);
 }
 
@@ -12,6 +12,7 @@
 #pragma once
 
 #include "indicommon.h"
+#include "propertyindex.h"
 
 #include <indiproperty.h>
 
@@ -213,7 +214,18 @@ class GenericDevice : public GDInterface
         void updateLocation();
 
     private:
+        // Properties handled on update
+        enum
+        {
+            GENERIC_CONNECTION,
+            GENERIC_GEOGRAPHIC_COORD,
+            GENERIC_WATCHDOG_HEARTBEAT
+        };
+        // Elements of GEOGRAPHIC_COORD
+        enum { GEO_LONG, GEO_LAT, GEO_ELEV };
+
         static void registerDBusType();
+        PropertyIndex propertyIndex;
         bool connected { false };
         DriverInfo *driverInfo { nullptr };
         DeviceInfo *deviceInfo { nullptr };
@@ -277,6 +289,8 @@ class DeviceDecorator : public GDInterface
         INDI::BaseDevice *baseDevice { nullptr };
         ClientManager *clientManager { nullptr };
         GDInterface *interfacePtr { nullptr };
+        // Properties the decorator handles on update, filled by its constructor
+        PropertyIndex propertyIndex;
 };
 
 /**
@@ -33,6 +33,10 @@ Telescope::Telescope(GDInterface *iPtr) : DeviceDecorator(iPtr)
     maxAlt               = -1;
     EqCoordPreviousState = IPS_IDLE;
 
+    propertyIndex.add("EQUATORIAL_EOD_COORD", MOUNT_EQUATORIAL_EOD_COORD, { "RA", "DEC" });
+    propertyIndex.add("EQUATORIAL_COORD", MOUNT_EQUATORIAL_COORD, { "RA", "DEC" });
+    propertyIndex.add("HORIZONTAL_COORD", MOUNT_HORIZONTAL_COORD, { "AZ", "ALT" });
+
     // Set it for 5 seconds for now as not to spam the display update
     centerLockTimer.setInterval(5000);
     centerLockTimer.setSingleShot(true);
@@ -41,6 +45,9 @@ Telescope::Telescope(GDInterface *iPtr) : DeviceDecorator(iPtr)
         runCommand(INDI_CENTER_LOCK);
     });
 
+    symbolUpdateTimer.setSingleShot(true);
+    connect(&symbolUpdateTimer, &QTimer::timeout, this, &Telescope::updateSkyMapSymbol);
+
     // If after 250ms no new properties are registered then emit ready
     readyTimer.setInterval(250);
     readyTimer.setSingleShot(true);
@@ -206,10 +213,12 @@ void Telescope::registerProperty(INDI::Property *prop)
 
 void Telescope::processNumber(INumberVectorProperty *nvp)
 {
-    if (!strcmp(nvp->name, "EQUATORIAL_EOD_COORD") || !strcmp(nvp->name, "EQUATORIAL_COORD"))
+    const PropertyIndex::entry_t property = propertyIndex.find(nvp);
+
+    if (property.id == MOUNT_EQUATORIAL_EOD_COORD || property.id == MOUNT_EQUATORIAL_COORD)
     {
-        INumber *RA  = IUFindNumber(nvp, "RA");
-        INumber *DEC = IUFindNumber(nvp, "DEC");
+        INumber *RA  = PropertyIndex::numberElement(nvp, property, COORD_FIRST);
+        INumber *DEC = PropertyIndex::numberElement(nvp, property, COORD_SECOND);
 
         if (RA == nullptr || DEC == nullptr)
             return;
@@ -218,7 +227,7 @@ void Telescope::processNumber(INumberVectorProperty *nvp)
         currentCoord.setDec(DEC->value);
 
         // If J2000, convert it to JNow
-        if (!strcmp(nvp->name, "EQUATORIAL_COORD"))
+        if (property.id == MOUNT_EQUATORIAL_COORD)
         {
             currentCoord.setRA0(RA->value);
             currentCoord.setDec0(DEC->value);
@@ -246,12 +255,13 @@ void Telescope::processNumber(INumberVectorProperty *nvp)
 
         EqCoordPreviousState = nvp->s;
 
-        KStars::Instance()->map()->update();
+        if (symbolUpdateTimer.isActive() == false)
+            symbolUpdateTimer.start(Options::telescopeSymbolUpdateInterval());
     }
-    else if (!strcmp(nvp->name, "HORIZONTAL_COORD"))
+    else if (property.id == MOUNT_HORIZONTAL_COORD)
     {
-        INumber *Az  = IUFindNumber(nvp, "AZ");
-        INumber *Alt = IUFindNumber(nvp, "ALT");
+        INumber *Az  = PropertyIndex::numberElement(nvp, property, COORD_FIRST);
+        INumber *Alt = PropertyIndex::numberElement(nvp, property, COORD_SECOND);
 
         if (Az == nullptr || Alt == nullptr)
             return;
@@ -261,12 +271,24 @@ void Telescope::processNumber(INumberVectorProperty *nvp)
         currentCoord.HorizontalToEquatorial(KStars::Instance()->data()->lst(),
                                             KStars::Instance()->data()->geo()->lat());
 
-        KStars::Instance()->map()->update();
+        if (symbolUpdateTimer.isActive() == false)
+            symbolUpdateTimer.start(Options::telescopeSymbolUpdateInterval());
     }
 
     DeviceDecorator::processNumber(nvp);
 }
 
+void Telescope::updateSkyMapSymbol()
+{
+    if (Options::showTargetCrosshair() == false)
+    {
+        symbolRect = QRect();
+        return;
+    }
+
+    symbolRect = KStars::Instance()->map()->updateTelescopeSymbol(symbolRect, &currentCoord, getDeviceName());
+}
+
 void Telescope::processSwitch(ISwitchVectorProperty *svp)
 {
     bool manualMotionChanged = false;
@@ -10,6 +10,7 @@
 #pragma once
 
 #include <QDBusArgument>
+#include <QRect>
 #include <QTimer>
 
 #include "indistd.h"
@@ -193,12 +194,29 @@ class Telescope : public DeviceDecorator
         void ready();
 
     private:
+        // Properties handled on update
+        enum
+        {
+            MOUNT_EQUATORIAL_EOD_COORD,
+            MOUNT_EQUATORIAL_COORD,
+            MOUNT_HORIZONTAL_COORD
+        };
+        // Elements of the coordinate properties, RA/DEC or AZ/ALT
+        enum { COORD_FIRST, COORD_SECOND };
+
+        // Repaint the crosshairs at the latest coordinates received
+        void updateSkyMapSymbol();
+
         SkyPoint currentCoord;
         double minAlt = 0, maxAlt = 90;
         ParkStatus m_ParkStatus = PARK_UNKNOWN;
         IPState EqCoordPreviousState;
         QTimer centerLockTimer;
         QTimer readyTimer;
+        // Coordinate updates within its interval are drawn once
+        QTimer symbolUpdateTimer;
+        // Sky map region of the crosshairs last drawn
+        QRect symbolRect;
         SkyObject *currentObject = nullptr;
         bool inManualMotion      = false;
         bool inCustomParking     = false;
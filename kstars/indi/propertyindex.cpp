@@ -0,0 +1,115 @@
+/*  INDI Property Index
+    Copyright (C) 2020 KStars Developers
+
+    This application is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public
+    License as published by the Free Software Foundation; either
+    version 2 of the License, or (at your option) any later version.
+ */
+
+#include "propertyindex.h"
+
+#include "indi_debug.h"
+
+#include <cstring>
+
+namespace ISD
+{
+
+void PropertyIndex::add(const char *name, int id, const QList<QByteArray> &elements)
+{
+    Q_ASSERT(id >= 0 && elements.count() <= PROPERTY_INDEX_ELEMENTS);
+
+    m_Handlers.insert(QByteArray(name), { id, elements });
+}
+
+void PropertyIndex::insert(INDI::Property *prop)
+{
+    switch (prop->getType())
+    {
+        case INDI_NUMBER:
+            if (prop->getNumber())
+                find(prop->getNumber());
+            break;
+
+        case INDI_SWITCH:
+            if (prop->getSwitch())
+                find(prop->getSwitch());
+            break;
+
+        case INDI_TEXT:
+            if (prop->getText())
+                find(prop->getText());
+            break;
+
+        default:
+            break;
+    }
+}
+
+void PropertyIndex::remove(INDI::Property *prop)
+{
+    m_Vectors.remove(prop->getProperty());
+}
+
+PropertyIndex::entry_t PropertyIndex::find(INumberVectorProperty *nvp)
+{
+    auto entry = m_Vectors.constFind(nvp);
+    if (entry != m_Vectors.constEnd())
+        return entry.value();
+
+    return resolve(nvp, nvp->np, nvp->nnp);
+}
+
+PropertyIndex::entry_t PropertyIndex::find(ISwitchVectorProperty *svp)
+{
+    auto entry = m_Vectors.constFind(svp);
+    if (entry != m_Vectors.constEnd())
+        return entry.value();
+
+    return resolve(svp, svp->sp, svp->nsp);
+}
+
+PropertyIndex::entry_t PropertyIndex::find(ITextVectorProperty *tvp)
+{
+    auto entry = m_Vectors.constFind(tvp);
+    if (entry != m_Vectors.constEnd())
+        return entry.value();
+
+    return resolve(tvp, tvp->tp, tvp->ntp);
+}
+
+template <typename Vector, typename Element>
+PropertyIndex::entry_t PropertyIndex::resolve(const Vector *vector, const Element *items, int count)
+{
+    entry_t entry;
+    entry.id = PROPERTY_UNKNOWN;
+    for (int i = 0; i < PROPERTY_INDEX_ELEMENTS; i++)
+        entry.elements[i] = -1;
+
+    auto handler = m_Handlers.constFind(QByteArray(vector->name));
+    if (handler != m_Handlers.constEnd())
+    {
+        entry.id = handler->id;
+        for (int i = 0; i < handler->elements.count(); i++)
+        {
+            for (int j = 0; j < count; j++)
+            {
+                if (!strcmp(items[j].name, handler->elements[i].constData()))
+                {
+                    entry.elements[i] = j;
+                    break;
+                }
+            }
+
+            if (entry.elements[i] < 0)
+                qCDebug(KSTARS_INDI) << vector->device << vector->name << "has no element"
+                                     << handler->elements[i].constData();
+        }
+    }
+
+    m_Vectors.insert(vector, entry);
+    return entry;
+}
+
+}
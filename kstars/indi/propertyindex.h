@@ -0,0 +1,90 @@
+/*  INDI Property Index
+    Copyright (C) 2020 KStars Developers
+
+    This application is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public
+    License as published by the Free Software Foundation; either
+    version 2 of the License, or (at your option) any later version.
+ */
+
+#pragma once
+
+#include <indiproperty.h>
+
+#include <QByteArray>
+#include <QHash>
+#include <QList>
+
+// most elements a device reads by position from one property
+#define PROPERTY_INDEX_ELEMENTS 4
+
+namespace ISD
+{
+
+/**
+ * @class PropertyIndex
+ * Dispatch table of the properties a device handles on update.
+ *
+ * The device adds each property it handles by name with an id of its choosing and the elements it reads. When a
+ * vector is defined, or the first time it is updated if it was defined before the device was decorated, its name
+ * is looked up once and the vector pointer is mapped to the id and the positions of the elements. Every later
+ * update costs a single pointer lookup. Vectors that are not handled map to PROPERTY_UNKNOWN.
+ *
+ * Drivers may reuse the memory of a deleted vector, so the device must remove() each property it is told about.
+ */
+class PropertyIndex
+{
+    public:
+        enum { PROPERTY_UNKNOWN = -1 };
+
+        typedef struct
+        {
+            int id;
+            // Position of each element in the vector in the order they were added, -1 if the driver lacks it
+            int elements[PROPERTY_INDEX_ELEMENTS];
+        } entry_t;
+
+        /**
+         * @brief add Handle a property.
+         * @param name Property name.
+         * @param id Identifier returned for its vectors, not negative.
+         * @param elements Names of the elements to resolve, at most PROPERTY_INDEX_ELEMENTS.
+         */
+        void add(const char *name, int id, const QList<QByteArray> &elements = QList<QByteArray>());
+
+        // Resolve a vector as it is defined
+        void insert(INDI::Property *prop);
+        void remove(INDI::Property *prop);
+
+        entry_t find(INumberVectorProperty *nvp);
+        entry_t find(ISwitchVectorProperty *svp);
+        entry_t find(ITextVectorProperty *tvp);
+
+        static INumber *numberElement(INumberVectorProperty *nvp, const entry_t &entry, int element)
+        {
+            return entry.elements[element] < 0 ? nullptr : nvp->np + entry.elements[element];
+        }
+        static ISwitch *switchElement(ISwitchVectorProperty *svp, const entry_t &entry, int element)
+        {
+            return entry.elements[element] < 0 ? nullptr : svp->sp + entry.elements[element];
+        }
+        static IText *textElement(ITextVectorProperty *tvp, const entry_t &entry, int element)
+        {
+            return entry.elements[element] < 0 ? nullptr : tvp->tp + entry.elements[element];
+        }
+
+    private:
+        typedef struct
+        {
+            int id;
+            QList<QByteArray> elements;
+        } handler_t;
+
+        template <typename Vector, typename Element>
+        entry_t resolve(const Vector *vector, const Element *items, int count);
+
+        QHash<QByteArray, handler_t> m_Handlers;
+        QHash<const void *, entry_t> m_Vectors;
+};
+
+}
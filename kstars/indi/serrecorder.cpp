@@ -0,0 +1,343 @@
+/*  SER Stream Recorder
+    Copyright (C) 2020 KStars Developers
+
+    This application is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public
+    License as published by the Free Software Foundation; either
+    version 2 of the License, or (at your option) any later version.
+ */
+
+#include "serrecorder.h"
+
+#include "kstars_debug.h"
+
+#include <KLocalizedString>
+
+#include <QDateTime>
+#include <QDir>
+#include <QFileInfo>
+#include <QMutexLocker>
+#include <QtConcurrent>
+#include <QtEndian>
+
+#include <cstring>
+#include <new>
+
+// size of the SER file header
+#define SER_HEADER_SIZE   178
+// alignment of the ring buffer, a page so sequential writes start from aligned memory
+#define SER_RING_ALIGN    4096
+// largest single write, in bytes
+#define SER_MAX_WRITE     (16 * 1024 * 1024)
+// .NET ticks at the Unix epoch
+#define SER_EPOCH_TICKS   621355968000000000LL
+
+namespace
+{
+void appendInt32(QByteArray &data, int32_t value)
+{
+    char bytes[4];
+    qToLittleEndian<qint32>(value, reinterpret_cast<uchar *>(bytes));
+    data.append(bytes, 4);
+}
+
+void appendInt64(QByteArray &data, qint64 value)
+{
+    char bytes[8];
+    qToLittleEndian<qint64>(value, reinterpret_cast<uchar *>(bytes));
+    data.append(bytes, 8);
+}
+
+void appendString(QByteArray &data, const QString &value, int size)
+{
+    QByteArray latin = value.toLatin1().left(size);
+    latin.append(QByteArray(size - latin.size(), '\0'));
+    data.append(latin);
+}
+}
+
+SERRecorder::SERRecorder(quint64 ringSize, QObject *parent) : QObject(parent), m_RingSize(ringSize)
+{
+    m_Writer.setMaxThreadCount(1);
+}
+
+SERRecorder::~SERRecorder()
+{
+    close();
+    m_Writer.waitForDone();
+}
+
+qint64 SERRecorder::currentTicks(bool utc)
+{
+    QDateTime now = QDateTime::currentDateTime();
+    qint64 msecs  = now.toMSecsSinceEpoch();
+    if (utc == false)
+        msecs += now.offsetFromUtc() * 1000LL;
+
+    return SER_EPOCH_TICKS + msecs * 10000;
+}
+
+QString SERRecorder::expandFilename(const QString &directory, const QString &name, const QString &filter)
+{
+    QDateTime now = QDateTime::currentDateTime();
+    QString filename = name;
+
+    filename.replace("_D_", now.toString("yyyy-MM-dd"));
+    filename.replace("_H_", now.toString("HH-mm-ss"));
+    filename.replace("_T_", now.toString("yyyy-MM-ddTHH-mm-ss"));
+    filename.replace("_F_", filter);
+
+    if (filename.endsWith(".ser", Qt::CaseInsensitive) == false)
+        filename += ".ser";
+
+    return QDir(directory).filePath(filename);
+}
+
+bool SERRecorder::open(const QString &filename, uint32_t width, uint32_t height, uint32_t depth, ColorID color,
+                       const QString &instrument)
+{
+    close();
+    // The previous recording must release the file and the ring buffer first
+    m_Writer.waitForDone();
+
+    m_Error.clear();
+
+    if (width == 0 || height == 0 || (depth != 8 && depth != 16))
+    {
+        m_Error = i18n("Unsupported frame format.");
+        return false;
+    }
+
+    m_Width      = width;
+    m_Height     = height;
+    m_Depth      = depth;
+    m_Color      = color;
+    m_Instrument = instrument;
+    m_FrameSize  = width * height * (color == COLOR_RGB ? 3 : 1) * (depth / 8);
+
+    // Allocated once per recording so frames never wait for memory
+    m_SlotCount = static_cast<uint32_t>(qMin<quint64>(m_RingSize / m_FrameSize, 0x7FFFFFFF));
+    if (m_SlotCount < 2)
+        m_SlotCount = 2;
+
+    const quint64 storage = static_cast<quint64>(m_SlotCount) * m_FrameSize + SER_RING_ALIGN;
+    m_RingStorage.reset(new (std::nothrow) uint8_t[storage]);
+    if (!m_RingStorage)
+    {
+        m_Error = i18n("Unable to allocate %1 MB for the recording buffer.", storage / (1024 * 1024));
+        return false;
+    }
+
+    const uintptr_t address = reinterpret_cast<uintptr_t>(m_RingStorage.get());
+    m_Ring = m_RingStorage.get() + (SER_RING_ALIGN - address % SER_RING_ALIGN) % SER_RING_ALIGN;
+
+    m_SlotTicks.assign(m_SlotCount, 0);
+    m_Head = m_Tail = m_Buffered = 0;
+
+    QDir().mkpath(QFileInfo(filename).absolutePath());
+    m_Filename = filename;
+    m_File.setFileName(filename);
+    if (m_File.open(QIODevice::WriteOnly | QIODevice::Truncate | QIODevice::Unbuffered) == false)
+    {
+        m_Error = m_File.errorString();
+        m_RingStorage.reset();
+        return false;
+    }
+
+    m_StartTicks    = currentTicks(false);
+    m_StartTicksUTC = currentTicks(true);
+
+    // The frame count is updated when recording is closed
+    if (writeHeader(0) == false)
+    {
+        m_Error = m_File.errorString();
+        m_File.close();
+        m_RingStorage.reset();
+        return false;
+    }
+
+    m_Timestamps.clear();
+    m_Accepted = m_Written = m_Dropped = m_Bytes = 0;
+    m_Stopping = m_Failed = false;
+    m_Open     = true;
+    m_Timer.start();
+
+    QtConcurrent::run(&m_Writer, this, &SERRecorder::writeLoop);
+
+    qCInfo(KSTARS) << "SER recording to" << filename << width << "x" << height << depth << "bits," << m_SlotCount
+                   << "frames buffered";
+
+    return true;
+}
+
+bool SERRecorder::writeHeader(uint32_t frameCount)
+{
+    QByteArray header;
+    header.reserve(SER_HEADER_SIZE);
+
+    header.append("LUCAM-RECORDER", 14);
+    appendInt32(header, 0);
+    appendInt32(header, m_Color);
+    // The specification says 1 is little endian, but readers treat 0 as little endian since the first writers did
+    appendInt32(header, 0);
+    appendInt32(header, m_Width);
+    appendInt32(header, m_Height);
+    appendInt32(header, m_Depth);
+    appendInt32(header, frameCount);
+    appendString(header, QString(), 40);
+    appendString(header, m_Instrument, 40);
+    appendString(header, QString(), 40);
+    appendInt64(header, m_StartTicks);
+    appendInt64(header, m_StartTicksUTC);
+
+    return m_File.seek(0) && m_File.write(header) == SER_HEADER_SIZE;
+}
+
+bool SERRecorder::addFrame(const void *data, uint32_t size)
+{
+    if (m_Open == false)
+        return false;
+
+    uint32_t slot = 0;
+    {
+        QMutexLocker locker(&m_Mutex);
+
+        if (size != m_FrameSize || m_Failed || m_Buffered == m_SlotCount)
+        {
+            m_Dropped++;
+            return false;
+        }
+
+        slot = m_Head;
+    }
+
+    // The slot at the head is not visible to the writer until it is published below
+    memcpy(m_Ring + static_cast<quint64>(slot) * m_FrameSize, data, size);
+    m_SlotTicks[slot] = currentTicks(true);
+
+    QMutexLocker locker(&m_Mutex);
+    m_Head = (m_Head + 1) % m_SlotCount;
+    m_Buffered++;
+    m_Accepted++;
+    m_FramesAvailable.wakeOne();
+
+    return true;
+}
+
+void SERRecorder::writeLoop()
+{
+    const uint32_t maxBatch = qMax<uint32_t>(1, SER_MAX_WRITE / m_FrameSize);
+
+    QMutexLocker locker(&m_Mutex);
+
+    while (true)
+    {
+        while (m_Buffered == 0 && m_Stopping == false)
+            m_FramesAvailable.wait(&m_Mutex);
+
+        if (m_Buffered == 0 || m_Failed)
+        {
+            locker.unlock();
+            finish();
+            return;
+        }
+
+        // Consecutive frames up to the end of the ring are written at once
+        const uint32_t tail  = m_Tail;
+        const uint32_t count = qMin(qMin(m_Buffered, m_SlotCount - tail), maxBatch);
+
+        locker.unlock();
+
+        const qint64 bytes   = static_cast<qint64>(count) * m_FrameSize;
+        const qint64 written = m_File.write(reinterpret_cast<const char *>(m_Ring + static_cast<quint64>(tail) * m_FrameSize),
+                                            bytes);
+        for (uint32_t i = 0; i < count; i++)
+            m_Timestamps.append(m_SlotTicks[tail + i]);
+
+        locker.relock();
+
+        if (written != bytes)
+        {
+            qCCritical(KSTARS) << "SER recording failed:" << m_File.errorString();
+            m_Error  = m_File.errorString();
+            m_Failed = true;
+            // Frames still in the ring will never be written
+            m_Dropped += m_Buffered;
+            m_Buffered = 0;
+
+            locker.unlock();
+            finish();
+            return;
+        }
+
+        m_Tail = (m_Tail + count) % m_SlotCount;
+        m_Buffered -= count;
+        m_Written += count;
+        m_Bytes += bytes;
+    }
+}
+
+void SERRecorder::close()
+{
+    if (m_Open == false)
+        return;
+
+    m_Open = false;
+
+    QMutexLocker locker(&m_Mutex);
+    m_Stopping = true;
+    m_FramesAvailable.wakeOne();
+}
+
+void SERRecorder::finish()
+{
+    // Timestamps of the frames that were written follow the frame data
+    if (m_Failed == false)
+    {
+        QByteArray trailer;
+        trailer.reserve(m_Timestamps.count() * 8);
+        for (qint64 ticks : m_Timestamps)
+            appendInt64(trailer, ticks);
+
+        if (m_File.write(trailer) != trailer.size() || writeHeader(m_Written) == false)
+        {
+            m_Error = m_File.errorString();
+            qCCritical(KSTARS) << "SER recording failed to finalize" << m_Filename << m_Error;
+        }
+    }
+
+    m_File.close();
+    m_RingStorage.reset();
+    m_Ring = nullptr;
+
+    Statistics stats = statistics();
+    qCInfo(KSTARS) << "SER recording closed" << m_Filename << stats.written << "frames written," << stats.dropped
+                   << "dropped," << stats.rate << "MB/s";
+
+    emit finished();
+}
+
+bool SERRecorder::isLimitReached() const
+{
+    QMutexLocker locker(&m_Mutex);
+
+    if (m_FrameLimit > 0 && m_Accepted >= m_FrameLimit)
+        return true;
+
+    return m_DurationLimit > 0 && m_Timer.isValid() && m_Timer.elapsed() >= m_DurationLimit * 1000;
+}
+
+SERRecorder::Statistics SERRecorder::statistics() const
+{
+    QMutexLocker locker(&m_Mutex);
+
+    Statistics stats;
+    stats.written  = m_Written;
+    stats.dropped  = m_Dropped;
+    stats.buffered = m_Buffered;
+    stats.bytes    = m_Bytes;
+    stats.elapsed  = m_Timer.isValid() ? m_Timer.elapsed() / 1000.0 : 0;
+    stats.rate     = stats.elapsed > 0 ? m_Bytes / (1024.0 * 1024.0) / stats.elapsed : 0;
+
+    return stats;
+}
@@ -0,0 +1,190 @@
+/*  SER Stream Recorder
+    Copyright (C) 2020 KStars Developers
+
+    This application is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public
+    License as published by the Free Software Foundation; either
+    version 2 of the License, or (at your option) any later version.
+ */
+
+#pragma once
+
+#include <QElapsedTimer>
+#include <QFile>
+#include <QMutex>
+#include <QObject>
+#include <QString>
+#include <QThreadPool>
+#include <QVector>
+#include <QWaitCondition>
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+/**
+ * @class SERRecorder
+ * Records raw stream frames to a SER file on the client.
+ *
+ * Frames are copied into a ring buffer allocated when recording starts, and a dedicated writer thread
+ * writes runs of consecutive frames to disk in large sequential writes. Recording never blocks the stream:
+ * if the disk cannot keep up and the ring buffer is full, the frame is dropped and counted. Stopping does not
+ * block either: the writer thread drains the ring buffer, completes the file and emits finished().
+ */
+class SERRecorder : public QObject
+{
+        Q_OBJECT
+
+    public:
+        typedef enum
+        {
+            COLOR_MONO       = 0,
+            COLOR_BAYER_RGGB = 8,
+            COLOR_BAYER_GRBG = 9,
+            COLOR_BAYER_GBRG = 10,
+            COLOR_BAYER_BGGR = 11,
+            COLOR_RGB        = 100
+        } ColorID;
+
+        typedef struct
+        {
+            // Frames written to disk
+            quint64 written;
+            // Frames dropped because the ring buffer was full, the frame size was wrong or writing failed
+            quint64 dropped;
+            // Frames waiting in the ring buffer
+            uint32_t buffered;
+            // Bytes of frame data written to disk
+            quint64 bytes;
+            // Seconds since recording started
+            double elapsed;
+            // Sustained write rate in MB/s since recording started
+            double rate;
+        } Statistics;
+
+        /**
+         * @param ringSize Size of the ring buffer in bytes, allocated when recording starts.
+         */
+        explicit SERRecorder(quint64 ringSize = 256 * 1024 * 1024, QObject *parent = nullptr);
+        ~SERRecorder() override;
+
+        /**
+         * @brief open Create the SER file and start the writer thread.
+         * @param filename Path of the SER file, overwritten if it exists.
+         * @param width Frame width in pixels.
+         * @param height Frame height in pixels.
+         * @param depth Bits per pixel and color plane, 8 or 16.
+         * @param color Color layout of the frames.
+         * @param instrument Camera name stored in the header.
+         * @return False if the file could not be created or the ring buffer could not be allocated.
+         */
+        bool open(const QString &filename, uint32_t width, uint32_t height, uint32_t depth, ColorID color,
+                  const QString &instrument);
+
+        /**
+         * @brief close Stop accepting frames and return at once. The writer thread writes the remaining frames and
+         * the timestamps, closes the file, then emits finished().
+         */
+        void close();
+
+        bool isOpen() const
+        {
+            return m_Open;
+        }
+
+        // Recording limits, 0 for none. The limit is reached once that many frames were accepted or that
+        // many seconds elapsed.
+        void setFrameLimit(quint64 frames)
+        {
+            m_FrameLimit = frames;
+        }
+        void setDurationLimit(double seconds)
+        {
+            m_DurationLimit = seconds;
+        }
+        bool isLimitReached() const;
+
+        /**
+         * @brief addFrame Copy a frame into the ring buffer. Must always be called from the same thread.
+         * @return True if the frame was queued, false if it was dropped.
+         */
+        bool addFrame(const void *data, uint32_t size);
+
+        uint32_t frameSize() const
+        {
+            return m_FrameSize;
+        }
+        const QString &filename() const
+        {
+            return m_Filename;
+        }
+        const QString &errorString() const
+        {
+            return m_Error;
+        }
+
+        Statistics statistics() const;
+
+        /**
+         * @brief expandFilename Replace the _D_, _H_, _T_ and _F_ patterns of a SER file name template.
+         * @return Full path of the file, with the .ser extension.
+         */
+        static QString expandFilename(const QString &directory, const QString &name, const QString &filter);
+
+    signals:
+        // Emitted from the writer thread once the file is complete, or recording failed
+        void finished();
+
+    private:
+        void writeLoop();
+        // Writer thread: write the timestamps and the frame count, then release the file and the ring buffer
+        void finish();
+        bool writeHeader(uint32_t frameCount);
+
+        // .NET ticks used for SER timestamps, 100 ns since 0001-01-01
+        static qint64 currentTicks(bool utc);
+
+        quint64 m_RingSize { 0 };
+        std::unique_ptr<uint8_t[]> m_RingStorage;
+        // Start of the ring buffer aligned to the page size
+        uint8_t *m_Ring { nullptr };
+        uint32_t m_SlotCount { 0 };
+        // Slots in use run from m_Tail for m_Buffered slots, only the producer writes at m_Head
+        uint32_t m_Head { 0 };
+        uint32_t m_Tail { 0 };
+        uint32_t m_Buffered { 0 };
+        std::vector<qint64> m_SlotTicks;
+
+        mutable QMutex m_Mutex;
+        QWaitCondition m_FramesAvailable;
+        bool m_Stopping { false };
+        bool m_Failed { false };
+        QThreadPool m_Writer;
+
+        QFile m_File;
+        QString m_Filename;
+        QString m_Error;
+        // Accepting frames, only used from the thread calling open(), addFrame() and close()
+        bool m_Open { false };
+
+        uint32_t m_Width { 0 };
+        uint32_t m_Height { 0 };
+        uint32_t m_Depth { 0 };
+        ColorID m_Color { COLOR_MONO };
+        QString m_Instrument;
+        uint32_t m_FrameSize { 0 };
+        qint64 m_StartTicks { 0 };
+        qint64 m_StartTicksUTC { 0 };
+
+        // Written by the writer thread, in order
+        QVector<qint64> m_Timestamps;
+
+        quint64 m_Accepted { 0 };
+        quint64 m_Written { 0 };
+        quint64 m_Dropped { 0 };
+        quint64 m_Bytes { 0 };
+        QElapsedTimer m_Timer;
+
+        quint64 m_FrameLimit { 0 };
+        double m_DurationLimit { 0 };
+};
@@ -56,6 +56,10 @@ RecordOptions::RecordOptions(QWidget *parent) : QDialog(parent)
     selectDirB->setIcon(
         QIcon::fromTheme("document-open-folder"));
     connect(selectDirB, SIGNAL(clicked()), this, SLOT(selectRecordDirectory()));
+
+    clientDirectoryEdit->setText(Options::clientRecordDirectory());
+    selectClientDirB->setIcon(QIcon::fromTheme("document-open-folder"));
+    connect(selectClientDirB, SIGNAL(clicked()), this, SLOT(selectClientDirectory()));
 }
 
 void RecordOptions::selectRecordDirectory()
@@ -69,6 +73,17 @@ void RecordOptions::selectRecordDirectory()
     recordDirectoryEdit->setText(dir);
 }
 
+void RecordOptions::selectClientDirectory()
+{
+    QString dir = QFileDialog::getExistingDirectory(KStars::Instance(), i18n("Client SER Record Directory"),
+                  clientDirectoryEdit->text());
+
+    if (dir.isEmpty())
+        return;
+
+    clientDirectoryEdit->setText(dir);
+}
+
 StreamWG::StreamWG(ISD::CCD *ccd) : QDialog(KStars::Instance())
 {
     setupUi(this);
@@ -193,6 +208,8 @@ StreamWG::StreamWG(ISD::CCD *ccd) : QDialog(KStars::Instance())
         }
     });
 
+    recordStatus->hide();
+
     debayerB->setIcon(QIcon(":/icons/cfa.svg"));
     connect(debayerB, &QPushButton::clicked, this, [this]()
     {
@@ -267,6 +284,7 @@ void StreamWG::showEvent(QShowEvent *ev)
 void StreamWG::closeEvent(QCloseEvent * ev)
 {
     processStream = false;
+    stopClientRecording();
 
     Options::setStreamWindowWidth(width());
     Options::setStreamWindowHeight(height());
@@ -286,13 +304,18 @@ void StreamWG::enableStream(bool enable)
     if (enable)
     {
         processStream = true;
+        videoFrame->resetStatistics();
+        m_LastDisplayed = 0;
+        m_DisplayTimer.start();
         show();
     }
     else
     {
         processStream = false;
+        stopClientRecording();
         //instFPS->setText("--");
         avgFPS->setText("--");
+        droppedFrames->setText("--");
         hide();
     }
 }
@@ -346,7 +369,21 @@ void StreamWG::toggleRecord()
         isRecording = false;
         recordB->setToolTip(i18n("Start recording"));
 
-        currentCCD->stopRecording();
+        if (m_ClientRecording)
+            stopClientRecording();
+        else
+            currentCCD->stopRecording();
+    }
+    else if (options->clientRecordC->isChecked())
+    {
+        startClientRecording();
+        isRecording = m_ClientRecording;
+
+        if (isRecording)
+        {
+            recordB->setIcon(stopIcon);
+            recordB->setToolTip(i18n("Stop recording"));
+        }
     }
     else
     {
@@ -377,10 +414,135 @@ void StreamWG::toggleRecord()
 
 void StreamWG::newFrame(IBLOB *bp)
 {
+    // Recorded before the frame is handed to the display so dropped display frames are still recorded
+    if (m_ClientRecording)
+    {
+        if (m_Recorder->isOpen() || openClientRecorder(bp))
+        {
+            m_Recorder->addFrame(bp->blob, static_cast<uint32_t>(bp->size));
+            if (m_Recorder->isLimitReached())
+                stopClientRecording();
+        }
+        else
+            stopClientRecording();
+    }
+
+    // Decoding happens off the GUI thread, failures are counted in the decoder statistics
     bool rc = (m_DebayerActive) ? videoFrame->newBayerFrame(bp, m_DebayerParams) : videoFrame->newFrame(bp);
 
     if (rc == false)
-        qCWarning(KSTARS) << "Failed to load video frame.";
+        qCWarning(KSTARS) << "Failed to queue video frame.";
+}
+
+void StreamWG::startClientRecording()
+{
+    Options::setClientRecordDirectory(options->clientDirectoryEdit->text());
+
+    m_Recorder.reset(new SERRecorder());
+
+    if (options->recordDurationR->isChecked())
+        m_Recorder->setDurationLimit(options->durationSpin->value());
+    else if (options->recordFramesR->isChecked())
+        m_Recorder->setFrameLimit(options->framesSpin->value());
+
+    m_ClientRecording = true;
+
+    recordStatus->setText(i18n("Waiting for frames..."));
+    recordStatus->show();
+}
+
+bool StreamWG::openClientRecorder(const IBLOB *bp)
+{
+    const uint32_t pixels = static_cast<uint32_t>(streamWidth * streamHeight);
+    if (streamWidth <= 0 || streamHeight <= 0 || bp->size <= 0 || bp->size % pixels != 0)
+    {
+        recordStatus->setText(i18n("Client recording requires raw stream frames."));
+        return false;
+    }
+
+    SERRecorder::ColorID color = SERRecorder::COLOR_MONO;
+    uint32_t depth = 8;
+
+    switch (bp->size / pixels)
+    {
+        case 2:
+            depth = 16;
+        // fall through
+        case 1:
+            // Bayer frames are recorded raw, SER readers debayer them
+            if (m_DebayerSupported)
+            {
+                switch (m_DebayerParams.filter)
+                {
+                    case DC1394_COLOR_FILTER_GRBG:
+                        color = SERRecorder::COLOR_BAYER_GRBG;
+                        break;
+                    case DC1394_COLOR_FILTER_GBRG:
+                        color = SERRecorder::COLOR_BAYER_GBRG;
+                        break;
+                    case DC1394_COLOR_FILTER_BGGR:
+                        color = SERRecorder::COLOR_BAYER_BGGR;
+                        break;
+                    default:
+                        color = SERRecorder::COLOR_BAYER_RGGB;
+                        break;
+                }
+            }
+            break;
+
+        case 6:
+            depth = 16;
+        // fall through
+        case 3:
+            color = SERRecorder::COLOR_RGB;
+            break;
+
+        default:
+            recordStatus->setText(i18n("Client recording requires raw stream frames."));
+            return false;
+    }
+
+    // The directory of the driver may be on the remote INDI server, client recordings have their own
+    QString filename = SERRecorder::expandFilename(options->clientDirectoryEdit->text(),
+                       options->recordFilenameEdit->text(), QString());
+
+    if (m_Recorder->open(filename, streamWidth, streamHeight, depth, color, currentCCD->getDeviceName()) == false)
+    {
+        recordStatus->setText(i18n("Recording failed: %1", m_Recorder->errorString()));
+        return false;
+    }
+
+    return true;
+}
+
+void StreamWG::stopClientRecording()
+{
+    if (m_ClientRecording == false)
+        return;
+
+    m_ClientRecording = false;
+
+    if (m_Recorder->isOpen())
+    {
+        // The writer thread drains the ring buffer, the recorder is deleted once the file is complete
+        SERRecorder *recorder = m_Recorder.release();
+        connect(recorder, &SERRecorder::finished, this, [this, recorder]()
+        {
+            SERRecorder::Statistics stats = recorder->statistics();
+            if (recorder->errorString().isEmpty())
+                recordStatus->setText(i18n("%1 frames, %2 MB/s, %3 dropped", stats.written,
+                                           QString::number(stats.rate, 'f', 1), stats.dropped));
+            else
+                recordStatus->setText(i18n("Recording failed: %1", recorder->errorString()));
+            recordStatus->setToolTip(recorder->filename());
+        });
+        connect(recorder, &SERRecorder::finished, recorder, &QObject::deleteLater);
+        recorder->close();
+
+        recordStatus->setText(i18n("Writing buffered frames..."));
+    }
+
+    updateRecordStatus(false);
 }
 
 void StreamWG::resetFrame()
@@ -414,4 +576,30 @@ void StreamWG::updateFPS(double instantFPS, double averageFPS)
     Q_UNUSED(instantFPS)
     //instFPS->setText(QString::number(instantFPS, 'f', 1));
     avgFPS->setText(QString::number(averageFPS, 'f', 1));
+
+    VideoDecoder::Statistics stats = videoFrame->statistics();
+
+    double displayFPS = 0;
+    if (m_DisplayTimer.isValid() && m_DisplayTimer.elapsed() > 0)
+        displayFPS = (stats.displayed - m_LastDisplayed) * 1000.0 / m_DisplayTimer.elapsed();
+    m_LastDisplayed = stats.displayed;
+    m_DisplayTimer.restart();
+
+    droppedFrames->setText(QString::number(stats.droppedBeforeDecode + stats.droppedBeforeDisplay));
+    droppedFrames->setToolTip(i18n("Received: %1\nDisplayed: %2 (%3 FPS)\nDropped before decoding: %4\n"
+                                   "Dropped before display: %5\nFailed to decode: %6",
+                                   stats.received, stats.displayed, QString::number(displayFPS, 'f', 1),
+                                   stats.droppedBeforeDecode, stats.droppedBeforeDisplay, stats.failed));
+
+    if (m_ClientRecording && m_Recorder->isOpen())
+    {
+        SERRecorder::Statistics recording = m_Recorder->statistics();
+        recordStatus->setText(i18n("%1 MB/s, %2 dropped", QString::number(recording.rate, 'f', 1), recording.dropped));
+        recordStatus->setToolTip(i18n("Written: %1 frames\nBuffered: %2 frames\nDropped: %3 frames\nFile: %4",
+                                      recording.written, recording.buffered, recording.dropped, m_Recorder->filename()));
+    }
+
+    qCDebug(KSTARS) << "Stream FPS" << averageFPS << "display FPS" << displayFPS << "received" << stats.received
+                    << "displayed" << stats.displayed << "dropped before decoding" << stats.droppedBeforeDecode
+                    << "dropped before display" << stats.droppedBeforeDisplay << "failed" << stats.failed;
 }
@@ -14,9 +14,11 @@
 #include "ui_streamform.h"
 #include "ui_recordingoptions.h"
 #include "fitsviewer/bayer.h"
+#include "serrecorder.h"
 #include <indidevapi.h>
 
 #include <QCloseEvent>
+#include <QElapsedTimer>
 #include <QColor>
 #include <QIcon>
 #include <QImage>
@@ -26,6 +28,8 @@
 #include <QVBoxLayout>
 #include <QVector>
 
+#include <memory>
+
 class RecordOptions : public QDialog, public Ui::recordingOptions
 {
         Q_OBJECT
@@ -35,6 +39,7 @@ class RecordOptions : public QDialog, public Ui::recordingOptions
 
     public slots:
         void selectRecordDirectory();
+        void selectClientDirectory();
 
     private:
         QUrl dirPath;
@@ -92,6 +97,11 @@ class StreamWG : public QDialog, public Ui::streamForm
     private:
         bool queryDebayerParameters();
 
+        // Client side SER recording, the recorder is opened with the size of the first frame
+        void startClientRecording();
+        void stopClientRecording();
+        bool openClientRecorder(const IBLOB *bp);
+
         bool processStream;
         int streamWidth, streamHeight;
         bool colorFrame, isRecording;
@@ -105,6 +115,13 @@ class StreamWG : public QDialog, public Ui::streamForm
         double pixelX, pixelY;
         bool m_DebayerActive { false }, m_DebayerSupported { false };
 
+        // Frames displayed at the last FPS update, to compare the display rate with the stream rate
+        quint64 m_LastDisplayed { 0 };
+        QElapsedTimer m_DisplayTimer;
+
+        std::unique_ptr<SERRecorder> m_Recorder;
+        bool m_ClientRecording { false };
+
         // For Canon DSLRs
         INDI::Property *eoszoom {nullptr}, *eoszoomposition {nullptr};
         RecordOptions *options;
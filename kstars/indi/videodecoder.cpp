@@ -0,0 +1,244 @@
+/*  Video Stream Decoder
+    Copyright (C) 2020 KStars Developers
+
+    This application is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public
+    License as published by the Free Software Foundation; either
+    version 2 of the License, or (at your option) any later version.
+ */
+
+#include "videodecoder.h"
+
+#include "kstars_debug.h"
+
+#include <QImageReader>
+#include <QMutexLocker>
+#include <QtConcurrent>
+
+#include <cstring>
+#include <utility>
+
+VideoDecoder::VideoDecoder(QObject *parent) : QObject(parent)
+{
+    m_Worker.setMaxThreadCount(1);
+
+    m_GrayTable.resize(256);
+    for (int i = 0; i < 256; i++)
+        m_GrayTable[i] = qRgb(i, i, i);
+
+    resetStatistics();
+}
+
+VideoDecoder::~VideoDecoder()
+{
+    {
+        QMutexLocker locker(&m_Mutex);
+        m_HasPending = false;
+    }
+
+    m_Worker.waitForDone();
+}
+
+bool VideoDecoder::submit(const IBLOB *bp, uint16_t width, uint16_t height, bool debayer, const BayerParams &params,
+                          const QSize &targetSize)
+{
+    if (bp->size <= 0)
+        return false;
+
+    // QImageReader is queried once per format change only
+    if (m_RawFormat != bp->format)
+    {
+        m_RawFormat = bp->format;
+        QString format = m_RawFormat;
+        format.remove('.');
+        format.remove("stream_");
+        m_RawFormatSupported = QImageReader::supportedImageFormats().contains(format.toLatin1());
+    }
+
+    QMutexLocker locker(&m_Mutex);
+
+    m_Statistics.received++;
+
+    // Latest frame wins, the one still waiting is dropped
+    if (m_HasPending)
+        m_Statistics.droppedBeforeDecode++;
+
+    // Reuses the allocation of the buffer when the frame size does not change
+    m_Pending.data.resize(bp->size);
+    memcpy(m_Pending.data.data(), bp->blob, bp->size);
+    m_Pending.compressed = m_RawFormatSupported;
+    m_Pending.width      = width;
+    m_Pending.height     = height;
+    m_Pending.debayer    = debayer && !m_RawFormatSupported;
+    m_Pending.params     = params;
+    m_Pending.targetSize = targetSize;
+    m_HasPending         = true;
+
+    if (m_Running == false)
+    {
+        m_Running = true;
+        QtConcurrent::run(&m_Worker, this, &VideoDecoder::decodeLoop);
+    }
+
+    return true;
+}
+
+void VideoDecoder::decodeLoop()
+{
+    while (true)
+    {
+        {
+            QMutexLocker locker(&m_Mutex);
+            if (m_HasPending == false)
+            {
+                m_Running = false;
+                return;
+            }
+
+            std::swap(m_Pending, m_Decoding);
+            m_HasPending = false;
+        }
+
+        std::shared_ptr<QImage> image;
+        bool rc = decode(m_Decoding, image);
+
+        QImage scaled;
+        if (rc)
+            scaled = image->scaled(m_Decoding.targetSize, Qt::KeepAspectRatio);
+
+        QMutexLocker locker(&m_Mutex);
+
+        if (rc == false)
+        {
+            m_Statistics.failed++;
+            qCWarning(KSTARS) << "Failed to decode video frame.";
+            continue;
+        }
+
+        m_Statistics.decoded++;
+        if (m_Ready)
+            m_Statistics.droppedBeforeDisplay++;
+
+        m_Ready       = image;
+        m_ReadyScaled = scaled;
+
+        // The GUI takes the latest frame when it gets to it, one notification is enough
+        if (m_ReadyNotified == false)
+        {
+            m_ReadyNotified = true;
+            emit frameReady();
+        }
+    }
+}
+
+bool VideoDecoder::decode(const frame_t &frame, std::shared_ptr<QImage> &image)
+{
+    const uchar *data = reinterpret_cast<const uchar *>(frame.data.constData());
+    const uint32_t size = static_cast<uint32_t>(frame.data.size());
+    const uint32_t totalBaseCount = frame.width * frame.height;
+
+    if (frame.compressed)
+    {
+        image.reset(new QImage());
+        return image->loadFromData(data, size);
+    }
+
+    if (frame.width == 0 || frame.height == 0)
+        return false;
+
+    if (frame.debayer && size == totalBaseCount)
+        return debayer(frame, image);
+
+    // Raw frames are copied line by line since QImage lines are 32 bit aligned
+    uint32_t bytesPerPixel = 0;
+    if (size == totalBaseCount)
+    {
+        image.reset(new QImage(frame.width, frame.height, QImage::Format_Indexed8));
+        image->setColorTable(m_GrayTable);
+        bytesPerPixel = 1;
+    }
+    else if (size == totalBaseCount * 3)
+    {
+        image.reset(new QImage(frame.width, frame.height, QImage::Format_RGB888));
+        bytesPerPixel = 3;
+    }
+    else
+        return false;
+
+    if (image->isNull())
+        return false;
+
+    const uint32_t lineSize = frame.width * bytesPerPixel;
+    for (int y = 0; y < frame.height; y++)
+        memcpy(image->scanLine(y), data + y * lineSize, lineSize);
+
+    return true;
+}
+
+bool VideoDecoder::debayer(const frame_t &frame, std::shared_ptr<QImage> &image)
+{
+    const uint32_t rgb_size = frame.width * frame.height * 3;
+    if (m_DebayerBuffer.size() < rgb_size)
+        m_DebayerBuffer.resize(rgb_size);
+
+    int ds1394_height = frame.height;
+
+    const uint8_t *dc1394_source = reinterpret_cast<const uint8_t *>(frame.data.constData());
+    if (frame.params.offsetY == 1)
+    {
+        dc1394_source += frame.width;
+        ds1394_height--;
+    }
+    if (frame.params.offsetX == 1)
+    {
+        dc1394_source++;
+    }
+    dc1394error_t error_code = dc1394_bayer_decoding_8bit(dc1394_source, m_DebayerBuffer.data(), frame.width,
+                               ds1394_height, frame.params.filter, frame.params.method);
+
+    if (error_code != DC1394_SUCCESS)
+    {
+        qCCritical(KSTARS) << "Debayer failed" << error_code;
+        return false;
+    }
+
+    image.reset(new QImage(frame.width, frame.height, QImage::Format_RGB888));
+    if (image->isNull())
+        return false;
+
+    const uint32_t lineSize = frame.width * 3;
+    for (int y = 0; y < frame.height; y++)
+        memcpy(image->scanLine(y), m_DebayerBuffer.data() + y * lineSize, lineSize);
+
+    return true;
+}
+
+bool VideoDecoder::takeFrame(std::shared_ptr<QImage> &image, QImage &scaled)
+{
+    QMutexLocker locker(&m_Mutex);
+
+    m_ReadyNotified = false;
+
+    if (!m_Ready)
+        return false;
+
+    image = m_Ready;
+    scaled = m_ReadyScaled;
+    m_Ready.reset();
+    m_ReadyScaled = QImage();
+    m_Statistics.displayed++;
+
+    return true;
+}
+
+VideoDecoder::Statistics VideoDecoder::statistics() const
+{
+    QMutexLocker locker(&m_Mutex);
+    return m_Statistics;
+}
+
+void VideoDecoder::resetStatistics()
+{
+    QMutexLocker locker(&m_Mutex);
+    memset(&m_Statistics, 0, sizeof(m_Statistics));
+}
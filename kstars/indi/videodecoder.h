@@ -0,0 +1,126 @@
+/*  Video Stream Decoder
+    Copyright (C) 2020 KStars Developers
+
+    This application is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public
+    License as published by the Free Software Foundation; either
+    version 2 of the License, or (at your option) any later version.
+ */
+
+#pragma once
+
+#include "fitsviewer/bayer.h"
+
+#include <indidevapi.h>
+
+#include <QByteArray>
+#include <QImage>
+#include <QMutex>
+#include <QObject>
+#include <QSize>
+#include <QThreadPool>
+#include <QVector>
+
+#include <memory>
+#include <vector>
+
+/**
+ * @class VideoDecoder
+ * Decodes video stream frames to QImage on a worker thread.
+ *
+ * The pipeline holds at most one frame waiting to be decoded and one decoded frame waiting to be displayed.
+ * A newer frame replaces the waiting one, so the stream always shows the latest frame and never queues up
+ * when the GUI or the decoder cannot keep up with the camera. Each replaced frame is counted as dropped.
+ */
+class VideoDecoder : public QObject
+{
+        Q_OBJECT
+
+    public:
+        typedef struct
+        {
+            // Frames submitted by the driver
+            quint64 received;
+            // Frames decoded to an image
+            quint64 decoded;
+            // Frames handed to the GUI
+            quint64 displayed;
+            // Frames replaced by a newer one before they were decoded
+            quint64 droppedBeforeDecode;
+            // Frames decoded but replaced by a newer one before the GUI took them
+            quint64 droppedBeforeDisplay;
+            // Frames that could not be decoded
+            quint64 failed;
+        } Statistics;
+
+        explicit VideoDecoder(QObject *parent = nullptr);
+        virtual ~VideoDecoder() override;
+
+        /**
+         * @brief submit Copy the frame and queue it for decoding. Must be called from the thread owning the BLOB.
+         * @param bp Stream BLOB, its data is not referenced after submit returns.
+         * @param width Width of raw frames in pixels.
+         * @param height Height of raw frames in pixels.
+         * @param debayer True to debayer raw 8 bit frames using params.
+         * @param targetSize Size of the scaled image prepared for display.
+         * @return False if the BLOB is empty.
+         */
+        bool submit(const IBLOB *bp, uint16_t width, uint16_t height, bool debayer, const BayerParams &params,
+                    const QSize &targetSize);
+
+        /**
+         * @brief takeFrame Take the latest decoded frame.
+         * @param image Full resolution image.
+         * @param scaled Image scaled to the target size of the frame.
+         * @return False if no frame was decoded since the last call.
+         */
+        bool takeFrame(std::shared_ptr<QImage> &image, QImage &scaled);
+
+        Statistics statistics() const;
+        void resetStatistics();
+
+    signals:
+        // Emitted from the worker thread when a decoded frame is ready and the previous one was taken
+        void frameReady();
+
+    private:
+        typedef struct
+        {
+            QByteArray data;
+            uint16_t width;
+            uint16_t height;
+            bool compressed;
+            bool debayer;
+            BayerParams params;
+            QSize targetSize;
+        } frame_t;
+
+        void decodeLoop();
+        bool decode(const frame_t &frame, std::shared_ptr<QImage> &image);
+        bool debayer(const frame_t &frame, std::shared_ptr<QImage> &image);
+
+        // Single worker so frames are decoded in order
+        QThreadPool m_Worker;
+
+        mutable QMutex m_Mutex;
+        // Waiting to be decoded, and being decoded. Swapped so their buffers are reused.
+        frame_t m_Pending;
+        frame_t m_Decoding;
+        bool m_HasPending { false };
+        bool m_Running { false };
+
+        // Waiting to be displayed
+        std::shared_ptr<QImage> m_Ready;
+        QImage m_ReadyScaled;
+        bool m_ReadyNotified { false };
+
+        Statistics m_Statistics;
+
+        // Raw format of the last BLOB, and whether QImage can decode it
+        QString m_RawFormat;
+        bool m_RawFormatSupported { false };
+
+        // Only used by the worker
+        QVector<QRgb> m_GrayTable;
+        std::vector<uint8_t> m_DebayerBuffer;
+};
@@ -12,7 +12,6 @@
 
 #include "kstars_debug.h"
 
-#include <QImageReader>
 #include <QMouseEvent>
 #include <QResizeEvent>
 #include <QRubberBand>
@@ -21,55 +20,33 @@ VideoWG::VideoWG(QWidget *parent) : QLabel(parent)
 {
     streamImage.reset(new QImage());
 
-    grayTable.resize(256);
-
-    for (int i = 0; i < 256; i++)
-        grayTable[i] = qRgb(i, i, i);
+    m_Decoder = new VideoDecoder(this);
+    connect(m_Decoder, &VideoDecoder::frameReady, this, &VideoWG::showFrame, Qt::QueuedConnection);
 }
 
 bool VideoWG::newBayerFrame(IBLOB *bp, const BayerParams &params)
 {
-    return debayer(bp, params);
+    return m_Decoder->submit(bp, streamW, streamH, true, params, size());
 }
 
 bool VideoWG::newFrame(IBLOB *bp)
 {
-    if (bp->size <= 0)
-        return false;
+    return m_Decoder->submit(bp, streamW, streamH, false, BayerParams(), size());
+}
 
-    bool rc = false;
-    QString format(bp->format);
-    if (m_RawFormat != format)
-    {
-        format.remove('.');
-        format.remove("stream_");
-        m_RawFormatSupported = QImageReader::supportedImageFormats().contains(format.toLatin1());
-        m_RawFormat = format;
-    }
+void VideoWG::showFrame()
+{
+    std::shared_ptr<QImage> image;
+    QImage scaled;
 
-    if (m_RawFormatSupported)
-        rc = streamImage->loadFromData(static_cast<uchar *>(bp->blob), bp->size);
-    else if (static_cast<uint32_t>(bp->size) == totalBaseCount)
-    {
-        streamImage.reset(new QImage(static_cast<uchar *>(bp->blob), streamW, streamH, QImage::Format_Indexed8));
-        streamImage->setColorTable(grayTable);
-        rc = !streamImage->isNull();
-    }
-    else if (static_cast<uint32_t>(bp->size) == totalBaseCount * 3)
-    {
-        streamImage.reset(new QImage(static_cast<uchar *>(bp->blob), streamW, streamH, QImage::Format_RGB888));
-        rc = !streamImage->isNull();
-    }
+    if (m_Decoder->takeFrame(image, scaled) == false)
+        return;
 
-    if (rc)
-    {
-        kPix = QPixmap::fromImage(streamImage->scaled(size(), Qt::KeepAspectRatio));
-        setPixmap(kPix);
-    }
+    streamImage = image;
+    kPix        = QPixmap::fromImage(scaled);
+    setPixmap(kPix);
 
     emit imageChanged(streamImage);
-
-    return rc;
 }
 
 bool VideoWG::save(const QString &filename, const char *format)
@@ -79,9 +56,8 @@ bool VideoWG::save(const QString &filename, const char *format)
 
 void VideoWG::setSize(uint16_t w, uint16_t h)
 {
-    streamW        = w;
-    streamH        = h;
-    totalBaseCount = w * h;
+    streamW = w;
+    streamH = h;
 }
 
 //void VideoWG::resizeEvent(QResizeEvent *ev)
@@ -132,52 +108,3 @@ void VideoWG::mouseReleaseEvent(QMouseEvent *event)
     // determine selection, for example using QRect::intersects()
     // and QRect::contains().
 }
-
-bool VideoWG::debayer(const IBLOB *bp, const BayerParams &params)
-{
-    uint32_t rgb_size = streamW * streamH * 3;
-    auto * destinationBuffer = new uint8_t[rgb_size];
-
-    if (destinationBuffer == nullptr)
-    {
-        qCCritical(KSTARS) << "Unable to allocate memory for temporary bayer buffer.";
-        return false;
-    }
-
-    int ds1394_height = streamH;
-
-    uint8_t * dc1394_source = reinterpret_cast<uint8_t*>(bp->blob);
-    if (params.offsetY == 1)
-    {
-        dc1394_source += streamW;
-        ds1394_height--;
-    }
-    if (params.offsetX == 1)
-    {
-        dc1394_source++;
-    }
-    dc1394error_t error_code = dc1394_bayer_decoding_8bit(dc1394_source, destinationBuffer, streamW, ds1394_height,
-                               params.filter, params.method);
-
-    if (error_code != DC1394_SUCCESS)
-    {
-        qCCritical(KSTARS) << "Debayer failed" << error_code;
-        delete[] destinationBuffer;
-        return false;
-    }
-
-    streamImage.reset(new QImage(destinationBuffer, streamW, streamH, QImage::Format_RGB888));
-    bool rc = !streamImage->isNull();
-
-    if (rc)
-    {
-        kPix = QPixmap::fromImage(streamImage->scaled(size(), Qt::KeepAspectRatio));
-        setPixmap(kPix);
-    }
-
-    emit imageChanged(streamImage);
-
-    delete[] destinationBuffer;
-    return rc;
-}
-
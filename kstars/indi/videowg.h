@@ -11,6 +11,7 @@
 #pragma once
 
 #include "fitsviewer/bayer.h"
+#include "videodecoder.h"
 
 #include <indidevapi.h>
 
@@ -33,9 +34,19 @@ class VideoWG : public QLabel
         explicit VideoWG(QWidget *parent = nullptr);
         virtual ~VideoWG() override = default;
 
+        // Frames are decoded on a worker thread, the latest decoded frame is displayed when the GUI is ready
         bool newFrame(IBLOB *bp);
         bool newBayerFrame(IBLOB *bp, const BayerParams &params);
 
+        VideoDecoder::Statistics statistics() const
+        {
+            return m_Decoder->statistics();
+        }
+        void resetStatistics()
+        {
+            m_Decoder->resetStatistics();
+        }
+
         bool save(const QString &filename, const char *format);
 
         void setSize(uint16_t w, uint16_t h);
@@ -50,17 +61,15 @@ class VideoWG : public QLabel
         void newSelection(QRect);
         void imageChanged(std::shared_ptr<QImage> frame);
 
-    private:
-        bool debayer(const IBLOB *bp, const BayerParams &params);
+    private slots:
+        void showFrame();
 
+    private:
         uint16_t streamW { 0 };
         uint16_t streamH { 0 };
-        uint32_t totalBaseCount { 0 };
-        QVector<QRgb> grayTable;
+        VideoDecoder *m_Decoder { nullptr };
         std::shared_ptr<QImage> streamImage;
         QPixmap kPix;
         QRubberBand *rubberBand { nullptr };
         QPoint origin;
-        QString m_RawFormat;
-        bool m_RawFormatSupported { false };
 };
@@ -23,6 +23,7 @@
 #include "skycomponents/supernovaecomponent.h"
 #include "skycomponents/skymapcomposite.h"
 #include "ksnotification.h"
+#include "startuploader.h"
 #ifndef KSTARS_LITE
 #include "fov.h"
 #include "imageexporter.h"
@@ -136,15 +137,6 @@ bool KStarsData::initialize()
     //Initialize CatalogDB//
     catalogdb()->Initialize();
 
-    //Load Time Zone Rules//
-    emit progressText(i18n("Reading time zone rules"));
-    if (!readTimeZoneRulebook())
-    {
-        fatalErrorMessage("TZrules.dat");
-        return false;
-    }
-
-
     emit progressText(i18n("Upgrade existing user city db to support geographic elevation."));
 
 
@@ -184,50 +176,98 @@ bool KStarsData::initialize()
         fixcitydb.close();
     }
 
+    // The location dialog edits the user cities through this connection, so it must belong to the GUI thread
+    QSqlDatabase mycitydb = QSqlDatabase::addDatabase("QSQLITE", "mycitydb");
+    if (QFile::exists(dbfile))
+        mycitydb.setDatabaseName(dbfile);
 
-    //Load Cities//
-    emit progressText(i18n("Loading city data"));
-    if (!readCityData())
+    // Time zone rules and cities are read on the thread pool. Steps that convert local times, such as the sky
+    // objects and the observing list through KSAlmanac, wait for the rules
+    StartupLoader loader;
+
+    loader.add("Time zone rules", [this]()
     {
-        fatalErrorMessage("citydb.sqlite");
-        return false;
-    }
+        emit progressText(i18n("Reading time zone rules"));
+        return readTimeZoneRulebook();
+    }, QStringList(), true);
+
+    loader.add("Cities", [this]()
+    {
+        emit progressText(i18n("Loading city data"));
+        return readCityData();
+    }, QStringList("Time zone rules"), true);
 
     //Initialize User Database//
-    emit progressText(i18n("Loading User Information"));
-    m_ksuserdb.Initialize();
+    loader.add("User database", [this]()
+    {
+        emit progressText(i18n("Loading User Information"));
+        m_ksuserdb.Initialize();
+        return true;
+    });
 
     //Initialize SkyMapComposite//
-    emit progressText(i18n("Loading sky objects"));
-    m_SkyComposite.reset(new SkyMapComposite());
+    loader.add("Sky objects", [this]()
+    {
+        emit progressText(i18n("Loading sky objects"));
+        m_SkyComposite.reset(new SkyMapComposite());
+        return true;
+    }, QStringList("Time zone rules"));
+
     //Load Image URLs//
     //#ifndef Q_OS_ANDROID
     //On Android these 2 calls produce segfault. WARNING
-    emit progressText(i18n("Loading Image URLs"));
-
-    if( !readURLData( "image_url.dat", 0 ) && !nonFatalErrorMessage( "image_url.dat" ) )
-        return false;
+    loader.add("Image URLs", [this]()
+    {
+        emit progressText(i18n("Loading Image URLs"));
+        return readURLData("image_url.dat", 0) || nonFatalErrorMessage("image_url.dat");
+    }, QStringList("Sky objects"));
     //QtConcurrent::run(this, &KStarsData::readURLData, QString("image_url.dat"), 0, false);
 
     //Load Information URLs//
-    //emit progressText(i18n("Loading Information URLs"));
-    if( !readURLData( "info_url.dat", 1 ) && !nonFatalErrorMessage( "info_url.dat" ) )
-        return false;
-    QtConcurrent::run(this, &KStarsData::readURLData, QString("info_url.dat"), 1, false);
+    loader.add("Information URLs", [this]()
+    {
+        //emit progressText(i18n("Loading Information URLs"));
+        if (!readURLData("info_url.dat", 1) && !nonFatalErrorMessage("info_url.dat"))
+            return false;
+        QtConcurrent::run(this, &KStarsData::readURLData, QString("info_url.dat"), 1, false);
+        return true;
+    }, QStringList("Sky objects"));
 
     //#endif
     //emit progressText( i18n("Loading Variable Stars" ) );
 
 #ifndef KSTARS_LITE
     //Initialize Observing List
-    m_ObservingList = new ObservingList();
+    loader.add("Observing list", [this]()
+    {
+        m_ObservingList = new ObservingList();
+        return true;
+    }, QStringList() << "Sky objects" << "Time zone rules");
 #endif
 
-    readUserLog();
+    loader.add("User log", [this]()
+    {
+        readUserLog();
+        return true;
+    }, QStringList("Sky objects"));
 
 #ifndef KSTARS_LITE
-    readADVTreeData();
+    loader.add("Details tree", [this]()
+    {
+        readADVTreeData();
+        return true;
+    });
 #endif
+
+    if (loader.run() == false)
+    {
+        if (loader.failedStep() == "Time zone rules")
+            fatalErrorMessage("TZrules.dat");
+        else if (loader.failedStep() == "Cities")
+            fatalErrorMessage("citydb.sqlite");
+        return false;
+    }
+
     return true;
 }
 
@@ -444,6 +484,16 @@ bool KStarsData::readCityData()
         return false;
     }
 
+    // This runs on the thread pool while the sky is built from the same rulebook, so the rulebook is only read.
+    // Cities with a rule missing from it get the rule without daylight saving time.
+    auto rule = [this](const QString &id) -> TimeZoneRule *
+    {
+        auto found = Rulebook.constFind(id);
+        if (found == Rulebook.constEnd())
+            found = Rulebook.constFind("--");
+        return found == Rulebook.constEnd() ? nullptr : const_cast<TimeZoneRule *>(&found.value());
+    };
+
     QSqlQuery get_query(citydb);
 
     //get_query.prepare("SELECT * FROM city");
@@ -464,7 +514,7 @@ bool KStarsData::readCityData()
         dms lat              = dms(get_query.value(4).toString());
         dms lng              = dms(get_query.value(5).toString());
         double TZ            = get_query.value(6).toDouble();
-        TimeZoneRule *TZrule = &(Rulebook[get_query.value(7).toString()]);
+        TimeZoneRule *TZrule = rule(get_query.value(7).toString());
         double elevation     = get_query.value(8).toDouble();
 
         // appends city names to list
@@ -472,8 +522,8 @@ bool KStarsData::readCityData()
     }
     citydb.close();
 
-    // Reading local database
-    QSqlDatabase mycitydb = QSqlDatabase::addDatabase("QSQLITE", "mycitydb");
+    // Reading local database, through a connection of its own as this runs on the thread pool
+    QSqlDatabase mycitydb = QSqlDatabase::addDatabase("QSQLITE", "loadcitydb");
     dbfile = KSPaths::writableLocation(QStandardPaths::GenericDataLocation) + QDir::separator() + "mycitydb.sqlite";
 
     if (QFile::exists(dbfile))
@@ -496,7 +546,7 @@ bool KStarsData::readCityData()
                 dms lat              = dms(get_query.value(4).toString());
                 dms lng              = dms(get_query.value(5).toString());
                 double TZ            = get_query.value(6).toDouble();
-                TimeZoneRule *TZrule = &(Rulebook[get_query.value(7).toString()]);
+                TimeZoneRule *TZrule = rule(get_query.value(7).toString());
                 double elevation     = get_query.value(8).toDouble();
 
                 // appends city names to list
@@ -405,6 +405,7 @@ class KStarsData : public QObject
          * provides the information required to create one GeoLocation object.
          * @short Fill list of geographic locations from file(s)
          * @return true if at least one city read successfully.
+         * @note Runs on the thread pool during the startup, after readTimeZoneRulebook().
          * @see KStarsData::processCity()
          */
         bool readCityData();
@@ -27,6 +27,7 @@
 #include "ksutils.h"
 #include "Options.h"
 #include "simclock.h"
+#include "startuploader.h"
 #include "version.h"
 #if !defined(KSTARS_LITE)
 #include "kstars.h"
@@ -45,8 +46,10 @@
 #include <QCommandLineOption>
 #endif
 #include <QDebug>
+#include <QElapsedTimer>
 #include <QPixmap>
 #include <QScreen>
+#include <QTextStream>
 #include <QtGlobal>
 #include <QTranslator>
 
@@ -156,6 +159,7 @@ int main(int argc, char *argv[])
     parser.addOption(QCommandLineOption("height", i18n("Height of sky image."), "value"));
     parser.addOption(QCommandLineOption("date", i18n("Date and time."), "string"));
     parser.addOption(QCommandLineOption("paused", i18n("Start with clock paused.")));
+    parser.addOption(QCommandLineOption("startup-report", i18n("Print how long each part of the startup took.")));
 
     // urls to open
     parser.addPositionalArgument(QStringLiteral("urls"), i18n("FITS file(s) to open."), QStringLiteral("[urls...]"));
@@ -312,8 +316,17 @@ int main(int argc, char *argv[])
     writableDir.mkdir(KSPaths::writableLocation(QStandardPaths::GenericDataLocation));
     writableDir.mkdir(KSPaths::writableLocation(QStandardPaths::TempLocation));
 #ifndef KSTARS_LITE
+    QElapsedTimer startup;
+    startup.start();
+
     KStars::createInstance(true, !parser.isSet("paused"), datestring);
 
+    if (parser.isSet("startup-report"))
+    {
+        StartupLoader::record("Total", startup.elapsed());
+        QTextStream(stdout) << StartupLoader::report();
+    }
+
     // no session.. just start up normally
     const QStringList urls = parser.positionalArguments();
 
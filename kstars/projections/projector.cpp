@@ -58,6 +58,21 @@ Projector::Projector(const ViewParams &p)
 
 void Projector::setViewParams(const ViewParams &p)
 {
+    static quint64 lastViewID = 0;
+
+    // The focus is centered by its horizontal coordinates on a horizontal map, by its equatorial ones otherwise
+    const double focusLong = p.useAltAz ? p.focus->az().Degrees() : p.focus->ra().Degrees();
+    const double focusLat  = p.useAltAz ? p.focus->alt().Degrees() : p.focus->dec().Degrees();
+
+    if (m_viewID == 0 || p.width != m_vp.width || p.height != m_vp.height || p.zoomFactor != m_vp.zoomFactor ||
+            p.useRefraction != m_vp.useRefraction || p.useAltAz != m_vp.useAltAz || p.fillGround != m_vp.fillGround ||
+            focusLong != m_focusLong || focusLat != m_focusLat)
+    {
+        m_viewID    = ++lastViewID;
+        m_focusLong = focusLong;
+        m_focusLat  = focusLat;
+    }
+
     m_vp = p;
 
     /** Precompute cached values */
@@ -98,6 +98,13 @@ class Projector
     /** Return the FOV of this projection */
     double fov() const;
 
+    /**
+     * Identifies the view the projector is set up for. It changes whenever the size, zoom, focus or any
+     * other parameter that moves points on screen changes, and differs between projectors, so screen
+     * positions cached under one ID may be reused while it stays the same.
+     */
+    quint64 viewID() const { return m_viewID; }
+
     /**
      * Check if the current point on screen is a valid point on the sky. This is needed
      * to avoid a crash of the program if the user clicks on a point outside the sky (the
@@ -294,4 +301,8 @@ class Projector
     //Used by CheckVisibility
     double m_xrange { 0 };
     bool m_isPoleVisible { false };
+    //Used by viewID(), the focus point is updated in place so its coordinates are kept
+    quint64 m_viewID { 0 };
+    double m_focusLong { 0 };
+    double m_focusLat { 0 };
 };
@@ -32,6 +32,16 @@
 #include "skycomponents/skymapcomposite.h"
 
 #include <QHash>
+#include <QtMath>
+
+#include <algorithm>
+
+// columns of the constellation grid, 4 minutes of RA each
+#define CBOUNDS_GRID_COLUMNS 360
+// rows of the constellation grid, half a degree of Dec each
+#define CBOUNDS_GRID_ROWS 360
+// cells crossed by a boundary, searched exactly
+#define CBOUNDS_GRID_EDGE -1
 
 ConstellationBoundaryLines::ConstellationBoundaryLines(SkyComposite *parent)
     : NoPrecessIndex(parent, i18n("Constellation Boundaries"))
@@ -87,7 +97,10 @@ ConstellationBoundaryLines::ConstellationBoundaryLines(SkyComposite *parent)
             lineList.reset();
 
             if (polyList.get())
+            {
+                m_polyLists.append(polyList);
                 appendPoly(polyList, idxFile, verbose);
+            }
             QString cName = line.mid(1);
             polyList.reset(new PolyList(cName));
             if (verbose == -1)
@@ -147,7 +160,12 @@ ConstellationBoundaryLines::ConstellationBoundaryLines(SkyComposite *parent)
     if (lineList.get())
         appendLine(lineList);
     if (polyList.get())
+    {
+        m_polyLists.append(polyList);
         appendPoly(polyList, idxFile, verbose);
+    }
+
+    buildGrid();
 }
 
 bool ConstellationBoundaryLines::selected()
@@ -203,9 +221,98 @@ void ConstellationBoundaryLines::appendPoly(const std::shared_ptr<PolyList> &pol
         printf("PolyList: %3d: %d\n", ++m_polyIndexCnt, indexHash.size());
 }
 
+int ConstellationBoundaryLines::gridColumn(double ra)
+{
+    // Boundaries crossing 0h have negative RA
+    const int column = qFloor(ra * CBOUNDS_GRID_COLUMNS / 24.0) % CBOUNDS_GRID_COLUMNS;
+    return column < 0 ? column + CBOUNDS_GRID_COLUMNS : column;
+}
+
+int ConstellationBoundaryLines::gridRow(double dec)
+{
+    return qBound(0, qFloor((dec + 90.0) * CBOUNDS_GRID_ROWS / 180.0), CBOUNDS_GRID_ROWS - 1);
+}
+
+void ConstellationBoundaryLines::buildGrid()
+{
+    m_grid.fill(0, CBOUNDS_GRID_COLUMNS * CBOUNDS_GRID_ROWS);
+
+    // The boundaries run along lines of constant RA or Dec, so the cells in the bounding box of each edge are
+    // little more than the cells it crosses
+    for (const std::shared_ptr<PolyList> &polyList : m_polyLists)
+    {
+        const QPolygonF *poly = polyList->poly();
+
+        for (int i = 0; i < poly->size(); i++)
+        {
+            const QPointF &a = poly->at(i);
+            const QPointF &b = poly->at((i + 1) % poly->size());
+
+            const int minColumn = qFloor(std::min(a.x(), b.x()) * CBOUNDS_GRID_COLUMNS / 24.0);
+            const int maxColumn = qFloor(std::max(a.x(), b.x()) * CBOUNDS_GRID_COLUMNS / 24.0);
+            const int minRow    = gridRow(std::min(a.y(), b.y()));
+            const int maxRow    = gridRow(std::max(a.y(), b.y()));
+
+            for (int row = minRow; row <= maxRow; row++)
+            {
+                for (int column = minColumn; column <= maxColumn; column++)
+                {
+                    const int wrapped = (column % CBOUNDS_GRID_COLUMNS + CBOUNDS_GRID_COLUMNS) % CBOUNDS_GRID_COLUMNS;
+                    m_grid[row * CBOUNDS_GRID_COLUMNS + wrapped] = CBOUNDS_GRID_EDGE;
+                }
+            }
+        }
+    }
+
+    // No boundary separates the cells between two edges of a row, so one search covers all of them
+    for (int row = 0; row < CBOUNDS_GRID_ROWS; row++)
+    {
+        qint16 id    = CBOUNDS_GRID_EDGE;
+        bool newRun  = true;
+        qint16 *cell = m_grid.data() + row * CBOUNDS_GRID_COLUMNS;
+
+        for (int column = 0; column < CBOUNDS_GRID_COLUMNS; column++, cell++)
+        {
+            if (*cell == CBOUNDS_GRID_EDGE)
+            {
+                newRun = true;
+                continue;
+            }
+
+            if (newRun)
+            {
+                SkyPoint center((column + 0.5) * 24.0 / CBOUNDS_GRID_COLUMNS,
+                                (row + 0.5) * 180.0 / CBOUNDS_GRID_ROWS - 90.0);
+                PolyList *polyList = findPoly(&center);
+
+                auto found = std::find_if(m_polyLists.constBegin(), m_polyLists.constEnd(),
+                                          [polyList](const std::shared_ptr<PolyList> &other)
+                {
+                    return other.get() == polyList;
+                });
+
+                id     = polyList ? static_cast<qint16>(found - m_polyLists.constBegin()) : CBOUNDS_GRID_EDGE;
+                newRun = false;
+            }
+
+            *cell = id;
+        }
+    }
+}
+
 PolyList *ConstellationBoundaryLines::ContainingPoly(SkyPoint *p)
 {
-    //printf("called ContainingPoly(p)\n");
+    if (m_grid.isEmpty())
+        return findPoly(p);
+
+    const qint16 id = m_grid[gridRow(p->dec().Degrees()) * CBOUNDS_GRID_COLUMNS + gridColumn(p->ra().Hours())];
+
+    return id == CBOUNDS_GRID_EDGE ? findPoly(p) : m_polyLists[id].get();
+}
+
+PolyList *ConstellationBoundaryLines::findPoly(SkyPoint *p)
+{
+    //printf("called findPoly(p)\n");
 
     // we save the pointers in a hash because most often there is only one
     // constellation and we can avoid doing the expensive boundary calculations
@@ -21,6 +21,9 @@
 
 #include <QHash>
 #include <QPolygonF>
+#include <QVector>
+
+#include <memory>
 
 class PolyList;
 class ConstellationBoundary;
@@ -68,9 +71,31 @@ class ConstellationBoundaryLines : public NoPrecessIndex
      */
     void appendPoly(std::shared_ptr<PolyList> &polyList, KSFileReader *file, int debug);
 
+    /**
+     * @short fills m_grid once all the boundaries are read.  A cell crossed
+     * by a boundary is marked as an edge, any other cell holds the position
+     * in m_polyLists of the constellation it lies in.
+     */
+    void buildGrid();
+
+    static int gridColumn(double ra);
+    static int gridRow(double dec);
+
+    /**
+     * @short returns the constellation of the grid cell of p, and only
+     * searches the boundaries if the cell is crossed by one.
+     */
     PolyList *ContainingPoly(SkyPoint *p);
 
+    /**
+     * @short searches the boundaries indexed in the trixels around p.
+     */
+    PolyList *findPoly(SkyPoint *p);
+
     SkyMesh *m_skyMesh { nullptr };
     PolyIndex m_polyIndex;
     int m_polyIndexCnt { 0 };
+    // Owns every boundary, including those the index holds in no trixel
+    QVector<std::shared_ptr<PolyList>> m_polyLists;
+    QVector<qint16> m_grid;
 };
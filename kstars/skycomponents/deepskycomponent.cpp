@@ -28,17 +28,42 @@
 #endif
 #include "skymesh.h"
 #include "skypainter.h"
+#include "startuploader.h"
 #include "htmesh/MeshIterator.h"
 #include "projections/projector.h"
 #include "skyobjects/deepskyobject.h"
 
+#include <QCryptographicHash>
+#include <QElapsedTimer>
+#include <QSaveFile>
+
+#include <cstring>
+
+// magic number at the start of the deep-sky cache
+#define DSO_CACHE_MAGIC 0x4b534443
+// version of the deep-sky cache, raise it whenever the records or the parsing of ngcic.dat change
+#define DSO_CACHE_VERSION 1
+
 DeepSkyComponent::DeepSkyComponent(SkyComposite *parent) : SkyComponent(parent)
 {
     m_skyMesh = SkyMesh::Instance();
     // Add labels
     for (int i = 0; i <= MAX_LINENUMBER_MAG; i++)
         m_labelList[i] = new LabelList;
-    loadData();
+
+    catalog_t catalog = readCatalog(m_skyMesh->level());
+    loadData(catalog);
+}
+
+DeepSkyComponent::DeepSkyComponent(SkyComposite *parent, QFuture<catalog_t> catalog) : SkyComponent(parent)
+{
+    m_skyMesh = SkyMesh::Instance();
+    // Add labels
+    for (int i = 0; i <= MAX_LINENUMBER_MAG; i++)
+        m_labelList[i] = new LabelList;
+
+    catalog_t result = catalog.result();
+    loadData(result);
 }
 
 DeepSkyComponent::~DeepSkyComponent()
@@ -70,13 +95,56 @@ void DeepSkyComponent::update(KSNumbers *)
 {
 }
 
-void DeepSkyComponent::loadData()
+DeepSkyComponent::catalog_t DeepSkyComponent::readCatalog(int meshLevel)
 {
-    KStarsData *data = KStarsData::Instance();
+    QElapsedTimer timer;
+    timer.start();
+
     //Check whether we need to concatenate a split NGC/IC catalog
     //(i.e., if user has downloaded the Steinicke catalog)
     mergeSplitFiles();
 
+    QString file_name = KSPaths::locate(QStandardPaths::GenericDataLocation, QString("ngcic.dat"));
+
+    catalog_t catalog;
+    catalog.cacheName =
+        KSPaths::writableLocation(QStandardPaths::GenericCacheLocation) + QLatin1String("ngcic.cache");
+
+    // The cache is only used while it was made from the same catalog
+    QFile file(file_name);
+    if (file.open(QIODevice::ReadOnly))
+    {
+        QCryptographicHash md5(QCryptographicHash::Md5);
+        md5.addData(&file);
+        catalog.hash = md5.result();
+    }
+
+    catalog.cached =
+        catalog.hash.isEmpty() == false && readCache(catalog.cacheName, catalog.hash, meshLevel, catalog.entries);
+    if (catalog.cached)
+        qCInfo(KSTARS) << "Loading NGC/IC objects from" << catalog.cacheName;
+    else
+        parseCatalog(file_name, catalog.entries);
+
+    StartupLoader::record(QStringLiteral("Deep-sky catalog"), timer.elapsed());
+    return catalog;
+}
+
+void DeepSkyComponent::loadData(catalog_t &catalog)
+{
+    for (auto &entry : catalog.entries)
+        addObject(entry);
+
+    // The trixels of the entries are known once the objects are added
+    if (catalog.cached == false && catalog.hash.isEmpty() == false)
+        writeCache(catalog.cacheName, catalog.hash, catalog.entries);
+
+    for (auto &list : objectNames())
+        list.removeDuplicates();
+}
+
+void DeepSkyComponent::parseCatalog(const QString &file_name, QVector<catalogEntry_t> &entries)
+{
     QList<QPair<QString, KSParser::DataTypes>> sequence;
     QList<int> widths;
     sequence.append(qMakePair(QString("Flag"), KSParser::D_QSTRING));
@@ -145,7 +213,6 @@ void DeepSkyComponent::loadData()
     sequence.append(qMakePair(QString("Longname"), KSParser::D_QSTRING));
     //No width to be appended for last sequence object
 
-    QString file_name = KSPaths::locate(QStandardPaths::GenericDataLocation, QString("ngcic.dat"));
     KSParser deep_sky_parser(file_name, '#', sequence, widths);
 
     deep_sky_parser.SetProgress(i18n("Loading NGC/IC objects"), 13444, 10);
@@ -299,82 +366,258 @@ void DeepSkyComponent::loadData()
             if (!longname.isEmpty())
                 name = longname;
             else
-            {
                 hasName = false;
-                name    = i18n("Unnamed Object");
-            }
         }
 
-        name = i18nc("object name (optional)", name.toLatin1().constData());
-        if (!longname.isEmpty())
-            longname = i18nc("object name (optional)", longname.toLatin1().constData());
-
-        // create new deepskyobject
-        DeepSkyObject *o = nullptr;
         if (type == 0)
             type = 1; //Make sure we use CATALOG_STAR, not STAR
-        o = new DeepSkyObject(type, r, d, mag, name, name2, longname, cat, a, b, pa, pgc, ugc);
-        o->EquatorialToHorizontal(data->lst(), data->geo()->lat());
 
-        // Add the name(s) to the nameHash for fast lookup -jbb
-        if (hasName)
-        {
-            nameHash[name.toLower()] = o;
-            if (!longname.isEmpty())
-                nameHash[longname.toLower()] = o;
-            if (!name2.isEmpty())
-                nameHash[name2.toLower()] = o;
-        }
+        catalogEntry_t entry;
+        entry.type     = type;
+        entry.ra       = r.Degrees();
+        entry.dec      = d.Degrees();
+        entry.mag      = mag;
+        entry.a        = a;
+        entry.b        = b;
+        entry.pa       = pa;
+        entry.pgc      = pgc;
+        entry.ugc      = ugc;
+        entry.trixel   = -1;
+        entry.hasName  = hasName;
+        entry.name     = name;
+        entry.name2    = name2;
+        entry.longname = longname;
+        entry.catalog  = cat;
+        entries.append(entry);
 
-        Trixel trixel = m_skyMesh->index(o);
+        deep_sky_parser.ShowProgress();
+    }
+}
 
-        //Assign object to general DeepSkyObjects list,
-        //and a secondary list based on its catalog.
-        m_DeepSkyList.append(o);
-        appendIndex(o, &m_DeepSkyIndex, trixel);
+void DeepSkyComponent::addObject(catalogEntry_t &entry)
+{
+    KStarsData *data = KStarsData::Instance();
 
-        if (o->isCatalogM())
-        {
-            m_MessierList.append(o);
-            appendIndex(o, &m_MessierIndex, trixel);
-        }
-        else if (o->isCatalogNGC())
-        {
-            m_NGCList.append(o);
-            appendIndex(o, &m_NGCIndex, trixel);
-        }
-        else if (o->isCatalogIC())
+    // Names are kept untranslated in the cache, the language may have changed since it was made
+    QString name = entry.hasName ? i18nc("object name (optional)", entry.name.toLatin1().constData()) :
+                                   i18n("Unnamed Object");
+    QString longname;
+    if (!entry.longname.isEmpty())
+        longname = i18nc("object name (optional)", entry.longname.toLatin1().constData());
+    const QString &name2 = entry.name2;
+    const int type       = entry.type;
+
+    dms r(entry.ra), d(entry.dec);
+
+    // create new deepskyobject
+    DeepSkyObject *o = new DeepSkyObject(type, r, d, entry.mag, name, name2, longname, entry.catalog, entry.a,
+                                         entry.b, entry.pa, entry.pgc, entry.ugc);
+    o->EquatorialToHorizontal(data->lst(), data->geo()->lat());
+
+    // Add the name(s) to the nameHash for fast lookup -jbb
+    if (entry.hasName)
+    {
+        nameHash[name.toLower()] = o;
+        if (!longname.isEmpty())
+            nameHash[longname.toLower()] = o;
+        if (!name2.isEmpty())
+            nameHash[name2.toLower()] = o;
+    }
+
+    if (entry.trixel < 0)
+        entry.trixel = m_skyMesh->index(o);
+    Trixel trixel = entry.trixel;
+
+    //Assign object to general DeepSkyObjects list,
+    //and a secondary list based on its catalog.
+    m_DeepSkyList.append(o);
+    appendIndex(o, &m_DeepSkyIndex, trixel);
+
+    if (o->isCatalogM())
+    {
+        m_MessierList.append(o);
+        appendIndex(o, &m_MessierIndex, trixel);
+    }
+    else if (o->isCatalogNGC())
+    {
+        m_NGCList.append(o);
+        appendIndex(o, &m_NGCIndex, trixel);
+    }
+    else if (o->isCatalogIC())
+    {
+        m_ICList.append(o);
+        appendIndex(o, &m_ICIndex, trixel);
+    }
+    else
+    {
+        m_OtherList.append(o);
+        appendIndex(o, &m_OtherIndex, trixel);
+    }
+
+    // JM: VERY INEFFICIENT. Disabling for now until we figure out how to deal with dups. QSet?
+    //if ( ! name.isEmpty() && !objectNames(type).contains(name))
+    if (!name.isEmpty())
+    {
+        objectNames(type).append(name);
+        objectLists(type).append(QPair<QString, SkyObject *>(name, o));
+    }
+
+    //Add long name to the list of object names
+    //if ( ! longname.isEmpty() && longname != name  && !objectNames(type).contains(longname))
+    if (!longname.isEmpty() && longname != name)
+    {
+        objectNames(type).append(longname);
+        objectLists(type).append(QPair<QString, SkyObject *>(longname, o));
+    }
+}
+
+bool DeepSkyComponent::readCache(const QString &cache_name, const QByteArray &hash, int meshLevel,
+                                 QVector<catalogEntry_t> &entries)
+{
+    QFile file(cache_name);
+    if (file.open(QIODevice::ReadOnly) == false || file.size() < static_cast<qint64>(sizeof(cacheHeader_t)))
+        return false;
+
+    const uchar *map = file.map(0, file.size());
+    if (map == nullptr)
+        return false;
+
+    cacheHeader_t header;
+    memcpy(&header, map, sizeof(header));
+
+    const quint64 recordsEnd = sizeof(header) + static_cast<quint64>(header.count) * sizeof(cacheRecord_t);
+    if (header.magic != DSO_CACHE_MAGIC || header.version != DSO_CACHE_VERSION ||
+            header.meshLevel != static_cast<quint32>(meshLevel) ||
+            QByteArray(header.hash, sizeof(header.hash)) != hash || header.stringsOffset != recordsEnd ||
+            header.stringsOffset + header.stringsSize != static_cast<quint64>(file.size()))
+    {
+        qCInfo(KSTARS) << "Deep-sky cache" << cache_name << "is out of date";
+        file.unmap(const_cast<uchar *>(map));
+        return false;
+    }
+
+    const uchar *strings = map + header.stringsOffset;
+    bool valid           = true;
+    auto string          = [&](quint32 offset) -> QString
+    {
+        quint16 length = 0;
+        if (offset + sizeof(length) > header.stringsSize)
         {
-            m_ICList.append(o);
-            appendIndex(o, &m_ICIndex, trixel);
+            valid = false;
+            return QString();
         }
-        else
+        memcpy(&length, strings + offset, sizeof(length));
+        if (offset + sizeof(length) + length > header.stringsSize)
         {
-            m_OtherList.append(o);
-            appendIndex(o, &m_OtherIndex, trixel);
+            valid = false;
+            return QString();
         }
+        return QString::fromUtf8(reinterpret_cast<const char *>(strings + offset + sizeof(length)), length);
+    };
 
-        // JM: VERY INEFFICIENT. Disabling for now until we figure out how to deal with dups. QSet?
-        //if ( ! name.isEmpty() && !objectNames(type).contains(name))
-        if (!name.isEmpty())
-        {
-            objectNames(type).append(name);
-            objectLists(type).append(QPair<QString, SkyObject *>(name, o));
-        }
+    entries.resize(header.count);
+    const uchar *record = map + sizeof(header);
+    for (quint32 i = 0; i < header.count && valid; i++, record += sizeof(cacheRecord_t))
+    {
+        cacheRecord_t cached;
+        memcpy(&cached, record, sizeof(cached));
+
+        catalogEntry_t &entry = entries[i];
+        entry.type     = cached.type;
+        entry.ra       = cached.ra;
+        entry.dec      = cached.dec;
+        entry.mag      = cached.mag;
+        entry.a        = cached.a;
+        entry.b        = cached.b;
+        entry.pa       = cached.pa;
+        entry.pgc      = cached.pgc;
+        entry.ugc      = cached.ugc;
+        entry.trixel   = cached.trixel;
+        entry.hasName  = cached.hasName != 0;
+        entry.name     = string(cached.name);
+        entry.name2    = string(cached.name2);
+        entry.longname = string(cached.longname);
+        entry.catalog  = string(cached.catalog);
+    }
 
-        //Add long name to the list of object names
-        //if ( ! longname.isEmpty() && longname != name  && !objectNames(type).contains(longname))
-        if (!longname.isEmpty() && longname != name)
-        {
-            objectNames(type).append(longname);
-            objectLists(type).append(QPair<QString, SkyObject *>(longname, o));
-        }
+    file.unmap(const_cast<uchar *>(map));
 
-        deep_sky_parser.ShowProgress();
+    if (valid == false)
+    {
+        qCWarning(KSTARS) << "Deep-sky cache" << cache_name << "is corrupt";
+        entries.clear();
     }
+    return valid;
+}
 
-    for (auto &list : objectNames())
-        list.removeDuplicates();
+void DeepSkyComponent::writeCache(const QString &cache_name, const QByteArray &hash,
+                                  const QVector<catalogEntry_t> &entries)
+{
+    QByteArray strings;
+    QHash<QString, quint32> stringOffsets;
+    auto string = [&](const QString &value) -> quint32
+    {
+        auto found = stringOffsets.constFind(value);
+        if (found != stringOffsets.constEnd())
+            return found.value();
+
+        const QByteArray utf8 = value.toUtf8().left(0xffff);
+        const quint16 length  = utf8.size();
+        const quint32 offset  = strings.size();
+        strings.append(reinterpret_cast<const char *>(&length), sizeof(length));
+        strings.append(utf8);
+        stringOffsets.insert(value, offset);
+        return offset;
+    };
+
+    QByteArray records;
+    records.reserve(entries.count() * sizeof(cacheRecord_t));
+    for (const auto &entry : entries)
+    {
+        cacheRecord_t cached;
+        memset(&cached, 0, sizeof(cached));
+        cached.type     = entry.type;
+        cached.ra       = entry.ra;
+        cached.dec      = entry.dec;
+        cached.mag      = entry.mag;
+        cached.a        = entry.a;
+        cached.b        = entry.b;
+        cached.pa       = entry.pa;
+        cached.pgc      = entry.pgc;
+        cached.ugc      = entry.ugc;
+        cached.trixel   = entry.trixel;
+        cached.hasName  = entry.hasName ? 1 : 0;
+        cached.name     = string(entry.name);
+        cached.name2    = string(entry.name2);
+        cached.longname = string(entry.longname);
+        cached.catalog  = string(entry.catalog);
+        records.append(reinterpret_cast<const char *>(&cached), sizeof(cached));
+    }
+
+    cacheHeader_t header;
+    memset(&header, 0, sizeof(header));
+    header.magic         = DSO_CACHE_MAGIC;
+    header.version       = DSO_CACHE_VERSION;
+    header.meshLevel     = m_skyMesh->level();
+    header.count         = entries.count();
+    memcpy(header.hash, hash.constData(), qMin<int>(hash.size(), sizeof(header.hash)));
+    header.stringsOffset = sizeof(header) + records.size();
+    header.stringsSize   = strings.size();
+
+    QDir().mkpath(QFileInfo(cache_name).absolutePath());
+
+    QSaveFile file(cache_name);
+    if (file.open(QIODevice::WriteOnly) == false)
+    {
+        qCWarning(KSTARS) << "Cannot write deep-sky cache" << cache_name << file.errorString();
+        return;
+    }
+
+    file.write(reinterpret_cast<const char *>(&header), sizeof(header));
+    file.write(records);
+    file.write(strings);
+    if (file.commit() == false)
+        qCWarning(KSTARS) << "Cannot write deep-sky cache" << cache_name << file.errorString();
 }
 
 void DeepSkyComponent::mergeSplitFiles()
@@ -578,10 +821,7 @@ void DeepSkyComponent::drawLabels()
     {
         LabelList *list = m_labelList[i];
 
-        for (const auto &item : *list)
-        {
-            labeler->drawNameLabel(item.obj, item.o);
-        }
+        labeler->drawNameLabels(*list);
         list->clear();
     }
 #endif
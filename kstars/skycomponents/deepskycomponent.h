@@ -20,6 +20,9 @@
 #include "skycomponent.h"
 #include "skylabel.h"
 
+#include <QFuture>
+#include <QVector>
+
 class QPointF;
 
 #ifdef KSTARS_LITE
@@ -55,8 +58,50 @@ class DeepSkyComponent : public SkyComponent
 #endif
 
   public:
+    // An object of ngcic.dat as parsed, before its names are translated
+    typedef struct
+    {
+        int type;
+        // J2000 coordinates in degrees
+        double ra;
+        double dec;
+        float mag;
+        float a;
+        float b;
+        int pa;
+        int pgc;
+        int ugc;
+        // -1 until the object is indexed
+        int trixel;
+        bool hasName;
+        QString name;
+        QString name2;
+        QString longname;
+        QString catalog;
+    } catalogEntry_t;
+
+    // ngcic.dat as read by readCatalog(), before any object is created
+    typedef struct
+    {
+        QString cacheName;
+        // MD5 of ngcic.dat, empty if it cannot be read
+        QByteArray hash;
+        bool cached;
+        QVector<catalogEntry_t> entries;
+    } catalog_t;
+
     explicit DeepSkyComponent(SkyComposite *);
 
+    /** @short Create the objects of a catalog read by readCatalog(), waiting for it if it is still being read. */
+    DeepSkyComponent(SkyComposite *parent, QFuture<catalog_t> catalog);
+
+    /**
+     * @short Read ngcic.dat, or its cache when it is up to date.
+     * Only files are touched, so SkyMapComposite runs it on the thread pool while the other components load.
+     * @param meshLevel Level of the sky mesh the cached trixels belong to.
+     */
+    static catalog_t readCatalog(int meshLevel);
+
     ~DeepSkyComponent() override;
 
     void draw(SkyPainter *skyp) override;
@@ -105,10 +150,44 @@ class DeepSkyComponent : public SkyComponent
     bool selected() override;
 
   private:
+    /** @short Create the objects of the catalog, then cache it if it was parsed. */
+    void loadData(catalog_t &catalog);
+
+    // Deep-sky cache layout: the header, the records, then the strings, each a quint16 length and UTF-8 bytes
+    typedef struct
+    {
+        quint32 magic;
+        quint32 version;
+        quint32 meshLevel;
+        quint32 count;
+        // MD5 of the ngcic.dat the cache was made from
+        char hash[16];
+        quint64 stringsOffset;
+        quint64 stringsSize;
+    } cacheHeader_t;
+
+    typedef struct
+    {
+        qint32 type;
+        qint32 pa;
+        qint32 pgc;
+        qint32 ugc;
+        qint32 trixel;
+        float mag;
+        float a;
+        float b;
+        double ra;
+        double dec;
+        // Offsets in the strings
+        quint32 name;
+        quint32 name2;
+        quint32 longname;
+        quint32 catalog;
+        quint32 hasName;
+    } cacheRecord_t;
+
     /**
-     * @short Read the ngcic.dat deep-sky database.
-     * Parse all lines from the deep-sky object catalog files. Construct a DeepSkyObject
-     * from the data in each line, and add it to the DeepSkyComponent.
+     * @short Parse ngcic.dat into entries.
      *
      * Each line in the file is parsed according to column position:
      * @li 0        IC indicator [char]  If 'I' then IC object; if ' ' then NGC object
@@ -131,13 +210,27 @@ class DeepSkyComponent : public SkyComponent
      * @li 64-69    PGC Catalog number [int] can be blank
      * @li 71-75    UGC Catalog number [int] can be blank
      * @li 77-END   Common name [string] can be blank
-     * @return true if data file is successfully read.
      */
-    void loadData();
+    static void parseCatalog(const QString &file_name, QVector<catalogEntry_t> &entries);
+
+    /**
+     * @short Read the entries from the binary cache of ngcic.dat.
+     * @param hash MD5 of the ngcic.dat in use.
+     * @return false if the cache is missing, was made from another catalog, another sky mesh or
+     * another version of KStars, or is damaged.
+     */
+    static bool readCache(const QString &cache_name, const QByteArray &hash, int meshLevel,
+                          QVector<catalogEntry_t> &entries);
+
+    /** @short Save the entries, with their trixels, to the binary cache of ngcic.dat. */
+    void writeCache(const QString &cache_name, const QByteArray &hash, const QVector<catalogEntry_t> &entries);
+
+    /** @short Create the DeepSkyObject of an entry and add it to the lists, indexes and name hashes. */
+    void addObject(catalogEntry_t &entry);
 
     void clearList(QList<DeepSkyObject *> &list);
 
-    void mergeSplitFiles();
+    static void mergeSplitFiles();
 
     void drawDeepSkyCatalog(SkyPainter *skyp, bool drawObject, DeepSkyIndex *dsIndex, const QString &colorString,
                             bool drawImage = false);
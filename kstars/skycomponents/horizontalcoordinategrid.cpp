@@ -121,6 +121,12 @@ void HorizontalCoordinateGrid::preDraw(SkyPainter *skyp)
     skyp->setPen(QPen(QBrush(color), 2, Qt::DotLine));
 }
 
+// The points are fixed to the horizon and move across the sky with every update
+UpdateID HorizontalCoordinateGrid::screenUpdateID()
+{
+    return KStarsData::Instance()->updateID();
+}
+
 void HorizontalCoordinateGrid::update(KSNumbers *)
 {
     KStarsData *data = KStarsData::Instance();
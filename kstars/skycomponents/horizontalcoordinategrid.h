@@ -41,4 +41,7 @@ class HorizontalCoordinateGrid : public CoordinateGrid
     void update(KSNumbers *) override;
 
     bool selected() override;
+
+  protected:
+    UpdateID screenUpdateID() override;
 };
@@ -20,6 +20,8 @@
 #include "typedef.h"
 
 #include <QList>
+#include <QPointF>
+#include <QVector>
 
 class SkyPoint;
 class KSNumbers;
@@ -56,6 +58,20 @@ class LineList
     UpdateID updateID;
     UpdateID updateNumID;
 
+    /**
+     * The screen position of each point and whether it is visible, as last
+     * projected by the painter.  LineListIndex sets cacheScreen and the
+     * coordinate update the points follow in screenUpdateID before each draw.
+     * The positions are reused while neither the projector view nor
+     * screenUpdateID change, so redraws of an unchanged view do not project
+     * anything.  screenKey is 0 while nothing is cached.
+     */
+    bool cacheScreen { false };
+    UpdateID screenUpdateID { 0 };
+    quint64 screenKey { 0 };
+    QVector<QPointF> screenPoints;
+    QVector<bool> screenVisible;
+
   private:
     SkyList pointList;
 };
@@ -181,6 +181,15 @@ MeshIterator LineListIndex::visibleTrixels()
 }
 #endif
 
+UpdateID LineListIndex::screenUpdateID()
+{
+    KStarsData *data = KStarsData::Instance();
+
+    if (Options::useAltAz() || Options::showGround())
+        return data->updateID();
+    return data->updateNumID();
+}
+
 // This is a callback used int drawLinesInt() and drawLinesFloat()
 SkipHashList *LineListIndex::skipList(LineList *lineList)
 {
@@ -190,8 +199,9 @@ SkipHashList *LineListIndex::skipList(LineList *lineList)
 
 void LineListIndex::drawLines(SkyPainter *skyp)
 {
-    DrawID drawID     = skyMesh()->drawID();
-    UpdateID updateID = KStarsData::Instance()->updateID();
+    DrawID drawID           = skyMesh()->drawID();
+    UpdateID updateID       = KStarsData::Instance()->updateID();
+    UpdateID screenUpdateID = this->screenUpdateID();
 
     for (auto &lineListList : m_lineIndex->values())
     {
@@ -206,6 +216,8 @@ void LineListIndex::drawLines(SkyPainter *skyp)
             if (lineList->updateID != updateID)
                 JITupdate(lineList.get());
 
+            lineList->cacheScreen    = true;
+            lineList->screenUpdateID = screenUpdateID;
             skyp->drawSkyPolyline(lineList.get(), skipList(lineList.get()), label());
         }
     }
@@ -213,8 +225,9 @@ void LineListIndex::drawLines(SkyPainter *skyp)
 
 void LineListIndex::drawFilled(SkyPainter *skyp)
 {
-    DrawID drawID     = skyMesh()->drawID();
-    UpdateID updateID = KStarsData::Instance()->updateID();
+    DrawID drawID           = skyMesh()->drawID();
+    UpdateID updateID       = KStarsData::Instance()->updateID();
+    UpdateID screenUpdateID = this->screenUpdateID();
 
     MeshIterator region(skyMesh(), drawBuffer());
 
@@ -237,6 +250,8 @@ void LineListIndex::drawFilled(SkyPainter *skyp)
             if (lineList->updateID != updateID)
                 JITupdate(lineList.get());
 
+            lineList->cacheScreen    = true;
+            lineList->screenUpdateID = screenUpdateID;
             skyp->drawSkyPolygon(lineList.get());
         }
     }
@@ -152,6 +152,15 @@ class LineListIndex : public SkyComponent
      */
     virtual MeshBufNum_t drawBuffer() { return DRAW_BUF; }
 
+    /**
+     * @short Returns the coordinate update the screen positions of the
+     * points follow, used by the painter to reuse the positions of the
+     * previous frame.  On an equatorial map without ground, points fixed
+     * in RA and Dec only move when they are precessed.  Overridden by the
+     * components whose points follow the horizon.
+     */
+    virtual UpdateID screenUpdateID();
+
     /**
      * @short Returns an IndexHash from the SkyMesh that contains the set of
      * trixels that cover lineList.  Overridden by SkipListIndex so it can
@@ -77,6 +77,12 @@ void LocalMeridianComponent::preDraw(SkyPainter *skyp)
     skyp->setPen(QPen(QBrush(color), 2, Qt::SolidLine));
 }
 
+// The points are fixed to the horizon and move across the sky with every update
+UpdateID LocalMeridianComponent::screenUpdateID()
+{
+    return KStarsData::Instance()->updateID();
+}
+
 void LocalMeridianComponent::update(KSNumbers *)
 {
     KStarsData *data = KStarsData::Instance();
@@ -33,4 +33,7 @@ class LocalMeridianComponent : public CoordinateGrid
     void update(KSNumbers *) override;
 
     bool selected() override;
+
+  protected:
+    UpdateID screenUpdateID() override;
 };
@@ -27,17 +27,33 @@
 #include "skymap.h"
 #include "projections/projector.h"
 
+// side in pixels of the cells of the label grid
+#define LABEL_CELL_SIZE 64
+// pixels kept free around each label
+#define LABEL_MARGIN_X 2
+#define LABEL_MARGIN_Y 1
+
 //---------------------------------------------------------------------------//
-// A Little data container class
+// Where a name label may go around its object.  The baseline of the text
+// starts at the object plus offset times the label offset plus size times the
+// size of the text.  The first candidate is where labels have always been.
 //---------------------------------------------------------------------------//
 
-typedef struct LabelRun
+typedef struct
+{
+    qreal offsetX, sizeX;
+    qreal offsetY, sizeY;
+} LabelCandidate;
+
+static const LabelCandidate labelCandidates[] =
 {
-    LabelRun(int s, int e) : start(s), end(e) {}
-    int start;
-    int end;
+    { 1, 0, 1, 0 },  // right
+    { -1, -1, 1, 0 }, // left
+    { 1, 0, -1, 0 }, // above right
+    { 1, 0, 1, 1 }   // below right
+};
 
-} LabelRun;
+#define LABEL_CANDIDATES int(sizeof(labelCandidates) / sizeof(labelCandidates[0]))
 
 //----- Now for the main event ----------------------------------------------//
 
@@ -110,14 +126,6 @@ SkyLabeler::SkyLabeler()
 
 SkyLabeler::~SkyLabeler()
 {
-    for (auto &row : screenRows)
-    {
-        for (auto &item : *row)
-        {
-            delete item;
-        }
-        delete row;
-    }
 }
 
 bool SkyLabeler::drawGuideLabel(QPointF &o, const QString &text, double angle)
@@ -175,15 +183,35 @@ bool SkyLabeler::drawNameLabel(SkyObject *obj, const QPointF &_p)
     if (sLabel.isEmpty())
         return false;
 
+    // An object gets one label per frame
+    if (m_placements.contains(obj))
+        return false;
+
     double offset = obj->labelOffset();
-    QPointF p(_p.x() + offset, _p.y() + offset);
+    qreal width   = m_fontMetrics.width(sLabel);
+    qreal height  = m_fontMetrics.height();
 
-    if (!markText(p, sLabel))
-    {
-        return false;
-    }
-    else
+    // Try the side the label had in the previous frame first, then the others in order
+    auto last     = m_lastPlacements.constFind(obj);
+    int preferred = (last != m_lastPlacements.constEnd()) ? last.value() : 0;
+
+    for (int i = -1; i < LABEL_CANDIDATES; i++)
     {
+        int candidate = (i < 0) ? preferred : i;
+        if (i == preferred)
+            continue;
+
+        const LabelCandidate &c = labelCandidates[candidate];
+        QPointF p(_p.x() + c.offsetX * offset + c.sizeX * width, _p.y() + c.offsetY * offset + c.sizeY * height);
+
+        if (!placeRegion(QRectF(p.x(), p.y() - height, width, height)))
+            continue;
+
+        m_hits++;
+        if (last != m_lastPlacements.constEnd())
+            m_kept++;
+        m_placements.insert(obj, candidate);
+
         double factor = log(Options::zoomFactor() / 750.0);
         double newPointSize = qBound(12.0, factor*m_stdFont.pointSizeF(), 18.0);
         QFont zoomFont(m_p.font());
@@ -192,6 +220,28 @@ bool SkyLabeler::drawNameLabel(SkyObject *obj, const QPointF &_p)
         m_p.drawText(p, sLabel);
         return true;
     }
+
+    m_misses++;
+    return false;
+}
+
+void SkyLabeler::drawNameLabels(const LabelList &list)
+{
+    // Labels shown in the previous frame keep their place ahead of new ones
+    LabelList deferred;
+
+    for (const auto &item : list)
+    {
+        if (m_lastPlacements.contains(item.obj))
+            drawNameLabel(item.obj, item.o);
+        else
+            deferred.append(item);
+    }
+
+    for (const auto &item : deferred)
+    {
+        drawNameLabel(item.obj, item.o);
+    }
 }
 
 void SkyLabeler::setFont(const QFont &font)
@@ -275,53 +325,11 @@ void SkyLabeler::reset(SkyMap *skyMap)
     setZoomFont();
     m_skyFont     = m_p.font();
     m_fontMetrics = QFontMetrics(m_skyFont);
-    m_minDeltaX   = (int)m_fontMetrics.width("MMMMM");
 
     // ----- Set up Zoom Dependent Offset -----
     m_offset = SkyLabeler::ZoomOffset();
 
-    // ----- Prepare Virtual Screen -----
-    m_yScale = (m_fontMetrics.height() + 1.0);
-
-    int maxY = int(skyMap->height() / m_yScale);
-    if (maxY < 1)
-        maxY = 1; // prevents a crash below?
-
-    int m_maxX = skyMap->width();
-    m_size     = (maxY + 1) * m_maxX;
-
-    // Resize if needed:
-    if (maxY > m_maxY)
-    {
-        screenRows.resize(m_maxY);
-        for (int y = m_maxY; y <= maxY; y++)
-        {
-            screenRows.append(new LabelRow());
-        }
-        //printf("resize: %d -> %d, size:%d\n", m_maxY, maxY, screenRows.size());
-    }
-
-    // Clear all pre-existing rows as needed
-
-    int minMaxY = (maxY < m_maxY) ? maxY : m_maxY;
-
-    for (int y = 0; y <= minMaxY; y++)
-    {
-        LabelRow *row = screenRows[y];
-
-        for (auto &item : *row)
-        {
-            delete item;
-        }
-        row->clear();
-    }
-
-    // never decrease m_maxY:
-    if (m_maxY < maxY)
-        m_maxY = maxY;
-
-    // reset the counters
-    m_marks = m_hits = m_misses = m_elements = 0;
+    resetScreen(skyMap->width(), skyMap->height());
 
     //----- Clear out labelList -----
     for (auto &item : labelList)
@@ -341,59 +349,43 @@ void SkyLabeler::reset()
     setZoomFont();
     m_skyFont     = m_drawFont;
     m_fontMetrics = QFontMetrics(m_skyFont);
-    m_minDeltaX   = (int)m_fontMetrics.width("MMMMM");
     // ----- Set up Zoom Dependent Offset -----
     m_offset = ZoomOffset();
 
-    // ----- Prepare Virtual Screen -----
-    m_yScale = (m_fontMetrics.height() + 1.0);
+    resetScreen(skyMap->width(), skyMap->height());
 
-    int maxY = int(skyMap->height() / m_yScale);
-    if (maxY < 1)
-        maxY = 1; // prevents a crash below?
-
-    int m_maxX = skyMap->width();
-    m_size     = (maxY + 1) * m_maxX;
-
-    // Resize if needed:
-    if (maxY > m_maxY)
+    //----- Clear out labelList -----
+    for (int i = 0; i < labelList.size(); i++)
     {
-        screenRows.resize(m_maxY);
-        for (int y = m_maxY; y <= maxY; y++)
-        {
-            screenRows.append(new LabelRow());
-        }
-        //printf("resize: %d -> %d, size:%d\n", m_maxY, maxY, screenRows.size());
+        labelList[i].clear();
     }
+}
+#endif
 
-    // Clear all pre-existing rows as needed
+void SkyLabeler::resetScreen(int width, int height)
+{
+    m_screen = QRectF(0, 0, width, height);
+    m_size   = width * height;
 
-    int minMaxY = (maxY < m_maxY) ? maxY : m_maxY;
+    // ----- Prepare the grid -----
+    m_columns = qMax(1, width / LABEL_CELL_SIZE + 1);
+    m_rows    = qMax(1, height / LABEL_CELL_SIZE + 1);
 
-    for (int y = 0; y <= minMaxY; y++)
+    // Cells keep their capacity from frame to frame
+    m_cells.resize(m_columns * m_rows);
+    for (auto &cell : m_cells)
     {
-        LabelRow *row = screenRows[y];
-        for (int i = 0; i < row->size(); i++)
-        {
-            delete row->at(i);
-        }
-        row->clear();
+        cell.resize(0);
     }
+    m_regions.clear();
 
-    // never decrease m_maxY:
-    if (m_maxY < maxY)
-        m_maxY = maxY;
+    // ----- Remember the labels of the previous frame -----
+    m_lastPlacements.swap(m_placements);
+    m_placements.clear();
 
     // reset the counters
-    m_marks = m_hits = m_misses = m_elements = 0;
-
-    //----- Clear out labelList -----
-    for (int i = 0; i < labelList.size(); i++)
-    {
-        labelList[i].clear();
-    }
+    m_marks = m_hits = m_misses = m_kept = 0;
 }
-#endif
 
 void SkyLabeler::draw(QPainter &p)
 {
@@ -410,11 +402,6 @@ void SkyLabeler::draw(QPainter &p)
     //m_p.begin(&m_picture);
 }
 
-// We use Run Length Encoding to hold the information instead of an array of
-// chars.  This is both faster and smaller but the code is more complicated.
-//
-// This code is easy to break and hard to fix.
-
 bool SkyLabeler::markText(const QPointF &p, const QString &text)
 {
     qreal maxX = p.x() + m_fontMetrics.width(text);
@@ -424,150 +411,59 @@ bool SkyLabeler::markText(const QPointF &p, const QString &text)
 
 bool SkyLabeler::markRegion(qreal left, qreal right, qreal top, qreal bot)
 {
-    if (m_maxY < 1)
+    if (placeRegion(QRectF(QPointF(left, top), QPointF(right, bot)).normalized()))
     {
-        if (!m_errors++)
-            qDebug() << QString("Someone forgot to reset the SkyLabeler!");
+        m_hits++;
         return true;
     }
 
-    // setup x coordinates of rectangular region
-    int minX = int(left);
-    int maxX = int(right);
-    if (maxX < minX)
+    m_misses++;
+    return false;
+}
+
+bool SkyLabeler::placeRegion(const QRectF &rect)
+{
+    if (m_cells.isEmpty())
     {
-        maxX = minX;
-        minX = int(right);
+        if (!m_errors++)
+            qDebug() << QString("Someone forgot to reset the SkyLabeler!");
+        return true;
     }
 
-    // setup y coordinates
-    int maxY = int(bot / m_yScale);
-    int minY = int(top / m_yScale);
+    QRectF region = rect.adjusted(-LABEL_MARGIN_X, -LABEL_MARGIN_Y, LABEL_MARGIN_X, LABEL_MARGIN_Y);
 
-    if (maxY < 0)
-        maxY = 0;
-    if (maxY > m_maxY)
-        maxY = m_maxY;
-    if (minY < 0)
-        minY = 0;
-    if (minY > m_maxY)
-        minY = m_maxY;
-
-    if (maxY < minY)
-    {
-        int temp = maxY;
-        maxY     = minY;
-        minY     = temp;
-    }
+    // Labels past the edges of the screen share the border cells
+    int minX = qBound(0, int(floor(region.left() / LABEL_CELL_SIZE)), m_columns - 1);
+    int maxX = qBound(0, int(floor(region.right() / LABEL_CELL_SIZE)), m_columns - 1);
+    int minY = qBound(0, int(floor(region.top() / LABEL_CELL_SIZE)), m_rows - 1);
+    int maxY = qBound(0, int(floor(region.bottom() / LABEL_CELL_SIZE)), m_rows - 1);
 
     // check to see if we overlap any existing label
-    // We must check all rows before we start marking
+    // We must check all cells before we start marking
     for (int y = minY; y <= maxY; y++)
     {
-        LabelRow *row = screenRows[y];
-        int i;
-        for (i = 0; i < row->size(); i++)
+        for (int x = minX; x <= maxX; x++)
         {
-            if (row->at(i)->end < minX)
-                continue; // skip past these
-            if (row->at(i)->start > maxX)
-                break;
-            m_misses++;
-            return false;
+            for (int index : m_cells[y * m_columns + x])
+            {
+                if (m_regions[index].intersects(region))
+                    return false;
+            }
         }
     }
 
-    m_hits++;
-    m_marks += (maxX - minX + 1) * (maxY - minY + 1);
+    QRectF visible = rect.intersected(m_screen);
+    m_marks += int(visible.width() * visible.height());
 
-    // Okay, there was no overlap so let's insert the current rectangle into
-    // screenRows.
+    // Okay, there was no overlap so let's add the label to every cell it covers
+    int index = m_regions.size();
+    m_regions.append(region);
 
     for (int y = minY; y <= maxY; y++)
     {
-        LabelRow *row = screenRows[y];
-
-        // Simplest case: an empty row
-        if (row->size() < 1)
-        {
-            row->append(new LabelRun(minX, maxX));
-            m_elements++;
-            continue;
-        }
-
-        // Find out our place in the universe (or row).
-        // H'mm.  Maybe we could cache these numbers above.
-        int i;
-        for (i = 0; i < row->size(); i++)
-        {
-            if (row->at(i)->end >= minX)
-                break;
-        }
-
-        // i now points to first label PAST ours
-
-        // if we are first, append or merge at start of list
-        if (i == 0)
-        {
-            if (row->at(0)->start - maxX < m_minDeltaX)
-            {
-                row->at(0)->start = minX;
-            }
-            else
-            {
-                row->insert(0, new LabelRun(minX, maxX));
-                m_elements++;
-            }
-            continue;
-        }
-
-        // if we are past the last label, merge or append at end
-        else if (i == row->size())
+        for (int x = minX; x <= maxX; x++)
         {
-            if (minX - row->at(i - 1)->end < m_minDeltaX)
-            {
-                row->at(i - 1)->end = maxX;
-            }
-            else
-            {
-                row->append(new LabelRun(minX, maxX));
-                m_elements++;
-            }
-            continue;
-        }
-
-        // if we got here, we must insert or merge the new label
-        //  between [i-1] and [i]
-
-        bool mergeHead = (minX - row->at(i - 1)->end < m_minDeltaX);
-        bool mergeTail = (row->at(i)->start - maxX < m_minDeltaX);
-
-        // double merge => combine all 3 into one
-        if (mergeHead && mergeTail)
-        {
-            row->at(i - 1)->end = row->at(i)->end;
-            delete row->at(i);
-            row->removeAt(i);
-            m_elements--;
-        }
-
-        // Merge label with [i-1]
-        else if (mergeHead)
-        {
-            row->at(i - 1)->end = maxX;
-        }
-
-        // Merge label with [i]
-        else if (mergeTail)
-        {
-            row->at(i)->start = minX;
-        }
-
-        // insert between the two
-        else
-        {
-            row->insert(i, new LabelRun(minX, maxX));
-            m_elements++;
+            m_cells[y * m_columns + x].append(index);
         }
     }
 
@@ -632,12 +528,7 @@ void SkyLabeler::drawQueuedLabels()
 
 void SkyLabeler::drawQueuedLabelsType(SkyLabeler::label_t type)
 {
-    LabelList list = labelList[type];
-
-    for (const auto &item : list)
-    {
-        drawNameLabel(item.obj, item.o);
-    }
+    drawNameLabels(labelList[type]);
 }
 
 //Rude name labels don't check for collisions with other labels,
@@ -685,10 +576,8 @@ void SkyLabeler::printInfo()
     printf("SkyLabeler:\n");
     printf("  fillRatio=%.1f%%\n", fillRatio());
     printf("  hits=%d  misses=%d  ratio=%.1f%%\n", m_hits, m_misses, hitRatio());
-    printf("  yScale=%.1f maxY=%d\n", m_yScale, m_maxY);
-
-    printf("  screenRows=%d elements=%d virtualSize=%.1f Kbytes\n", screenRows.size(), m_elements,
-           float(m_size) / 1024.0);
+    printf("  labels=%d  kept from last frame=%d\n", m_regions.size(), m_kept);
+    printf("  grid=%dx%d cells of %d pixels\n", m_columns, m_rows, LABEL_CELL_SIZE);
 
 //    static const char *labelName[NUM_LABEL_TYPES];
 //
@@ -705,29 +594,4 @@ void SkyLabeler::printInfo()
 //    {
 //        printf("  %20ss: %d\n", labelName[i], labelList[i].size());
 //    }
-//
-//    // Check for errors in the data structure
-//    for (int y = 0; y <= m_maxY; y++)
-//    {
-//        LabelRow *row = screenRows[y];
-//        int size      = row->size();
-//        if (size < 2)
-//            continue;
-//
-//        bool error = false;
-//        for (int i = 1; i < size; i++)
-//        {
-//            if (row->at(i - 1)->end > row->at(i)->start)
-//                error = true;
-//        }
-//        if (!error)
-//            continue;
-//
-//        printf("ERROR: %3d: ", y);
-//        for (int i = 0; i < row->size(); i++)
-//        {
-//            printf("(%d, %d) ", row->at(i)->start, row->at(i)->end);
-//        }
-//        printf("\n");
-//    }
 }
@@ -20,7 +20,9 @@
 #include "skylabel.h"
 
 #include <QFontMetricsF>
+#include <QHash>
 #include <QList>
+#include <QRectF>
 #include <QVector>
 #include <QPainter>
 #include <QPicture>
@@ -30,38 +32,30 @@ class QString;
 class QPointF;
 class SkyMap;
 class Projector;
-struct LabelRun;
-
-typedef QList<LabelRun *> LabelRow;
-typedef QVector<LabelRow *> ScreenRows;
 
 /**
  *@class SkyLabeler
- * The purpose of this class is to prevent labels from overlapping.  We do this
- * by creating a virtual (lower Y-resolution) screen. Each "pixel" of this
- * screen essentially contains a boolean value telling us whether or not there
- * is an existing label covering at least part of that pixel.  Before you draw
- * a label, call mark( QPointF, QString ) of that label.  We will check to see
- * if it would overlap any existing label.  If there is overlap we return false.
- * If there is no overlap then we mark all the pixels that cover the new label
+ * The purpose of this class is to prevent labels from overlapping.  Before you
+ * draw a label, call mark( QPointF, QString ) of that label.  We will check to
+ * see if it would overlap any existing label.  If there is overlap we return
+ * false.  If there is no overlap then we record the rectangle of the new label
  * and return true.
  *
  * Since we need to check for overlap for every label every time it is
- * potentially drawn on the screen, efficiency is essential.  So instead of
- * having a 2-dimensional array of boolean values we use Run Length Encoding
- * and store the virtual array in a QVector of QLists.  Each element of the
- * vector, a LabelRow, corresponds to a horizontal strip of pixels on the actual
- * screen.  How many vertical pixels are in each strip is controlled by
- * m_yDensity.  The higher the density, the fewer vertical pixels per strip and
- * hence a larger number of strips are needed to cover the screen.  As
- * m_yDensity increases so does the density of the strips.
+ * potentially drawn on the screen, efficiency is essential.  The rectangles of
+ * the labels already placed are kept in a uniform grid of square cells laid
+ * over the screen, each cell listing the rectangles that overlap it.  A new
+ * label is only tested against the rectangles of the few cells it covers, and
+ * the test is exact so labels are not rejected because of a coarse virtual
+ * screen.
  *
- * The information in the X-dimension is completed run length encoded. A
- * consecutive run of pixels in one strip that are covered by one or more labels
- * is stored in a LabelRun object that merely stores the start pixel and the end
- * pixel.  A LabelRow is a list of LabelRun's stored in ascending order.  This
- * saves a lot of space over an explicit array and it also makes checking for
- * overlaps faster and even makes inserting new overlaps faster on average.
+ * Name labels are placed greedily in the order they are drawn, which is their
+ * priority.  If a label does not fit to the right of its object, it tries the
+ * other side, above and below before giving up.  To keep labels from
+ * flickering while the map moves, the labeler remembers which objects were
+ * labeled in the previous frame and on which side.  Those labels try the same
+ * side first, and drawNameLabels() places them ahead of new labels of the same
+ * priority.
  *
  * Synopsis:
  *
@@ -241,6 +235,12 @@ class SkyLabeler
          */
     bool drawNameLabel(SkyObject *obj, const QPointF &_p);
 
+    /**
+         * @short Tries to draw the labels of a list of objects of the same priority.
+         * Objects labeled in the previous frame are placed first.
+         */
+    void drawNameLabels(const LabelList &list);
+
     /**
          *@short draw the object's name label on the map, without checking for
          *overlap with other labels.
@@ -297,7 +297,7 @@ class SkyLabeler
     //----- Diagnostics and Information -----//
 
     /**
-         * @short diagnostic. the *percentage* of pixels that have been filled.
+         * @short diagnostic. the *percentage* of screen pixels covered by labels.
          * Expect return values between 0.0 and 100.0.  A fillRatio above 20
          * is pretty busy and crowded.  I think a fillRatio of about 10 looks
          * good.  The fillRatio will be lowered of the screen is zoomed out
@@ -332,18 +332,33 @@ class SkyLabeler
     int marks() { return m_marks; }
 
   private:
-    ScreenRows screenRows;
-    int m_maxX { 0 };
-    int m_maxY { 0 };
+    /**
+         * @short clears the placed labels and sizes the grid to the screen.
+         */
+    void resetScreen(int width, int height);
+
+    /**
+         * @short records rect if it does not overlap a placed label, without
+         * counting a hit or a miss.
+         */
+    bool placeRegion(const QRectF &rect);
+
+    /// Rectangles of the labels placed in this frame
+    QVector<QRectF> m_regions;
+    /// Indexes in m_regions of the rectangles overlapping each grid cell, row by row
+    QVector<QVector<int>> m_cells;
+    int m_columns { 0 };
+    int m_rows { 0 };
+    QRectF m_screen;
+    /// Candidate position of each object labeled in this frame and in the previous one
+    QHash<const SkyObject *, int> m_placements;
+    QHash<const SkyObject *, int> m_lastPlacements;
     int m_size { 0 };
-    /// When to merge two adjacent regions
-    int m_minDeltaX { 30 };
     int m_marks { 0 };
     int m_hits { 0 };
     int m_misses { 0 };
-    int m_elements { 0 };
+    int m_kept { 0 };
     int m_errors { 0 };
-    qreal m_yScale { 0 };
     double m_offset { 0 };
     QFont m_stdFont, m_skyFont;
     QFontMetricsF m_fontMetrics;
@@ -44,6 +44,7 @@
 #include "skypainter.h"
 #include "solarsystemcomposite.h"
 #include "starcomponent.h"
+#include "startuploader.h"
 #include "supernovaecomponent.h"
 #include "syncedcatalogcomponent.h"
 #include "targetlistcomponent.h"
@@ -61,6 +62,8 @@
 #endif
 
 #include <QApplication>
+#include <QElapsedTimer>
+#include <QtConcurrent>
 
 #include <kstars_debug.h>
 
@@ -131,27 +134,43 @@ SkyMapComposite::SkyMapComposite(SkyComposite *parent) : SkyComposite(parent), m
     addComponent(m_Supernovae = new SupernovaeComponent(this), 7);
     SkyMapLite::Instance()->loadingFinished();
 #else
+    // The deep-sky catalog is only read from files, it is read on the thread pool while the components before it load
+    QFuture<DeepSkyComponent::catalog_t> deepSkyCatalog =
+        QtConcurrent::run(&DeepSkyComponent::readCatalog, m_skyMesh->level());
+
+    QElapsedTimer timer;
+    timer.start();
+
     addComponent(m_MilkyWay = new MilkyWay(this), 50);
+    StartupLoader::record("Milky Way", timer.restart());
     addComponent(m_Stars = StarComponent::Create(this), 10);
+    StartupLoader::record("Stars", timer.restart());
     addComponent(m_EquatorialCoordinateGrid = new EquatorialCoordinateGrid(this));
     addComponent(m_HorizontalCoordinateGrid = new HorizontalCoordinateGrid(this));
     addComponent(m_LocalMeridianComponent = new LocalMeridianComponent(this));
+    StartupLoader::record("Coordinate grids", timer.restart());
 
     // Do add to components.
     addComponent(m_CBoundLines = new ConstellationBoundaryLines(this), 80);
+    StartupLoader::record("Constellation boundaries", timer.restart());
     m_Cultures.reset(new CultureList());
     addComponent(m_CLines = new ConstellationLines(this, m_Cultures.get()), 85);
     addComponent(m_CNames = new ConstellationNamesComponent(this, m_Cultures.get()), 90);
+    StartupLoader::record("Constellation lines and names", timer.restart());
     addComponent(m_Equator = new Equator(this), 95);
     addComponent(m_Ecliptic = new Ecliptic(this), 95);
     addComponent(m_Horizon = new HorizonComponent(this), 100);
-    addComponent(m_DeepSky = new DeepSkyComponent(this), 5);
+    StartupLoader::record("Equator, ecliptic and horizon", timer.restart());
+    addComponent(m_DeepSky = new DeepSkyComponent(this, deepSkyCatalog), 5);
+    StartupLoader::record("Deep-sky objects", timer.restart());
     addComponent(m_ConstellationArt = new ConstellationArtComponent(this, m_Cultures.get()), 100);
+    StartupLoader::record("Constellation art", timer.restart());
 
     // Hips
     addComponent(m_HiPS = new HIPSComponent(this));
 
     addComponent(m_ArtificialHorizon = new ArtificialHorizonComponent(this), 110);
+    StartupLoader::record("HiPS and artificial horizon", timer.restart());
 
     m_internetResolvedCat = "_Internet_Resolved";
     m_manualAdditionsCat  = "_Manual_Additions";
@@ -167,8 +186,10 @@ SkyMapComposite::SkyMapComposite(SkyComposite *parent) : SkyComposite(parent), m
         m_CustomCatalogs->addComponent(new CatalogComponent(this, allcatalogs.at(i), false, i),
                                        6); // FIXME: Should this be 6 or 5? See SkyMapComposite::reloadDeepSky()
     }
+    StartupLoader::record("Custom catalogs", timer.restart());
 
     addComponent(m_SolarSystem = new SolarSystemComposite(this), 2);
+    StartupLoader::record("Solar system", timer.restart());
 
     addComponent(m_Flags = new FlagComponent(this), 4);
 
@@ -176,8 +197,11 @@ SkyMapComposite::SkyMapComposite(SkyComposite *parent) : SkyComposite(parent), m
                      new TargetListComponent(this, nullptr, QPen(), &Options::obsListSymbol, &Options::obsListText),
                  120);
     addComponent(m_StarHopRouteList = new TargetListComponent(this, nullptr, QPen()), 130);
+    StartupLoader::record("Flags and target lists", timer.restart());
     addComponent(m_Satellites = new SatellitesComponent(this), 7);
+    StartupLoader::record("Satellites", timer.restart());
     addComponent(m_Supernovae = new SupernovaeComponent(this), 7);
+    StartupLoader::record("Supernovae", timer.restart());
 #endif
     connect(this, SIGNAL(progressText(QString)), KStarsData::Instance(), SIGNAL(progressText(QString)));
 }
@@ -316,6 +316,9 @@ void StarComponent::draw(SkyPainter *skyp)
 
     int nTrixels = 0;
 
+    // Stars, the focus star and the deep stars do not overlap anything else drawn here
+    skyp->beginPointSources();
+
     while (region.hasNext())
     {
         ++nTrixels;
@@ -358,6 +361,8 @@ void StarComponent::draw(SkyPainter *skyp)
     {
         component->draw(skyp);
     }
+
+    skyp->endPointSources();
 #else
     Q_UNUSED(skyp)
 #endif
@@ -391,10 +396,7 @@ void StarComponent::drawLabels()
     {
         LabelList *list = m_labelList[i];
 
-        for (const auto &item : *list)
-        {
-            labeler->drawNameLabel(item.obj, item.o);
-        }
+        labeler->drawNameLabels(*list);
         list->clear();
     }
 }
@@ -1209,6 +1209,33 @@ void SkyMap::forceUpdate(bool now)
         m_SkyMapDraw->update();
 }
 
+QRect SkyMap::updateTelescopeSymbol(const QRect &previous, const SkyPoint *position, const QString &label)
+{
+    QRect symbol;
+
+    bool visible = false;
+    const QPointF P = m_proj->toScreen(position, true, &visible);
+    if (visible && m_proj->onScreen(P))
+    {
+        // Same geometry as SkyMapDrawAbstract::drawTelescopeSymbols(), the crosshairs reach one degree
+        // around the position and the label starts right of them on the position baseline.
+        const double pxperdegree = Options::zoomFactor() / 57.3;
+        const QFontMetrics metrics(m_SkyMapDraw->font());
+
+        QRectF area(P.x() - pxperdegree, P.y() - pxperdegree, 2 * pxperdegree, 2 * pxperdegree);
+        area |= QRectF(P.x() + pxperdegree + 2, P.y() - metrics.ascent(), metrics.width(label) + 2, metrics.height());
+
+        // Room for the pen and antialiasing
+        symbol = area.toAlignedRect().adjusted(-2, -2, 2, 2) & m_SkyMapDraw->rect();
+    }
+
+    const QRect dirty = previous.united(symbol);
+    if (dirty.isEmpty() == false)
+        m_SkyMapDraw->update(dirty);
+
+    return symbol;
+}
+
 float SkyMap::fov()
 {
     float diagonalPixels = sqrt(static_cast<double>(width() * width() + height() * height()));
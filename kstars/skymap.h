@@ -364,6 +364,16 @@ class SkyMap : public QGraphicsView
 
         SkyPoint getCenterPoint();
 
+        /**
+         * @short Repaint the telescope crosshairs after the telescope moved, without recomputing the sky.
+         * Only the regions of the crosshairs at the previous and the new position are refreshed from the sky pixmap.
+         * @param previous Region returned by the previous call for the same telescope, empty the first time.
+         * @param position New telescope position, with its horizontal coordinates up to date.
+         * @param label Name drawn next to the crosshairs.
+         * @return Region of the crosshairs at the new position, empty if it is off screen.
+         */
+        QRect updateTelescopeSymbol(const QRect &previous, const SkyPoint *position, const QString &label);
+
     public slots:
         /** Recalculates the positions of objects in the sky, and then repaints the sky map.
              * If the positions don't need to be recalculated, use update() instead of forceUpdate().
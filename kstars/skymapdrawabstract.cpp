@@ -69,6 +69,14 @@ void SkyMapDrawAbstract::drawOverlays(QPainter &p, bool drawFov)
     //draw labels
     SkyLabeler::Instance()->draw(p);
 
+    drawDynamicOverlays(p, drawFov);
+}
+
+void SkyMapDrawAbstract::drawDynamicOverlays(QPainter &p, bool drawFov)
+{
+    if (!KStars::Instance())
+        return;
+
     if (drawFov)
     {
         //draw FOV symbol
@@ -68,6 +68,15 @@ class SkyMapDrawAbstract
         	*/
     void drawOverlays(QPainter &p, bool drawFov = true);
 
+    /**Draw the overlays that change without the sky being recomputed: the field-of-view
+            *indicators, telescope symbols, zoom box and angle ruler.  Unlike drawOverlays(),
+            *the object labels are left out, as they only change with the sky and SkyMapQDraw
+            *keeps them in its cached sky layer.
+            *@param p reference to the QPainter on which to draw
+            *@param drawFov determines if the FOV should be drawn
+            */
+    void drawDynamicOverlays(QPainter &p, bool drawFov = true);
+
     /**Draw symbols at the position of each Telescope currently being controlled by KStars.
         	*@note The shape of the Telescope symbol is currently a hard-coded bullseye.
         	*@param psky reference to the QPainter on which to draw (this should be the Sky pixmap).
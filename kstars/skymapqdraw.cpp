@@ -20,6 +20,7 @@
 #include "skymap.h"
 #include "projections/projector.h"
 #include "printing/legend.h"
+#include "skycomponents/skylabeler.h"
 #include "kstars_debug.h"
 
 SkyMapQDraw::SkyMapQDraw(SkyMap *sm) : QWidget(sm), SkyMapDrawAbstract(sm)
@@ -34,7 +35,6 @@ SkyMapQDraw::~SkyMapQDraw()
 
 void SkyMapQDraw::paintEvent(QPaintEvent *event)
 {
-    Q_UNUSED(event)
     // This is machinery to prevent multiple concurrent paint events / recursive paint events
     if (m_DrawLock)
     {
@@ -46,19 +46,28 @@ void SkyMapQDraw::paintEvent(QPaintEvent *event)
     // JM 2016-05-03: Not needed since we're not using OpenGL for now
     //calculateFPS();
 
-    //If computeSkymap is false, then we just refresh the window using the stored sky pixmap
-    //and draw the "overlays" on top.  This lets us update the overlay information rapidly
-    //without needing to recompute the entire skymap.
-    //use update() to trigger this "short" paint event; to force a full "recompute"
-    //of the skymap, use forceUpdate().
+    //The sky is drawn in two layers. The sky layer holds everything the sky components
+    //draw together with their labels, and is kept in m_SkyPixmap. The dynamic overlays
+    //(FOV symbols, telescope symbols, zoom box and angle ruler) are drawn on top of it
+    //on every paint event.
+    //If computeSkymap is false, then we just refresh the damaged part of the window from
+    //the stored sky layer and draw the dynamic overlays on top.  This lets us update the
+    //overlay information rapidly without needing to recompute the entire skymap.
+    //use update() to trigger this "short" paint event, or update(QRect) when only a part
+    //of the overlays moved; to force a full "recompute" of the skymap, use forceUpdate().
 
     if (!m_SkyMap->computeSkymap)
     {
         QPainter p;
         p.begin(this);
         p.drawLine(0, 0, 1, 1); // Dummy operation to circumvent bug. TODO: Add details
-        p.drawPixmap(0, 0, *m_SkyPixmap);
-        drawOverlays(p);
+#if QT_VERSION >= QT_VERSION_CHECK(5, 8, 0)
+        for (const QRect &rect : event->region())
+#else
+        for (const QRect &rect : event->region().rects())
+#endif
+            p.drawPixmap(rect, *m_SkyPixmap, rect);
+        drawDynamicOverlays(p);
         p.end();
 
         setDrawLock(false);
@@ -84,6 +93,11 @@ void SkyMapQDraw::paintEvent(QPaintEvent *event)
     psky.setClipping(true);
 
     m_KStarsData->skyComposite()->draw(&psky);
+
+    // Labels may reach past the edge of the sky, and are only replayed once per recompute
+    psky.setClipping(false);
+    SkyLabeler::Instance()->draw(psky);
+
     //Finish up
     psky.end();
 
@@ -91,7 +105,7 @@ void SkyMapQDraw::paintEvent(QPaintEvent *event)
     psky2.begin(this);
     psky2.drawLine(0, 0, 1, 1); // Dummy op.
     psky2.drawPixmap(0, 0, *m_SkyPixmap);
-    drawOverlays(psky2);
+    drawDynamicOverlays(psky2);
     psky2.end();
 
     if (m_SkyMap->m_previewLegend)
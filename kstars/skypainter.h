@@ -128,6 +128,18 @@ class SkyPainter
      */
     virtual bool drawPointSource(SkyPoint *loc, float mag, char sp = 'A') = 0;
 
+    /**
+     * @short Start a batch of point sources.
+     * Until endPointSources() is called, the painter may keep the point
+     * sources it is asked to draw and draw them together at the end, so
+     * nothing else may be drawn in between.
+     * @see endPointSources()
+     */
+    virtual void beginPointSources() {}
+
+    /** @short Draw the point sources kept since beginPointSources(). */
+    virtual void endPointSources() {}
+
     /**
      * @short Draw a deep sky object
      * @param obj the object to draw
@@ -86,8 +86,12 @@ const int nSPclasses = 7;
 
 // Cache for star images.
 //
-// These pixmaps are never deallocated. Not really good...
-QPixmap *imageCache[nSPclasses][nStarSizes] = { { nullptr } };
+// The images of every spectral class and size are packed in one pixmap, so a
+// batch of stars is drawn with a single drawPixmapFragments() call. Class i
+// is in row i, sizes grow from left to right with a transparent pixel between
+// them so smooth scaling never picks up a neighbour.
+QPixmap *starAtlas = nullptr;
+QRectF starAtlasRects[nSPclasses][nStarSizes];
 
 std::unique_ptr<QPixmap> visibleSatPixmap, invisibleSatPixmap;
 }
@@ -98,18 +102,8 @@ QMap<char, QColor> SkyQPainter::ColorMap = QMap<char, QColor>();
 
 void SkyQPainter::releaseImageCache()
 {
-    for (char &color : ColorMap.keys())
-    {
-        QPixmap **pmap = imageCache[harvardToIndex(color)];
-
-        for (int size = 1; size < nStarSizes; size++)
-        {
-            if (pmap[size])
-                delete pmap[size];
-
-            pmap[size] = nullptr;
-        }
-    }
+    delete starAtlas;
+    starAtlas = nullptr;
 }
 
 SkyQPainter::SkyQPainter(QPaintDevice *pd) : SkyPainter(), QPainter()
@@ -153,6 +147,7 @@ void SkyQPainter::begin()
 
 void SkyQPainter::end()
 {
+    endPointSources();
     QPainter::end();
 }
 
@@ -211,6 +206,16 @@ void SkyQPainter::initStarImages()
         ColorMap.insert('M', m_starColor);
     }
 
+    // Each row holds the sizes 1 to nStarSizes - 1, each followed by a gap
+    const int atlasRow = nStarSizes + 1;
+    if (!starAtlas)
+        starAtlas = new QPixmap(nStarSizes * (nStarSizes - 1) / 2 + nStarSizes - 1, nSPclasses * atlasRow);
+    starAtlas->fill(Qt::transparent);
+
+    QPainter atlas;
+    atlas.begin(starAtlas);
+    atlas.setCompositionMode(QPainter::CompositionMode_Source);
+
     for (char &color : ColorMap.keys())
     {
         QPixmap BigImage(15, 15);
@@ -251,16 +256,19 @@ void SkyQPainter::initStarImages()
         }
         p.end();
 
-        // Cache array slice
-        QPixmap **pmap = imageCache[harvardToIndex(color)];
+        // Atlas row
+        const int row = harvardToIndex(color);
+        int x         = 0;
 
         for (int size = 1; size < nStarSizes; size++)
         {
-            if (!pmap[size])
-                pmap[size] = new QPixmap();
-            *pmap[size] = BigImage.scaled(size, size, Qt::KeepAspectRatio, Qt::SmoothTransformation);
+            starAtlasRects[row][size] = QRectF(x, row * atlasRow, size, size);
+            atlas.drawPixmap(x, row * atlasRow,
+                             BigImage.scaled(size, size, Qt::KeepAspectRatio, Qt::SmoothTransformation));
+            x += size + 1;
         }
     }
+    atlas.end();
     starColorMode = Options::starColorMode();
 
     if (!visibleSatPixmap.get())
@@ -295,54 +303,57 @@ void SkyQPainter::drawSkyLine(SkyPoint *a, SkyPoint *b)
     //    } //FIXME: what if both are offscreen but the line isn't?
 }
 
-void SkyQPainter::drawSkyPolyline(LineList *list, SkipHashList *skipList, LineListLabel *label)
+void SkyQPainter::projectLineList(LineList *list)
 {
     SkyList *points = list->points();
-    bool isVisible, isVisibleLast;
+    quint64 key     = (m_proj->viewID() << 32) | list->screenUpdateID;
+
+    if (list->cacheScreen && list->screenKey == key && list->screenPoints.size() == points->size())
+        return;
 
-    QPointF oLast = m_proj->toScreen(points->first().get(), true, &isVisibleLast);
-    // & with the result of checkVisibility to clip away things below horizon
-    isVisibleLast &= m_proj->checkVisibility(points->first().get());
-    QPointF oThis, oThis2;
+    list->screenPoints.resize(points->size());
+    list->screenVisible.resize(points->size());
 
-    for (int j = 1; j < points->size(); j++)
+    for (int i = 0; i < points->size(); i++)
     {
-        SkyPoint *pThis = points->at(j).get();
+        SkyPoint *point = points->at(i).get();
+        bool isVisible  = false;
 
-        oThis2 = oThis = m_proj->toScreen(pThis, true, &isVisible);
+        list->screenPoints[i] = m_proj->toScreen(point, true, &isVisible);
         // & with the result of checkVisibility to clip away things below horizon
-        isVisible &= m_proj->checkVisibility(pThis);
-        bool doSkip = false;
-        if (skipList)
-        {
-            doSkip = skipList->skip(j);
-        }
+        list->screenVisible[i] = isVisible && m_proj->checkVisibility(point);
+    }
 
-        bool pointsVisible = false;
-        //Temporary solution to avoid random lines in Gnomonic projection and draw lines up to horizon
-        if (SkyMap::Instance()->projector()->type() == Projector::Gnomonic)
-        {
-            if (isVisible && isVisibleLast)
-                pointsVisible = true;
-        }
-        else
-        {
-            if (isVisible || isVisibleLast)
-                pointsVisible = true;
-        }
+    list->screenKey = list->cacheScreen ? key : 0;
+}
+
+void SkyQPainter::drawSkyPolyline(LineList *list, SkipHashList *skipList, LineListLabel *label)
+{
+    projectLineList(list);
 
-        if (!doSkip)
+    const QVector<QPointF> &screenPoints = list->screenPoints;
+    const QVector<bool> &screenVisible   = list->screenVisible;
+    //Temporary solution to avoid random lines in Gnomonic projection and draw lines up to horizon
+    const bool isGnomonic = SkyMap::Instance()->projector()->type() == Projector::Gnomonic;
+
+    for (int j = 1; j < screenPoints.size(); j++)
+    {
+        bool isVisible     = screenVisible[j];
+        bool isVisibleLast = screenVisible[j - 1];
+
+        if (skipList && skipList->skip(j))
+            continue;
+
+        bool pointsVisible = isGnomonic ? (isVisible && isVisibleLast) : (isVisible || isVisibleLast);
+
+        if (pointsVisible)
         {
-            if (pointsVisible)
-            {
-                drawLine(oLast, oThis);
-                if (label)
-                    label->updateLabelCandidates(oThis.x(), oThis.y(), list, j);
-            }
-        }
+            const QPointF &oThis = screenPoints[j];
 
-        oLast         = oThis2;
-        isVisibleLast = isVisible;
+            drawLine(screenPoints[j - 1], oThis);
+            if (label)
+                label->updateLabelCandidates(oThis.x(), oThis.y(), list, j);
+        }
     }
 }
 
@@ -367,37 +378,38 @@ void SkyQPainter::drawSkyPolygon(LineList *list, bool forceClip)
         return;
     }
 
-    SkyPoint *pLast = points->last().get();
-    QPointF oLast   = m_proj->toScreen(pLast, true, &isVisibleLast);
-    // & with the result of checkVisibility to clip away things below horizon
-    isVisibleLast &= m_proj->checkVisibility(pLast);
+    if (points->isEmpty())
+        return;
+
+    projectLineList(list);
+
+    const QVector<QPointF> &screenPoints = list->screenPoints;
+    const QVector<bool> &screenVisible   = list->screenVisible;
+    int last                             = points->size() - 1;
 
-    for (const auto &point : *points)
+    polygon.reserve(points->size());
+
+    for (int i = 0; i < points->size(); i++)
     {
-        SkyPoint *pThis = point.get();
-        QPointF oThis   = m_proj->toScreen(pThis, true, &isVisible);
-        // & with the result of checkVisibility to clip away things below horizon
-        isVisible &= m_proj->checkVisibility(pThis);
+        isVisible     = screenVisible[i];
+        isVisibleLast = screenVisible[last];
 
+        // Only segments crossing the edge of the visible sky need the points themselves
         if (isVisible && isVisibleLast)
         {
-            polygon << oThis;
+            polygon << screenPoints[i];
         }
         else if (isVisibleLast)
         {
-            QPointF oMid = m_proj->clipLine(pLast, pThis);
-            polygon << oMid;
+            polygon << m_proj->clipLine(points->at(last).get(), points->at(i).get());
         }
         else if (isVisible)
         {
-            QPointF oMid = m_proj->clipLine(pThis, pLast);
-            polygon << oMid;
-            polygon << oThis;
+            polygon << m_proj->clipLine(points->at(i).get(), points->at(last).get());
+            polygon << screenPoints[i];
         }
 
-        pLast         = pThis;
-        oLast         = oThis;
-        isVisibleLast = isVisible;
+        last = i;
     }
 
     if (polygon.size())
@@ -578,15 +590,34 @@ bool SkyQPainter::drawPointSource(SkyPoint *loc, float mag, char sp)
     }
 }
 
+void SkyQPainter::beginPointSources()
+{
+    m_batchPointSources = true;
+}
+
+void SkyQPainter::endPointSources()
+{
+    m_batchPointSources = false;
+
+    if (m_pointSources.isEmpty())
+        return;
+
+    drawPixmapFragments(m_pointSources.constData(), m_pointSources.size(), *starAtlas);
+    // Keep the capacity for the next batch
+    m_pointSources.resize(0);
+}
+
 void SkyQPainter::drawPointSource(const QPointF &pos, float size, char sp)
 {
-    int isize = qMin(static_cast<int>(size), 14);
+    int isize = qBound(1, static_cast<int>(size), 14);
     if (!m_vectorStars || starColorMode == 0)
     {
         // Draw stars as bitmaps, either because we were asked to, or because we're painting real colors
-        QPixmap *im  = imageCache[harvardToIndex(sp)][isize];
-        float offset = 0.5 * im->width();
-        drawPixmap(QPointF(pos.x() - offset, pos.y() - offset), *im);
+        const QRectF &source = starAtlasRects[harvardToIndex(sp)][isize];
+        if (m_batchPointSources)
+            m_pointSources.append(QPainter::PixmapFragment::create(pos, source));
+        else
+            drawPixmap(QPointF(pos.x() - 0.5 * source.width(), pos.y() - 0.5 * source.height()), *starAtlas, source);
     }
     else
     {
@@ -23,6 +23,7 @@
 
 #include <QColor>
 #include <QMap>
+#include <QVector>
 
 class Projector;
 class QWidget;
@@ -87,6 +88,8 @@ class SkyQPainter : public SkyPainter, public QPainter
                          LineListLabel *label = nullptr) override;
     void drawSkyPolygon(LineList *list, bool forceClip = true) override;
     bool drawPointSource(SkyPoint *loc, float mag, char sp = 'A') override;
+    void beginPointSources() override;
+    void endPointSources() override;
     bool drawDeepSkyObject(DeepSkyObject *obj, bool drawImage = false) override;
     bool drawPlanet(KSPlanetBase *planet) override;
     bool drawEarthShadow(KSEarthShadow *shadow) override;
@@ -104,10 +107,15 @@ class SkyQPainter : public SkyPainter, public QPainter
 
 private:
     virtual bool drawDeepSkyImage(const QPointF &pos, DeepSkyObject *obj, float positionAngle);
+    /** Fills the screen positions of the list, unless those of its previous draw are still valid. */
+    void projectLineList(LineList *list);
 
     QPaintDevice *m_pd { nullptr };
     const Projector *m_proj { nullptr };
     bool m_vectorStars { false };
+    // Star images kept between beginPointSources() and endPointSources()
+    bool m_batchPointSources { false };
+    QVector<QPainter::PixmapFragment> m_pointSources;
     HIPSRenderer *m_hipsRender { nullptr };
     QSize m_size;
     static int starColorMode;